@@ -49,6 +49,9 @@ static gboolean		component_supports_custom_props	(JanaComponent *self);
 static GList *		component_get_custom_props_list	(JanaComponent *self);
 static gchar *		component_get_custom_prop	(JanaComponent *self,
 							 const gchar *name);
+static void		component_get_custom_props	(JanaComponent *self,
+							 const gchar **names,
+							 gchar **values);
 static gboolean		component_set_custom_prop	(JanaComponent *self,
 							 const gchar *name,
 							 const gchar *value);
@@ -68,12 +71,71 @@ typedef struct _JanaEcalComponentPrivate JanaEcalComponentPrivate;
 struct _JanaEcalComponentPrivate
 {
 	ECalComponent *comp;
+
+	/* When created over an icalcomponent owned by somebody else (an
+	 * ECalView, for example), comp is NULL and this points at the
+	 * borrowed component until component_ensure_ecalcomp() copies it.
+	 */
+	icalcomponent *icalcomp;
+
+	/* Decoded fields, filled in on first access and dropped by the
+	 * corresponding setters.
+	 */
+	JanaTime *start;
+	JanaTime *end;
+	gchar **categories;
+	gboolean start_valid;
+	gboolean end_valid;
+	gboolean categories_valid;
+
+	/* X-property name to first icalproperty with that name, built on 
+	 * first use. Keys are owned by the properties. It is dropped 
+	 * whenever comp is handed out, and not kept while anybody else holds 
+	 * a reference on comp, as properties may then be changed behind its 
+	 * back.
+	 */
+	GHashTable *props_index;
 };
 
 enum {
 	PROP_ECALCOMP = 1,
+	PROP_ICALCOMP,
 };
 
+static void
+component_invalidate_props_index (JanaEcalComponentPrivate *priv)
+{
+	if (priv->props_index) {
+		g_hash_table_destroy (priv->props_index);
+		priv->props_index = NULL;
+	}
+}
+
+static ECalComponent *
+component_ensure_ecalcomp (JanaEcalComponentPrivate *priv)
+{
+	if (!priv->comp) {
+		/* The index points into the borrowed component */
+		component_invalidate_props_index (priv);
+
+		priv->comp = e_cal_component_new ();
+		if (priv->icalcomp)
+			e_cal_component_set_icalcomponent (priv->comp,
+				icalcomponent_new_clone (priv->icalcomp));
+		priv->icalcomp = NULL;
+	}
+	
+	return priv->comp;
+}
+
+static icalcomponent *
+component_get_icalcomp (JanaEcalComponentPrivate *priv)
+{
+	return priv->comp ?
+		e_cal_component_get_icalcomponent (priv->comp) :
+		priv->icalcomp;
+}
+
 static void
 jana_ecal_component_get_property (GObject *object, guint property_id,
 			      GValue *value, GParamSpec *pspec)
@@ -82,7 +144,8 @@ jana_ecal_component_get_property (GObject *object, guint property_id,
 
 	switch (property_id) {
 	    case PROP_ECALCOMP :
-		g_value_set_object (value, priv->comp);
+		g_value_set_object (value, component_ensure_ecalcomp (priv));
+		component_invalidate_props_index (priv);
 		break;
 	    default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
@@ -97,22 +160,60 @@ jana_ecal_component_set_property (GObject *object, guint property_id,
 
 	switch (property_id) {
 	    case PROP_ECALCOMP :
-		priv->comp = E_CAL_COMPONENT (g_value_dup_object (value));
+		if (g_value_get_object (value))
+			priv->comp = E_CAL_COMPONENT (
+				g_value_dup_object (value));
+		component_invalidate_props_index (priv);
+		break;
+	    case PROP_ICALCOMP :
+		priv->icalcomp = g_value_get_pointer (value);
 		break;
 	    default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
 	}
 }
 
+static void
+component_invalidate_start (JanaEcalComponentPrivate *priv)
+{
+	if (priv->start) {
+		g_object_unref (priv->start);
+		priv->start = NULL;
+	}
+	priv->start_valid = FALSE;
+}
+
+static void
+component_invalidate_end (JanaEcalComponentPrivate *priv)
+{
+	if (priv->end) {
+		g_object_unref (priv->end);
+		priv->end = NULL;
+	}
+	priv->end_valid = FALSE;
+}
+
+static void
+component_invalidate_categories (JanaEcalComponentPrivate *priv)
+{
+	g_strfreev (priv->categories);
+	priv->categories = NULL;
+	priv->categories_valid = FALSE;
+}
+
 static void
 jana_ecal_component_dispose (GObject *object)
 {
 	JanaEcalComponentPrivate *priv = COMPONENT_PRIVATE (object);
 
+	component_invalidate_start (priv);
+	component_invalidate_end (priv);
+
 	if (priv->comp) {
 		g_object_unref (priv->comp);
 		priv->comp = NULL;
 	}
+	priv->icalcomp = NULL;
 
 	if (G_OBJECT_CLASS (jana_ecal_component_parent_class)->dispose)
 		G_OBJECT_CLASS (jana_ecal_component_parent_class)->dispose (object);
@@ -121,6 +222,11 @@ jana_ecal_component_dispose (GObject *object)
 static void
 jana_ecal_component_finalize (GObject *object)
 {
+	JanaEcalComponentPrivate *priv = COMPONENT_PRIVATE (object);
+
+	component_invalidate_categories (priv);
+	component_invalidate_props_index (priv);
+
 	G_OBJECT_CLASS (jana_ecal_component_parent_class)->finalize (object);
 }
 
@@ -140,6 +246,7 @@ component_interface_init (gpointer g_iface, gpointer iface_data)
 	iface->get_custom_props_list = component_get_custom_props_list;
 	iface->get_custom_prop = component_get_custom_prop;
 	iface->set_custom_prop = component_set_custom_prop;
+	iface->get_custom_props = component_get_custom_props;
 }
 
 static void
@@ -165,6 +272,17 @@ jana_ecal_component_class_init (JanaEcalComponentClass *klass)
 			E_TYPE_CAL_COMPONENT,
 			G_PARAM_READABLE | G_PARAM_WRITABLE |
 			G_PARAM_CONSTRUCT_ONLY));
+
+	g_object_class_install_property (
+		object_class,
+		PROP_ICALCOMP,
+		g_param_spec_pointer (
+			"icalcomp",
+			"icalcomponent *",
+			"An icalcomponent to represent without copying. The "
+			"caller must keep it alive until "
+			"jana_ecal_component_detach() is called.",
+			G_PARAM_WRITABLE | G_PARAM_CONSTRUCT_ONLY));
 }
 
 static void
@@ -188,6 +306,121 @@ jana_ecal_component_new_from_ecalcomp (ECalComponent *component)
 		"ecalcomp", component, NULL));
 }
 
+/**
+ * jana_ecal_component_detach:
+ * @self: A #JanaEcalComponent
+ *
+ * If @self was created over a borrowed icalcomponent, using the "icalcomp" 
+ * construct property, makes a private copy of it so that @self remains 
+ * valid after the owner of the icalcomponent frees it. Components that 
+ * already own their data are left untouched.
+ */
+void
+jana_ecal_component_detach (JanaEcalComponent *self)
+{
+	JanaEcalComponentPrivate *priv = COMPONENT_PRIVATE (self);
+	
+	if (priv->icalcomp) component_ensure_ecalcomp (priv);
+}
+
+/**
+ * jana_ecal_component_peek_icalcomp:
+ * @self: A #JanaEcalComponent
+ *
+ * Retrieves the icalcomponent that currently holds the data of @self. This 
+ * may be borrowed from elsewhere (see jana_ecal_component_detach()), so it 
+ * must only be read from, and not kept. This function is intended for 
+ * using only when extending #JanaEcalComponent.
+ *
+ * Returns: The icalcomponent backing @self, or %NULL.
+ */
+icalcomponent *
+jana_ecal_component_peek_icalcomp (JanaEcalComponent *self)
+{
+	JanaEcalComponentPrivate *priv = COMPONENT_PRIVATE (self);
+	
+	return component_get_icalcomp (priv);
+}
+
+static icalproperty *
+component_get_first_property (JanaEcalComponentPrivate *priv,
+			      icalproperty_kind kind)
+{
+	icalcomponent *comp = component_get_icalcomp (priv);
+	
+	return comp ? icalcomponent_get_first_property (comp, kind) : NULL;
+}
+
+/**
+ * jana_ecal_component_peek_summary:
+ * @self: A #JanaEcalComponent
+ *
+ * Retrieves the summary from the underlying #ECalComponent, without copying 
+ * it. This function is intended for using only when extending 
+ * #JanaEcalComponent.
+ *
+ * Returns: The summary from the underlying #ECalComponent, or %NULL. This 
+ * string is owned by the component and must not be freed.
+ */
+const gchar *
+jana_ecal_component_peek_summary (JanaEcalComponent *self)
+{
+	icalproperty *prop;
+	JanaEcalComponentPrivate *priv = COMPONENT_PRIVATE (self);
+	
+	prop = component_get_first_property (priv, ICAL_SUMMARY_PROPERTY);
+	
+	return prop ? icalproperty_get_summary (prop) : NULL;
+}
+
+/**
+ * jana_ecal_component_peek_description:
+ * @self: A #JanaEcalComponent
+ *
+ * Retrieves the first description from the underlying #ECalComponent, 
+ * without copying it. This function is intended for using only when 
+ * extending #JanaEcalComponent.
+ *
+ * Returns: The first description from the underlying #ECalComponent, or 
+ * %NULL. This string is owned by the component and must not be freed.
+ */
+const gchar *
+jana_ecal_component_peek_description (JanaEcalComponent *self)
+{
+	icalproperty *prop;
+	JanaEcalComponentPrivate *priv = COMPONENT_PRIVATE (self);
+	
+	/* Note, that only journal components are allowed to have more than one
+	 * description. It's ok to just take the first here. Reading the 
+	 * property directly avoids building a text list on every call.
+	 */
+	prop = component_get_first_property (priv, ICAL_DESCRIPTION_PROPERTY);
+	
+	return prop ? icalproperty_get_description (prop) : NULL;
+}
+
+/**
+ * jana_ecal_component_peek_location:
+ * @self: A #JanaEcalComponent
+ *
+ * Retrieves the location from the underlying #ECalComponent, without copying 
+ * it. This function is intended for using only when extending 
+ * #JanaEcalComponent.
+ *
+ * Returns: The location from the underlying #ECalComponent, or %NULL. This 
+ * string is owned by the component and must not be freed.
+ */
+const gchar *
+jana_ecal_component_peek_location (JanaEcalComponent *self)
+{
+	icalproperty *prop;
+	JanaEcalComponentPrivate *priv = COMPONENT_PRIVATE (self);
+	
+	prop = component_get_first_property (priv, ICAL_LOCATION_PROPERTY);
+	
+	return prop ? icalproperty_get_location (prop) : NULL;
+}
+
 /**
  * jana_ecal_component_get_summary:
  * @self: A #JanaEcalComponent
@@ -201,14 +434,7 @@ jana_ecal_component_new_from_ecalcomp (ECalComponent *component)
 gchar *
 jana_ecal_component_get_summary (JanaEcalComponent *self)
 {
-	ECalComponentText summary;
-	JanaEcalComponentPrivate *priv = COMPONENT_PRIVATE (self);
-	
-	e_cal_component_get_summary (priv->comp, &summary);
-	
-	if (summary.value) return g_strdup (summary.value);
-	/*else if (summary.altrep) return g_strdup (summary.altrep);*/
-	else return NULL;
+	return g_strdup (jana_ecal_component_peek_summary (self));
 }
 
 /**
@@ -224,24 +450,7 @@ jana_ecal_component_get_summary (JanaEcalComponent *self)
 gchar *
 jana_ecal_component_get_description (JanaEcalComponent *self)
 {
-	GSList *desc_list;
-	ECalComponentText *desc;
-	gchar *desc_copy = NULL;
-	JanaEcalComponentPrivate *priv = COMPONENT_PRIVATE (self);
-	
-	/* Note, that only journal components are allowed to have more than one
-	 * description. It's ok to just take the first here.
-	 */
-	e_cal_component_get_description_list (priv->comp, &desc_list);
-	if (desc_list) {
-		desc = desc_list->data;
-		if (desc->value)
-			desc_copy = g_strdup (desc->value);
-	}
-	
-	e_cal_component_free_text_list (desc_list);
-	
-	return desc_copy;
+	return g_strdup (jana_ecal_component_peek_description (self));
 }
 
 /**
@@ -257,12 +466,7 @@ jana_ecal_component_get_description (JanaEcalComponent *self)
 gchar *
 jana_ecal_component_get_location (JanaEcalComponent *self)
 {
-	const char *location;
-	JanaEcalComponentPrivate *priv = COMPONENT_PRIVATE (self);
-	
-	e_cal_component_get_location (priv->comp, &location);
-	
-	return location ? g_strdup (location) : NULL;
+	return g_strdup (jana_ecal_component_peek_location (self));
 }
 
 /**
@@ -282,7 +486,8 @@ jana_ecal_component_set_summary (JanaEcalComponent *self, const gchar *summary)
 	summary_text.value = summary;
 	summary_text.altrep = NULL;
 	
-	e_cal_component_set_summary (priv->comp, &summary_text);
+	e_cal_component_set_summary (component_ensure_ecalcomp (priv),
+		&summary_text);
 }
 
 /**
@@ -305,7 +510,8 @@ jana_ecal_component_set_description (JanaEcalComponent *self,
 	desc_text.altrep = NULL;
 	text_list = g_slist_append (NULL, &desc_text);
 	
-	e_cal_component_set_description_list (priv->comp, text_list);
+	e_cal_component_set_description_list (
+		component_ensure_ecalcomp (priv), text_list);
 	
 	g_slist_free (text_list);
 }
@@ -323,7 +529,42 @@ jana_ecal_component_set_location (JanaEcalComponent *self,
 				  const gchar *location)
 {
 	JanaEcalComponentPrivate *priv = COMPONENT_PRIVATE (self);
-	e_cal_component_set_location (priv->comp, location);
+	e_cal_component_set_location (component_ensure_ecalcomp (priv),
+		location);
+
+	/* The substitute start time for components without a dtstart is 
+	 * created in the location's timezone.
+	 */
+	component_invalidate_start (priv);
+}
+
+/* Equivalent to e_cal_component_get_dtstart/dtend, but reads the property 
+ * straight from the (possibly borrowed) icalcomponent.
+ */
+static gboolean
+component_get_datetime (JanaEcalComponentPrivate *priv,
+			icalproperty_kind kind, struct icaltimetype *value,
+			ECalComponentDateTime *dt)
+{
+	icalparameter *param;
+	icalproperty *prop = component_get_first_property (priv, kind);
+	
+	if (!prop) return FALSE;
+	
+	*value = (kind == ICAL_DTSTART_PROPERTY) ?
+		icalproperty_get_dtstart (prop) :
+		icalproperty_get_dtend (prop);
+	dt->value = value;
+	
+	param = icalproperty_get_first_parameter (prop, ICAL_TZID_PARAMETER);
+	if (param)
+		dt->tzid = icalparameter_get_tzid (param);
+	else if (icaltime_is_utc (*value))
+		dt->tzid = "UTC";
+	else
+		dt->tzid = NULL;
+	
+	return TRUE;
 }
 
 /**
@@ -340,35 +581,36 @@ JanaTime *
 jana_ecal_component_get_start (JanaEcalComponent *self)
 {
 	ECalComponentDateTime dt;
-	JanaTime *time;
+	struct icaltimetype value;
 	JanaEcalComponentPrivate *priv = COMPONENT_PRIVATE (self);
 
-	dt.value = NULL;	
-	e_cal_component_get_dtstart (priv->comp, &dt);
-	
-	if (dt.value) {
-		time = jana_ecal_time_new_from_ecaltime (&dt);
-		e_cal_component_free_datetime (&dt);
+	if (priv->start_valid)
+		return priv->start ? jana_time_duplicate (priv->start) : NULL;
+
+	if (component_get_datetime (priv, ICAL_DTSTART_PROPERTY,
+	     &value, &dt)) {
+		priv->start = jana_ecal_time_new_from_ecaltime (&dt);
 	} else {
 		const gchar *location;
 		
 		/* A NULL time means 'from the beginning of time', so create
 		 * a very early time as substitute.
 		 */
-		time = jana_ecal_time_new ();
+		priv->start = jana_ecal_time_new ();
 		
-		e_cal_component_get_location (priv->comp, &location);
+		location = jana_ecal_component_peek_location (self);
 		if (location)
 			jana_ecal_time_set_location (
-				JANA_ECAL_TIME (time), location);
+				JANA_ECAL_TIME (priv->start), location);
 		
-		jana_time_set_year (time, -G_MAXINT);
-		jana_time_set_month (time, 1);
-		jana_time_set_day (time, 1);
-		jana_time_set_isdate (time, TRUE);
+		jana_time_set_year (priv->start, -G_MAXINT);
+		jana_time_set_month (priv->start, 1);
+		jana_time_set_day (priv->start, 1);
+		jana_time_set_isdate (priv->start, TRUE);
 	}
+	priv->start_valid = TRUE;
 	
-	return time;
+	return jana_time_duplicate (priv->start);
 }
 
 /**
@@ -385,14 +627,38 @@ JanaTime *
 jana_ecal_component_get_end (JanaEcalComponent *self)
 {
 	ECalComponentDateTime dt;
-	JanaTime *time;
+	struct icaltimetype value;
 	JanaEcalComponentPrivate *priv = COMPONENT_PRIVATE (self);
 
-	dt.value = NULL;	
-	e_cal_component_get_dtend (priv->comp, &dt);
-	time = jana_ecal_time_new_from_ecaltime (&dt);
-	if (dt.value) e_cal_component_free_datetime (&dt);
-	return time;
+	if (!priv->end_valid) {
+		icalproperty *prop;
+		
+		if (component_get_datetime (priv, ICAL_DTEND_PROPERTY,
+		     &value, &dt)) {
+			priv->end = jana_ecal_time_new_from_ecaltime (&dt);
+		} else if ((prop = component_get_first_property (priv,
+			    ICAL_DURATION_PROPERTY)) &&
+			   component_get_datetime (priv, ICAL_DTSTART_PROPERTY,
+			    &value, &dt)) {
+			/* As libecal does, fall back to dtstart + duration */
+			struct icaldurationtype duration =
+				icalproperty_get_duration (prop);
+			
+			if (!duration.is_neg) {
+				duration.days += duration.weeks * 7;
+				if (value.is_date && (duration.hours ||
+				    duration.minutes || duration.seconds))
+					value.is_date = 0;
+				icaltime_adjust (&value, duration.days,
+					duration.hours, duration.minutes,
+					duration.seconds);
+			}
+			priv->end = jana_ecal_time_new_from_ecaltime (&dt);
+		}
+		priv->end_valid = TRUE;
+	}
+
+	return priv->end ? jana_time_duplicate (priv->end) : NULL;
 }
 
 /**
@@ -428,7 +694,8 @@ jana_ecal_component_set_start (JanaEcalComponent *self, JanaTime *start)
 		dt.tzid = (const char *)icaltimezone_get_tzid (
 			(icaltimezone *)icaltime->zone);
 	
-	e_cal_component_set_dtstart (priv->comp, &dt);
+	e_cal_component_set_dtstart (component_ensure_ecalcomp (priv), &dt);
+	component_invalidate_start (priv);
 	
 	g_object_unref (time);
 }
@@ -466,7 +733,8 @@ jana_ecal_component_set_end (JanaEcalComponent *self, JanaTime *end)
 		dt.tzid = (const char *)icaltimezone_get_tzid (
 			(icaltimezone *)icaltime->zone);
 	
-	e_cal_component_set_dtend (priv->comp, &dt);
+	e_cal_component_set_dtend (component_ensure_ecalcomp (priv), &dt);
+	component_invalidate_end (priv);
 	
 	g_object_unref (time);
 }
@@ -488,39 +756,55 @@ component_is_fully_represented (JanaComponent *self)
 static gchar *
 component_get_uid (JanaComponent *self)
 {
-	const char *uid = NULL;
-	JanaEcalComponentPrivate *priv = COMPONENT_PRIVATE (self);
-	
-	e_cal_component_get_uid (priv->comp, &uid);
-	
-	return uid ? g_strdup (uid) : NULL;
+	return g_strdup (component_peek_uid (self));
 }
 
 static const gchar *
 component_peek_uid (JanaComponent *self)
 {
-	const char *uid = NULL;
+	icalproperty *prop;
 	JanaEcalComponentPrivate *priv = COMPONENT_PRIVATE (self);
 	
-	e_cal_component_get_uid (priv->comp, &uid);
+	prop = component_get_first_property (priv, ICAL_UID_PROPERTY);
 	
-	return uid;
+	return prop ? icalproperty_get_uid (prop) : NULL;
 }
 
 static gchar **
 component_get_categories (JanaComponent *self)
 {
-	const char *categories;
-	gchar **category_list;
 	JanaEcalComponentPrivate *priv = COMPONENT_PRIVATE (self);
 	
-	e_cal_component_get_categories (priv->comp, &categories);
+	if (!priv->categories_valid) {
+		icalproperty *prop;
+		icalcomponent *comp = component_get_icalcomp (priv);
+		GString *categories = NULL;
+		
+		/* libecal joins multiple CATEGORIES properties with commas */
+		for (prop = comp ? icalcomponent_get_first_property (comp,
+		     ICAL_CATEGORIES_PROPERTY) : NULL; prop;
+		     prop = icalcomponent_get_next_property (comp,
+		     ICAL_CATEGORIES_PROPERTY)) {
+			const char *value = icalproperty_get_categories (prop);
+			
+			if (!value) continue;
+			if (!categories)
+				categories = g_string_new (value);
+			else
+				g_string_append_printf (categories, ",%s",
+					value);
+		}
+		
+		if (categories) {
+			priv->categories = g_strsplit (
+				categories->str, ",", 0);
+			g_string_free (categories, TRUE);
+		} else
+			priv->categories = NULL;
+		priv->categories_valid = TRUE;
+	}
 
-	if (categories) {
-		category_list = g_strsplit (categories, ",", 0);
-		return category_list;
-	} else
-		return NULL;
+	return g_strdupv (priv->categories);
 }
 
 static void
@@ -534,14 +818,17 @@ component_set_categories (JanaComponent *self, const gchar **categories)
 	 *       category set will cause libical to crash.
 	 */
 	if ((!categories_joined) || (categories_joined[0] == '\0')) {
-		const gchar *categories;
-		e_cal_component_get_categories (priv->comp, &categories);
-		if (categories)
-			e_cal_component_set_categories (priv->comp, NULL);
+		if (component_get_first_property (priv,
+		    ICAL_CATEGORIES_PROPERTY))
+			e_cal_component_set_categories (
+				component_ensure_ecalcomp (priv), NULL);
 	} else {
-		e_cal_component_set_categories (priv->comp, categories_joined);
+		e_cal_component_set_categories (
+			component_ensure_ecalcomp (priv), categories_joined);
 	}
 	g_free (categories_joined);
+	
+	component_invalidate_categories (priv);
 }
 
 static gboolean
@@ -550,6 +837,76 @@ component_supports_custom_props (JanaComponent *self)
 	return TRUE;
 }
 
+static gchar *
+component_dup_prop_value (icalproperty *prop)
+{
+#ifdef LIBICAL_MEMFIXES
+	return icalproperty_get_value_as_string (prop);
+#else
+	return g_strdup (icalproperty_get_value_as_string (prop));
+#endif
+}
+
+static gboolean
+component_comp_is_shared (JanaEcalComponentPrivate *priv)
+{
+	return priv->comp && (G_OBJECT (priv->comp)->ref_count > 1);
+}
+
+/* Returns %NULL when the index can't be trusted */
+static GHashTable *
+component_get_props_index (JanaEcalComponentPrivate *priv)
+{
+	icalproperty *prop;
+	icalcomponent *comp;
+	
+	if (component_comp_is_shared (priv)) {
+		component_invalidate_props_index (priv);
+		return NULL;
+	}
+	
+	if (priv->props_index) return priv->props_index;
+	
+	priv->props_index = g_hash_table_new (g_str_hash, g_str_equal);
+	if (!(comp = component_get_icalcomp (priv))) return priv->props_index;
+	
+	for (prop = icalcomponent_get_first_property (comp, ICAL_X_PROPERTY);
+	     prop; prop = icalcomponent_get_next_property (
+	     comp, ICAL_X_PROPERTY)) {
+		const gchar *name = icalproperty_get_x_name (prop);
+		
+		/* Only the first property of a given name is visible */
+		if (name && !g_hash_table_lookup (priv->props_index, name))
+			g_hash_table_insert (priv->props_index,
+				(gpointer)name, prop);
+	}
+	
+	return priv->props_index;
+}
+
+static icalproperty *
+component_lookup_custom_prop (JanaEcalComponentPrivate *priv,
+			      const gchar *name)
+{
+	icalproperty *prop;
+	icalcomponent *comp;
+	GHashTable *index;
+	
+	if ((index = component_get_props_index (priv)))
+		return g_hash_table_lookup (index, name);
+	
+	if (!(comp = component_get_icalcomp (priv))) return NULL;
+	
+	for (prop = icalcomponent_get_first_property (comp, ICAL_X_PROPERTY);
+	     prop; prop = icalcomponent_get_next_property (
+	     comp, ICAL_X_PROPERTY)) {
+		const gchar *x_name = icalproperty_get_x_name (prop);
+		if (x_name && (strcmp (x_name, name) == 0)) return prop;
+	}
+	
+	return NULL;
+}
+
 static GList *
 component_get_custom_props_list (JanaComponent *self)
 {
@@ -558,21 +915,14 @@ component_get_custom_props_list (JanaComponent *self)
 	GList *props = NULL;
 	JanaEcalComponentPrivate *priv = COMPONENT_PRIVATE (self);
 	
-	comp = e_cal_component_get_icalcomponent (priv->comp);
+	if (!(comp = component_get_icalcomp (priv))) return NULL;
 	
 	for (prop = icalcomponent_get_first_property (comp, ICAL_X_PROPERTY);
 	     prop; prop = icalcomponent_get_next_property (
 	     comp, ICAL_X_PROPERTY)) {
 		gchar **prop_pair = g_new (gchar *, 2);
-		gchar *name = g_strdup (icalproperty_get_x_name (prop));
-#ifdef LIBICAL_MEMFIXES
-		gchar *value = icalproperty_get_value_as_string (prop);
-#else
-		gchar *value = g_strdup (icalproperty_get_value_as_string (
-			prop));
-#endif
-		prop_pair[0] = name;
-		prop_pair[1] = value;
+		prop_pair[0] = g_strdup (icalproperty_get_x_name (prop));
+		prop_pair[1] = component_dup_prop_value (prop);
 		props = g_list_prepend (props, prop_pair);
 	}
 	
@@ -583,26 +933,25 @@ static gchar *
 component_get_custom_prop (JanaComponent *self, const gchar *name)
 {
 	icalproperty *prop;
-	icalcomponent *comp;
 	JanaEcalComponentPrivate *priv = COMPONENT_PRIVATE (self);
 	
-	comp = e_cal_component_get_icalcomponent (priv->comp);
+	prop = component_lookup_custom_prop (priv, name);
 	
-	/* See if the property exists first */
-	for (prop = icalcomponent_get_first_property (comp, ICAL_X_PROPERTY);
-	     prop; prop = icalcomponent_get_next_property (
-	     comp, ICAL_X_PROPERTY)) {
-		if (strcmp (icalproperty_get_x_name (prop), name) == 0) {
-#ifdef LIBICAL_MEMFIXES
-			return icalproperty_get_value_as_string (prop);
-#else
-			return g_strdup (icalproperty_get_value_as_string (
-				prop));
-#endif
-		}
-	}
+	return prop ? component_dup_prop_value (prop) : NULL;
+}
+
+static void
+component_get_custom_props (JanaComponent *self, const gchar **names,
+			    gchar **values)
+{
+	gint i;
+	JanaEcalComponentPrivate *priv = COMPONENT_PRIVATE (self);
 	
-	return NULL;
+	for (i = 0; names[i]; i++) {
+		icalproperty *prop =
+			component_lookup_custom_prop (priv, names[i]);
+		values[i] = prop ? component_dup_prop_value (prop) : NULL;
+	}
 }
 
 static gboolean
@@ -611,22 +960,17 @@ component_set_custom_prop (JanaComponent *self, const gchar *name,
 {
 	icalproperty *prop;
 	icalcomponent *comp;
-	gboolean exists = FALSE;
+	gboolean exists;
 	JanaEcalComponentPrivate *priv = COMPONENT_PRIVATE (self);
 	
 	if (strncmp ("X-", name, 2) != 0) return FALSE;
 	
-	comp = e_cal_component_get_icalcomponent (priv->comp);
+	comp = e_cal_component_get_icalcomponent (
+		component_ensure_ecalcomp (priv));
 	
 	/* See if the property exists first */
-	for (prop = icalcomponent_get_first_property (comp, ICAL_X_PROPERTY);
-	     prop; prop = icalcomponent_get_next_property (
-	     comp, ICAL_X_PROPERTY)) {
-		if (strcmp (icalproperty_get_x_name (prop), name) == 0) {
-			exists = TRUE;
-			break;
-		}
-	}
+	prop = component_lookup_custom_prop (priv, name);
+	exists = prop ? TRUE : FALSE;
 	
 	if (!exists) {
 		/* Create a new property */
@@ -639,6 +983,9 @@ component_set_custom_prop (JanaComponent *self, const gchar *name,
 	
 	if (!exists) {
 		icalcomponent_add_property (comp, prop);
+		if (priv->props_index)
+			g_hash_table_insert (priv->props_index, (gpointer)
+				icalproperty_get_x_name (prop), prop);
 		/* FIXME: Check that the property added without errors - no
 		 *        idea how to do this :(
 		 */
@@ -652,6 +999,34 @@ component_set_custom_prop (JanaComponent *self, const gchar *name,
 	return TRUE;
 }
 
+/**
+ * jana_ecal_component_peek_ecalcomp:
+ * @self: A #JanaEcalComponent
+ *
+ * Retrieves the underlying #ECalComponent without taking a reference, as 
+ * opposed to reading the "ecalcomp" property. This function is intended for 
+ * using only when extending #JanaEcalComponent. Changes made directly on 
+ * the returned component bypass the start, end and category lookups that 
+ * @self caches, so the jana_ecal_component_set_* functions should be 
+ * preferred. Custom property lookups are indexed afresh afterwards. If 
+ * @self was borrowing its icalcomponent, this detaches it (see 
+ * jana_ecal_component_detach()).
+ *
+ * Returns: The #ECalComponent wrapped by @self. This is owned by @self and 
+ * must not be unreferenced.
+ */
+ECalComponent *
+jana_ecal_component_peek_ecalcomp (JanaEcalComponent *self)
+{
+	ECalComponent *comp;
+	JanaEcalComponentPrivate *priv = COMPONENT_PRIVATE (self);
+
+	comp = component_ensure_ecalcomp (priv);
+	component_invalidate_props_index (priv);
+	
+	return comp;
+}
+
 /**
  * jana_ecal_component_get_recurrence_id:
  * @self: A #JanaEcalComponent
@@ -665,6 +1040,7 @@ jana_ecal_component_get_recurrence_id (JanaEcalComponent *self)
 {
 	JanaEcalComponentPrivate *priv = COMPONENT_PRIVATE (self);
 
-	return e_cal_component_get_recurid_as_string (priv->comp);
+	return e_cal_component_get_recurid_as_string (
+		component_ensure_ecalcomp (priv));
 }
 
@@ -65,11 +65,19 @@ GType jana_ecal_component_get_type (void);
 
 JanaComponent *jana_ecal_component_new_from_ecalcomp (ECalComponent *component);
 
+ECalComponent *jana_ecal_component_peek_ecalcomp (JanaEcalComponent *self);
+icalcomponent *jana_ecal_component_peek_icalcomp (JanaEcalComponent *self);
+void jana_ecal_component_detach (JanaEcalComponent *self);
+
 gchar * jana_ecal_component_get_summary (JanaEcalComponent *self);
 gchar * jana_ecal_component_get_description (JanaEcalComponent *self);
 gchar * jana_ecal_component_get_location (JanaEcalComponent *self);
 gchar * jana_ecal_component_get_recurrence_id (JanaEcalComponent *self);
 
+const gchar * jana_ecal_component_peek_summary (JanaEcalComponent *self);
+const gchar * jana_ecal_component_peek_description (JanaEcalComponent *self);
+const gchar * jana_ecal_component_peek_location (JanaEcalComponent *self);
+
 JanaTime * jana_ecal_component_get_start (JanaEcalComponent *self);
 JanaTime * jana_ecal_component_get_end (JanaEcalComponent *self);
 
@@ -48,6 +48,9 @@ static gboolean			component_is_fully_represented
 static gchar * 	event_get_summary	(JanaEvent *self);
 static gchar * 	event_get_description	(JanaEvent *self);
 static gchar * 	event_get_location	(JanaEvent *self);
+static const gchar *	event_peek_summary	(JanaEvent *self);
+static const gchar *	event_peek_description	(JanaEvent *self);
+static const gchar *	event_peek_location	(JanaEvent *self);
 static JanaTime * 	event_get_start	(JanaEvent *self);
 static JanaTime *	event_get_end	(JanaEvent *self);
 
@@ -58,6 +61,7 @@ static JanaTime *event_get_alarm_time	(JanaEvent *self);
 static gboolean		event_supports_recurrence	(JanaEvent *self);
 static gboolean		event_has_recurrence		(JanaEvent *self);
 static JanaRecurrence *	event_get_recurrence		(JanaEvent *self);
+static JanaRecurrence *	event_parse_recurrence	(icalcomponent *comp);
 
 static gboolean	event_supports_exceptions	(JanaEvent *self);
 static gboolean	event_has_exceptions	(JanaEvent *self);
@@ -95,6 +99,9 @@ typedef struct _JanaEcalEventPrivate JanaEcalEventPrivate;
 
 struct _JanaEcalEventPrivate
 {
+	/* Parsed recurrence rule, see event_update_recurrence() */
+	JanaRecurrence *recur;
+	gboolean recur_valid;
 };
 
 static void
@@ -131,6 +138,10 @@ jana_ecal_event_dispose (GObject *object)
 static void
 jana_ecal_event_finalize (GObject *object)
 {
+	JanaEcalEventPrivate *priv = EVENT_PRIVATE (object);
+
+	jana_recurrence_free (priv->recur);
+
 	G_OBJECT_CLASS (jana_ecal_event_parent_class)->finalize (object);
 }
 
@@ -151,6 +162,9 @@ event_interface_init (gpointer g_iface, gpointer iface_data)
 	iface->get_summary = event_get_summary;
 	iface->get_description = event_get_description;
 	iface->get_location = event_get_location;
+	iface->peek_summary = event_peek_summary;
+	iface->peek_description = event_peek_description;
+	iface->peek_location = event_peek_location;
 	iface->get_start = event_get_start;
 	iface->get_end = event_get_end;
 	
@@ -181,8 +195,7 @@ jana_ecal_event_class_init (JanaEcalEventClass *klass)
 {
 	GObjectClass *object_class = G_OBJECT_CLASS (klass);
 
-	/* Don't add a zero-size private, causes memory corruption issues */
-	/*g_type_class_add_private (klass, sizeof (JanaEcalEventPrivate));*/
+	g_type_class_add_private (klass, sizeof (JanaEcalEventPrivate));
 
 	object_class->get_property = jana_ecal_event_get_property;
 	object_class->set_property = jana_ecal_event_set_property;
@@ -241,8 +254,8 @@ static gboolean
 component_is_fully_represented (JanaComponent *self)
 {
 	gboolean result = TRUE;
-	ECalComponent *comp;
-	g_object_get (self, "ecalcomp", &comp, NULL);
+	ECalComponent *comp = jana_ecal_component_peek_ecalcomp (
+		JANA_ECAL_COMPONENT (self));
 
 	/* TODO: We actually support slightly less than ECal simple recurrence,
 	 * filter this down some more.
@@ -279,8 +292,6 @@ component_is_fully_represented (JanaComponent *self)
 	 *       JanaEvent level, or do more in-depth checking here. This will
 	 *       catch the most important aspects at least.
 	 */
-	
-	g_object_unref (comp);
 
 	return result;
 }
@@ -303,6 +314,25 @@ event_get_location (JanaEvent *self)
 	return jana_ecal_component_get_location (JANA_ECAL_COMPONENT (self));
 }
 
+static const gchar *
+event_peek_summary (JanaEvent *self)
+{
+	return jana_ecal_component_peek_summary (JANA_ECAL_COMPONENT (self));
+}
+
+static const gchar *
+event_peek_description (JanaEvent *self)
+{
+	return jana_ecal_component_peek_description (
+		JANA_ECAL_COMPONENT (self));
+}
+
+static const gchar *
+event_peek_location (JanaEvent *self)
+{
+	return jana_ecal_component_peek_location (JANA_ECAL_COMPONENT (self));
+}
+
 static JanaTime *
 event_get_start (JanaEvent *self)
 {
@@ -342,18 +372,34 @@ event_supports_recurrence (JanaEvent *self)
 	return TRUE;
 }
 
+/* Parsing the rrule list is relatively expensive and the event store asks 
+ * for the recurrence of every event, so keep the parsed result until the 
+ * recurrence is changed.
+ */
+static void
+event_update_recurrence (JanaEvent *self)
+{
+	icalcomponent *comp;
+	JanaEcalEventPrivate *priv = EVENT_PRIVATE (self);
+	
+	if (priv->recur_valid) return;
+	
+	comp = jana_ecal_component_peek_icalcomp (JANA_ECAL_COMPONENT (self));
+	priv->recur = comp ? event_parse_recurrence (comp) : NULL;
+	priv->recur_valid = TRUE;
+}
+
 static gboolean
 event_has_recurrence (JanaEvent *self)
 {
-	ECalComponent *comp;
-	gboolean result;
+	JanaEcalEventPrivate *priv = EVENT_PRIVATE (self);
 	
-	g_object_get (self, "ecalcomp", &comp, NULL);
+	event_update_recurrence (self);
 	
-	result = e_cal_component_has_recurrences (comp);
-	g_object_unref (comp);
-	
-	return result;
+	/* Only report recurrences we can describe with a JanaRecurrence, 
+	 * callers expect jana_event_get_recurrence() to succeed after this.
+	 */
+	return priv->recur ? TRUE : FALSE;
 }
 
 /* Following function and define copied from libecal */
@@ -373,20 +419,32 @@ count_by_xxx (short *field, int max_elements)
 
 static JanaRecurrence *
 event_get_recurrence (JanaEvent *self)
+{
+	JanaEcalEventPrivate *priv = EVENT_PRIVATE (self);
+	
+	event_update_recurrence (self);
+	
+	return jana_recurrence_copy (priv->recur);
+}
+
+static JanaRecurrence *
+event_parse_recurrence (icalcomponent *comp)
 {
 	gint i;
-	GSList *rrule_list;
-	ECalComponent *comp;
+	icalproperty *prop;
 	JanaRecurrence *recur;
-	struct icalrecurrencetype *r;
+	struct icalrecurrencetype rrule, *r;
 	
-	if (!event_has_recurrence (self)) return NULL;
+	/* Recurrences may also be specified only by rdates, which aren't 
+	 * represented by JanaRecurrence.
+	 */
+	prop = icalcomponent_get_first_property (comp, ICAL_RRULE_PROPERTY);
+	if (!prop) return NULL;
 
 	/* Fill in our own recurrence struct */
-	g_object_get (self, "ecalcomp", &comp, NULL);
 	recur = jana_recurrence_new ();
-	e_cal_component_get_rrule_list (comp, &rrule_list);
-	r = rrule_list->data;
+	rrule = icalproperty_get_rrule (prop);
+	r = &rrule;
 
 	recur->interval = r->interval;
 	switch (r->freq) {
@@ -446,9 +504,6 @@ event_get_recurrence (JanaEvent *self)
 		recur->end = jana_ecal_time_new_from_icaltime (&r->until);
 	}
 	
-	e_cal_component_free_recur_list (rrule_list);
-	g_object_unref (comp);
-	
 	return recur;
 }
 
@@ -517,13 +572,17 @@ event_set_recurrence (JanaEvent *self, const JanaRecurrence *recur)
 	ECalComponent *comp;
 	GSList *rrule_list;
 	struct icalrecurrencetype r;
+	JanaEcalEventPrivate *priv = EVENT_PRIVATE (self);
 
-	g_object_get (self, "ecalcomp", &comp, NULL);
+	comp = jana_ecal_component_peek_ecalcomp (JANA_ECAL_COMPONENT (self));
+	
+	jana_recurrence_free (priv->recur);
+	priv->recur = NULL;
+	priv->recur_valid = FALSE;
 	
 	if (!recur) {
 		/* Remove recurrence */
 		e_cal_component_set_rrule_list (comp, NULL);
-		g_object_unref (comp);
 		return;
 	}
 	
@@ -633,8 +692,6 @@ event_set_recurrence (JanaEvent *self, const JanaRecurrence *recur)
 	rrule_list = g_slist_append (NULL, &r);
 	e_cal_component_set_rrule_list (comp, rrule_list);
 	g_slist_free (rrule_list);
-	
-	g_object_unref (comp);
 }
 
 static void
@@ -46,6 +46,10 @@ static gchar *	note_get_author		(JanaNote *self);
 static gchar *	note_get_recipient	(JanaNote *self);
 static gchar *	note_get_body		(JanaNote *self);
 
+static const gchar *	note_peek_author	(JanaNote *self);
+static const gchar *	note_peek_recipient	(JanaNote *self);
+static const gchar *	note_peek_body		(JanaNote *self);
+
 static JanaTime *	note_get_creation_time	(JanaNote *self);
 static JanaTime *	note_get_modified_time	(JanaNote *self);
 
@@ -80,6 +84,10 @@ note_interface_init (gpointer g_iface, gpointer iface_data)
 	iface->get_recipient = note_get_recipient;
 	iface->get_body = note_get_body;
 	
+	iface->peek_author = note_peek_author;
+	iface->peek_recipient = note_peek_recipient;
+	iface->peek_body = note_peek_body;
+	
 	iface->get_creation_time = note_get_creation_time;
 	iface->get_modified_time = note_get_modified_time;
 	
@@ -209,6 +217,41 @@ note_get_body (JanaNote *self)
 	return jana_ecal_component_get_description (JANA_ECAL_COMPONENT (self));
 }
 
+static const gchar *
+note_peek_author (JanaNote *self)
+{
+	return jana_ecal_component_peek_summary (JANA_ECAL_COMPONENT (self));
+}
+
+static const gchar *
+note_peek_recipient (JanaNote *self)
+{
+	return jana_ecal_component_peek_location (JANA_ECAL_COMPONENT (self));
+}
+
+static const gchar *
+note_peek_body (JanaNote *self)
+{
+	return jana_ecal_component_peek_description (
+		JANA_ECAL_COMPONENT (self));
+}
+
+/* Reads a CREATED or LAST-MODIFIED time without needing an ECalComponent */
+static JanaTime *
+note_get_time_property (JanaNote *self, icalproperty_kind kind)
+{
+	icalproperty *prop;
+	icaltimetype itime;
+	icalcomponent *comp = jana_ecal_component_peek_icalcomp (
+		JANA_ECAL_COMPONENT (self));
+
+	prop = comp ? icalcomponent_get_first_property (comp, kind) : NULL;
+	if (!prop) return jana_ecal_time_new_from_icaltime (NULL);
+	
+	itime = icalvalue_get_datetime (icalproperty_get_value (prop));
+	return jana_ecal_time_new_from_icaltime (&itime);
+}
+
 static JanaTime *
 note_get_creation_time (JanaNote *self)
 {
@@ -219,16 +262,8 @@ note_get_creation_time (JanaNote *self)
 	 * set.
 	 * FIXME: This will cause problems with store views...
 	 */
-	if (!creation) {
-		icaltimetype *itime;
-		ECalComponent *comp;
-
-		g_object_get (self, "ecalcomp", &comp, NULL);
-		e_cal_component_get_created (comp, &itime);
-		creation = jana_ecal_time_new_from_icaltime (itime);
-		if (itime) e_cal_component_free_icaltimetype (itime);
-		g_object_unref (comp);
-	}
+	if (!creation)
+		creation = note_get_time_property (self, ICAL_CREATED_PROPERTY);
 	
 	return creation;
 }
@@ -243,16 +278,9 @@ note_get_modified_time (JanaNote *self)
 	 * set.
 	 * FIXME: This will cause problems with store views...
 	 */
-	if (!modified) {
-		icaltimetype *itime;
-		ECalComponent *comp;
-
-		g_object_get (self, "ecalcomp", &comp, NULL);
-		e_cal_component_get_last_modified (comp, &itime);
-		modified = jana_ecal_time_new_from_icaltime (itime);
-		if (itime) e_cal_component_free_icaltimetype (itime);
-		g_object_unref (comp);
-	}
+	if (!modified)
+		modified = note_get_time_property (self,
+			ICAL_LASTMODIFIED_PROPERTY);
 	
 	return modified;
 }
@@ -68,7 +68,43 @@ static void	store_view_start	(JanaStoreView *self);
 
 static JanaStore *store_view_get_store	(JanaStoreView *self);
 
-static gboolean	store_view_refresh_query (JanaEcalStoreView *self);
+static void	store_view_begin_update	(JanaStoreView *self);
+
+static void	store_view_commit_update(JanaStoreView *self);
+
+static void	store_view_set_limit	(JanaStoreView *self, guint limit);
+
+static guint	store_view_get_limit	(JanaStoreView *self);
+
+static void	store_view_set_projection (JanaStoreView *self,
+					   JanaStoreViewProjection projection);
+
+static JanaStoreViewProjection store_view_get_projection (JanaStoreView *self);
+
+static void	store_view_refresh_query (JanaEcalStoreView *self);
+
+static void	store_view_schedule_changes (JanaEcalStoreView *self);
+
+static void	store_view_delivery_changed (JanaEcalStoreView *self);
+
+typedef struct _StoreViewQuery StoreViewQuery;
+typedef struct _StoreViewItem StoreViewItem;
+typedef struct _StoreViewCandidate StoreViewCandidate;
+typedef struct _StoreViewPending StoreViewPending;
+
+static void	store_view_query_free	(JanaEcalStoreView *self,
+					 StoreViewQuery *query);
+static void	store_view_item_free	(StoreViewItem *item);
+static void	store_view_candidate_free (StoreViewCandidate *candidate);
+static void	store_view_pending_free	(StoreViewPending *pending);
+
+/* A limited view first queries this far past the start of its range, and 
+ * doubles the window until enough events are found. Past the last window, 
+ * any recurring event would already have been found, so the rest of the 
+ * range is queried in one go.
+ */
+#define STORE_VIEW_FIRST_WINDOW	(60 * 60 * 24 * 7)
+#define STORE_VIEW_LAST_WINDOW	(60 * 60 * 24 * 366)
 
 G_DEFINE_TYPE_WITH_CODE (JanaEcalStoreView, 
                         jana_ecal_store_view, 
@@ -84,18 +120,117 @@ typedef struct _JanaEcalStoreViewPrivate JanaEcalStoreViewPrivate;
 struct _JanaEcalStoreViewPrivate
 {
 	JanaEcalStore *parent;
-	ECalView *query;
 	JanaEcalTime *start;
 	JanaEcalTime *end;
 	GList *matches;
 	guint timeout;
 	
-	GList *current_uids;
+	/* The queries feeding this view, as StoreViewQuery structs. There 
+	 * is more than one when the range has been moved and only the newly 
+	 * uncovered parts were queried, see store_view_slide_range(). The 
+	 * backend queries themselves belong to the parent store and may be 
+	 * shared with other views, or between parts of the range.
+	 */
+	GList *queries;
+	time_t query_start;
+	time_t query_end;
+	
+	/* The matches the queries were made with. When the matches are 
+	 * narrowed, the queries are kept and the new matches are applied 
+	 * locally with predicate instead.
+	 */
+	gchar *query_match;
+	JanaStoreViewPredicate *query_predicate;
+	JanaStoreViewPredicate *predicate;
+	
+	/* uid -> StoreViewItem for each component currently in the view */
+	GHashTable *items;
 	GList *old_uids;
 	gboolean started;
 	
 	guint remove_id;
 	guint refresh_id;
+	
+	/* Changes waiting for the idle refresh or for the outermost 
+	 * commit_update.
+	 */
+	guint update_depth;
+	gboolean range_changed;
+	gboolean matches_changed;
+	gboolean limit_changed;
+	gboolean window_changed;
+	gboolean projection_changed;
+	
+	/* The fields to copy into reported components */
+	JanaStoreViewProjection projection;
+	
+	/* When delivery is throttled, see the "batch-size" and "interval" 
+	 * properties, changes wait in pending, in order, and in pending_uids 
+	 * so that later changes to a component can be merged into them.
+	 */
+	guint batch_size;
+	guint interval;
+	GQueue *pending;
+	GHashTable *pending_uids;
+	gint pending_progress;
+	guint deliver_id;
+	GTimeVal last_delivery;
+	
+	/* When limited, the queries only cover up to window_end, and what 
+	 * they find is ranked by next occurrence in candidates, uid -> 
+	 * StoreViewCandidate. Only the soonest of those are reported.
+	 */
+	guint limit;
+	gboolean limited;
+	time_t window_end;
+	GHashTable *candidates;
+};
+
+struct _StoreViewQuery {
+	JanaEcalStoreQuery *shared;
+	ECalView *view;
+	time_t start;
+	time_t end;
+	/* The shared query was already running when this view started 
+	 * listening to it, so what it reported before needs replaying.
+	 */
+	gboolean replay;
+	gboolean done;
+};
+
+struct _StoreViewItem {
+	/* Pairs of time_t delimiting where the component occurs within the 
+	 * queried range, or NULL if that isn't known.
+	 */
+	GArray *spans;
+	/* The ECalViews that currently report this component */
+	GSList *views;
+	/* The projected fields as last reported, when not every field is 
+	 * reported, so that changes to the others can go unreported.
+	 */
+	gchar *projected;
+};
+
+typedef enum {
+	STORE_VIEW_CHANGE_NONE,
+	STORE_VIEW_CHANGE_ADDED,
+	STORE_VIEW_CHANGE_MODIFIED,
+	STORE_VIEW_CHANGE_REMOVED,
+} StoreViewChange;
+
+struct _StoreViewPending {
+	gchar *uid;
+	StoreViewChange change;
+	JanaComponent *comp;
+};
+
+struct _StoreViewCandidate {
+	/* Points at the key in the candidates table */
+	const gchar *uid;
+	JanaComponent *comp;
+	time_t next;
+	gboolean reported;
+	gboolean changed;
 };
 
 enum {
@@ -104,6 +239,8 @@ enum {
 	PROP_START,
 	PROP_END,
 	PROP_TIMEOUT,
+	PROP_BATCH_SIZE,
+	PROP_INTERVAL,
 };
 
 static void
@@ -117,7 +254,8 @@ jana_ecal_store_view_get_property (GObject *object, guint property_id,
 		g_value_set_object (value, priv->parent);
 		break;
 	    case PROP_VIEW :
-		g_value_set_object (value, priv->query);
+		g_value_set_object (value, priv->queries ?
+			((StoreViewQuery *)priv->queries->data)->view : NULL);
 		break;
 	    case PROP_START :
 		g_value_take_object (value, jana_time_duplicate (
@@ -130,6 +268,12 @@ jana_ecal_store_view_get_property (GObject *object, guint property_id,
 	    case PROP_TIMEOUT :
 		g_value_set_uint (value, priv->timeout);
 		break;
+	    case PROP_BATCH_SIZE :
+		g_value_set_uint (value, priv->batch_size);
+		break;
+	    case PROP_INTERVAL :
+		g_value_set_uint (value, priv->interval);
+		break;
 	    default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
 	}
@@ -159,6 +303,14 @@ jana_ecal_store_view_set_property (GObject *object, guint property_id,
 	    case PROP_TIMEOUT :
 		priv->timeout = g_value_get_uint (value);
 		break;
+	    case PROP_BATCH_SIZE :
+		priv->batch_size = g_value_get_uint (value);
+		store_view_delivery_changed (JANA_ECAL_STORE_VIEW (object));
+		break;
+	    case PROP_INTERVAL :
+		priv->interval = g_value_get_uint (value);
+		store_view_delivery_changed (JANA_ECAL_STORE_VIEW (object));
+		break;
 	    default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
 	}
@@ -179,11 +331,24 @@ jana_ecal_store_view_dispose (GObject *object)
 		priv->refresh_id = 0;
 	}
 	
-	if (priv->query) {
-		g_object_unref (priv->query);
-		priv->query = NULL;
+	if (priv->deliver_id) {
+		g_source_remove (priv->deliver_id);
+		priv->deliver_id = 0;
+	}
+	
+	while (!g_queue_is_empty (priv->pending))
+		store_view_pending_free (g_queue_pop_head (priv->pending));
+	g_hash_table_remove_all (priv->pending_uids);
+	
+	while (priv->queries) {
+		StoreViewQuery *query = (StoreViewQuery *)priv->queries->data;
+		priv->queries = g_list_delete_link (priv->queries,
+			priv->queries);
+		store_view_query_free (JANA_ECAL_STORE_VIEW (object), query);
 	}
 	
+	g_hash_table_remove_all (priv->candidates);
+	
 	if (priv->parent) {
 		g_object_unref (priv->parent);
 		priv->parent = NULL;
@@ -215,11 +380,16 @@ jana_ecal_store_view_finalize (GObject *object)
 			priv->old_uids);
 	}
 
-	while (priv->current_uids) {
-		g_free (priv->current_uids->data);
-		priv->current_uids = g_list_delete_link (priv->current_uids,
-			priv->current_uids);
-	}
+	g_hash_table_destroy (priv->items);
+	g_hash_table_destroy (priv->candidates);
+	g_queue_free (priv->pending);
+	g_hash_table_destroy (priv->pending_uids);
+	
+	g_free (priv->query_match);
+	if (priv->query_predicate)
+		jana_store_view_predicate_free (priv->query_predicate);
+	if (priv->predicate)
+		jana_store_view_predicate_free (priv->predicate);
 
 	G_OBJECT_CLASS (jana_ecal_store_view_parent_class)->finalize (object);
 }
@@ -239,6 +409,15 @@ store_view_interface_init (gpointer g_iface, gpointer iface_data)
 	iface->start = store_view_start;
 	
 	iface->get_store = store_view_get_store;
+	
+	iface->begin_update = store_view_begin_update;
+	iface->commit_update = store_view_commit_update;
+	
+	iface->set_limit = store_view_set_limit;
+	iface->get_limit = store_view_get_limit;
+	
+	iface->set_projection = store_view_set_projection;
+	iface->get_projection = store_view_get_projection;
 }
 
 static void
@@ -304,6 +483,29 @@ jana_ecal_store_view_class_init (JanaEcalStoreViewClass *klass)
 			"an old query are removed.",
 			0, G_MAXUINT, 0,
 			G_PARAM_READWRITE));
+
+	g_object_class_install_property (
+		object_class,
+		PROP_BATCH_SIZE,
+		g_param_spec_uint (
+			"batch-size",
+			"guint",
+			"The most changes to deliver in one go, or 0 for no "
+			"limit.",
+			0, G_MAXUINT, 0,
+			G_PARAM_READWRITE));
+
+	g_object_class_install_property (
+		object_class,
+		PROP_INTERVAL,
+		g_param_spec_uint (
+			"interval",
+			"guint",
+			"The least time (in milliseconds) between deliveries "
+			"of changes, or G_MAXUINT to only deliver on "
+			"jana_ecal_store_view_flush().",
+			0, G_MAXUINT, 0,
+			G_PARAM_READWRITE));
 }
 
 static void
@@ -317,6 +519,16 @@ jana_ecal_store_view_init (JanaEcalStoreView *self)
 	 *        setting the default timeout to zero for now.
 	 */
 	priv->timeout = 0;
+	priv->projection = JANA_STORE_VIEW_PROJECT_ALL;
+	
+	priv->items = g_hash_table_new_full (g_str_hash, g_str_equal,
+		g_free, (GDestroyNotify)store_view_item_free);
+	priv->candidates = g_hash_table_new_full (g_str_hash, g_str_equal,
+		g_free, (GDestroyNotify)store_view_candidate_free);
+	
+	priv->pending = g_queue_new ();
+	priv->pending_uids = g_hash_table_new (g_str_hash, g_str_equal);
+	priv->pending_progress = -1;
 }
 
 /**
@@ -334,308 +546,1201 @@ jana_ecal_store_view_new (JanaEcalStore *store)
 		"parent", store, NULL));
 }
 
-static gboolean
-store_view_remove_old_cb (JanaEcalStoreView *self)
+/* The icalcomponents passed to ECalView signal handlers are only valid for 
+ * the duration of the emission, so the wrappers created here borrow them 
+ * and are detached by store_view_release_comps() if anyone kept a reference.
+ * Most receivers just read a few fields and drop the component, which 
+ * saves cloning every object the view reports.
+ */
+static GType
+store_view_get_jcomp_type (icalcomponent *comp)
 {
-	JanaEcalStoreViewPrivate *priv = STORE_VIEW_PRIVATE (self);
-	
-	if (priv->old_uids) {
-		g_signal_emit_by_name (self, "removed", priv->old_uids);
+	switch (icalcomponent_isa (comp)) {
+	    case ICAL_VEVENT_COMPONENT :
+		return JANA_ECAL_TYPE_EVENT;
+	    case ICAL_VJOURNAL_COMPONENT :
+		return JANA_ECAL_TYPE_NOTE;
+	    case ICAL_VTODO_COMPONENT :
+		return JANA_ECAL_TYPE_TASK;
+	    default :
+		return JANA_ECAL_TYPE_COMPONENT;
+	}
+}
 
-		while (priv->old_uids) {
-			g_free (priv->old_uids->data);
-			priv->old_uids = g_list_delete_link (priv->old_uids,
-				priv->old_uids);
-		}
+static JanaComponent *
+store_view_jcomp_from_icalcomp (icalcomponent *comp)
+{
+	return JANA_COMPONENT (g_object_new (store_view_get_jcomp_type (comp),
+		"icalcomp", comp, NULL));
+}
+
+static gboolean
+store_view_projects_property (icalproperty_kind kind,
+			      JanaStoreViewProjection projection)
+{
+	switch (kind) {
+	    case ICAL_UID_PROPERTY :
+		return TRUE;
+	    case ICAL_DTSTART_PROPERTY :
+	    case ICAL_DTEND_PROPERTY :
+	    case ICAL_DURATION_PROPERTY :
+	    case ICAL_DUE_PROPERTY :
+	    case ICAL_COMPLETED_PROPERTY :
+	    case ICAL_RRULE_PROPERTY :
+	    case ICAL_RDATE_PROPERTY :
+	    case ICAL_EXRULE_PROPERTY :
+	    case ICAL_EXDATE_PROPERTY :
+	    case ICAL_RECURRENCEID_PROPERTY :
+		return (projection & JANA_STORE_VIEW_PROJECT_TIMES);
+	    case ICAL_SUMMARY_PROPERTY :
+		return (projection & JANA_STORE_VIEW_PROJECT_SUMMARY);
+	    case ICAL_LOCATION_PROPERTY :
+		return (projection & JANA_STORE_VIEW_PROJECT_LOCATION);
+	    case ICAL_DESCRIPTION_PROPERTY :
+		return (projection & JANA_STORE_VIEW_PROJECT_DESCRIPTION);
+	    case ICAL_CATEGORIES_PROPERTY :
+		return (projection & JANA_STORE_VIEW_PROJECT_CATEGORIES);
+	    default :
+		return (projection & JANA_STORE_VIEW_PROJECT_OTHER);
 	}
-	
-	priv->remove_id = 0;
-	
-	return FALSE;
 }
 
+/* Creates a component holding a copy of just the projected properties of 
+ * @comp. Unlike the borrowing wrappers above, it owns its data, so there's 
+ * nothing to detach if it's kept, and leaving out the description and 
+ * attendees makes it much cheaper than a full clone.
+ */
 static JanaComponent *
-store_view_jcomp_from_ecomp (ECalComponent *comp)
+store_view_jcomp_project (icalcomponent *comp,
+			  JanaStoreViewProjection projection)
 {
+	icalcomponent *projected, *sub;
+	icalproperty *prop;
+	ECalComponent *ecomp;
 	JanaComponent *jcomp;
 	
-	switch (e_cal_component_get_vtype (comp)) {
-	    case E_CAL_COMPONENT_EVENT :
-		jcomp = JANA_COMPONENT (
-			jana_ecal_event_new_from_ecalcomp (comp));
-		break;
-	    case E_CAL_COMPONENT_JOURNAL :
-		jcomp = JANA_COMPONENT (
-			jana_ecal_note_new_from_ecalcomp (comp));
-		break;
-	    case E_CAL_COMPONENT_TODO :
-		jcomp = JANA_COMPONENT (
-			jana_ecal_task_new_from_ecalcomp (comp));
-		break;
-	    default :
-		jcomp = jana_ecal_component_new_from_ecalcomp (comp);
-		break;
+	projected = icalcomponent_new (icalcomponent_isa (comp));
+	for (prop = icalcomponent_get_first_property (comp, ICAL_ANY_PROPERTY);
+	     prop; prop = icalcomponent_get_next_property (
+	     comp, ICAL_ANY_PROPERTY)) {
+		if (store_view_projects_property (
+		     icalproperty_isa (prop), projection))
+			icalcomponent_add_property (projected,
+				icalproperty_new_clone (prop));
+	}
+	
+	/* Alarms and the like */
+	if (projection & JANA_STORE_VIEW_PROJECT_OTHER) {
+		for (sub = icalcomponent_get_first_component (
+		     comp, ICAL_ANY_COMPONENT); sub;
+		     sub = icalcomponent_get_next_component (
+		     comp, ICAL_ANY_COMPONENT))
+			icalcomponent_add_component (projected,
+				icalcomponent_new_clone (sub));
 	}
 	
+	ecomp = e_cal_component_new ();
+	e_cal_component_set_icalcomponent (ecomp, projected);
+	jcomp = JANA_COMPONENT (g_object_new (store_view_get_jcomp_type (comp),
+		"ecalcomp", ecomp, NULL));
+	g_object_unref (ecomp);
+	
 	return jcomp;
 }
 
-static void
-store_view_objects_added_cb (ECalView *query, GList *objects,
-			     JanaStoreView *self)
+static gchar *
+store_view_dup_ical_string (JanaComponent *comp)
 {
-	JanaEcalStoreViewPrivate *priv = STORE_VIEW_PRIVATE (self);
-
-	GList *comps_added = NULL;
-	GList *comps_modified = NULL;
+	icalcomponent *icalcomp = jana_ecal_component_peek_icalcomp (
+		JANA_ECAL_COMPONENT (comp));
 	
-	for (; objects; objects = objects->next) {
-		JanaComponent *jcomp;
-		const char *uid = icalcomponent_get_uid (objects->data);
-		GList *previous_uid = g_list_find_custom (priv->old_uids,
-			uid, (GCompareFunc)strcmp);
-		ECalComponent *comp = e_cal_component_new ();
-		
-		e_cal_component_set_icalcomponent (comp,
-			icalcomponent_new_clone (objects->data));
+#ifdef LIBICAL_MEMFIXES
+	return icalcomponent_as_ical_string (icalcomp);
+#else
+	return g_strdup (icalcomponent_as_ical_string (icalcomp));
+#endif
+}
 
-		jcomp = store_view_jcomp_from_ecomp (comp);
+static JanaStoreViewProjection
+store_view_get_effective_projection (JanaEcalStoreView *self)
+{
+	JanaEcalStoreViewPrivate *priv = STORE_VIEW_PRIVATE (self);
+	
+	/* Limited views rank components by when they occur */
+	return priv->limited ?
+		(priv->projection | JANA_STORE_VIEW_PROJECT_TIMES) :
+		priv->projection;
+}
 
-		if (previous_uid) {
-			g_free (previous_uid->data);
-			priv->old_uids = g_list_delete_link (
-				priv->old_uids, previous_uid);
-			comps_modified = g_list_prepend (comps_modified,
-				jcomp);
-		} else
-			comps_added = g_list_prepend (comps_added, jcomp);
+static void
+store_view_release_comps (GList *comps)
+{
+	while (comps) {
+		GObject *object = G_OBJECT (comps->data);
+		
+		if (object->ref_count > 1)
+			jana_ecal_component_detach (
+				JANA_ECAL_COMPONENT (object));
+		g_object_unref (object);
 		
-		priv->current_uids = g_list_prepend (priv->current_uids,
-			g_strdup (uid));
+		comps = g_list_delete_link (comps, comps);
 	}
+}
+
+static void
+store_view_candidate_free (StoreViewCandidate *candidate)
+{
+	g_object_unref (candidate->comp);
+	g_slice_free (StoreViewCandidate, candidate);
+}
+
+static void
+store_view_item_free (StoreViewItem *item)
+{
+	if (item->spans) g_array_free (item->spans, TRUE);
+	g_slist_free (item->views);
+	g_free (item->projected);
+	g_slice_free (StoreViewItem, item);
+}
+
+static time_t
+store_view_time_to_timet (JanaTime *time)
+{
+	time_t result;
+	JanaTime *ecal_time;
+	icaltimetype *itime;
 	
-	if (comps_added) g_signal_emit_by_name (self, "added", comps_added);
-	if (comps_modified) g_signal_emit_by_name (self, "modified",
-		comps_modified);
+	if (JANA_ECAL_IS_TIME (time))
+		ecal_time = g_object_ref (time);
+	else
+		ecal_time = jana_utils_time_copy (time, jana_ecal_time_new ());
 	
-	while (comps_added) {
-		g_object_unref (G_OBJECT (comps_added->data));
-		comps_added = g_list_delete_link (comps_added, comps_added);
-	}
+	g_object_get (ecal_time, "icaltime", &itime, NULL);
+	result = icaltime_as_timet_with_zone (*itime, itime->zone);
+	g_object_unref (ecal_time);
 	
-	while (comps_modified) {
-		g_object_unref (G_OBJECT (comps_modified->data));
-		comps_modified = g_list_delete_link (
-			comps_modified, comps_modified);
-	}
+	return result;
 }
 
-static void
-store_view_objects_modified_cb (ECalView *query, GList *objects,
-				JanaStoreView *self)
+/* Works out where an event occurs within the current range, so that it can 
+ * be dropped without asking the backend when the range moves away from it. 
+ * Only recurring events need expanding, anything else occupies a single 
+ * span, which is just its start if it has no end.
+ */
+static GArray *
+store_view_get_spans (JanaEcalStoreView *self, JanaComponent *comp)
 {
-	/*JanaEcalStoreViewPrivate *priv = STORE_VIEW_PRIVATE (self);*/
-
-	GList *comps_modified = NULL;
+	GList *instances, *i;
+	GArray *spans;
+	JanaEvent *event;
+	JanaEcalStoreViewPrivate *priv = STORE_VIEW_PRIVATE (self);
 	
-	for (; objects; objects = objects->next) {
-		JanaComponent *jcomp;
-		ECalComponent *comp = e_cal_component_new ();
+	if ((!priv->start) || (!priv->end) ||
+	    (jana_component_get_component_type (comp) != JANA_COMPONENT_EVENT))
+		return NULL;
+	
+	event = JANA_EVENT (comp);
+	if (!jana_event_has_recurrence (event)) {
+		JanaTime *start, *end;
+		time_t span[2];
 		
-		e_cal_component_set_icalcomponent (comp,
-			icalcomponent_new_clone (objects->data));
-		jcomp = store_view_jcomp_from_ecomp (comp);
-
-		comps_modified = g_list_prepend (comps_modified, jcomp);
+		/* Of unknown extent */
+		if (!(start = jana_event_get_start (event))) return NULL;
+		end = jana_event_get_end (event);
+		
+		span[0] = store_view_time_to_timet (start);
+		span[1] = end ? store_view_time_to_timet (end) : span[0];
+		
+		g_object_unref (start);
+		if (end) g_object_unref (end);
+		
+		spans = g_array_sized_new (FALSE, FALSE, sizeof (time_t), 2);
+		g_array_append_vals (spans, span, 2);
+		
+		return spans;
 	}
 	
-	if (comps_modified) g_signal_emit_by_name (self, "modified",
-		comps_modified);
+	spans = g_array_new (FALSE, FALSE, sizeof (time_t));
+	instances = jana_utils_event_get_instances (event,
+		JANA_TIME (priv->start), JANA_TIME (priv->end), 0);
 	
-	while (comps_modified) {
-		g_object_unref (G_OBJECT (comps_modified->data));
-		comps_modified = g_list_delete_link (
-			comps_modified, comps_modified);
+	for (i = instances; i; i = i->next) {
+		JanaDuration *duration = (JanaDuration *)i->data;
+		time_t start = store_view_time_to_timet (duration->start);
+		time_t end = store_view_time_to_timet (duration->end);
+		
+		/* Instances are split by day, join them back up */
+		if (spans->len && (g_array_index (spans, time_t,
+		     spans->len - 1) >= start))
+			g_array_index (spans, time_t, spans->len - 1) = end;
+		else {
+			g_array_append_val (spans, start);
+			g_array_append_val (spans, end);
+		}
 	}
+	jana_utils_instance_list_free (instances);
+	
+	return spans;
 }
 
-static void
-store_view_objects_removed_cb (ECalView *query, GList *uids,
-			       JanaStoreView *self)
+static gboolean
+store_view_spans_in_range (GArray *spans, time_t start, time_t end)
 {
-	GList *comps_removed = NULL;
+	guint i;
 	
-	for (; uids; uids = uids->next) {
-#ifdef HAVE_ECALCOMPONENTID
-		ECalComponentId *id = uids->data;
-		comps_removed = g_list_prepend (comps_removed, id->uid);
-#else
-		comps_removed = g_list_prepend (comps_removed, uids->data);
-#endif
-	}
+	/* Components of unknown extent stay for as long as a query that 
+	 * still overlaps the range reports them.
+	 */
+	if (!spans) return TRUE;
 	
-	g_signal_emit_by_name (self, "removed", comps_removed);
+	for (i = 0; i < spans->len; i += 2) {
+		if ((g_array_index (spans, time_t, i) < end) &&
+		    (g_array_index (spans, time_t, i + 1) >= start))
+			return TRUE;
+	}
 	
-	g_list_free (comps_removed);
+	return FALSE;
 }
 
-static void
-store_view_progress_cb (ECalView *query, gchar *message, gint percent,
-			JanaStoreView *self)
+static gboolean
+store_view_has_view (JanaEcalStoreView *self, ECalView *view)
 {
-	/* Ignore 100%, we'll get the done signal - we don't want to emit 1.0
-	 * twice.
-	 */
-	if (percent < 100)
-		g_signal_emit_by_name (self, "progress", percent);
+	GList *q;
+	JanaEcalStoreViewPrivate *priv = STORE_VIEW_PRIVATE (self);
+	
+	for (q = priv->queries; q; q = q->next) {
+		if (((StoreViewQuery *)q->data)->view == view) return TRUE;
+	}
+	
+	return FALSE;
 }
 
 static void
-store_view_done_cb (ECalView *query, ECalendarStatus status,
-		    JanaStoreView *self)
+store_view_pending_free (StoreViewPending *pending)
 {
-	g_signal_emit_by_name (self, "progress", 100);
+	if (pending->comp) g_object_unref (pending->comp);
+	g_free (pending->uid);
+	g_slice_free (StoreViewPending, pending);
 }
 
-static gchar *
-get_match_string (GList *matches)
+static gboolean
+store_view_is_throttled (JanaEcalStoreView *self)
 {
-	GList *m;
-	GString *string;
-	gchar *match_string;
+	JanaEcalStoreViewPrivate *priv = STORE_VIEW_PRIVATE (self);
 	
-	if (!matches) return NULL;
+	return (priv->batch_size || priv->interval);
+}
+
+static void	store_view_schedule_delivery (JanaEcalStoreView *self);
+
+/* Delivers the oldest batch of pending changes, and then the latest 
+ * progress once nothing else is waiting.
+ */
+static void
+store_view_deliver (JanaEcalStoreView *self)
+{
+	guint count = 0;
+	GList *added = NULL, *modified = NULL, *removed = NULL;
+	JanaEcalStoreViewPrivate *priv = STORE_VIEW_PRIVATE (self);
 	
-	string = g_string_new ("");
-	for (m = matches; m; m = m->next) {
-		JanaStoreViewMatch *match;
-		const gchar *field;
+	while ((!g_queue_is_empty (priv->pending)) &&
+	       ((!priv->batch_size) || (count < priv->batch_size))) {
+		StoreViewPending *pending = (StoreViewPending *)
+			g_queue_pop_head (priv->pending);
 		
-		if (m != matches) {
-			g_string_prepend (string, "(or ");
-			g_string_append_c (string, ' ');
-		}
-		
-		match = (JanaStoreViewMatch *)m->data;
-		switch (match->field) {
-		    case JANA_STORE_VIEW_AUTHOR :
-		    case JANA_STORE_VIEW_SUMMARY :
-			field = "summary";
+		switch (pending->change) {
+		    case STORE_VIEW_CHANGE_ADDED :
+			added = g_list_prepend (added,
+				g_object_ref (pending->comp));
 			break;
-		    case JANA_STORE_VIEW_RECIPIENT :
-		    case JANA_STORE_VIEW_LOCATION :
-			field = "location";
+		    case STORE_VIEW_CHANGE_MODIFIED :
+			modified = g_list_prepend (modified,
+				g_object_ref (pending->comp));
 			break;
-		    case JANA_STORE_VIEW_BODY :
-		    case JANA_STORE_VIEW_DESCRIPTION :
-			field = "description";
+		    case STORE_VIEW_CHANGE_REMOVED :
+			removed = g_list_prepend (removed,
+				g_strdup (pending->uid));
 			break;
-		    case JANA_STORE_VIEW_ANYFIELD :
 		    default :
-			field = "any";
-			break;
+			/* Added and removed again before delivery */
+			store_view_pending_free (pending);
+			continue;
 		}
 		
-		if (match->field == JANA_STORE_VIEW_CATEGORY) {
-			g_string_append_printf (string,
-				"(has-categories? \"%s\")", match->data);
-		} else {
-			g_string_append_printf (string,
-				"(contains? \"%s\" \"%s\")",
-				field, match->data);
-		}
-		if (m != matches) g_string_append_c (string, ')');
+		g_hash_table_remove (priv->pending_uids, pending->uid);
+		store_view_pending_free (pending);
+		count ++;
 	}
 	
-	match_string = string->str;
-	g_string_free (string, FALSE);
+	g_get_current_time (&priv->last_delivery);
 	
-	return match_string;
+	if (added) {
+		added = g_list_reverse (added);
+		g_signal_emit_by_name (self, "added", added);
+		g_list_foreach (added, (GFunc)g_object_unref, NULL);
+		g_list_free (added);
+	}
+	if (modified) {
+		modified = g_list_reverse (modified);
+		g_signal_emit_by_name (self, "modified", modified);
+		g_list_foreach (modified, (GFunc)g_object_unref, NULL);
+		g_list_free (modified);
+	}
+	if (removed) {
+		removed = g_list_reverse (removed);
+		g_signal_emit_by_name (self, "removed", removed);
+		g_list_foreach (removed, (GFunc)g_free, NULL);
+		g_list_free (removed);
+	}
+	
+	if (!g_queue_is_empty (priv->pending))
+		store_view_schedule_delivery (self);
+	else if (priv->pending_progress >= 0) {
+		gint percent = priv->pending_progress;
+		priv->pending_progress = -1;
+		g_signal_emit_by_name (self, "progress", percent);
+	}
 }
 
 static gboolean
-store_view_refresh_query (JanaEcalStoreView *self)
+store_view_deliver_cb (JanaEcalStoreView *self)
 {
-	ECal *ecal;
-	gchar *query;
-	GError *error = NULL;
-
 	JanaEcalStoreViewPrivate *priv = STORE_VIEW_PRIVATE (self);
 	
-	if (priv->query) {
-		g_object_unref (priv->query);
-		priv->query = NULL;
-	}
-	
-	priv->old_uids = g_list_concat (priv->old_uids, priv->current_uids);
-	priv->current_uids = NULL;
+	priv->deliver_id = 0;
+	store_view_deliver (self);
 	
-	if (priv->start || priv->end || priv->matches) {
-		gchar *start, *end;
-		
-		if (priv->start) {
-			icaltimetype *ical_start;
-			g_object_get (priv->start, "icaltime",
-				&ical_start, NULL);
-			start = isodate_from_time_t (
-				icaltime_as_timet_with_zone (*ical_start,
-					ical_start->zone));
-		} else
-			start = isodate_from_time_t (0);
-		if (priv->end) {
-			icaltimetype *ical_end;
-			g_object_get (priv->end, "icaltime", &ical_end, NULL);
-			end = isodate_from_time_t (icaltime_as_timet_with_zone (
-				*ical_end, ical_end->zone));
-		} else
-			end = isodate_from_time_t (G_MAXLONG);
-		
-		if (priv->matches) {
-			gchar *match = get_match_string (priv->matches);
-			query = g_strdup_printf ("(and %s "
-				"(occur-in-time-range? "
-				"(make-time \"%s\") (make-time \"%s\")))",
-				match, start, end);
-			g_free (match);
-		} else
-			query = g_strdup_printf ("(occur-in-time-range? "
-				"(make-time \"%s\") (make-time \"%s\"))",
-				start, end);
-
-		g_free (start);
-		g_free (end);
-	} else {
-		query = g_strdup ("#t");
-	}
+	return FALSE;
+}
 
-	g_object_get (priv->parent, "ecal", &ecal, NULL);
+static void
+store_view_schedule_delivery (JanaEcalStoreView *self)
+{
+	GTimeVal now;
+	gint64 elapsed;
+	JanaEcalStoreViewPrivate *priv = STORE_VIEW_PRIVATE (self);
 	
-	if (!e_cal_get_query (ecal, query, &priv->query, &error)) {
-		g_warning ("Failed to retrieve query '%s': %s",
-			query, error->message);
-		g_error_free (error);
-	} else {
-		g_signal_connect (priv->query, "objects-added",
-			G_CALLBACK (store_view_objects_added_cb), self);
-		g_signal_connect (priv->query, "objects-modified",
-			G_CALLBACK (store_view_objects_modified_cb), self);
-		g_signal_connect (priv->query, "objects-removed",
-			G_CALLBACK (store_view_objects_removed_cb), self);
-		g_signal_connect (priv->query, "view_progress",
-			G_CALLBACK (store_view_progress_cb), self);
-		g_signal_connect (priv->query, "view_done",
-			G_CALLBACK (store_view_done_cb), self);
-		
-		if (priv->started) e_cal_view_start (priv->query);
-	}
+	if (priv->deliver_id || (priv->interval == G_MAXUINT)) return;
 	
-	g_free (query);
-	g_object_unref (ecal);
+	g_get_current_time (&now);
+	elapsed = (((gint64)now.tv_sec - priv->last_delivery.tv_sec) * 1000) +
+		((now.tv_usec - priv->last_delivery.tv_usec) / 1000);
 	
-	/* Remove old components (but possibly wait to see if they don't need
-	 * removing, to prevent 'flickering' when resizing the view).
+	/* Even without an interval, changes wait for the main loop, so that 
+	 * those arriving together are delivered together.
 	 */
-	if (priv->old_uids) {	
+	if ((elapsed < 0) || (elapsed >= priv->interval))
+		priv->deliver_id = g_idle_add (
+			(GSourceFunc)store_view_deliver_cb, self);
+	else
+		priv->deliver_id = g_timeout_add (
+			priv->interval - (guint)elapsed,
+			(GSourceFunc)store_view_deliver_cb, self);
+}
+
+/* Adds a change to the pending changes, merging it with any that haven't 
+ * been delivered yet for the same component.
+ */
+static void
+store_view_queue_change (JanaEcalStoreView *self, StoreViewChange change,
+			 const gchar *uid, JanaComponent *comp)
+{
+	StoreViewPending *pending;
+	JanaEcalStoreViewPrivate *priv = STORE_VIEW_PRIVATE (self);
+	
+	if (!(pending = g_hash_table_lookup (priv->pending_uids, uid))) {
+		pending = g_slice_new0 (StoreViewPending);
+		pending->uid = g_strdup (uid);
+		pending->change = change;
+		pending->comp = comp ? g_object_ref (comp) : NULL;
+		g_queue_push_tail (priv->pending, pending);
+		g_hash_table_insert (priv->pending_uids, pending->uid, pending);
+		store_view_schedule_delivery (self);
+		return;
+	}
+	
+	if (pending->comp) {
+		g_object_unref (pending->comp);
+		pending->comp = NULL;
+	}
+	
+	/* Left in the queue, to be skipped over */
+	if ((change == STORE_VIEW_CHANGE_REMOVED) &&
+	    (pending->change == STORE_VIEW_CHANGE_ADDED)) {
+		g_hash_table_remove (priv->pending_uids, uid);
+		pending->change = STORE_VIEW_CHANGE_NONE;
+		return;
+	}
+	
+	if (pending->change == STORE_VIEW_CHANGE_ADDED)
+		change = STORE_VIEW_CHANGE_ADDED;
+	else if ((pending->change == STORE_VIEW_CHANGE_REMOVED) &&
+		 (change == STORE_VIEW_CHANGE_ADDED))
+		change = STORE_VIEW_CHANGE_MODIFIED;
+	
+	pending->change = change;
+	pending->comp = comp ? g_object_ref (comp) : NULL;
+}
+
+/* Delivers everything straight away when throttling is turned off */
+static void
+store_view_delivery_changed (JanaEcalStoreView *self)
+{
+	JanaEcalStoreViewPrivate *priv = STORE_VIEW_PRIVATE (self);
+	
+	if (priv->deliver_id) {
+		g_source_remove (priv->deliver_id);
+		priv->deliver_id = 0;
+	}
+	
+	if (!store_view_is_throttled (self))
+		store_view_deliver (self);
+	else if ((!g_queue_is_empty (priv->pending)) ||
+		 (priv->pending_progress >= 0))
+		store_view_schedule_delivery (self);
+}
+
+static void
+store_view_signal_changed (JanaEcalStoreView *self, GList *added,
+			   GList *modified)
+{
+	if (!store_view_is_throttled (self)) {
+		if (added) g_signal_emit_by_name (self, "added", added);
+		if (modified) g_signal_emit_by_name (self, "modified",
+			modified);
+		return;
+	}
+	
+	for (; added; added = added->next) {
+		JanaComponent *comp = JANA_COMPONENT (added->data);
+		store_view_queue_change (self, STORE_VIEW_CHANGE_ADDED,
+			jana_component_peek_uid (comp), comp);
+	}
+	for (; modified; modified = modified->next) {
+		JanaComponent *comp = JANA_COMPONENT (modified->data);
+		store_view_queue_change (self, STORE_VIEW_CHANGE_MODIFIED,
+			jana_component_peek_uid (comp), comp);
+	}
+}
+
+static void
+store_view_signal_removed (JanaEcalStoreView *self, GList *uids)
+{
+	if (uids && !store_view_is_throttled (self))
+		g_signal_emit_by_name (self, "removed", uids);
+	
+	while (uids) {
+		if (store_view_is_throttled (self))
+			store_view_queue_change (self,
+				STORE_VIEW_CHANGE_REMOVED, uids->data, NULL);
+		g_free (uids->data);
+		uids = g_list_delete_link (uids, uids);
+	}
+}
+
+static void
+store_view_signal_progress (JanaEcalStoreView *self, gint percent)
+{
+	JanaEcalStoreViewPrivate *priv = STORE_VIEW_PRIVATE (self);
+	
+	if (!store_view_is_throttled (self)) {
+		g_signal_emit_by_name (self, "progress", percent);
+		return;
+	}
+	
+	/* Only the latest is worth reporting */
+	priv->pending_progress = percent;
+	store_view_schedule_delivery (self);
+}
+
+static gint
+store_view_candidate_compare (gconstpointer a, gconstpointer b)
+{
+	const StoreViewCandidate *candidate1 = *(StoreViewCandidate **)a;
+	const StoreViewCandidate *candidate2 = *(StoreViewCandidate **)b;
+	
+	if (candidate1->next != candidate2->next)
+		return (candidate1->next < candidate2->next) ? -1 : 1;
+	
+	return strcmp (candidate1->uid, candidate2->uid);
+}
+
+/* Reports the changes to which candidates are among the soonest. @removed 
+ * holds the uids of reported candidates that have already been dropped, 
+ * and is freed.
+ */
+static void
+store_view_limit_rank (JanaEcalStoreView *self, GList *removed)
+{
+	guint i;
+	GPtrArray *ranked;
+	GHashTableIter iter;
+	gpointer data;
+	GList *added = NULL, *modified = NULL;
+	JanaEcalStoreViewPrivate *priv = STORE_VIEW_PRIVATE (self);
+	
+	ranked = g_ptr_array_sized_new (g_hash_table_size (priv->candidates));
+	g_hash_table_iter_init (&iter, priv->candidates);
+	while (g_hash_table_iter_next (&iter, NULL, &data))
+		g_ptr_array_add (ranked, data);
+	g_ptr_array_sort (ranked, store_view_candidate_compare);
+	
+	for (i = 0; i < ranked->len; i++) {
+		StoreViewCandidate *candidate = (StoreViewCandidate *)
+			g_ptr_array_index (ranked, i);
+		gboolean reported = (i < priv->limit);
+		
+		if (reported && !candidate->reported)
+			added = g_list_prepend (added, candidate->comp);
+		else if (reported && candidate->changed)
+			modified = g_list_prepend (modified, candidate->comp);
+		else if ((!reported) && candidate->reported)
+			removed = g_list_prepend (removed,
+				g_strdup (candidate->uid));
+		
+		candidate->reported = reported;
+		candidate->changed = FALSE;
+	}
+	g_ptr_array_free (ranked, TRUE);
+	
+	store_view_signal_changed (self, added, modified);
+	store_view_signal_removed (self, removed);
+	
+	g_list_free (added);
+	g_list_free (modified);
+}
+
+/* Works out when each component next occurs and updates its candidate, 
+ * prepending the uids of reported candidates that no longer occur to 
+ * @removed.
+ */
+static void
+store_view_limit_offer (JanaEcalStoreView *self, GList *comps,
+			GList **removed)
+{
+	JanaEcalStoreViewPrivate *priv = STORE_VIEW_PRIVATE (self);
+	
+	for (; comps; comps = comps->next) {
+		StoreViewCandidate *candidate;
+		JanaDuration *next = NULL;
+		JanaComponent *comp = JANA_COMPONENT (comps->data);
+		const gchar *uid = jana_component_peek_uid (comp);
+		
+		if (jana_component_get_component_type (comp) ==
+		    JANA_COMPONENT_EVENT)
+			next = jana_utils_event_get_next_instance (
+				JANA_EVENT (comp), JANA_TIME (priv->start));
+		
+		candidate = g_hash_table_lookup (priv->candidates, uid);
+		if (!next) {
+			if (candidate && candidate->reported)
+				*removed = g_list_prepend (*removed,
+					g_strdup (uid));
+			g_hash_table_remove (priv->candidates, uid);
+			continue;
+		}
+		
+		if (candidate) {
+			g_object_unref (candidate->comp);
+			candidate->changed = TRUE;
+		} else {
+			gchar *key = g_strdup (uid);
+			candidate = g_slice_new0 (StoreViewCandidate);
+			candidate->uid = key;
+			g_hash_table_insert (priv->candidates, key, candidate);
+		}
+		candidate->comp = g_object_ref (comp);
+		candidate->next = store_view_time_to_timet (next->start);
+		jana_duration_free (next);
+	}
+}
+
+/* Widens the window a limited view queries, if everything in it has been 
+ * found and there still aren't enough events. Returns %TRUE if the window 
+ * is being widened.
+ */
+static gboolean
+store_view_limit_widen (JanaEcalStoreView *self)
+{
+	GList *q;
+	time_t start, end;
+	JanaEcalStoreViewPrivate *priv = STORE_VIEW_PRIVATE (self);
+	
+	if ((!priv->limited) || (!priv->started) || priv->window_changed ||
+	    (g_hash_table_size (priv->candidates) >= priv->limit))
+		return FALSE;
+	
+	for (q = priv->queries; q; q = q->next) {
+		if (!((StoreViewQuery *)q->data)->done) return FALSE;
+	}
+	
+	start = store_view_time_to_timet (JANA_TIME (priv->start));
+	end = priv->end ?
+		store_view_time_to_timet (JANA_TIME (priv->end)) : G_MAXLONG;
+	if (priv->window_end >= end) return FALSE;
+	
+	if ((priv->window_end - start) >= STORE_VIEW_LAST_WINDOW)
+		priv->window_end = end;
+	else
+		priv->window_end = MIN (end,
+			start + ((priv->window_end - start) * 2));
+	
+	/* Applied from idle, as this can be reached while the queries are 
+	 * being changed.
+	 */
+	priv->window_changed = TRUE;
+	store_view_schedule_changes (self);
+	
+	return TRUE;
+}
+
+/* Withdraws everything that has been reported, for when a view switches 
+ * between being limited and not, as the two report different components.
+ */
+static void
+store_view_limit_reset (JanaEcalStoreView *self)
+{
+	GHashTableIter iter;
+	gpointer uid, data;
+	GList *removed = NULL;
+	JanaEcalStoreViewPrivate *priv = STORE_VIEW_PRIVATE (self);
+	
+	if (priv->remove_id) {
+		g_source_remove (priv->remove_id);
+		priv->remove_id = 0;
+	}
+	
+	if (priv->limited) {
+		g_hash_table_iter_init (&iter, priv->candidates);
+		while (g_hash_table_iter_next (&iter, &uid, &data)) {
+			if (((StoreViewCandidate *)data)->reported)
+				removed = g_list_prepend (removed,
+					g_strdup (uid));
+		}
+		while (priv->old_uids) {
+			g_free (priv->old_uids->data);
+			priv->old_uids = g_list_delete_link (priv->old_uids,
+				priv->old_uids);
+		}
+	} else {
+		g_hash_table_iter_init (&iter, priv->items);
+		while (g_hash_table_iter_next (&iter, &uid, NULL))
+			removed = g_list_prepend (removed, g_strdup (uid));
+		removed = g_list_concat (removed, priv->old_uids);
+		priv->old_uids = NULL;
+	}
+	
+	g_hash_table_remove_all (priv->candidates);
+	g_hash_table_remove_all (priv->items);
+	
+	store_view_signal_removed (self, removed);
+}
+
+static void
+store_view_emit_changed (JanaEcalStoreView *self, GList *added,
+			 GList *modified)
+{
+	GList *removed = NULL;
+	JanaEcalStoreViewPrivate *priv = STORE_VIEW_PRIVATE (self);
+	
+	if (!priv->limited) {
+		store_view_signal_changed (self, added, modified);
+		return;
+	}
+	
+	store_view_limit_offer (self, added, &removed);
+	store_view_limit_offer (self, modified, &removed);
+	store_view_limit_rank (self, removed);
+	store_view_limit_widen (self);
+}
+
+static void
+store_view_emit_removed (JanaEcalStoreView *self, GList *uids)
+{
+	GList *u, *removed = NULL;
+	JanaEcalStoreViewPrivate *priv = STORE_VIEW_PRIVATE (self);
+	
+	if (!priv->limited) {
+		store_view_signal_removed (self, uids);
+		return;
+	}
+	
+	for (u = uids; u; u = u->next) {
+		StoreViewCandidate *candidate =
+			g_hash_table_lookup (priv->candidates, u->data);
+		
+		if (!candidate) continue;
+		if (candidate->reported)
+			removed = g_list_prepend (removed, g_strdup (u->data));
+		g_hash_table_remove (priv->candidates, u->data);
+	}
+	
+	while (uids) {
+		g_free (uids->data);
+		uids = g_list_delete_link (uids, uids);
+	}
+	
+	/* Something else may now be among the soonest */
+	if (removed) {
+		store_view_limit_rank (self, removed);
+		store_view_limit_widen (self);
+	}
+}
+
+static gboolean
+store_view_remove_old_cb (JanaEcalStoreView *self)
+{
+	GList *uids;
+	JanaEcalStoreViewPrivate *priv = STORE_VIEW_PRIVATE (self);
+	
+	uids = priv->old_uids;
+	priv->old_uids = NULL;
+	store_view_emit_removed (self, uids);
+	
+	priv->remove_id = 0;
+	
+	return FALSE;
+}
+
+/* Adds or updates the components reported by @view that occur between 
+ * @start and @end. A query may be shared with views covering a wider 
+ * range, or have been made with wider matches, so components that don't 
+ * belong in this view are filtered out here, and dropped if they were 
+ * modified out of it.
+ */
+static void
+store_view_process_objects (JanaEcalStoreView *self, ECalView *view,
+			    GList *objects, time_t start, time_t end)
+{
+	JanaStoreViewProjection projection;
+	JanaEcalStoreViewPrivate *priv = STORE_VIEW_PRIVATE (self);
+
+	GList *comps_added = NULL;
+	GList *comps_modified = NULL;
+	GList *comps_removed = NULL;
+	
+	projection = store_view_get_effective_projection (self);
+	
+	for (; objects; objects = objects->next) {
+		GArray *spans;
+		StoreViewItem *item;
+		JanaComponent *jcomp;
+		GList *previous_uid;
+		gchar *projected = NULL;
+		const char *uid = icalcomponent_get_uid (objects->data);
+		
+		jcomp = store_view_jcomp_from_icalcomp (objects->data);
+		spans = store_view_get_spans (self, jcomp);
+		item = g_hash_table_lookup (priv->items, uid);
+		
+		if ((!store_view_spans_in_range (spans, start, end)) ||
+		    (priv->predicate && !jana_store_view_predicate_match (
+		     priv->predicate, jcomp))) {
+			if (item && g_slist_find (item->views, view)) {
+				item->views = g_slist_remove (
+					item->views, view);
+				if (!item->views) {
+					comps_removed = g_list_prepend (
+						comps_removed, g_strdup (uid));
+					g_hash_table_remove (priv->items, uid);
+				}
+			}
+			if (spans) g_array_free (spans, TRUE);
+			g_object_unref (jcomp);
+			continue;
+		}
+		
+		/* Matching and spans above need every field, so only now is 
+		 * the component cut down.
+		 */
+		if (projection != JANA_STORE_VIEW_PROJECT_ALL) {
+			g_object_unref (jcomp);
+			jcomp = store_view_jcomp_project (
+				objects->data, projection);
+			projected = store_view_dup_ical_string (jcomp);
+		}
+		
+		/* Already reported by another query, or modified */
+		if (item) {
+			gboolean unchanged = (projected && item->projected &&
+				(strcmp (projected, item->projected) == 0) &&
+				g_slist_find (item->views, view));
+			
+			if (item->spans) g_array_free (item->spans, TRUE);
+			item->spans = spans;
+			g_free (item->projected);
+			item->projected = projected;
+			if (!g_slist_find (item->views, view))
+				item->views = g_slist_prepend (
+					item->views, view);
+			
+			/* Only fields that weren't asked for have changed */
+			if (unchanged) g_object_unref (jcomp);
+			else comps_modified = g_list_prepend (
+				comps_modified, jcomp);
+			continue;
+		}
+		
+		item = g_slice_new0 (StoreViewItem);
+		item->spans = spans;
+		item->projected = projected;
+		item->views = g_slist_prepend (NULL, view);
+		g_hash_table_insert (priv->items, g_strdup (uid), item);
+		
+		/* Left over from before a refresh */
+		previous_uid = g_list_find_custom (
+			priv->old_uids, uid, (GCompareFunc)strcmp);
+		if (previous_uid) {
+			g_free (previous_uid->data);
+			priv->old_uids = g_list_delete_link (
+				priv->old_uids, previous_uid);
+			comps_modified = g_list_prepend (comps_modified, jcomp);
+		} else
+			comps_added = g_list_prepend (comps_added, jcomp);
+	}
+	
+	store_view_emit_changed (self, comps_added, comps_modified);
+	store_view_emit_removed (self, comps_removed);
+	
+	store_view_release_comps (comps_added);
+	store_view_release_comps (comps_modified);
+}
+
+static void
+store_view_objects_changed_cb (ECalView *query, GList *objects,
+			       JanaEcalStoreView *self)
+{
+	JanaEcalStoreViewPrivate *priv = STORE_VIEW_PRIVATE (self);
+	
+	/* The query may already be running for another view, anything 
+	 * missed is caught up on in store_view_start().
+	 */
+	if (!priv->started) return;
+	
+	store_view_process_objects (self, query, objects, 0, G_MAXLONG);
+}
+
+static void
+store_view_objects_removed_cb (ECalView *query, GList *uids,
+			       JanaStoreView *self)
+{
+	GList *comps_removed = NULL;
+	JanaEcalStoreViewPrivate *priv = STORE_VIEW_PRIVATE (self);
+	
+	if (!priv->started) return;
+	
+	for (; uids; uids = uids->next) {
+		StoreViewItem *item;
+#ifdef HAVE_ECALCOMPONENTID
+		ECalComponentId *id = uids->data;
+		const gchar *uid = id->uid;
+#else
+		const gchar *uid = uids->data;
+#endif
+		
+		/* A component moved from one part of the range to another 
+		 * may be removed from one query after being added to another.
+		 */
+		if (!(item = g_hash_table_lookup (priv->items, uid)))
+			continue;
+		
+		item->views = g_slist_remove (item->views, query);
+		if (item->views) continue;
+		
+		comps_removed = g_list_prepend (comps_removed, g_strdup (uid));
+		g_hash_table_remove (priv->items, uid);
+	}
+	
+	store_view_emit_removed (JANA_ECAL_STORE_VIEW (self), comps_removed);
+}
+
+static void
+store_view_progress_cb (ECalView *query, gchar *message, gint percent,
+			JanaStoreView *self)
+{
+	JanaEcalStoreViewPrivate *priv = STORE_VIEW_PRIVATE (self);
+	
+	/* Ignore 100%, we'll get the done signal - we don't want to emit 1.0
+	 * twice.
+	 */
+	if (priv->started && (percent < 100))
+		store_view_signal_progress (JANA_ECAL_STORE_VIEW (self),
+			percent);
+}
+
+static void
+store_view_check_done (JanaEcalStoreView *self)
+{
+	GList *q;
+	JanaEcalStoreViewPrivate *priv = STORE_VIEW_PRIVATE (self);
+	
+	if (!priv->started) return;
+	
+	/* Only report completion once every part of the range is done */
+	for (q = priv->queries; q; q = q->next) {
+		if (!((StoreViewQuery *)q->data)->done) return;
+	}
+	
+	/* A limited view may not have found enough yet */
+	if (priv->window_changed || store_view_limit_widen (self)) return;
+	
+	store_view_signal_progress (self, 100);
+}
+
+static void
+store_view_done_cb (ECalView *query, ECalendarStatus status,
+		    JanaStoreView *self)
+{
+	GList *q;
+	JanaEcalStoreViewPrivate *priv = STORE_VIEW_PRIVATE (self);
+	
+	for (q = priv->queries; q; q = q->next) {
+		StoreViewQuery *svquery = (StoreViewQuery *)q->data;
+		if (svquery->view == query) svquery->done = TRUE;
+	}
+	
+	store_view_check_done (JANA_ECAL_STORE_VIEW (self));
+}
+
+static void
+append_match_data (GString *string, const gchar *data)
+{
+	g_string_append_c (string, '"');
+	for (; *data; data++) {
+		if ((*data == '"') || (*data == '\\'))
+			g_string_append_c (string, '\\');
+		g_string_append_c (string, *data);
+	}
+	g_string_append_c (string, '"');
+}
+
+static gchar *
+get_match_string (GList *matches)
+{
+	GList *m;
+	guint i, length;
+	GString *string;
+	gchar *match_string;
+	
+	if (!matches) return NULL;
+	
+	/* Matches are or'ed together as (or (or m1 m2) m3) ... */
+	string = g_string_new ("");
+	length = g_list_length (matches);
+	for (i = 1; i < length; i++)
+		g_string_append (string, "(or ");
+	
+	for (m = matches; m; m = m->next) {
+		JanaStoreViewMatch *match;
+		const gchar *field;
+		
+		if (m != matches) g_string_append_c (string, ' ');
+		
+		match = (JanaStoreViewMatch *)m->data;
+		switch (match->field) {
+		    case JANA_STORE_VIEW_AUTHOR :
+		    case JANA_STORE_VIEW_SUMMARY :
+			field = "summary";
+			break;
+		    case JANA_STORE_VIEW_RECIPIENT :
+		    case JANA_STORE_VIEW_LOCATION :
+			field = "location";
+			break;
+		    case JANA_STORE_VIEW_BODY :
+		    case JANA_STORE_VIEW_DESCRIPTION :
+			field = "description";
+			break;
+		    case JANA_STORE_VIEW_ANYFIELD :
+		    default :
+			field = "any";
+			break;
+		}
+		
+		if (match->field == JANA_STORE_VIEW_CATEGORY) {
+			g_string_append (string, "(has-categories? ");
+		} else {
+			g_string_append_printf (string,
+				"(contains? \"%s\" ", field);
+		}
+		append_match_data (string, match->data);
+		g_string_append_c (string, ')');
+		
+		if (m != matches) g_string_append_c (string, ')');
+	}
+	
+	match_string = string->str;
+	g_string_free (string, FALSE);
+	
+	return match_string;
+}
+
+/* Must be called after @query has been taken off the list of queries */
+static void
+store_view_query_free (JanaEcalStoreView *self, StoreViewQuery *query)
+{
+	JanaEcalStoreViewPrivate *priv = STORE_VIEW_PRIVATE (self);
+	
+	if (!store_view_has_view (self, query->view))
+		g_signal_handlers_disconnect_matched (query->view,
+			G_SIGNAL_MATCH_DATA, 0, 0, NULL, NULL, self);
+	jana_ecal_store_unref_query (priv->parent, query->shared);
+	g_slice_free (StoreViewQuery, query);
+}
+
+static StoreViewQuery *
+store_view_add_query (JanaEcalStoreView *self, time_t start, time_t end)
+{
+	JanaEcalStoreQuery *shared;
+	StoreViewQuery *svquery;
+	JanaEcalStoreViewPrivate *priv = STORE_VIEW_PRIVATE (self);
+	
+	shared = jana_ecal_store_ref_query (priv->parent, priv->query_match,
+		start, end);
+	if (!shared) return NULL;
+	
+	svquery = g_slice_new0 (StoreViewQuery);
+	svquery->shared = shared;
+	svquery->view = jana_ecal_store_query_get_view (shared);
+	svquery->start = start;
+	svquery->end = end;
+	
+	/* Parts of the range can be served by the same query */
+	if (!store_view_has_view (self, svquery->view)) {
+		g_signal_connect (svquery->view, "objects-added",
+			G_CALLBACK (store_view_objects_changed_cb), self);
+		g_signal_connect (svquery->view, "objects-modified",
+			G_CALLBACK (store_view_objects_changed_cb), self);
+		g_signal_connect (svquery->view, "objects-removed",
+			G_CALLBACK (store_view_objects_removed_cb), self);
+		g_signal_connect (svquery->view, "view_progress",
+			G_CALLBACK (store_view_progress_cb), self);
+		g_signal_connect (svquery->view, "view_done",
+			G_CALLBACK (store_view_done_cb), self);
+	}
+	
+	priv->queries = g_list_prepend (priv->queries, svquery);
+	if (priv->started) {
+		svquery->replay = jana_ecal_store_query_is_started (shared);
+		jana_ecal_store_query_start (shared);
+	}
+	
+	return svquery;
+}
+
+/* Reports what a shared query found before this part of the range 
+ * subscribed to it, from what the query has kept rather than from the 
+ * backend. Anything still on its way will arrive through the query's 
+ * signals, and anything this view was already sent is not sent again.
+ */
+static void
+store_view_query_catch_up (JanaEcalStoreView *self, StoreViewQuery *query)
+{
+	GList *objects, *o, *unseen = NULL;
+	JanaEcalStoreViewPrivate *priv = STORE_VIEW_PRIVATE (self);
+	
+	/* Nothing was missed if this view is what started the query */
+	objects = query->replay ?
+		jana_ecal_store_query_get_objects (query->shared) : NULL;
+	query->replay = FALSE;
+	for (o = objects; o; o = o->next) {
+		StoreViewItem *item = g_hash_table_lookup (priv->items,
+			icalcomponent_get_uid (o->data));
+		
+		/* Already sent, through this or another part of the range, 
+		 * but where it occurs may have grown with the range.
+		 */
+		if (item) {
+			JanaComponent *jcomp =
+				store_view_jcomp_from_icalcomp (o->data);
+			if (item->spans) g_array_free (item->spans, TRUE);
+			item->spans = store_view_get_spans (self, jcomp);
+			g_object_unref (jcomp);
+			
+			if ((!g_slist_find (item->views, query->view)) &&
+			    store_view_spans_in_range (item->spans,
+			     query->start, query->end))
+				item->views = g_slist_prepend (
+					item->views, query->view);
+			continue;
+		}
+		
+		unseen = g_list_prepend (unseen, o->data);
+	}
+	
+	/* The replayed objects belong to the shared query, and are only 
+	 * borrowed while they're processed, like those of an ECalView 
+	 * emission.
+	 */
+	if (unseen) {
+		store_view_process_objects (self, query->view, unseen,
+			query->start, query->end);
+		g_list_free (unseen);
+	}
+	g_list_free (objects);
+	
+	if (jana_ecal_store_query_is_done (query->shared)) {
+		query->done = TRUE;
+		store_view_check_done (self);
+	}
+}
+
+static void
+store_view_get_query_range (JanaEcalStoreView *self, time_t *start,
+			    time_t *end)
+{
+	JanaEcalStoreViewPrivate *priv = STORE_VIEW_PRIVATE (self);
+
+	*start = priv->start ?
+		store_view_time_to_timet (JANA_TIME (priv->start)) : 0;
+	*end = priv->end ?
+		store_view_time_to_timet (JANA_TIME (priv->end)) : G_MAXLONG;
+	
+	if (priv->limited && (priv->window_end < *end))
+		*end = priv->window_end;
+}
+
+static void
+store_view_refresh_query (JanaEcalStoreView *self)
+{
+	GHashTableIter iter;
+	gpointer uid, item;
+	StoreViewQuery *query;
+	JanaEcalStoreViewPrivate *priv = STORE_VIEW_PRIVATE (self);
+	
+	while (priv->queries) {
+		StoreViewQuery *query = (StoreViewQuery *)priv->queries->data;
+		priv->queries = g_list_delete_link (priv->queries,
+			priv->queries);
+		store_view_query_free (self, query);
+	}
+	
+	g_hash_table_iter_init (&iter, priv->items);
+	while (g_hash_table_iter_next (&iter, &uid, &item)) {
+		priv->old_uids = g_list_prepend (priv->old_uids, uid);
+		g_hash_table_iter_steal (&iter);
+		store_view_item_free ((StoreViewItem *)item);
+	}
+	
+	g_free (priv->query_match);
+	priv->query_match = get_match_string (priv->matches);
+	if (priv->query_predicate)
+		jana_store_view_predicate_free (priv->query_predicate);
+	priv->query_predicate = jana_store_view_predicate_new (priv->matches);
+	if (priv->predicate) {
+		jana_store_view_predicate_free (priv->predicate);
+		priv->predicate = NULL;
+	}
+	
+	store_view_get_query_range (self, &priv->query_start,
+		&priv->query_end);
+	query = store_view_add_query (self, priv->query_start,
+		priv->query_end);
+	if (query && priv->started) store_view_query_catch_up (self, query);
+	
+	/* Remove old components (but possibly wait to see if they don't need
+	 * removing, to prevent 'flickering' when resizing the view).
+	 */
+	if (priv->old_uids) {	
 		if (priv->timeout) {
 			if (priv->remove_id)
 				g_source_remove (priv->remove_id);
@@ -645,12 +1750,302 @@ store_view_refresh_query (JanaEcalStoreView *self)
 		} else
 			store_view_remove_old_cb (self);
 	}
+}
+
+/* Moves the range without re-querying the part that was already covered. 
+ * Queries that no longer overlap the range are dropped, along with any 
+ * components that don't occur in the new range, and only the newly 
+ * uncovered parts at either end are queried. Returns %FALSE if that isn't 
+ * possible and a full refresh is needed.
+ */
+static gboolean
+store_view_slide_range (JanaEcalStoreView *self)
+{
+	GList *q, *removed = NULL, *added = NULL;
+	GHashTableIter iter;
+	gpointer uid, data;
+	time_t start, end;
+	JanaEcalStoreViewPrivate *priv = STORE_VIEW_PRIVATE (self);
+	
+	if ((!priv->queries) || (!priv->start) ||
+	    ((!priv->end) && (!priv->limited)) || priv->remove_id)
+		return FALSE;
+	
+	store_view_get_query_range (self, &start, &end);
+	if ((start >= priv->query_end) || (end <= priv->query_start) ||
+	    (priv->query_start == 0) || (priv->query_end == G_MAXLONG))
+		return FALSE;
+	
+	for (q = priv->queries; q;) {
+		StoreViewQuery *query = (StoreViewQuery *)q->data;
+		GList *next = q->next;
+		
+		if ((query->end <= start) || (query->start >= end)) {
+			gboolean shared_view;
+			
+			priv->queries = g_list_delete_link (priv->queries, q);
+			shared_view = store_view_has_view (self, query->view);
+			
+			g_hash_table_iter_init (&iter, priv->items);
+			while ((!shared_view) &&
+			       g_hash_table_iter_next (&iter, NULL, &data)) {
+				StoreViewItem *item = (StoreViewItem *)data;
+				item->views = g_slist_remove (
+					item->views, query->view);
+			}
+			
+			store_view_query_free (self, query);
+		}
+		q = next;
+	}
+	
+	g_hash_table_iter_init (&iter, priv->items);
+	while (g_hash_table_iter_next (&iter, &uid, &data)) {
+		StoreViewItem *item = (StoreViewItem *)data;
+		
+		if (item->views &&
+		    store_view_spans_in_range (item->spans, start, end))
+			continue;
+		
+		removed = g_list_prepend (removed, uid);
+		g_hash_table_iter_steal (&iter);
+		store_view_item_free (item);
+	}
+	
+	store_view_emit_removed (self, removed);
+	
+	if (start < priv->query_start)
+		added = g_list_prepend (added, store_view_add_query (
+			self, start, priv->query_start));
+	if (end > priv->query_end)
+		added = g_list_prepend (added, store_view_add_query (
+			self, priv->query_end, end));
+	
+	priv->query_start = start;
+	priv->query_end = end;
+	
+	/* Only once both ends are in place, so that completion isn't 
+	 * reported early.
+	 */
+	for (q = added; q; q = q->next) {
+		if (q->data && priv->started)
+			store_view_query_catch_up (self, q->data);
+	}
+	g_list_free (added);
+	
+	return TRUE;
+}
+
+/* Applies matches narrower than the ones the queries were made with to 
+ * what the queries have already found and kept, rather than querying 
+ * again.
+ */
+static void
+store_view_refilter (JanaEcalStoreView *self)
+{
+	GList *q, *removed = NULL;
+	JanaEcalStoreViewPrivate *priv = STORE_VIEW_PRIVATE (self);
+	
+	if (!priv->started) return;
+	
+	for (q = priv->queries; q; q = q->next) {
+		StoreViewQuery *query = (StoreViewQuery *)q->data;
+		GList *objects, *o, *unseen = NULL;
+		
+		objects = jana_ecal_store_query_get_objects (query->shared);
+		for (o = objects; o; o = o->next) {
+			gboolean matches;
+			StoreViewItem *item;
+			const gchar *uid = icalcomponent_get_uid (o->data);
+			
+			if (priv->predicate) {
+				JanaComponent *jcomp =
+					store_view_jcomp_from_icalcomp (
+						o->data);
+				matches = jana_store_view_predicate_match (
+					priv->predicate, jcomp);
+				g_object_unref (jcomp);
+			} else
+				matches = TRUE;
+			
+			item = g_hash_table_lookup (priv->items, uid);
+			if (item && g_slist_find (item->views, query->view)) {
+				if (matches) continue;
+				
+				item->views = g_slist_remove (
+					item->views, query->view);
+				if (!item->views) {
+					removed = g_list_prepend (
+						removed, g_strdup (uid));
+					g_hash_table_remove (priv->items, uid);
+				}
+			} else if (matches)
+				unseen = g_list_prepend (unseen, o->data);
+		}
+		g_list_free (objects);
+		
+		if (unseen) {
+			store_view_process_objects (self, query->view, unseen,
+				query->start, query->end);
+			g_list_free (unseen);
+		}
+	}
+	
+	store_view_emit_removed (self, removed);
+}
+
+/* The backend's "any" field covers more than the summary, location and 
+ * description that predicates look at, so a local check could disagree 
+ * with a fresh query.
+ */
+static gboolean
+store_view_matches_any_field (GList *matches)
+{
+	for (; matches; matches = matches->next) {
+		if (((JanaStoreViewMatch *)matches->data)->field ==
+		    JANA_STORE_VIEW_ANYFIELD)
+			return TRUE;
+	}
+	
+	return FALSE;
+}
+
+static gboolean
+store_view_narrow_matches (JanaEcalStoreView *self)
+{
+	gboolean equivalent;
+	JanaStoreViewPredicate *predicate;
+	JanaEcalStoreViewPrivate *priv = STORE_VIEW_PRIVATE (self);
+	
+	if ((!priv->queries) || (!priv->query_predicate)) return FALSE;
+	
+	predicate = jana_store_view_predicate_new (priv->matches);
+	if (!jana_store_view_predicate_narrows (
+	     predicate, priv->query_predicate)) {
+		jana_store_view_predicate_free (predicate);
+		return FALSE;
+	}
+	
+	/* Back to the matches the queries were made with */
+	equivalent = jana_store_view_predicate_narrows (
+		priv->query_predicate, predicate);
+	if ((!equivalent) && store_view_matches_any_field (priv->matches)) {
+		jana_store_view_predicate_free (predicate);
+		return FALSE;
+	}
+	
+	if (priv->predicate)
+		jana_store_view_predicate_free (priv->predicate);
+	
+	if (equivalent) {
+		jana_store_view_predicate_free (predicate);
+		priv->predicate = NULL;
+	} else
+		priv->predicate = predicate;
+	
+	return TRUE;
+}
+
+static void
+store_view_apply_changes (JanaEcalStoreView *self)
+{
+	gboolean limited, refresh = FALSE, refilter = FALSE;
+	JanaEcalStoreViewPrivate *priv = STORE_VIEW_PRIVATE (self);
+	
+	/* Which events are soonest depends on where the range starts, so a 
+	 * limited view starts again from the first window when it moves.
+	 */
+	limited = (priv->limit && priv->start);
+	if ((priv->limit_changed || priv->range_changed) &&
+	    (limited || priv->limited)) {
+		if (limited != priv->limited) {
+			store_view_limit_reset (self);
+			priv->limited = limited;
+		}
+		if (limited)
+			priv->window_end = store_view_time_to_timet (
+				JANA_TIME (priv->start)) +
+				STORE_VIEW_FIRST_WINDOW;
+		priv->window_changed = FALSE;
+		refresh = TRUE;
+	} else if (priv->window_changed) {
+		priv->window_changed = FALSE;
+		refresh = !store_view_slide_range (self);
+	}
+	
+	if (priv->matches_changed && store_view_narrow_matches (self)) {
+		priv->matches_changed = FALSE;
+		refilter = TRUE;
+	}
+	
+	if (refresh || priv->matches_changed || priv->projection_changed ||
+	    (priv->range_changed && !store_view_slide_range (self)))
+		store_view_refresh_query (self);
+	else if (refilter)
+		store_view_refilter (self);
+	
+	priv->range_changed = FALSE;
+	priv->matches_changed = FALSE;
+	priv->limit_changed = FALSE;
+	priv->projection_changed = FALSE;
+}
+
+static gboolean
+store_view_apply_changes_cb (JanaEcalStoreView *self)
+{
+	JanaEcalStoreViewPrivate *priv = STORE_VIEW_PRIVATE (self);
 	
 	priv->refresh_id = 0;
 	
+	/* An update began after this was scheduled, the changes are left 
+	 * for its commit.
+	 */
+	if (priv->update_depth) return FALSE;
+	
+	store_view_apply_changes (self);
+	
 	return FALSE;
 }
 
+/* Range and match changes are applied from an idle callback, so that 
+ * several changes made in a row result in a single query. Within a 
+ * begin_update/commit_update pair, they wait for the commit instead.
+ */
+static void
+store_view_schedule_changes (JanaEcalStoreView *self)
+{
+	JanaEcalStoreViewPrivate *priv = STORE_VIEW_PRIVATE (self);
+	
+	if (priv->update_depth || priv->refresh_id) return;
+	
+	priv->refresh_id = g_idle_add (
+		(GSourceFunc)store_view_apply_changes_cb, self);
+}
+
+static void
+store_view_begin_update (JanaStoreView *self)
+{
+	JanaEcalStoreViewPrivate *priv = STORE_VIEW_PRIVATE (self);
+	
+	priv->update_depth ++;
+}
+
+static void
+store_view_commit_update (JanaStoreView *self)
+{
+	JanaEcalStoreViewPrivate *priv = STORE_VIEW_PRIVATE (self);
+	
+	g_return_if_fail (priv->update_depth > 0);
+	
+	if (--priv->update_depth) return;
+	
+	if (priv->refresh_id) {
+		g_source_remove (priv->refresh_id);
+		priv->refresh_id = 0;
+	}
+	store_view_apply_changes (JANA_ECAL_STORE_VIEW (self));
+}
+
 static void
 store_view_get_range (JanaStoreView *self,
 		      JanaTime **start,
@@ -692,7 +2087,8 @@ store_view_set_range (JanaStoreView *self,
 				end, jana_ecal_time_new ()));
 	}
 
-	store_view_refresh_query (JANA_ECAL_STORE_VIEW (self));
+	priv->range_changed = TRUE;
+	store_view_schedule_changes (JANA_ECAL_STORE_VIEW (self));
 }
 
 static JanaStoreViewMatch *
@@ -709,8 +2105,8 @@ store_view_add_match (JanaStoreView *self, JanaStoreViewField field,
 	match->data = g_strdup (data);
 	priv->matches = g_list_prepend (priv->matches, match);
 	
-	if (!priv->refresh_id) priv->refresh_id = g_idle_add (
-		(GSourceFunc)store_view_refresh_query, self);
+	priv->matches_changed = TRUE;
+	store_view_schedule_changes (JANA_ECAL_STORE_VIEW (self));
 
 	return match;
 }
@@ -732,8 +2128,8 @@ store_view_remove_match (JanaStoreView *self, JanaStoreViewMatch *match)
 	g_free (match->data);
 	g_slice_free (JanaStoreViewMatch, match);
 
-	if (!priv->refresh_id) priv->refresh_id = g_idle_add (
-		(GSourceFunc)store_view_refresh_query, self);
+	priv->matches_changed = TRUE;
+	store_view_schedule_changes (JANA_ECAL_STORE_VIEW (self));
 }
 
 static void
@@ -750,13 +2146,60 @@ store_view_clear_matches (JanaStoreView *self)
 static void
 store_view_start (JanaStoreView *self)
 {
+	GList *q;
 	JanaEcalStoreViewPrivate *priv = STORE_VIEW_PRIVATE (self);
 
-	if (priv->query && (!priv->started)) {
-		e_cal_view_start (priv->query);
+	if (priv->started) return;
+	
+	priv->started = TRUE;
+	for (q = priv->queries; q; q = q->next) {
+		StoreViewQuery *query = (StoreViewQuery *)q->data;
+		query->replay = jana_ecal_store_query_is_started (
+			query->shared);
+		jana_ecal_store_query_start (query->shared);
+		store_view_query_catch_up (JANA_ECAL_STORE_VIEW (self), query);
 	}
+}
 
-	priv->started = TRUE;
+static void
+store_view_set_limit (JanaStoreView *self, guint limit)
+{
+	JanaEcalStoreViewPrivate *priv = STORE_VIEW_PRIVATE (self);
+	
+	if (priv->limit == limit) return;
+	
+	priv->limit = limit;
+	priv->limit_changed = TRUE;
+	store_view_schedule_changes (JANA_ECAL_STORE_VIEW (self));
+}
+
+static guint
+store_view_get_limit (JanaStoreView *self)
+{
+	JanaEcalStoreViewPrivate *priv = STORE_VIEW_PRIVATE (self);
+	
+	return priv->limit;
+}
+
+static void
+store_view_set_projection (JanaStoreView *self,
+			   JanaStoreViewProjection projection)
+{
+	JanaEcalStoreViewPrivate *priv = STORE_VIEW_PRIVATE (self);
+	
+	if (priv->projection == projection) return;
+	
+	priv->projection = projection;
+	priv->projection_changed = TRUE;
+	store_view_schedule_changes (JANA_ECAL_STORE_VIEW (self));
+}
+
+static JanaStoreViewProjection
+store_view_get_projection (JanaStoreView *self)
+{
+	JanaEcalStoreViewPrivate *priv = STORE_VIEW_PRIVATE (self);
+	
+	return priv->projection;
 }
 
 static JanaStore *
@@ -769,3 +2212,27 @@ store_view_get_store (JanaStoreView *self)
 	return store;
 }
 
+
+/**
+ * jana_ecal_store_view_flush:
+ * @self: A #JanaEcalStoreView
+ *
+ * When the delivery of changes is throttled, with the "batch-size" or 
+ * "interval" properties, delivers the next batch of pending changes 
+ * immediately. Setting "interval" to %G_MAXUINT and calling this once per 
+ * frame, before drawing, lets changes arrive in step with redraws.
+ */
+void
+jana_ecal_store_view_flush (JanaEcalStoreView *self)
+{
+	JanaEcalStoreViewPrivate *priv = STORE_VIEW_PRIVATE (self);
+	
+	if (priv->deliver_id) {
+		g_source_remove (priv->deliver_id);
+		priv->deliver_id = 0;
+	}
+	
+	if ((!g_queue_is_empty (priv->pending)) ||
+	    (priv->pending_progress >= 0))
+		store_view_deliver (self);
+}
@@ -65,5 +65,7 @@ GType jana_ecal_store_view_get_type (void);
 
 JanaStoreView *jana_ecal_store_view_new (JanaEcalStore *store);
 
+void jana_ecal_store_view_flush (JanaEcalStoreView *self);
+
 #endif /* JANA_ECAL_STORE_VIEW_H */
 
@@ -32,6 +32,7 @@
 
 #define HANDLE_LIBICAL_MEMORY 1
 
+#include <string.h>
 #include <libjana/jana-utils.h>
 #include <libedataserverui/libedataserverui.h>
 #include "jana-ecal-component.h"
@@ -78,6 +79,28 @@ struct _JanaEcalStorePrivate
 {
 	ECal *ecal;
 	JanaComponentType type;
+	
+	/* JanaEcalStoreQuery structs shared between this store's views */
+	GList *queries;
+};
+
+/* A backend query shared by every view asking for the same thing. The 
+ * objects it has reported so far are kept so that views subscribing after 
+ * it has started, or filtering what it found, don't need to ask the 
+ * backend again.
+ */
+struct _JanaEcalStoreQuery {
+	gchar *match;
+	time_t start;
+	time_t end;
+	ECalView *view;
+	/* "uid\nrecurrence-id" -> icalcomponent, so that detached instances 
+	 * of a recurring event don't replace each other.
+	 */
+	GHashTable *objects;
+	gboolean started;
+	gboolean done;
+	guint refs;
 };
 
 enum {
@@ -124,11 +147,31 @@ jana_ecal_store_set_property (GObject *object, guint property_id,
 	}
 }
 
+static void
+store_query_free (JanaEcalStoreQuery *query)
+{
+	g_signal_handlers_disconnect_matched (query->view,
+		G_SIGNAL_MATCH_DATA, 0, 0, NULL, NULL, query);
+	g_object_unref (query->view);
+	g_hash_table_destroy (query->objects);
+	g_free (query->match);
+	g_slice_free (JanaEcalStoreQuery, query);
+}
+
 static void
 jana_ecal_store_dispose (GObject *object)
 {
 	JanaEcalStorePrivate *priv = STORE_PRIVATE (object);
 
+	/* Views hold a reference on their store, so there shouldn't be any 
+	 * queries left by now.
+	 */
+	while (priv->queries) {
+		store_query_free ((JanaEcalStoreQuery *)priv->queries->data);
+		priv->queries = g_list_delete_link (priv->queries,
+			priv->queries);
+	}
+
 	if (priv->ecal) {
 		g_object_unref (priv->ecal);
 		priv->ecal = NULL;
@@ -544,3 +587,324 @@ store_remove_component (JanaStore *self, JanaComponent *comp)
 	g_free (uid);
 }
 
+
+static gchar *
+store_query_get_key (const gchar *uid, const gchar *rid)
+{
+	return g_strconcat (uid, "\n", rid ? rid : "", NULL);
+}
+
+static gchar *
+store_query_get_object_key (icalcomponent *comp)
+{
+	gchar *key, *rid;
+	struct icaltimetype recurrence_id;
+	
+	recurrence_id = icalcomponent_get_recurrenceid (comp);
+	if (icaltime_is_null_time (recurrence_id))
+		return store_query_get_key (icalcomponent_get_uid (comp), NULL);
+	
+	rid = icaltime_as_ical_string (recurrence_id);
+	key = store_query_get_key (icalcomponent_get_uid (comp), rid);
+#ifdef LIBICAL_MEMFIXES
+	g_free (rid);
+#endif
+	
+	return key;
+}
+
+static gboolean
+store_query_key_has_uid (const gchar *key, gpointer value, const gchar *uid)
+{
+	gsize length = strlen (uid);
+	
+	return (strncmp (key, uid, length) == 0) && (key[length] == '\n');
+}
+
+static void
+store_query_objects_changed_cb (ECalView *view, GList *objects,
+				JanaEcalStoreQuery *query)
+{
+	for (; objects; objects = objects->next) {
+		icalcomponent *comp = (icalcomponent *)objects->data;
+		g_hash_table_replace (query->objects,
+			store_query_get_object_key (comp),
+			icalcomponent_new_clone (comp));
+	}
+}
+
+static void
+store_query_objects_removed_cb (ECalView *view, GList *uids,
+				JanaEcalStoreQuery *query)
+{
+	for (; uids; uids = uids->next) {
+#ifdef HAVE_ECALCOMPONENTID
+		ECalComponentId *id = uids->data;
+		
+		if (id->rid && *id->rid) {
+			gchar *key = store_query_get_key (id->uid, id->rid);
+			g_hash_table_remove (query->objects, key);
+			g_free (key);
+			continue;
+		}
+		
+		/* The whole series went */
+		g_hash_table_foreach_remove (query->objects,
+			(GHRFunc)store_query_key_has_uid, id->uid);
+#else
+		g_hash_table_foreach_remove (query->objects,
+			(GHRFunc)store_query_key_has_uid, uids->data);
+#endif
+	}
+}
+
+static void
+store_query_done_cb (ECalView *view, ECalendarStatus status,
+		     JanaEcalStoreQuery *query)
+{
+	query->done = TRUE;
+}
+
+static gboolean
+store_query_match_equal (const gchar *match1, const gchar *match2)
+{
+	if ((!match1) || (!match2)) return (match1 == match2);
+	return (strcmp (match1, match2) == 0);
+}
+
+static gchar *
+store_query_get_sexp (const gchar *match, time_t start, time_t end)
+{
+	gchar *sexp, *start_str, *end_str;
+	
+	if ((!match) && (start == 0) && (end == G_MAXLONG))
+		return g_strdup ("#t");
+	
+	start_str = isodate_from_time_t (start);
+	end_str = isodate_from_time_t (end);
+	
+	if (match)
+		sexp = g_strdup_printf ("(and %s (occur-in-time-range? "
+			"(make-time \"%s\") (make-time \"%s\")))",
+			match, start_str, end_str);
+	else
+		sexp = g_strdup_printf ("(occur-in-time-range? "
+			"(make-time \"%s\") (make-time \"%s\"))",
+			start_str, end_str);
+	
+	g_free (start_str);
+	g_free (end_str);
+	
+	return sexp;
+}
+
+/**
+ * jana_ecal_store_ref_query:
+ * @store: A #JanaEcalStore
+ * @match: An evolution-data-server s-expression to match, or %NULL
+ * @start: The start of the range to query
+ * @end: The end of the range to query
+ *
+ * Retrieves a backend query for components matching @match that occur 
+ * between @start and @end, sharing an existing query if one is suitable. 
+ * For stores of events, a query with the same match over a wider range may 
+ * be shared when the requested range is bounded at both ends, so the 
+ * caller must be prepared to filter out components that fall outside of 
+ * it. A @start of 0 and an @end of %G_MAXLONG with no match retrieves 
+ * everything in the store.
+ *
+ * This function is intended for use by #JanaEcalStoreView, so that views 
+ * of the same store and range only cost one query on the backend.
+ *
+ * Returns: A #JanaEcalStoreQuery, to be released with 
+ * jana_ecal_store_unref_query(), or %NULL if the query failed.
+ */
+JanaEcalStoreQuery *
+jana_ecal_store_ref_query (JanaEcalStore *store, const gchar *match,
+			   time_t start, time_t end)
+{
+	GList *q;
+	gchar *sexp;
+	ECalView *view;
+	gboolean bounded;
+	GError *error = NULL;
+	JanaEcalStoreQuery *query, *best = NULL;
+	JanaEcalStorePrivate *priv = STORE_PRIVATE (store);
+	
+	/* Only events have an extent that views can filter by */
+	bounded = (priv->type == JANA_COMPONENT_EVENT) &&
+		(start > 0) && (end < G_MAXLONG);
+	
+	for (q = priv->queries; q; q = q->next) {
+		query = (JanaEcalStoreQuery *)q->data;
+		
+		if (!store_query_match_equal (query->match, match)) continue;
+		
+		if ((query->start == start) && (query->end == end)) {
+			best = query;
+			break;
+		}
+		
+		if ((!bounded) || (query->start > start) ||
+		    (query->end < end))
+			continue;
+		
+		/* Prefer the narrowest range, there's less to filter */
+		if ((!best) || ((query->end - query->start) <
+		     (best->end - best->start)))
+			best = query;
+	}
+	
+	if (best) {
+		best->refs ++;
+		return best;
+	}
+	
+	sexp = store_query_get_sexp (match, start, end);
+	if (!e_cal_get_query (priv->ecal, sexp, &view, &error)) {
+		g_warning ("Failed to retrieve query '%s': %s",
+			sexp, error->message);
+		g_error_free (error);
+		g_free (sexp);
+		return NULL;
+	}
+	g_free (sexp);
+	
+	query = g_slice_new0 (JanaEcalStoreQuery);
+	query->match = g_strdup (match);
+	query->start = start;
+	query->end = end;
+	query->view = view;
+	query->objects = g_hash_table_new_full (g_str_hash, g_str_equal,
+		g_free, (GDestroyNotify)icalcomponent_free);
+	query->refs = 1;
+	
+	/* Connected before any view gets the chance to, so the kept objects 
+	 * are up to date by the time views are notified.
+	 */
+	g_signal_connect (view, "objects-added",
+		G_CALLBACK (store_query_objects_changed_cb), query);
+	g_signal_connect (view, "objects-modified",
+		G_CALLBACK (store_query_objects_changed_cb), query);
+	g_signal_connect (view, "objects-removed",
+		G_CALLBACK (store_query_objects_removed_cb), query);
+	g_signal_connect (view, "view_done",
+		G_CALLBACK (store_query_done_cb), query);
+	
+	priv->queries = g_list_prepend (priv->queries, query);
+	
+	return query;
+}
+
+/**
+ * jana_ecal_store_unref_query:
+ * @store: A #JanaEcalStore
+ * @query: A #JanaEcalStoreQuery retrieved from @store
+ *
+ * Releases a reference on a query retrieved with 
+ * jana_ecal_store_ref_query(). The backend query is stopped when the last 
+ * reference is released.
+ */
+void
+jana_ecal_store_unref_query (JanaEcalStore *store, JanaEcalStoreQuery *query)
+{
+	JanaEcalStorePrivate *priv = STORE_PRIVATE (store);
+	
+	g_return_if_fail (query->refs > 0);
+	
+	if (--query->refs) return;
+	
+	priv->queries = g_list_remove (priv->queries, query);
+	store_query_free (query);
+}
+
+/**
+ * jana_ecal_store_query_start:
+ * @query: A #JanaEcalStoreQuery
+ *
+ * Starts the backend query, if it hasn't been started already.
+ */
+void
+jana_ecal_store_query_start (JanaEcalStoreQuery *query)
+{
+	if (query->started) return;
+	
+	query->started = TRUE;
+	e_cal_view_start (query->view);
+}
+
+/**
+ * jana_ecal_store_query_is_started:
+ * @query: A #JanaEcalStoreQuery
+ *
+ * Determines whether @query has been started. Subscribers connecting to 
+ * the view of a started query may have missed objects it has already 
+ * reported, and can retrieve them with jana_ecal_store_query_get_objects().
+ *
+ * Returns: %TRUE if the query has been started, %FALSE otherwise.
+ */
+gboolean
+jana_ecal_store_query_is_started (JanaEcalStoreQuery *query)
+{
+	return query->started;
+}
+
+/**
+ * jana_ecal_store_query_get_view:
+ * @query: A #JanaEcalStoreQuery
+ *
+ * Retrieves the #ECalView behind @query. Objects are reported through its 
+ * signals to every subscriber.
+ *
+ * Returns: The #ECalView used by @query. This is owned by the query and 
+ * should not be unreferenced.
+ */
+ECalView *
+jana_ecal_store_query_get_view (JanaEcalStoreQuery *query)
+{
+	return query->view;
+}
+
+static void
+store_query_get_objects_cb (gpointer key, icalcomponent *comp,
+			    GList **objects)
+{
+	*objects = g_list_prepend (*objects, comp);
+}
+
+/**
+ * jana_ecal_store_query_get_objects:
+ * @query: A #JanaEcalStoreQuery
+ *
+ * Retrieves the objects @query has reported so far, as #icalcomponent 
+ * structs. These are owned by the query and are only valid until it next 
+ * reports a change. Objects the backend has found but not yet reported 
+ * are not included, they will be reported through the query's view.
+ *
+ * Returns: A newly allocated #GList of #icalcomponent structs, to be freed 
+ * with g_list_free().
+ */
+GList *
+jana_ecal_store_query_get_objects (JanaEcalStoreQuery *query)
+{
+	GList *objects = NULL;
+	
+	g_hash_table_foreach (query->objects,
+		(GHFunc)store_query_get_objects_cb, &objects);
+	
+	return objects;
+}
+
+/**
+ * jana_ecal_store_query_is_done:
+ * @query: A #JanaEcalStoreQuery
+ *
+ * Determines whether @query has finished reporting its initial results.
+ *
+ * Returns: %TRUE if the query is done, %FALSE otherwise.
+ */
+gboolean
+jana_ecal_store_query_is_done (JanaEcalStoreQuery *query)
+{
+	return query->done;
+}
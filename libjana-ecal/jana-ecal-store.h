@@ -43,6 +43,7 @@
 
 typedef struct _JanaEcalStore JanaEcalStore;
 typedef struct _JanaEcalStoreClass JanaEcalStoreClass;
+typedef struct _JanaEcalStoreQuery JanaEcalStoreQuery;
 
 /**
  * JanaEcalStore:
@@ -57,6 +58,13 @@ struct _JanaEcalStoreClass {
 	GObjectClass parent;
 };
 
+/**
+ * JanaEcalStoreQuery:
+ *
+ * An opaque structure representing a backend query that is shared between 
+ * the views of a #JanaEcalStore.
+ */
+
 GType jana_ecal_store_get_type (void);
 
 JanaStore *jana_ecal_store_new 		(JanaComponentType type);
@@ -64,5 +72,17 @@ JanaStore *jana_ecal_store_new_from_uri	(const gchar *uri,
 					 JanaComponentType type);
 const gchar *jana_ecal_store_get_uri	(JanaEcalStore *store);
 
+JanaEcalStoreQuery *jana_ecal_store_ref_query	(JanaEcalStore *store,
+						 const gchar *match,
+						 time_t start,
+						 time_t end);
+void	jana_ecal_store_unref_query		(JanaEcalStore *store,
+						 JanaEcalStoreQuery *query);
+void	jana_ecal_store_query_start		(JanaEcalStoreQuery *query);
+gboolean jana_ecal_store_query_is_started	(JanaEcalStoreQuery *query);
+ECalView *jana_ecal_store_query_get_view	(JanaEcalStoreQuery *query);
+GList *	jana_ecal_store_query_get_objects	(JanaEcalStoreQuery *query);
+gboolean jana_ecal_store_query_is_done		(JanaEcalStoreQuery *query);
+
 #endif /* JANA_ECAL_STORE_H */
 
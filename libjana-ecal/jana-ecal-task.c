@@ -44,6 +44,8 @@ static gboolean			component_is_fully_represented
 
 static gchar *		task_get_summary	(JanaTask *self);
 static gchar *		task_get_description	(JanaTask *self);
+static const gchar *	task_peek_summary	(JanaTask *self);
+static const gchar *	task_peek_description	(JanaTask *self);
 static gboolean		task_get_completed	(JanaTask *self);
 static JanaTime	*	task_get_due_date	(JanaTask *self);
 static gint		task_get_priority	(JanaTask *self);
@@ -83,6 +85,8 @@ task_interface_init (gpointer g_iface, gpointer iface_data)
 	
 	iface->get_summary = task_get_summary;
 	iface->get_description = task_get_description;
+	iface->peek_summary = task_peek_summary;
+	iface->peek_description = task_peek_description;
 	iface->get_completed = task_get_completed;
 	iface->get_due_date = task_get_due_date;
 	iface->get_priority = task_get_priority;
@@ -183,17 +187,31 @@ task_get_description (JanaTask *self)
 	return jana_ecal_component_get_description (JANA_ECAL_COMPONENT (self));
 }
 
+static const gchar *
+task_peek_summary (JanaTask *self)
+{
+	return jana_ecal_component_peek_summary (JANA_ECAL_COMPONENT (self));
+}
+
+static const gchar *
+task_peek_description (JanaTask *self)
+{
+	return jana_ecal_component_peek_description (
+		JANA_ECAL_COMPONENT (self));
+}
+
 static gboolean
 task_get_completed (JanaTask *self)
 {
-	ECalComponent *comp;
-	icalproperty_status status;
+	icalproperty *prop;
+	icalcomponent *comp = jana_ecal_component_peek_icalcomp (
+		JANA_ECAL_COMPONENT (self));
 
-	g_object_get (self, "ecalcomp", &comp, NULL);
-	e_cal_component_get_status (comp, &status);
-	g_object_unref (comp);
+	prop = comp ? icalcomponent_get_first_property (comp,
+		ICAL_STATUS_PROPERTY) : NULL;
 
-	return (status == ICAL_STATUS_COMPLETED);
+	return prop && (icalproperty_get_status (prop) ==
+		ICAL_STATUS_COMPLETED);
 }
 
 static JanaTime *
@@ -218,18 +236,14 @@ task_get_due_date (JanaTask *self)
 static gint
 task_get_priority (JanaTask *self)
 {
-	ECalComponent *comp;
-	gint *priority = NULL;
-	gint res;
+	icalproperty *prop;
+	icalcomponent *comp = jana_ecal_component_peek_icalcomp (
+		JANA_ECAL_COMPONENT (self));
 
-	g_object_get (self, "ecalcomp", &comp, NULL);
-	e_cal_component_get_priority (comp, &priority);
-	res = priority ? *priority: 0;
-	if (priority)
-		e_cal_component_free_priority (priority);
-	g_object_unref (comp);
+	prop = comp ? icalcomponent_get_first_property (comp,
+		ICAL_PRIORITY_PROPERTY) : NULL;
 
-	return res;
+	return prop ? icalproperty_get_priority (prop) : 0;
 }
 
 static void
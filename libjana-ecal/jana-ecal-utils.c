@@ -32,6 +32,10 @@
 #include <libjana/jana-utils.h>
 #include <libecal/libecal.h>
 #include <libjana-ecal/jana-ecal-time.h>
+#include <libjana-ecal/jana-ecal-component.h>
+#include <libjana-ecal/jana-ecal-event.h>
+#include <libjana-ecal/jana-ecal-note.h>
+#include <libjana-ecal/jana-ecal-task.h>
 #include <gconf/gconf-client.h>
 #include "jana-ecal-utils.h"
 
@@ -265,3 +269,78 @@ jana_ecal_utils_get_locations ()
 	
 	return locations;
 }
+
+/**
+ * jana_ecal_utils_load_ics:
+ * @store: A #JanaStore
+ * @filename: The path of an iCalendar file
+ * @error: Return location for a #GError, or %NULL
+ *
+ * Reads the events, tasks and journal entries in an iCalendar (.ics) file 
+ * and adds them to @store with jana_store_add_component(). This is mostly 
+ * useful for filling a #JanaMemoryStore with test data.
+ *
+ * Returns: The number of components added, or -1 if the file couldn't be 
+ * read or parsed, in which case @error is set.
+ */
+gint
+jana_ecal_utils_load_ics (JanaStore *store, const gchar *filename,
+			  GError **error)
+{
+	gchar *contents;
+	icalcomponent *toplevel, *comp;
+	gint count = 0;
+	
+	if (!g_file_get_contents (filename, &contents, NULL, error))
+		return -1;
+	
+	toplevel = icalparser_parse_string (contents);
+	g_free (contents);
+	
+	if (!toplevel) {
+		g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+			"Failed to parse '%s' as iCalendar data", filename);
+		return -1;
+	}
+	
+	/* A file can hold a bare component rather than a VCALENDAR */
+	if (icalcomponent_isa (toplevel) == ICAL_VCALENDAR_COMPONENT)
+		comp = icalcomponent_get_first_component (toplevel,
+			ICAL_ANY_COMPONENT);
+	else
+		comp = toplevel;
+	
+	for (; comp; comp = (comp == toplevel) ? NULL :
+	     icalcomponent_get_next_component (toplevel, ICAL_ANY_COMPONENT)) {
+		GType type;
+		JanaComponent *jcomp;
+		
+		switch (icalcomponent_isa (comp)) {
+		    case ICAL_VEVENT_COMPONENT :
+			type = JANA_ECAL_TYPE_EVENT;
+			break;
+		    case ICAL_VJOURNAL_COMPONENT :
+			type = JANA_ECAL_TYPE_NOTE;
+			break;
+		    case ICAL_VTODO_COMPONENT :
+			type = JANA_ECAL_TYPE_TASK;
+			break;
+		    default :
+			continue;
+		}
+		
+		/* Borrow the parsed component, then take a copy of it so 
+		 * that the parse tree can be freed.
+		 */
+		jcomp = JANA_COMPONENT (g_object_new (type,
+			"icalcomp", comp, NULL));
+		jana_ecal_component_detach (JANA_ECAL_COMPONENT (jcomp));
+		jana_store_add_component (store, jcomp);
+		g_object_unref (jcomp);
+		count ++;
+	}
+	
+	icalcomponent_free (toplevel);
+	
+	return count;
+}
@@ -24,6 +24,7 @@
 #include <time.h>
 #include <glib.h>
 #include <libjana/jana-time.h>
+#include <libjana/jana-store.h>
 
 /**
  * JANA_ECAL_LOCATION_KEY:
@@ -58,6 +59,8 @@ JanaTime * jana_ecal_utils_time_now_local ();
 JanaTime * jana_ecal_utils_time_today (const gchar *location);
 gchar * jana_ecal_utils_guess_location ();
 gchar ** jana_ecal_utils_get_locations ();
+gint jana_ecal_utils_load_ics (JanaStore *store, const gchar *filename,
+			       GError **error);
 
 #endif
 
@@ -22,6 +22,7 @@
 #include <locale.h>
 #include <langinfo.h>
 #include <libjana-gtk/jana-gtk-tree-layout.h>
+#include <libjana-gtk/jana-gtk-utils.h>
 #include <libjana/jana-utils.h>
 #include "jana-gtk-day-view.h"
 
@@ -52,6 +53,9 @@ struct _JanaGtkDayViewPrivate
 	PangoLayout **time_layouts;
 	PangoLayout **day_layouts;
 	PangoLayout *week_layout;
+	GdkPixmap *grid_background;
+	GdkPixmap *days_background;
+	GdkPixmap *times_background;
 	guint col0_width;
 	guint row0_height;
 
@@ -83,8 +87,23 @@ struct _JanaGtkDayViewPrivate
 	gint highlighted_time_x;
 	gint highlighted_time_y;
 	gdouble highlighted_time_pos;
+	
+	gboolean virtualise;
+	/* Store -> GPtrArray of VirtualRow, by row number */
+	GHashTable *virtual_rows;
+	GdkRectangle virtual_window;
 };
 
+/* A timed event in virtual mode, whether or not it currently has a cell.
+ * Its times are kept here and refreshed when the row changes, so that
+ * placing it doesn't need to go back to the model.
+ */
+typedef struct {
+	GtkTreeRowReference *row;
+	JanaTime *start;
+	JanaTime *end;
+} VirtualRow;
+
 enum {
 	PROP_RANGE = 1,
 	PROP_SELECTION,
@@ -96,6 +115,7 @@ enum {
 	PROP_RATIO_Y,
 	PROP_ACTIVE_RANGE,
 	PROP_HIGHLIGHTED_TIME,
+	PROP_VIRTUALISE,
 };
 
 enum {
@@ -111,6 +131,26 @@ static void relayout (JanaGtkDayView *self);
 static gboolean compare_selection (JanaGtkDayView *self,
 				   GtkTreeRowReference *row);
 
+static void
+virtual_row_free (VirtualRow *vrow)
+{
+	gtk_tree_row_reference_free (vrow->row);
+	if (vrow->start) g_object_unref (vrow->start);
+	if (vrow->end) g_object_unref (vrow->end);
+	g_slice_free (VirtualRow, vrow);
+}
+
+static void
+virtual_rows_free (GPtrArray *rows)
+{
+	guint i;
+	
+	for (i = 0; i < rows->len; i++) {
+		VirtualRow *vrow = (VirtualRow *)g_ptr_array_index (rows, i);
+		if (vrow) virtual_row_free (vrow);
+	}
+	g_ptr_array_free (rows, TRUE);
+}
 
 static void
 set_alignments (JanaGtkDayView *self)
@@ -238,12 +278,39 @@ create_layouts (JanaGtkDayView *self)
 	set_alignments (self);
 }
 
+/* The grid and headers only change with the range, size, style or active
+ * range, so they're painted once into pixmaps and copied to the screen
+ * on expose.
+ */
+static void
+free_backgrounds (JanaGtkDayView *self)
+{
+	JanaGtkDayViewPrivate *priv = DAY_VIEW_PRIVATE (self);
+	
+	if (priv->grid_background) {
+		g_object_unref (priv->grid_background);
+		priv->grid_background = NULL;
+	}
+	
+	if (priv->days_background) {
+		g_object_unref (priv->days_background);
+		priv->days_background = NULL;
+	}
+	
+	if (priv->times_background) {
+		g_object_unref (priv->times_background);
+		priv->times_background = NULL;
+	}
+}
+
 static void
 free_layouts (JanaGtkDayView *self)
 {
 	gint i;
 	JanaGtkDayViewPrivate *priv = DAY_VIEW_PRIVATE (self);
 	
+	free_backgrounds (self);
+	
 	if (priv->day_layouts) {
 		for (i = 0; i < priv->visible_days; i++)
 			g_object_unref (priv->day_layouts[i]);
@@ -332,6 +399,9 @@ jana_gtk_day_view_get_property (GObject *object, guint property_id,
 			g_value_take_object (value,
 				jana_time_duplicate (priv->highlighted_time));
 		break;
+	    case PROP_VIRTUALISE :
+		g_value_set_boolean (value, priv->virtualise);
+		break;
 	    default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
 	}
@@ -362,6 +432,7 @@ jana_gtk_day_view_set_property (GObject *object, guint property_id,
 			priv->style_hint = NULL;
 		}
 		priv->style_hint = g_value_dup_string (value);
+		free_backgrounds (JANA_GTK_DAY_VIEW (object));
 		gtk_widget_queue_draw (GTK_WIDGET (object));
 		break;
 	    case PROP_SELECTION :
@@ -388,6 +459,10 @@ jana_gtk_day_view_set_property (GObject *object, guint property_id,
 		jana_gtk_day_view_set_active_range (
 			JANA_GTK_DAY_VIEW (object), g_value_get_boxed (value));
 		break;
+	    case PROP_VIRTUALISE :
+		jana_gtk_day_view_set_virtualise (
+			JANA_GTK_DAY_VIEW (object), g_value_get_boolean (value));
+		break;
 	    default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
 	}
@@ -398,6 +473,8 @@ jana_gtk_day_view_dispose (GObject *object)
 {
 	JanaGtkDayViewPrivate *priv = DAY_VIEW_PRIVATE (object);
 
+	jana_gtk_utils_cancel_updates (object);
+
 	if (priv->event_renderer) {
 		g_object_unref (priv->event_renderer);
 		priv->event_renderer = NULL;
@@ -408,6 +485,8 @@ jana_gtk_day_view_dispose (GObject *object)
 		priv->event_renderer24hr = NULL;
 	}
 	
+	g_hash_table_remove_all (priv->virtual_rows);
+	
 	if (G_OBJECT_CLASS (jana_gtk_day_view_parent_class)->dispose)
 		G_OBJECT_CLASS (jana_gtk_day_view_parent_class)->
 			dispose (object);
@@ -444,6 +523,8 @@ jana_gtk_day_view_finalize (GObject *object)
 	}
 	
 	free_layouts (JANA_GTK_DAY_VIEW (object));
+	
+	g_hash_table_destroy (priv->virtual_rows);
 
 	G_OBJECT_CLASS (jana_gtk_day_view_parent_class)->finalize (object);
 }
@@ -459,35 +540,84 @@ paint_box (GtkStyle *style, GdkWindow *window, GtkStateType state_type,
 		widget, detail, x, y, width, height);
 }
 
+/* Makes sure *pixmap is a background of the given size for the current
+ * style of widget. Returns %TRUE if it needs painting.
+ */
 static gboolean
-layout_expose_event_cb (GtkWidget *widget, GdkEventExpose *event,
-			JanaGtkDayView *self)
+get_background (GdkPixmap **pixmap, GtkWidget *widget, gint width,
+		gint height)
 {
-	gint x, y, box_x, box_y, row_height, col_width, selection_direction;
-	GtkStyle *style;
+	gint old_width, old_height;
+	
+	width = MAX (width, 1);
+	height = MAX (height, 1);
+	
+	if (*pixmap) {
+		gdk_drawable_get_size (*pixmap, &old_width, &old_height);
+		if ((old_width == width) && (old_height == height) &&
+		    (g_object_get_data (G_OBJECT (*pixmap), "style") ==
+		     widget->style))
+			return FALSE;
+		g_object_unref (*pixmap);
+	}
+	
+	*pixmap = gdk_pixmap_new (widget->window, width, height, -1);
+	g_object_set_data_full (G_OBJECT (*pixmap), "style",
+		g_object_ref (widget->style), g_object_unref);
+	
+	return TRUE;
+}
 
-	JanaGtkDayViewPrivate *priv = DAY_VIEW_PRIVATE (self);
+static void
+draw_background (GtkWidget *widget, GdkPixmap *pixmap, GdkRectangle *area,
+		 gint x, gint y)
+{
+	GdkRectangle rect;
 	
-	if ((!jana_duration_valid (priv->range)) || (priv->cells == 0))
-		return FALSE;
+	rect.x = x;
+	rect.y = y;
+	gdk_drawable_get_size (pixmap, &rect.width, &rect.height);
+	if (!gdk_rectangle_intersect (area, &rect, &rect)) return;
+	
+	gdk_draw_drawable (widget->window,
+		widget->style->fg_gc[GTK_WIDGET_STATE (widget)], pixmap,
+		rect.x - x, rect.y - y, rect.x, rect.y,
+		rect.width, rect.height);
+}
+
+static GtkStyle *
+create_base_style (GtkWidget *widget)
+{
+	GtkStyle *style;
 	
-	/* Draw background */
 	/* Make a style with base as bg */
 	style = gtk_style_copy (widget->style);
 	style->bg[GTK_STATE_NORMAL] = style->base[GTK_STATE_NORMAL];
 	style->bg[GTK_STATE_SELECTED] = style->base[GTK_STATE_SELECTED];
-	style = gtk_style_attach (style, widget->window);
+	return gtk_style_attach (style, widget->window);
+}
 
-	/* Draw event boxes */
-	row_height = widget->allocation.height / priv->cells;
-	col_width = widget->allocation.width / priv->visible_days;
+static GtkStyle *
+create_dark_style (GtkWidget *widget)
+{
+	GtkStyle *style;
 	
-	if ((priv->selection_start_x < priv->selection_end_x) ||
-	    ((priv->selection_start_x == priv->selection_end_x) &&
-	     (priv->selection_start_y < priv->selection_end_y)))
-		selection_direction = 1;
-	else
-		selection_direction = 0;
+	style = gtk_style_copy (widget->style);
+	style->bg[GTK_STATE_NORMAL] = style->bg[GTK_STATE_ACTIVE];
+	style->fg[GTK_STATE_NORMAL] = style->fg[GTK_STATE_ACTIVE];
+	return gtk_style_attach (style, widget->window);
+}
+
+static void
+paint_grid (JanaGtkDayView *self, GtkWidget *widget, GdkDrawable *drawable,
+	    gint col_width, gint row_height)
+{
+	gint x, y, box_x, box_y;
+	GtkStyle *style;
+
+	JanaGtkDayViewPrivate *priv = DAY_VIEW_PRIVATE (self);
+	
+	style = create_base_style (widget);
 
 	box_x = 0;
 	for (x = 0; x < priv->visible_days; x++) {
@@ -504,102 +634,147 @@ layout_expose_event_cb (GtkWidget *widget, GdkEventExpose *event,
 					state = GTK_STATE_INSENSITIVE;
 			}
 			
-			if (priv->selection) {
-				gint start_x, start_y, end_x, end_y;
-				
-				if (selection_direction) {
-					start_x = priv->selection_start_x;
-					start_y = priv->selection_start_y;
-					end_x = priv->selection_end_x;
-					end_y = priv->selection_end_y;
-				} else {
-					start_x = priv->selection_end_x;
-					start_y = priv->selection_end_y - 1;
-					end_x = priv->selection_start_x;
-					end_y = priv->selection_start_y + 1;
-				}
-				
-				/* These can be combined, but you end
-				 * up with a horrible unreadable mess.
-				 */
-				if ((x > start_x) && (x < end_x))
-					state = GTK_STATE_SELECTED;
-				else
-				if ((x == start_x) && (x < end_x) &&
-				    (y >= start_y))
-					state = GTK_STATE_SELECTED;
-				else
-				if ((x == end_x) && (x > start_x) &&
-				    (y < end_y))
-					state = GTK_STATE_SELECTED;
-				else
-				if ((x == start_x) && (x == end_x) &&
-				    (y >= start_y) && (y < end_y))
-					state = GTK_STATE_SELECTED;
-			}
-
-			paint_box (style, widget->window,
+			paint_box (style, (GdkWindow *)drawable,
 				state, GTK_SHADOW_IN,
-				&event->area, widget, priv->style_hint,
+				NULL, widget, priv->style_hint,
 				box_x, box_y, col_width, row_height);
 			
-			if (priv->highlighted_time &&
-			    (x == priv->highlighted_time_x) &&
-			    (y == priv->highlighted_time_y)) {
-				/* Draw time line */
-				gtk_paint_hline (style, widget->window,
-					GTK_STATE_SELECTED,
-					&event->area, widget,
-					priv->style_hint, box_x,
-					box_x + col_width,
-					(gdouble)row_height *
-					(gdouble)priv->cells *
-					priv->highlighted_time_pos);
-			}
-			
 			box_y += row_height;
 		}
 		box_x += col_width;
 	}
 	gtk_style_detach (style);
+}
 
+static gboolean
+cell_selected (gint x, gint y, gint start_x, gint start_y,
+	       gint end_x, gint end_y)
+{
+	/* These can be combined, but you end
+	 * up with a horrible unreadable mess.
+	 */
+	if ((x > start_x) && (x < end_x))
+		return TRUE;
+	else
+	if ((x == start_x) && (x < end_x) &&
+	    (y >= start_y))
+		return TRUE;
+	else
+	if ((x == end_x) && (x > start_x) &&
+	    (y < end_y))
+		return TRUE;
+	else
+	if ((x == start_x) && (x == end_x) &&
+	    (y >= start_y) && (y < end_y))
+		return TRUE;
+	
 	return FALSE;
 }
 
 static gboolean
-layout24hr_expose_event_cb (GtkWidget *widget, GdkEventExpose *event,
+layout_expose_event_cb (GtkWidget *widget, GdkEventExpose *event,
 			JanaGtkDayView *self)
 {
-	gint x, box_x, col_width, text_width, text_height;
-	GtkStyle *dark_style;
+	gint x, y, row_height, col_width;
+	gint start_x, start_y, end_x, end_y;
+	GtkStyle *style;
 
 	JanaGtkDayViewPrivate *priv = DAY_VIEW_PRIVATE (self);
 	
 	if ((!jana_duration_valid (priv->range)) || (priv->cells == 0))
 		return FALSE;
 	
-	col_width = priv->layout->allocation.width / priv->visible_days;
+	/* Draw background */
+	row_height = widget->allocation.height / priv->cells;
+	col_width = widget->allocation.width / priv->visible_days;
+	
+	if (get_background (&priv->grid_background, widget,
+	    col_width * priv->visible_days, row_height * priv->cells))
+		paint_grid (self, widget, priv->grid_background,
+			col_width, row_height);
+	draw_background (widget, priv->grid_background, &event->area, 0, 0);
+	
+	if ((!priv->selection) && (!priv->highlighted_time)) return FALSE;
+	
+	/* Draw selection and time-line on top */
+	style = create_base_style (widget);
+	
+	if (priv->selection) {
+		if ((priv->selection_start_x < priv->selection_end_x) ||
+		    ((priv->selection_start_x == priv->selection_end_x) &&
+		     (priv->selection_start_y < priv->selection_end_y))) {
+			start_x = priv->selection_start_x;
+			start_y = priv->selection_start_y;
+			end_x = priv->selection_end_x;
+			end_y = priv->selection_end_y;
+		} else {
+			start_x = priv->selection_end_x;
+			start_y = priv->selection_end_y - 1;
+			end_x = priv->selection_start_x;
+			end_y = priv->selection_start_y + 1;
+		}
+		
+		for (x = MAX (start_x, 0);
+		     (x <= end_x) && (x < priv->visible_days); x++) {
+			for (y = 0; y < priv->cells; y++) {
+				if (!cell_selected (x, y, start_x, start_y,
+				     end_x, end_y))
+					continue;
+
+				paint_box (style, widget->window,
+					GTK_STATE_SELECTED, GTK_SHADOW_IN,
+					&event->area, widget, priv->style_hint,
+					x * col_width, y * row_height,
+					col_width, row_height);
+			}
+		}
+	}
+	
+	if (priv->highlighted_time &&
+	    (priv->highlighted_time_x >= 0) &&
+	    (priv->highlighted_time_x < priv->visible_days) &&
+	    (priv->highlighted_time_y >= 0) &&
+	    (priv->highlighted_time_y < priv->cells)) {
+		/* Draw time line */
+		gtk_paint_hline (style, widget->window,
+			GTK_STATE_SELECTED,
+			&event->area, widget,
+			priv->style_hint,
+			priv->highlighted_time_x * col_width,
+			(priv->highlighted_time_x + 1) * col_width,
+			(gdouble)row_height *
+			(gdouble)priv->cells *
+			priv->highlighted_time_pos);
+	}
+	gtk_style_detach (style);
 
-	/* Draw headers */
+	return FALSE;
+}
+
+static void
+paint_day_headers (JanaGtkDayView *self, GtkWidget *widget,
+		   GdkDrawable *drawable, gint col_width, gint height)
+{
+	gint x, box_x, text_width, text_height;
+	GtkStyle *dark_style;
+
+	JanaGtkDayViewPrivate *priv = DAY_VIEW_PRIVATE (self);
+	
 	/* Create darker style */
-	dark_style = gtk_style_copy (widget->style);
-	dark_style->bg[GTK_STATE_NORMAL] = dark_style->bg[GTK_STATE_ACTIVE];
-	dark_style->fg[GTK_STATE_NORMAL] = dark_style->fg[GTK_STATE_ACTIVE];
-	dark_style = gtk_style_attach (dark_style, widget->window);
+	dark_style = create_dark_style (widget);
 
 	/* Week/day headers */
 	for (x = 0, box_x = 0; x < priv->visible_days; x++) {
 		PangoLayout *layout = priv->day_layouts[x];
 		pango_layout_get_pixel_size (layout, &text_width, &text_height);
 
-		paint_box (dark_style, widget->window,
+		paint_box (dark_style, (GdkWindow *)drawable,
 			GTK_STATE_NORMAL, GTK_SHADOW_OUT,
-			&event->area, widget, priv->style_hint,
-			box_x, 0,
-			col_width, priv->layout24hr->allocation.height);
+			NULL, widget, priv->style_hint,
+			box_x, 0, col_width, height);
 
-		gtk_paint_layout (dark_style, widget->window,
-			GTK_STATE_NORMAL, FALSE, &event->area,
+		gtk_paint_layout (dark_style, (GdkWindow *)drawable,
+			GTK_STATE_NORMAL, FALSE, NULL,
 			widget, priv->style_hint,
 			box_x + (col_width / 2) - (text_width / 2),
 			(priv->row0_height / 2) - (text_height / 2),
@@ -608,54 +783,56 @@ layout24hr_expose_event_cb (GtkWidget *widget, GdkEventExpose *event,
 		box_x += col_width;
 	}
 	gtk_style_detach (dark_style);
-	
-	return FALSE;
 }
 
 static gboolean
-jana_gtk_day_view_expose_event (GtkWidget *widget, GdkEventExpose *event)
+layout24hr_expose_event_cb (GtkWidget *widget, GdkEventExpose *event,
+			JanaGtkDayView *self)
 {
-	gint y, box_y, row_height, col_width,
-		row_offset, text_width, text_height;
-	GtkAdjustment *adjustment;
-	GtkStyle *dark_style;
+	gint col_width;
 
-	JanaGtkDayViewPrivate *priv = DAY_VIEW_PRIVATE (widget);
+	JanaGtkDayViewPrivate *priv = DAY_VIEW_PRIVATE (self);
 	
 	if ((!jana_duration_valid (priv->range)) || (priv->cells == 0))
 		return FALSE;
 	
-	row_height = priv->layout->allocation.height / priv->cells;
 	col_width = priv->layout->allocation.width / priv->visible_days;
 
 	/* Draw headers */
-	/* Create darker style */
-	dark_style = gtk_style_copy (widget->style);
-	dark_style->bg[GTK_STATE_NORMAL] = dark_style->bg[GTK_STATE_ACTIVE];
-	dark_style->fg[GTK_STATE_NORMAL] = dark_style->fg[GTK_STATE_ACTIVE];
-	dark_style = gtk_style_attach (dark_style, widget->window);
+	if (get_background (&priv->days_background, widget,
+	    col_width * priv->visible_days,
+	    priv->layout24hr->allocation.height))
+		paint_day_headers (self, widget, priv->days_background,
+			col_width, priv->layout24hr->allocation.height);
+	draw_background (widget, priv->days_background, &event->area, 0, 0);
+	
+	return FALSE;
+}
 
-	/* Calculate header offsets */
-	adjustment = gtk_viewport_get_vadjustment (
-		GTK_VIEWPORT (priv->viewport));
-	row_offset = (gint)(((adjustment->value - adjustment->lower) /
-		(adjustment->upper - adjustment->lower)) *
-		(gdouble)priv->layout->allocation.height);
+static void
+paint_time_headers (JanaGtkDayView *self, GtkWidget *widget,
+		    GdkDrawable *drawable, gint row_height)
+{
+	gint y, box_y, text_width, text_height;
+	GtkStyle *dark_style;
+
+	JanaGtkDayViewPrivate *priv = DAY_VIEW_PRIVATE (self);
+	
+	/* Create darker style */
+	dark_style = create_dark_style (widget);
 
 	/* Time headers */
-	box_y = priv->layout24hr->allocation.height - row_offset;
-	for (y = 0; y < priv->cells; y++) {
+	for (y = 0, box_y = 0; y < priv->cells; y++) {
 		PangoLayout *layout = priv->time_layouts[y];
 		pango_layout_get_pixel_size (layout, &text_width, &text_height);
 
-		paint_box (dark_style, widget->window,
+		paint_box (dark_style, (GdkWindow *)drawable,
 			GTK_STATE_NORMAL, GTK_SHADOW_OUT,
-			&event->area, widget, priv->style_hint,
-			0, box_y,
-			priv->col0_width, row_height);
+			NULL, widget, priv->style_hint,
+			0, box_y, priv->col0_width, row_height);
 
-		gtk_paint_layout (dark_style, widget->window,
-			GTK_STATE_NORMAL, FALSE, &event->area,
+		gtk_paint_layout (dark_style, (GdkWindow *)drawable,
+			GTK_STATE_NORMAL, FALSE, NULL,
 			widget, priv->style_hint,
 			(priv->col0_width / 2) - (text_width / 2),
 			box_y + (row_height / 2) - (text_height / 2),
@@ -663,6 +840,36 @@ jana_gtk_day_view_expose_event (GtkWidget *widget, GdkEventExpose *event)
 		
 		box_y += row_height;
 	}
+	gtk_style_detach (dark_style);
+}
+
+static gboolean
+jana_gtk_day_view_expose_event (GtkWidget *widget, GdkEventExpose *event)
+{
+	gint row_height, row_offset, text_width, text_height;
+	GtkAdjustment *adjustment;
+
+	JanaGtkDayViewPrivate *priv = DAY_VIEW_PRIVATE (widget);
+	
+	if ((!jana_duration_valid (priv->range)) || (priv->cells == 0))
+		return FALSE;
+	
+	row_height = priv->layout->allocation.height / priv->cells;
+
+	/* Calculate header offsets */
+	adjustment = gtk_viewport_get_vadjustment (
+		GTK_VIEWPORT (priv->viewport));
+	row_offset = (gint)(((adjustment->value - adjustment->lower) /
+		(adjustment->upper - adjustment->lower)) *
+		(gdouble)priv->layout->allocation.height);
+
+	/* Time headers, scrolling only moves them */
+	if (get_background (&priv->times_background, widget,
+	    priv->col0_width, row_height * priv->cells))
+		paint_time_headers (JANA_GTK_DAY_VIEW (widget), widget,
+			priv->times_background, row_height);
+	draw_background (widget, priv->times_background, &event->area,
+		0, priv->layout24hr->allocation.height - row_offset);
 	
 	/* Week */
 	paint_box (widget->style, widget->window,
@@ -680,11 +887,242 @@ jana_gtk_day_view_expose_event (GtkWidget *widget, GdkEventExpose *event)
 		(priv->row0_height / 2) - (text_height / 2),
 		priv->week_layout);
 
-	gtk_style_detach (dark_style);
-	
 	return FALSE;
 }
 
+static void
+add_event_cell (JanaGtkTreeLayout *layout, GtkTreeRowReference *row,
+		GtkCellRenderer *renderer)
+{
+	jana_gtk_tree_layout_add_cell (layout,
+		row, 0, 0, 0, 0, renderer,
+		"uid", JANA_GTK_EVENT_STORE_COL_UID,
+		"categories", JANA_GTK_EVENT_STORE_COL_CATEGORIES,
+		"summary", JANA_GTK_EVENT_STORE_COL_SUMMARY,
+		"location", JANA_GTK_EVENT_STORE_COL_LOCATION,
+		"description", JANA_GTK_EVENT_STORE_COL_DESCRIPTION,
+		"start", JANA_GTK_EVENT_STORE_COL_START,
+		"end", JANA_GTK_EVENT_STORE_COL_END,
+		"first_instance", JANA_GTK_EVENT_STORE_COL_FIRST_INSTANCE,
+		"last_instance", JANA_GTK_EVENT_STORE_COL_LAST_INSTANCE,
+		"has_recurrences", JANA_GTK_EVENT_STORE_COL_HAS_RECURRENCES,
+		"has_alarm", JANA_GTK_EVENT_STORE_COL_HAS_ALARM,
+		NULL);
+}
+
+/* Returns the area of the event layout that's scrolled into view. */
+static void
+get_visible_area (JanaGtkDayView *self, GdkRectangle *area)
+{
+	GtkAdjustment *adjustment;
+	JanaGtkDayViewPrivate *priv = DAY_VIEW_PRIVATE (self);
+	
+	area->x = 0;
+	area->y = 0;
+	area->width = priv->layout->allocation.width;
+	area->height = priv->layout->allocation.height;
+	
+	adjustment = gtk_viewport_get_hadjustment (
+		GTK_VIEWPORT (priv->viewport));
+	if (adjustment && (adjustment->upper > adjustment->lower)) {
+		area->x = (gint)(((adjustment->value - adjustment->lower) /
+			(adjustment->upper - adjustment->lower)) *
+			(gdouble)priv->layout->allocation.width);
+		area->width = (gint)((adjustment->page_size /
+			(adjustment->upper - adjustment->lower)) *
+			(gdouble)priv->layout->allocation.width);
+	}
+	
+	adjustment = gtk_viewport_get_vadjustment (
+		GTK_VIEWPORT (priv->viewport));
+	if (adjustment && (adjustment->upper > adjustment->lower)) {
+		area->y = (gint)(((adjustment->value - adjustment->lower) /
+			(adjustment->upper - adjustment->lower)) *
+			(gdouble)priv->layout->allocation.height);
+		area->height = (gint)((adjustment->page_size /
+			(adjustment->upper - adjustment->lower)) *
+			(gdouble)priv->layout->allocation.height);
+	}
+}
+
+/* Works out the column and vertical extent of a timed event, with the
+ * same arithmetic relayout() uses to place it.
+ */
+static gboolean
+get_event_extents (JanaGtkDayView *self, JanaTime *start, JanaTime *end,
+		   GDate *first_day, gint *day, gint *y1, gint *y2)
+{
+	GDate *date;
+	gint min_time, max_time, alloc_height, minutes;
+	gfloat min_per_pixel;
+	JanaGtkDayViewPrivate *priv = DAY_VIEW_PRIVATE (self);
+	
+	if (!start) return FALSE;
+	
+	date = jana_utils_time_to_gdate (start);
+	*day = g_date_days_between (first_day, date);
+	g_date_free (date);
+	
+	min_time = (jana_time_get_hours (priv->range->start) * 60) +
+		jana_time_get_minutes (priv->range->start);
+	max_time = ((jana_time_get_hours (priv->range->end) ?
+		     jana_time_get_hours (priv->range->end) : 24) * 60) +
+		jana_time_get_minutes (priv->range->end);
+	alloc_height = priv->layout->allocation.height -
+		(priv->layout->allocation.height % priv->cells);
+	min_per_pixel = (gfloat)alloc_height / (gfloat)(max_time - min_time);
+	
+	minutes = (jana_time_get_hours (start) * 60) +
+		jana_time_get_minutes (start);
+	*y1 = min_per_pixel * (minutes - min_time);
+	if (end) {
+		minutes = (((jana_time_get_hours (end) ||
+			jana_time_get_minutes (end)) ?
+			    jana_time_get_hours (end) : 24) * 60) +
+			jana_time_get_minutes (end);
+	} else
+		minutes += 30;
+	*y2 = min_per_pixel * (minutes - min_time);
+	
+	return TRUE;
+}
+
+static VirtualRow *
+virtual_row_lookup (JanaGtkDayView *self, GtkTreeModel *model,
+		    GtkTreePath *path)
+{
+	GPtrArray *rows;
+	guint row = gtk_tree_path_get_indices (path)[0];
+	JanaGtkDayViewPrivate *priv = DAY_VIEW_PRIVATE (self);
+	
+	if (!(rows = g_hash_table_lookup (priv->virtual_rows, model)))
+		return NULL;
+	
+	return (row < rows->len) ? g_ptr_array_index (rows, row) : NULL;
+}
+
+/* Makes @path a virtual row, or refreshes the times of the virtual row
+ * that's already there.
+ */
+static void
+virtual_row_set (JanaGtkDayView *self, GtkTreeModel *model,
+		 GtkTreePath *path, JanaTime *start, JanaTime *end)
+{
+	GPtrArray *rows;
+	VirtualRow *vrow;
+	guint row = gtk_tree_path_get_indices (path)[0];
+	JanaGtkDayViewPrivate *priv = DAY_VIEW_PRIVATE (self);
+	
+	if (!(rows = g_hash_table_lookup (priv->virtual_rows, model))) {
+		rows = g_ptr_array_new ();
+		g_hash_table_insert (priv->virtual_rows, model, rows);
+	}
+	if (row >= rows->len) g_ptr_array_set_size (rows, row + 1);
+	
+	if (!(vrow = g_ptr_array_index (rows, row))) {
+		vrow = g_slice_new0 (VirtualRow);
+		vrow->row = gtk_tree_row_reference_new (model, path);
+		g_ptr_array_index (rows, row) = vrow;
+	}
+	
+	if (start) g_object_ref (start);
+	if (end) g_object_ref (end);
+	if (vrow->start) g_object_unref (vrow->start);
+	if (vrow->end) g_object_unref (vrow->end);
+	vrow->start = start;
+	vrow->end = end;
+}
+
+static void
+virtual_row_unset (JanaGtkDayView *self, GtkTreeModel *model,
+		   GtkTreePath *path)
+{
+	GPtrArray *rows;
+	VirtualRow *vrow;
+	guint row = gtk_tree_path_get_indices (path)[0];
+	JanaGtkDayViewPrivate *priv = DAY_VIEW_PRIVATE (self);
+	
+	if (!(rows = g_hash_table_lookup (priv->virtual_rows, model))) return;
+	if ((row >= rows->len) || (!(vrow = g_ptr_array_index (rows, row))))
+		return;
+	
+	virtual_row_free (vrow);
+	g_ptr_array_index (rows, row) = NULL;
+}
+
+/* Gives the virtual rows of a store that intersect the virtual window a
+ * cell, and takes it from those that don't. The cell of the selected
+ * event is kept regardless, so that scrolling away doesn't deselect it.
+ */
+static void
+virtual_sync_rows (GtkTreeModel *model, GPtrArray *rows,
+		   JanaGtkDayView *self)
+{
+	guint i;
+	GDate *first_day;
+	GdkRectangle *window;
+	gint cell_width, first_col, last_col;
+	JanaGtkTreeLayout *layout;
+	JanaGtkDayViewPrivate *priv = DAY_VIEW_PRIVATE (self);
+	
+	layout = JANA_GTK_TREE_LAYOUT (priv->layout);
+	cell_width = priv->layout->allocation.width / priv->visible_days;
+	window = &priv->virtual_window;
+	first_col = window->x / cell_width;
+	last_col = (window->x + window->width) / cell_width;
+	first_day = jana_utils_time_to_gdate (priv->range->start);
+	
+	for (i = 0; i < rows->len; i++) {
+		VirtualRow *vrow = (VirtualRow *)g_ptr_array_index (rows, i);
+		gint day, y1, y2;
+		gboolean wanted;
+		
+		if (!vrow) continue;
+		
+		wanted = get_event_extents (self, vrow->start, vrow->end,
+			first_day, &day, &y1, &y2) &&
+			(day >= 0) && (day < priv->visible_days) &&
+			(day >= first_col) && (day <= last_col) &&
+			(y2 > window->y) &&
+			(y1 < window->y + window->height);
+		
+		if (jana_gtk_tree_layout_get_cell (layout, vrow->row)) {
+			if ((!wanted) && (!(priv->selected_event &&
+			     compare_selection (self, vrow->row))))
+				jana_gtk_tree_layout_remove_cell (
+					layout, vrow->row);
+		} else if (wanted)
+			add_event_cell (layout, vrow->row,
+				priv->event_renderer);
+	}
+	
+	g_date_free (first_day);
+}
+
+/* In virtual mode, the event layout only has cells for the events that
+ * intersect the scrolled window, padded by a page on each side so that
+ * small scrolls don't need a relayout. Cells leaving the window are
+ * returned to the pool of virtual rows.
+ */
+static void
+virtual_sync (JanaGtkDayView *self)
+{
+	GdkRectangle *window;
+	JanaGtkDayViewPrivate *priv = DAY_VIEW_PRIVATE (self);
+	
+	if (priv->layout->allocation.width / priv->visible_days <= 0) return;
+	
+	window = &priv->virtual_window;
+	get_visible_area (self, window);
+	window->x -= window->width;
+	window->y -= window->height;
+	window->width *= 3;
+	window->height *= 3;
+	
+	g_hash_table_foreach (priv->virtual_rows,
+		(GHFunc)virtual_sync_rows, self);
+}
+
 static void
 relayout (JanaGtkDayView *self)
 {
@@ -698,6 +1136,8 @@ relayout (JanaGtkDayView *self)
 	
 	if ((!jana_duration_valid (priv->range)) || (priv->cells == 0))
 		return;
+	
+	if (priv->virtualise) virtual_sync (self);
 
 	cell_width = priv->layout->allocation.width / priv->visible_days;
 	min_time = (jana_time_get_hours (priv->range->start) * 60) +
@@ -1133,6 +1573,22 @@ adjustment_changed_cb (GtkAdjustment *adjustment, JanaGtkDayView *self)
 
 	gdk_window_invalidate_rect (GTK_WIDGET (self)->window, &rect, FALSE);
 	gdk_window_process_updates (GTK_WIDGET (self)->window, FALSE);
+	
+	if (priv->virtualise) {
+		GdkRectangle area;
+		
+		/* Only re-sync the cells when the visible area leaves the
+		 * padded window they were created for.
+		 */
+		get_visible_area (self, &area);
+		if ((area.x < priv->virtual_window.x) ||
+		    (area.y < priv->virtual_window.y) ||
+		    (area.x + area.width > priv->virtual_window.x +
+		     priv->virtual_window.width) ||
+		    (area.y + area.height > priv->virtual_window.y +
+		     priv->virtual_window.height))
+			relayout (self);
+	}
 }
 
 static void
@@ -1349,6 +1805,16 @@ jana_gtk_day_view_class_init (JanaGtkDayViewClass *klass)
 			JANA_TYPE_DURATION,
 			G_PARAM_READWRITE));
 
+	g_object_class_install_property (
+		object_class,
+		PROP_VIRTUALISE,
+		g_param_spec_boolean (
+			"virtualise",
+			"Virtualise",
+			"Only create cells for events in the scrolled window.",
+			FALSE,
+			G_PARAM_READWRITE));
+
 	signals[SELECTION_CHANGED] =
 		g_signal_new ("selection_changed",
 			G_OBJECT_CLASS_TYPE (object_class),
@@ -1626,6 +2092,9 @@ jana_gtk_day_view_init (JanaGtkDayView *self)
 	priv->xratio = 1.0;
 	priv->yratio = 1.0;
 	
+	priv->virtual_rows = g_hash_table_new_full (NULL, NULL, NULL,
+		(GDestroyNotify)virtual_rows_free);
+	
 	priv->vbox = gtk_vbox_new (FALSE, 0);
 	
 	priv->alignment = gtk_alignment_new (0.5, 0.5, 1, 1);
@@ -1776,30 +2245,35 @@ row_changed_cb (GtkTreeModel *tree_model, GtkTreePath *path,
 		renderer = priv->event_renderer;
 	}
 	
-	if (start) g_object_unref (start);
-	if (end) g_object_unref (end);
-	
 	row = gtk_tree_row_reference_new (tree_model, path);
 
-	if (!jana_gtk_tree_layout_get_cell (layout, row)) {
+	if (priv->virtualise) {
+		/* Timed events are kept as virtual rows, relayout() gives
+		 * them a cell if they're in view.
+		 */
+		if (layout == (JanaGtkTreeLayout *)priv->layout) {
+			jana_gtk_tree_layout_remove_cell (old_layout, row);
+			virtual_row_set (self, tree_model, path, start, end);
+		} else {
+			if (virtual_row_lookup (self, tree_model, path)) {
+				jana_gtk_tree_layout_remove_cell (
+					old_layout, row);
+				virtual_row_unset (self, tree_model, path);
+			}
+			if (!jana_gtk_tree_layout_get_cell (layout, row))
+				add_event_cell (layout, row, renderer);
+		}
+	} else if (!jana_gtk_tree_layout_get_cell (layout, row)) {
 		jana_gtk_tree_layout_remove_cell (old_layout, row);
-		jana_gtk_tree_layout_add_cell (layout,
-			row, 0, 0, 0, 0, renderer,
-			"uid", JANA_GTK_EVENT_STORE_COL_UID,
-			"categories", JANA_GTK_EVENT_STORE_COL_CATEGORIES,
-			"summary", JANA_GTK_EVENT_STORE_COL_SUMMARY,
-			"description", JANA_GTK_EVENT_STORE_COL_DESCRIPTION,
-			"start", JANA_GTK_EVENT_STORE_COL_START,
-			"end", JANA_GTK_EVENT_STORE_COL_END,
-			"first_instance", JANA_GTK_EVENT_STORE_COL_FIRST_INSTANCE,
-			"last_instance", JANA_GTK_EVENT_STORE_COL_LAST_INSTANCE,
-			"has_recurrences", JANA_GTK_EVENT_STORE_COL_HAS_RECURRENCES,
-			"has_alarm", JANA_GTK_EVENT_STORE_COL_HAS_ALARM,
-			NULL);
+		add_event_cell (layout, row, renderer);
 	}
 	
+	if (start) g_object_unref (start);
+	if (end) g_object_unref (end);
+	
 	gtk_tree_row_reference_free (row);
-	relayout (self);
+	jana_gtk_utils_queue_update (self,
+		(JanaGtkUtilsUpdateFunc)relayout);
 }
 
 static void
@@ -1811,6 +2285,7 @@ row_inserted_cb (GtkTreeModel *tree_model, GtkTreePath *path,
 	JanaTime *start, *end;
 	GtkTreeRowReference *row;
 	GtkCellRenderer *renderer;
+	GPtrArray *rows;
 	JanaGtkDayViewPrivate *priv = DAY_VIEW_PRIVATE (self);
 
 	gtk_tree_model_get (tree_model, iter,
@@ -1834,36 +2309,64 @@ row_inserted_cb (GtkTreeModel *tree_model, GtkTreePath *path,
 		renderer = priv->event_renderer;
 	}
 	
+	/* Make room in the virtual rows of the store */
+	if ((rows = g_hash_table_lookup (priv->virtual_rows, tree_model))) {
+		guint n = gtk_tree_path_get_indices (path)[0];
+		if (n < rows->len) {
+			g_ptr_array_add (rows, NULL);
+			g_memmove (&rows->pdata[n + 1], &rows->pdata[n],
+				(rows->len - n - 1) * sizeof (gpointer));
+			rows->pdata[n] = NULL;
+		}
+	}
+	
+	/* Add row to layout */
+	if (priv->virtualise && (layout == (JanaGtkTreeLayout *)priv->layout))
+		virtual_row_set (self, tree_model, path, start, end);
+	else {
+		row = gtk_tree_row_reference_new (tree_model, path);
+		add_event_cell (layout, row, renderer);
+		gtk_tree_row_reference_free (row);
+	}
+	
 	if (start) g_object_unref (start);
 	if (end) g_object_unref (end);
 	
-	/* Add row to layout */
-	row = gtk_tree_row_reference_new (tree_model, path);
+	jana_gtk_utils_queue_update (self,
+		(JanaGtkUtilsUpdateFunc)relayout);
+}
+
+static void
+rows_reordered_cb (GtkTreeModel *tree_model, GtkTreePath *path,
+		   GtkTreeIter *iter, gint *new_order, JanaGtkDayView *self)
+{
+	gint i, n_rows;
+	GPtrArray *rows, *old_rows;
+	JanaGtkDayViewPrivate *priv = DAY_VIEW_PRIVATE (self);
 	
-	jana_gtk_tree_layout_add_cell (layout,
-		row, 0, 0, 0, 0, renderer,
-		"uid", JANA_GTK_EVENT_STORE_COL_UID,
-		"categories", JANA_GTK_EVENT_STORE_COL_CATEGORIES,
-		"summary", JANA_GTK_EVENT_STORE_COL_SUMMARY,
-		"location", JANA_GTK_EVENT_STORE_COL_LOCATION,
-		"description", JANA_GTK_EVENT_STORE_COL_DESCRIPTION,
-		"start", JANA_GTK_EVENT_STORE_COL_START,
-		"end", JANA_GTK_EVENT_STORE_COL_END,
-		"first_instance", JANA_GTK_EVENT_STORE_COL_FIRST_INSTANCE,
-		"last_instance", JANA_GTK_EVENT_STORE_COL_LAST_INSTANCE,
-		"has_recurrences", JANA_GTK_EVENT_STORE_COL_HAS_RECURRENCES,
-		"has_alarm", JANA_GTK_EVENT_STORE_COL_HAS_ALARM,
-		NULL);
+	if (!(old_rows = g_hash_table_lookup (priv->virtual_rows, tree_model)))
+		return;
 	
-	gtk_tree_row_reference_free (row);
+	/* new_order maps new positions to old ones */
+	n_rows = gtk_tree_model_iter_n_children (tree_model, NULL);
+	rows = g_ptr_array_sized_new (n_rows);
+	for (i = 0; i < n_rows; i++) {
+		guint row = new_order[i];
+		g_ptr_array_add (rows, (row < old_rows->len) ?
+			g_ptr_array_index (old_rows, row) : NULL);
+	}
 	
-	relayout (self);
+	/* Steal the array, so that the rows it holds aren't freed */
+	g_hash_table_steal (priv->virtual_rows, tree_model);
+	g_ptr_array_free (old_rows, TRUE);
+	g_hash_table_insert (priv->virtual_rows, tree_model, rows);
 }
 
 static void
 row_deleted_cb (GtkTreeModel *tree_model, GtkTreePath *path,
 		JanaGtkDayView *self)
 {
+	GPtrArray *rows;
 	JanaGtkDayViewPrivate *priv = DAY_VIEW_PRIVATE (self);
 
 	if (priv->selected_event &&
@@ -1873,7 +2376,17 @@ row_deleted_cb (GtkTreeModel *tree_model, GtkTreePath *path,
 		g_signal_emit (self, signals[EVENT_SELECTED], 0, NULL);
 	}
 	
-	relayout (self);
+	/* Close the gap left in the virtual rows of the store */
+	if ((rows = g_hash_table_lookup (priv->virtual_rows, tree_model))) {
+		guint n = gtk_tree_path_get_indices (path)[0];
+		if (n < rows->len) {
+			VirtualRow *vrow = g_ptr_array_remove_index (rows, n);
+			if (vrow) virtual_row_free (vrow);
+		}
+	}
+	
+	jana_gtk_utils_queue_update (self,
+		(JanaGtkUtilsUpdateFunc)relayout);
 }
 
 static void
@@ -1902,10 +2415,13 @@ remove_rows (JanaGtkDayView *self, JanaGtkEventStore *store)
 		if (gtk_tree_row_reference_get_model (info->row) ==
 		    (GtkTreeModel *)store)
 			jana_gtk_tree_layout_remove_cell (
-				(JanaGtkTreeLayout *)self, info->row);
+				JANA_GTK_TREE_LAYOUT (priv->layout),
+				info->row);
 	}
 	
 	g_list_free (cells);
+	
+	g_hash_table_remove (priv->virtual_rows, store);
 }
 
 /**
@@ -1927,6 +2443,8 @@ jana_gtk_day_view_add_store (JanaGtkDayView *self, JanaGtkEventStore *store)
 		G_CALLBACK (row_changed_cb), self);
 	g_signal_connect_after (store, "row-deleted",
 		G_CALLBACK (row_deleted_cb), self);
+	g_signal_connect (store, "rows-reordered",
+		G_CALLBACK (rows_reordered_cb), self);
 }
 
 /**
@@ -1943,6 +2461,7 @@ jana_gtk_day_view_remove_store (JanaGtkDayView *self,
 	g_signal_handlers_disconnect_by_func (store, row_inserted_cb, self);
 	g_signal_handlers_disconnect_by_func (store, row_changed_cb, self);
 	g_signal_handlers_disconnect_by_func (store, row_deleted_cb, self);
+	g_signal_handlers_disconnect_by_func (store, rows_reordered_cb, self);
 	
 	remove_rows (self, store);
 }
@@ -2401,6 +2920,17 @@ jana_gtk_day_view_set_selected_event (JanaGtkDayView *self,
 		JANA_GTK_TREE_LAYOUT (priv->layout24hr), NULL);
 }
 
+/**
+ * jana_gtk_day_view_set_visible_func:
+ * @self: A #JanaGtkDayView
+ * @visible_cb: A function deciding whether an event row is visible, or %NULL
+ * @data: User data to pass to @visible_cb
+ *
+ * Sets a function to filter the events shown on the view. @visible_cb is
+ * called for every row, so filters on category should test the row with
+ * jana_gtk_utils_model_has_category() rather than comparing the row's
+ * category names.
+ */
 void
 jana_gtk_day_view_set_visible_func (JanaGtkDayView *self,
 				    GtkTreeModelFilterVisibleFunc visible_cb,
@@ -2423,6 +2953,27 @@ jana_gtk_day_view_refilter (JanaGtkDayView *self)
 	jana_gtk_tree_layout_refilter (JANA_GTK_TREE_LAYOUT (priv->layout24hr));
 }
 
+static gboolean
+day_view_has_category_cb (GtkTreeModel *model, GtkTreeIter *iter,
+			  gpointer data)
+{
+	return jana_gtk_utils_model_has_category (model, iter,
+		JANA_GTK_EVENT_STORE_COL_CATEGORY_MASK,
+		JANA_GTK_EVENT_STORE_COL_CATEGORIES, GPOINTER_TO_UINT (data));
+}
+
+void
+jana_gtk_day_view_refilter_category (JanaGtkDayView *self, guint atom)
+{
+	JanaGtkDayViewPrivate *priv = DAY_VIEW_PRIVATE (self);
+	
+	jana_gtk_tree_layout_refilter_rows (JANA_GTK_TREE_LAYOUT (priv->layout),
+		day_view_has_category_cb, GUINT_TO_POINTER (atom));
+	jana_gtk_tree_layout_refilter_rows (
+		JANA_GTK_TREE_LAYOUT (priv->layout24hr),
+		day_view_has_category_cb, GUINT_TO_POINTER (atom));
+}
+
 void
 jana_gtk_day_view_set_highlighted_time (JanaGtkDayView *self, JanaTime *time)
 {
@@ -2460,5 +3011,100 @@ jana_gtk_day_view_set_active_range (JanaGtkDayView *self, JanaDuration *range)
 		}
 	}
 
+	if (priv->grid_background) {
+		g_object_unref (priv->grid_background);
+		priv->grid_background = NULL;
+	}
 	gtk_widget_queue_draw (priv->layout);
 }
+
+static gboolean
+unvirtualise_rows_cb (GtkTreeModel *model, GPtrArray *rows,
+		      JanaGtkDayView *self)
+{
+	guint i;
+	JanaGtkDayViewPrivate *priv = DAY_VIEW_PRIVATE (self);
+	
+	for (i = 0; i < rows->len; i++) {
+		VirtualRow *vrow = (VirtualRow *)g_ptr_array_index (rows, i);
+		
+		if (vrow && (!jana_gtk_tree_layout_get_cell (
+		     JANA_GTK_TREE_LAYOUT (priv->layout), vrow->row)))
+			add_event_cell (JANA_GTK_TREE_LAYOUT (priv->layout),
+				vrow->row, priv->event_renderer);
+	}
+	
+	/* The rows are freed along with the array */
+	return TRUE;
+}
+
+/**
+ * jana_gtk_day_view_set_virtualise:
+ * @self: A #JanaGtkDayView
+ * @virtualise: %TRUE to only create cells for events in view
+ *
+ * Sets whether the day view should only create cells for the timed events
+ * that intersect the visible days and the scrolled hour window. Other
+ * events are kept as rows and get a cell as they're scrolled into view.
+ * This makes long or dense ranges much cheaper to lay out, at the cost of
+ * some work when scrolling far. All-day events are not virtualised.
+ */
+void
+jana_gtk_day_view_set_virtualise (JanaGtkDayView *self, gboolean virtualise)
+{
+	GList *c, *cells;
+	JanaGtkDayViewPrivate *priv = DAY_VIEW_PRIVATE (self);
+	
+	if (priv->virtualise == virtualise) return;
+	priv->virtualise = virtualise;
+	
+	if (virtualise) {
+		/* Cells out of view get dropped on the next relayout */
+		cells = jana_gtk_tree_layout_get_cells (
+			JANA_GTK_TREE_LAYOUT (priv->layout));
+		for (c = cells; c; c = c->next) {
+			JanaGtkTreeLayoutCellInfo *info =
+				(JanaGtkTreeLayoutCellInfo *)c->data;
+			GtkTreeModel *model;
+			GtkTreePath *path;
+			GtkTreeIter iter;
+			JanaTime *start, *end;
+			
+			model = gtk_tree_row_reference_get_model (info->row);
+			path = gtk_tree_row_reference_get_path (info->row);
+			gtk_tree_model_get_iter (model, &iter, path);
+			gtk_tree_model_get (model, &iter,
+				JANA_GTK_EVENT_STORE_COL_START, &start,
+				JANA_GTK_EVENT_STORE_COL_END, &end, -1);
+			
+			virtual_row_set (self, model, path, start, end);
+			
+			if (start) g_object_unref (start);
+			if (end) g_object_unref (end);
+			gtk_tree_path_free (path);
+		}
+		g_list_free (cells);
+	} else {
+		g_hash_table_foreach_remove (priv->virtual_rows,
+			(GHRFunc)unvirtualise_rows_cb, self);
+	}
+	
+	relayout (self);
+}
+
+/**
+ * jana_gtk_day_view_get_virtualise:
+ * @self: A #JanaGtkDayView
+ *
+ * Gets whether the day view only creates cells for events in view. See
+ * jana_gtk_day_view_set_virtualise().
+ *
+ * Returns: %TRUE if the day view is virtualised
+ */
+gboolean
+jana_gtk_day_view_get_virtualise (JanaGtkDayView *self)
+{
+	JanaGtkDayViewPrivate *priv = DAY_VIEW_PRIVATE (self);
+	
+	return priv->virtualise;
+}
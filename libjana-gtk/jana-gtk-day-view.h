@@ -135,6 +135,8 @@ void	jana_gtk_day_view_set_visible_func	(JanaGtkDayView *self,
 						 gpointer data);
 
 void	jana_gtk_day_view_refilter		(JanaGtkDayView *self);
+void	jana_gtk_day_view_refilter_category	(JanaGtkDayView *self,
+						 guint atom);
 
 void	jana_gtk_day_view_set_highlighted_time	(JanaGtkDayView *self,
 						 JanaTime *time);
@@ -142,6 +144,11 @@ void	jana_gtk_day_view_set_highlighted_time	(JanaGtkDayView *self,
 void	jana_gtk_day_view_set_active_range	(JanaGtkDayView *self,
 						 JanaDuration *range);
 
+void	jana_gtk_day_view_set_virtualise	(JanaGtkDayView *self,
+						 gboolean virtualise);
+
+gboolean jana_gtk_day_view_get_virtualise	(JanaGtkDayView *self);
+
 G_END_DECLS
 
 #endif /* _JANA_GTK_DAY_VIEW_H */
@@ -23,6 +23,7 @@
 #include <libjana/jana-utils.h>
 #include "jana-gtk-event-list.h"
 #include "jana-gtk-cell-renderer-event.h"
+#include "jana-gtk-utils.h"
 
 G_DEFINE_TYPE (JanaGtkEventList, jana_gtk_event_list, GTK_TYPE_TREE_VIEW)
 
@@ -40,6 +41,7 @@ struct _JanaGtkEventListPrivate
 	GtkCellRenderer *event_renderer;
 	GtkCellRenderer *text_renderer;
 	gboolean show_headers;
+	gboolean resort;
 };
 
 enum {
@@ -208,6 +210,35 @@ recalculate_headers (JanaGtkEventList *self)
 	if (day) g_object_unref (day);
 }
 
+/* Run before the next redraw, so a burst of row signals only sorts and
+ * recalculates headers once.
+ */
+static void
+update_list (JanaGtkEventList *self)
+{
+	JanaGtkEventListPrivate *priv = EVENT_LIST_PRIVATE (self);
+	
+	if (priv->resort) {
+		priv->resort = FALSE;
+		
+		/* Re-sort */
+		/* http://bugzilla.gnome.org/show_bug.cgi?id=316152 */
+		gtk_tree_sortable_set_sort_func (
+			GTK_TREE_SORTABLE (priv->model),
+			JANA_GTK_EVENT_LIST_COL_ROW,
+			jana_gtk_event_list_compare, self, NULL);
+
+		/* Re-filter */
+		/* Note, this isn't really necessary as recalculating headers
+		 * will trigger a re-filter, but that may change...
+		*/
+		gtk_tree_model_filter_refilter ((GtkTreeModelFilter *)
+			gtk_tree_view_get_model (GTK_TREE_VIEW (self)));
+	}
+	
+	recalculate_headers (self);
+}
+
 static void
 row_deleted_cb (GtkTreeModel *tree_model, GtkTreePath *path,
 		JanaGtkEventList *self)
@@ -246,7 +277,7 @@ row_deleted_cb (GtkTreeModel *tree_model, GtkTreePath *path,
 	} while (skip || gtk_tree_model_iter_next (
 		 (GtkTreeModel *)priv->model, &iter));
 
-	recalculate_headers (self);
+	jana_gtk_utils_queue_update (self, (JanaGtkUtilsUpdateFunc)update_list);
 }
 
 static void
@@ -255,20 +286,8 @@ row_changed_cb (GtkTreeModel *tree_model, GtkTreePath *path,
 {
 	JanaGtkEventListPrivate *priv = EVENT_LIST_PRIVATE (self);
 	
-	/* Re-sort */
-	/* http://bugzilla.gnome.org/show_bug.cgi?id=316152 */
-	gtk_tree_sortable_set_sort_func (GTK_TREE_SORTABLE (priv->model),
-		JANA_GTK_EVENT_LIST_COL_ROW, jana_gtk_event_list_compare,
-		self, NULL);
-
-	/* Re-filter */
-	/* Note, this isn't really necessary as recalculating headers will
-	 * trigger a re-filter, but that may change...
-	*/
-	gtk_tree_model_filter_refilter ((GtkTreeModelFilter *)
-		gtk_tree_view_get_model (GTK_TREE_VIEW (self)));
-	
-	recalculate_headers (self);
+	priv->resort = TRUE;
+	jana_gtk_utils_queue_update (self, (JanaGtkUtilsUpdateFunc)update_list);
 }
 
 static void
@@ -284,7 +303,7 @@ row_inserted_cb (GtkTreeModel *tree_model, GtkTreePath *path,
 		JANA_GTK_EVENT_LIST_COL_IS_EVENT, TRUE,
 		-1);
 	
-	recalculate_headers (self);
+	jana_gtk_utils_queue_update (self, (JanaGtkUtilsUpdateFunc)update_list);
 }
 
 static void
@@ -352,6 +371,8 @@ jana_gtk_event_list_dispose (GObject *self)
 {
 	JanaGtkEventListPrivate *priv = EVENT_LIST_PRIVATE (self);
 	
+	jana_gtk_utils_cancel_updates (self);
+	
 	while (priv->stores) {
 		GObject *object = (GObject *)priv->stores->data;
 
@@ -0,0 +1,1381 @@
+/*
+ * Copyright (C) 2009 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St - Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/**
+ * SECTION:jana-gtk-event-model
+ * @short_description: A compact event model for #JanaStoreView
+ * @see_also: #JanaGtkEventStore
+ *
+ * #JanaGtkEventModel is a #GtkTreeModel with the same columns as
+ * #JanaGtkEventStore, but rather than storing a full set of #GValue columns
+ * per row, each row is a small instance struct that points at a record
+ * shared between all instances of the same event. Values are only created
+ * when they're requested, iters remain valid for the lifetime of their row
+ * and looking up an event by its UID doesn't require a search of the model.
+ *
+ * Views that take a #JanaGtkEventStore only ever use it as a #GtkTreeModel,
+ * so a #JanaGtkEventModel can be passed in its place.
+ */
+
+#include <string.h>
+#include <gtk/gtk.h>
+#include <libjana/jana-store-view.h>
+#include <libjana/jana-component.h>
+#include <libjana/jana-event.h>
+#include <libjana/jana-utils.h>
+#include "jana-gtk-event-model.h"
+
+static void	event_model_tree_model_init	(GtkTreeModelIface *iface);
+static void	event_model_tree_sortable_init	(GtkTreeSortableIface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (JanaGtkEventModel,
+			 jana_gtk_event_model,
+			 G_TYPE_OBJECT,
+			 G_IMPLEMENT_INTERFACE (GTK_TYPE_TREE_MODEL,
+						event_model_tree_model_init)
+			 G_IMPLEMENT_INTERFACE (GTK_TYPE_TREE_SORTABLE,
+					event_model_tree_sortable_init));
+
+#define EVENT_MODEL_PRIVATE(o) \
+(G_TYPE_INSTANCE_GET_PRIVATE ((o), JANA_GTK_TYPE_EVENT_MODEL, \
+ JanaGtkEventModelPrivate))
+
+typedef struct _JanaGtkEventModelPrivate JanaGtkEventModelPrivate;
+
+struct _JanaGtkEventModelPrivate
+{
+	GPtrArray *rows;
+	GHashTable *records;
+	gint stamp;
+
+	gint sort_column_id;
+	GtkSortType order;
+	GList *sort_funcs;
+	GtkTreeIterCompareFunc default_sort_func;
+	gpointer default_sort_data;
+	GDestroyNotify default_sort_destroy;
+
+	JanaStoreView *view;
+	glong offset;
+
+	/* Rows changed by the current update, which may need moving once
+	 * it's done.
+	 */
+	GPtrArray *moved;
+};
+
+/* Per-event data, shared between all the instances of an event */
+typedef struct {
+	gint ref_count;
+
+	gchar *uid;
+	gchar *summary;
+	gchar *description;
+	gchar *location;
+	gchar **categories;
+	guint64 category_mask;
+	gboolean has_recurrences;
+	gboolean has_alarm;
+	JanaRecurrence *recur;
+
+	GList *instances;
+} EventRecord;
+
+/* A row in the model. @index is the row's current position in priv->rows,
+ * and @moved is set while the row is in priv->moved.
+ */
+typedef struct {
+	EventRecord *record;
+	JanaTime *start;
+	JanaTime *end;
+	gboolean first;
+	gboolean last;
+	gboolean moved;
+	guint index;
+} EventInstance;
+
+typedef struct {
+	gint column;
+	GtkTreeIterCompareFunc func;
+	gpointer data;
+	GDestroyNotify destroy;
+} EventModelSortFunc;
+
+enum {
+	PROP_VIEW = 1,
+	PROP_OFFSET,
+};
+
+static const GType column_types[JANA_GTK_EVENT_STORE_COL_LAST] = {
+	G_TYPE_STRING,		/* UID */
+	G_TYPE_STRING,		/* SUMMARY */
+	G_TYPE_STRING,		/* DESCRIPTION */
+	G_TYPE_STRING,		/* LOCATION */
+	G_TYPE_INVALID,		/* CATEGORIES, G_TYPE_STRV isn't constant */
+	G_TYPE_OBJECT,		/* START */
+	G_TYPE_OBJECT,		/* END */
+	G_TYPE_BOOLEAN,		/* FIRST_INSTANCE */
+	G_TYPE_BOOLEAN,		/* LAST_INSTANCE */
+	G_TYPE_BOOLEAN,		/* HAS_RECURRENCES */
+	G_TYPE_BOOLEAN,		/* HAS_ALARM */
+	G_TYPE_INVALID,		/* RECUR_TYPE, JANA_TYPE_RECURRENCE */
+	G_TYPE_UINT64,		/* CATEGORY_MASK */
+};
+
+static EventRecord *
+event_record_new (const gchar *uid)
+{
+	EventRecord *record = g_slice_new0 (EventRecord);
+
+	record->ref_count = 1;
+	record->uid = g_strdup (uid);
+
+	return record;
+}
+
+static void
+event_record_clear (EventRecord *record)
+{
+	g_free (record->summary);
+	g_free (record->description);
+	g_free (record->location);
+	g_strfreev (record->categories);
+	if (record->recur) jana_recurrence_free (record->recur);
+}
+
+static void
+event_record_set_event (EventRecord *record, JanaEvent *event)
+{
+	event_record_clear (record);
+
+	record->summary = g_strdup (jana_event_peek_summary (event));
+	record->description = g_strdup (jana_event_peek_description (event));
+	record->location = g_strdup (jana_event_peek_location (event));
+	record->categories = jana_event_get_categories (event);
+	record->category_mask = jana_utils_category_get_mask (
+		(const gchar **)record->categories);
+	record->has_recurrences = jana_event_has_recurrence (event);
+	record->has_alarm = jana_event_has_alarm (event);
+	record->recur = jana_event_get_recurrence (event);
+}
+
+static EventRecord *
+event_record_ref (EventRecord *record)
+{
+	record->ref_count ++;
+	return record;
+}
+
+static void
+event_record_unref (gpointer data)
+{
+	EventRecord *record = (EventRecord *)data;
+
+	if (--record->ref_count > 0) return;
+
+	event_record_clear (record);
+	g_free (record->uid);
+	g_list_free (record->instances);
+	g_slice_free (EventRecord, record);
+}
+
+static void
+event_instance_free (EventInstance *instance)
+{
+	g_object_unref (instance->start);
+	g_object_unref (instance->end);
+	event_record_unref (instance->record);
+	g_slice_free (EventInstance, instance);
+}
+
+static void
+event_model_set_iter (JanaGtkEventModel *self, GtkTreeIter *iter,
+		      EventInstance *instance)
+{
+	JanaGtkEventModelPrivate *priv = EVENT_MODEL_PRIVATE (self);
+
+	iter->stamp = priv->stamp;
+	iter->user_data = instance;
+	iter->user_data2 = NULL;
+	iter->user_data3 = NULL;
+}
+
+static gint
+event_model_compare_instances (EventInstance *a, EventInstance *b)
+{
+	gint result;
+
+	result = jana_utils_time_compare (a->start, b->start, FALSE);
+	if (result == 0)
+		result = jana_utils_time_compare (b->end, a->end, FALSE);
+	if ((result == 0) && a->record->summary && b->record->summary)
+		result = strcmp (a->record->summary, b->record->summary);
+
+	return result;
+}
+
+static gint
+event_model_compare_strings (const gchar *string1, const gchar *string2)
+{
+	if (string1 && string2) return g_utf8_collate (string1, string2);
+	return (string1 ? 1 : 0) - (string2 ? 1 : 0);
+}
+
+/* Compares the instance structs directly rather than going through
+ * gtk_tree_model_get(), in the same way as the sort functions of
+ * #JanaGtkEventStore, falling back to the start order for equal values.
+ */
+static gint
+event_model_compare_column (EventInstance *a, EventInstance *b, gint column)
+{
+	EventRecord *record1 = a->record, *record2 = b->record;
+	gint result = 0;
+
+	switch (column) {
+	    case JANA_GTK_EVENT_STORE_COL_UID :
+		result = event_model_compare_strings (
+			record1->uid, record2->uid);
+		break;
+	    case JANA_GTK_EVENT_STORE_COL_SUMMARY :
+		result = event_model_compare_strings (
+			record1->summary, record2->summary);
+		break;
+	    case JANA_GTK_EVENT_STORE_COL_DESCRIPTION :
+		result = event_model_compare_strings (
+			record1->description, record2->description);
+		break;
+	    case JANA_GTK_EVENT_STORE_COL_LOCATION :
+		result = event_model_compare_strings (
+			record1->location, record2->location);
+		break;
+	    case JANA_GTK_EVENT_STORE_COL_CATEGORIES :
+		/* Order by the first category */
+		result = event_model_compare_strings (
+			record1->categories ? record1->categories[0] : NULL,
+			record2->categories ? record2->categories[0] : NULL);
+		break;
+	    case JANA_GTK_EVENT_STORE_COL_START :
+		break;
+	    case JANA_GTK_EVENT_STORE_COL_END :
+		result = jana_utils_time_compare (a->end, b->end, FALSE);
+		break;
+	    case JANA_GTK_EVENT_STORE_COL_FIRST_INSTANCE :
+		result = (a->first ? 1 : 0) - (b->first ? 1 : 0);
+		break;
+	    case JANA_GTK_EVENT_STORE_COL_LAST_INSTANCE :
+		result = (a->last ? 1 : 0) - (b->last ? 1 : 0);
+		break;
+	    case JANA_GTK_EVENT_STORE_COL_HAS_RECURRENCES :
+		result = (record1->has_recurrences ? 1 : 0) -
+			(record2->has_recurrences ? 1 : 0);
+		break;
+	    case JANA_GTK_EVENT_STORE_COL_HAS_ALARM :
+		result = (record1->has_alarm ? 1 : 0) -
+			(record2->has_alarm ? 1 : 0);
+		break;
+	    case JANA_GTK_EVENT_STORE_COL_RECUR_TYPE :
+		/* Order by recurrence type, non-recurring events first */
+		result = (record1->recur ? (gint)record1->recur->type + 1 : 0) -
+			(record2->recur ? (gint)record2->recur->type + 1 : 0);
+		break;
+	    case JANA_GTK_EVENT_STORE_COL_CATEGORY_MASK :
+		result = (record1->category_mask > record2->category_mask) ?
+			1 : ((record1->category_mask <
+			      record2->category_mask) ? -1 : 0);
+		break;
+	}
+
+	if (result == 0) result = event_model_compare_instances (a, b);
+
+	return result;
+}
+
+static gint
+event_model_compare (JanaGtkEventModel *self, EventInstance *a,
+		     EventInstance *b)
+{
+	GtkTreeIterCompareFunc func = NULL;
+	gpointer data = NULL;
+	GtkTreeIter iter_a, iter_b;
+	gint result;
+	GList *f;
+
+	JanaGtkEventModelPrivate *priv = EVENT_MODEL_PRIVATE (self);
+
+	switch (priv->sort_column_id) {
+	    case GTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID :
+		return 0;
+	    case GTK_TREE_SORTABLE_DEFAULT_SORT_COLUMN_ID :
+		func = priv->default_sort_func;
+		data = priv->default_sort_data;
+		break;
+	    default :
+		for (f = priv->sort_funcs; f; f = f->next) {
+			EventModelSortFunc *sort =
+				(EventModelSortFunc *)f->data;
+			if (sort->column == priv->sort_column_id) {
+				func = sort->func;
+				data = sort->data;
+				break;
+			}
+		}
+		break;
+	}
+
+	if (func) {
+		event_model_set_iter (self, &iter_a, a);
+		event_model_set_iter (self, &iter_b, b);
+		result = func (GTK_TREE_MODEL (self), &iter_a, &iter_b, data);
+	} else if ((priv->sort_column_id >= 0) &&
+		   (priv->sort_column_id < JANA_GTK_EVENT_STORE_COL_LAST)) {
+		result = event_model_compare_column (a, b,
+			priv->sort_column_id);
+	} else
+		return 0;
+
+	return (priv->order == GTK_SORT_DESCENDING) ? -result : result;
+}
+
+static gint
+event_model_qsort_cb (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+	return event_model_compare ((JanaGtkEventModel *)user_data,
+		*((EventInstance **)a), *((EventInstance **)b));
+}
+
+static void
+event_model_renumber (JanaGtkEventModel *self, guint from, guint to)
+{
+	JanaGtkEventModelPrivate *priv = EVENT_MODEL_PRIVATE (self);
+
+	for (; from < to; from++)
+		((EventInstance *)priv->rows->pdata[from])->index = from;
+}
+
+/* Finds the position an instance should be inserted at, after any rows it
+ * compares equal to, searching no earlier than @from.
+ */
+static guint
+event_model_find_position (JanaGtkEventModel *self, EventInstance *instance,
+			   guint from)
+{
+	guint lo, hi;
+
+	JanaGtkEventModelPrivate *priv = EVENT_MODEL_PRIVATE (self);
+
+	for (lo = from, hi = priv->rows->len; lo < hi;) {
+		guint mid = lo + (hi - lo) / 2;
+		if (event_model_compare (self, instance,
+		    (EventInstance *)priv->rows->pdata[mid]) < 0)
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+
+	return lo;
+}
+
+static void
+event_model_insert_row (JanaGtkEventModel *self, EventInstance *instance,
+			guint position)
+{
+	GtkTreePath *path;
+	GtkTreeIter iter;
+
+	JanaGtkEventModelPrivate *priv = EVENT_MODEL_PRIVATE (self);
+
+	g_ptr_array_add (priv->rows, NULL);
+	memmove (&priv->rows->pdata[position + 1],
+		&priv->rows->pdata[position],
+		(priv->rows->len - position - 1) * sizeof (gpointer));
+	priv->rows->pdata[position] = instance;
+	event_model_renumber (self, position, priv->rows->len);
+
+	event_model_set_iter (self, &iter, instance);
+	path = gtk_tree_path_new_from_indices (position, -1);
+	gtk_tree_model_row_inserted (GTK_TREE_MODEL (self), path, &iter);
+	gtk_tree_path_free (path);
+}
+
+static void
+event_model_remove_row (JanaGtkEventModel *self, EventInstance *instance)
+{
+	GtkTreePath *path;
+	guint position = instance->index;
+
+	JanaGtkEventModelPrivate *priv = EVENT_MODEL_PRIVATE (self);
+
+	if (instance->moved) {
+		g_ptr_array_remove_fast (priv->moved, instance);
+		instance->moved = FALSE;
+	}
+
+	memmove (&priv->rows->pdata[position],
+		&priv->rows->pdata[position + 1],
+		(priv->rows->len - position - 1) * sizeof (gpointer));
+	g_ptr_array_set_size (priv->rows, priv->rows->len - 1);
+	event_model_renumber (self, position, priv->rows->len);
+
+	path = gtk_tree_path_new_from_indices (position, -1);
+	gtk_tree_model_row_deleted (GTK_TREE_MODEL (self), path);
+	gtk_tree_path_free (path);
+}
+
+/* Emits rows-reordered after priv->rows has been rearranged, but before the
+ * instances have been renumbered, so each still holds its old position.
+ */
+static void
+event_model_rows_reordered (JanaGtkEventModel *self)
+{
+	GtkTreePath *path;
+	gint *new_order;
+	gboolean changed;
+	guint i;
+
+	JanaGtkEventModelPrivate *priv = EVENT_MODEL_PRIVATE (self);
+
+	new_order = g_new (gint, priv->rows->len);
+	for (i = 0, changed = FALSE; i < priv->rows->len; i++) {
+		new_order[i] = ((EventInstance *)priv->rows->pdata[i])->index;
+		if (new_order[i] != (gint)i) changed = TRUE;
+	}
+
+	if (changed) {
+		event_model_renumber (self, 0, priv->rows->len);
+		path = gtk_tree_path_new ();
+		gtk_tree_model_rows_reordered (GTK_TREE_MODEL (self),
+			path, NULL, new_order);
+		gtk_tree_path_free (path);
+	}
+
+	g_free (new_order);
+}
+
+/* Moves the rows changed by an update to their new positions, with a single
+ * rows-reordered. Every other row is still in order, so the changed rows are
+ * sorted on their own and merged back in.
+ */
+static void
+event_model_reposition (JanaGtkEventModel *self)
+{
+	GPtrArray *rows;
+	guint i, j;
+
+	JanaGtkEventModelPrivate *priv = EVENT_MODEL_PRIVATE (self);
+
+	if (!priv->moved->len) return;
+
+	if (priv->sort_column_id == GTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID) {
+		for (i = 0; i < priv->moved->len; i++)
+			((EventInstance *)priv->moved->pdata[i])->moved = FALSE;
+		g_ptr_array_set_size (priv->moved, 0);
+		return;
+	}
+
+	g_qsort_with_data (priv->moved->pdata, priv->moved->len,
+		sizeof (gpointer), event_model_qsort_cb, self);
+
+	/* Changed rows go after any rows they compare equal to, as they
+	 * would if they were inserted.
+	 */
+	rows = g_ptr_array_sized_new (priv->rows->len);
+	for (i = 0, j = 0; i < priv->rows->len; i++) {
+		EventInstance *row = (EventInstance *)priv->rows->pdata[i];
+
+		if (row->moved) continue;
+		while ((j < priv->moved->len) && (event_model_compare (self,
+		       (EventInstance *)priv->moved->pdata[j], row) < 0))
+			g_ptr_array_add (rows, priv->moved->pdata[j++]);
+		g_ptr_array_add (rows, row);
+	}
+	for (; j < priv->moved->len; j++)
+		g_ptr_array_add (rows, priv->moved->pdata[j]);
+
+	for (i = 0; i < priv->moved->len; i++)
+		((EventInstance *)priv->moved->pdata[i])->moved = FALSE;
+	g_ptr_array_set_size (priv->moved, 0);
+
+	g_ptr_array_free (priv->rows, TRUE);
+	priv->rows = rows;
+	event_model_rows_reordered (self);
+}
+
+static void
+event_model_resort (JanaGtkEventModel *self)
+{
+	JanaGtkEventModelPrivate *priv = EVENT_MODEL_PRIVATE (self);
+
+	if ((priv->rows->len < 2) || (priv->sort_column_id ==
+	     GTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID))
+		return;
+
+	g_qsort_with_data (priv->rows->pdata, priv->rows->len,
+		sizeof (gpointer), event_model_qsort_cb, self);
+	event_model_rows_reordered (self);
+}
+
+/* Inserts newly created instances. Sorting them first means that each
+ * insertion point is after the last, so populating an empty model only ever
+ * appends.
+ */
+static void
+event_model_insert_instances (JanaGtkEventModel *self, GPtrArray *added)
+{
+	guint i, position;
+
+	if (!added->len) return;
+
+	g_qsort_with_data (added->pdata, added->len, sizeof (gpointer),
+		event_model_qsort_cb, self);
+	for (i = 0, position = 0; i < added->len; i++) {
+		EventInstance *instance = (EventInstance *)added->pdata[i];
+		position = event_model_find_position (self, instance, position);
+		event_model_insert_row (self, instance, position);
+		position ++;
+	}
+}
+
+static void
+event_model_remove_record (JanaGtkEventModel *self, EventRecord *record)
+{
+	JanaGtkEventModelPrivate *priv = EVENT_MODEL_PRIVATE (self);
+
+	while (record->instances) {
+		EventInstance *instance =
+			(EventInstance *)record->instances->data;
+		record->instances = g_list_delete_link (
+			record->instances, record->instances);
+		event_model_remove_row (self, instance);
+		event_instance_free (instance);
+	}
+	g_hash_table_remove (priv->records, record->uid);
+}
+
+/* Re-instances an event, updating existing rows in place, trimming any
+ * surplus and adding new instances to @added to be inserted later.
+ */
+static void
+event_model_update_instances (JanaGtkEventModel *self, EventRecord *record,
+			      JanaEvent *event, JanaTime *range_start,
+			      JanaTime *range_end, GPtrArray *added)
+{
+	GList *instance, *instances, *existing, *last;
+	JanaTime *start, *end;
+	gint days, inst_days;
+	glong seconds;
+
+	JanaGtkEventModelPrivate *priv = EVENT_MODEL_PRIVATE (self);
+
+	start = jana_event_get_start (event);
+	end = jana_event_get_end (event);
+	if (start && end) {
+		jana_utils_time_diff (start, end, NULL, NULL, &days,
+			NULL, NULL, &seconds);
+	} else {
+		days = 0;
+		seconds = 0;
+	}
+	if (start) g_object_unref (start);
+	if (end) g_object_unref (end);
+
+	if (days && (seconds == 0)) days--;
+	inst_days = 0;
+
+	existing = record->instances;
+	last = NULL;
+	instances = jana_utils_event_get_instances (event,
+		range_start, range_end, priv->offset);
+	for (instance = instances; instance; instance = instance->next) {
+		JanaDuration *duration = (JanaDuration *)instance->data;
+		EventInstance *row;
+		gboolean first, last_inst;
+
+		first = (inst_days == 0) ? TRUE : FALSE;
+		if (inst_days == days) {
+			last_inst = TRUE;
+			inst_days -= (days + 1);
+		} else
+			last_inst = FALSE;
+		inst_days ++;
+
+		if (existing) {
+			GtkTreePath *path;
+			GtkTreeIter iter;
+
+			row = (EventInstance *)existing->data;
+			g_object_unref (row->start);
+			g_object_unref (row->end);
+			row->start = g_object_ref (duration->start);
+			row->end = g_object_ref (duration->end);
+			row->first = first;
+			row->last = last_inst;
+
+			/* Moved into place once the whole update is done */
+			if (!row->moved) {
+				row->moved = TRUE;
+				g_ptr_array_add (priv->moved, row);
+			}
+
+			event_model_set_iter (self, &iter, row);
+			path = gtk_tree_path_new_from_indices (row->index, -1);
+			gtk_tree_model_row_changed (GTK_TREE_MODEL (self),
+				path, &iter);
+			gtk_tree_path_free (path);
+
+			last = existing;
+			existing = existing->next;
+		} else {
+			row = g_slice_new (EventInstance);
+			row->record = event_record_ref (record);
+			row->start = g_object_ref (duration->start);
+			row->end = g_object_ref (duration->end);
+			row->first = first;
+			row->last = last_inst;
+			row->moved = FALSE;
+			row->index = 0;
+
+			/* Keep track of the tail so appending stays cheap */
+			if (last) {
+				last = g_list_append (last, row)->next;
+			} else {
+				record->instances = g_list_append (
+					record->instances, row);
+				last = record->instances;
+			}
+			g_ptr_array_add (added, row);
+		}
+	}
+	jana_utils_instance_list_free (instances);
+
+	/* Trim off instances if there are too many */
+	while (existing) {
+		EventInstance *row = (EventInstance *)existing->data;
+		GList *next = existing->next;
+
+		record->instances = g_list_delete_link (
+			record->instances, existing);
+		event_model_remove_row (self, row);
+		event_instance_free (row);
+		existing = next;
+	}
+}
+
+static void
+event_model_update (JanaGtkEventModel *self, GList *components,
+		    gboolean modified)
+{
+	JanaTime *range_start, *range_end;
+	GPtrArray *added;
+
+	JanaGtkEventModelPrivate *priv = EVENT_MODEL_PRIVATE (self);
+
+	jana_store_view_get_range (priv->view, &range_start, &range_end);
+	added = g_ptr_array_new ();
+
+	for (; components; components = components->next) {
+		EventRecord *record;
+		JanaEvent *event;
+		gchar *uid;
+
+		if (jana_component_get_component_type (JANA_COMPONENT (
+		    components->data)) != JANA_COMPONENT_EVENT) continue;
+		event = JANA_EVENT (components->data);
+
+		uid = jana_component_get_uid (JANA_COMPONENT (event));
+		record = (EventRecord *)g_hash_table_lookup (
+			priv->records, uid);
+		if (!record) {
+			if (modified) {
+				g_free (uid);
+				continue;
+			}
+			record = event_record_new (uid);
+			g_hash_table_insert (priv->records,
+				record->uid, record);
+		}
+		g_free (uid);
+
+		event_record_set_event (record, event);
+		event_model_update_instances (self, record, event,
+			range_start, range_end, added);
+	}
+
+	event_model_reposition (self);
+	event_model_insert_instances (self, added);
+	g_ptr_array_free (added, TRUE);
+
+	if (range_start) g_object_unref (range_start);
+	if (range_end) g_object_unref (range_end);
+}
+
+static void
+event_model_added_cb (JanaStoreView *view, GList *components,
+		      JanaGtkEventModel *self)
+{
+	event_model_update (self, components, FALSE);
+}
+
+static void
+event_model_modified_cb (JanaStoreView *view, GList *components,
+			 JanaGtkEventModel *self)
+{
+	event_model_update (self, components, TRUE);
+}
+
+static void
+event_model_removed_cb (JanaStoreView *view, GList *uids,
+			JanaGtkEventModel *self)
+{
+	JanaGtkEventModelPrivate *priv = EVENT_MODEL_PRIVATE (self);
+
+	for (; uids; uids = uids->next) {
+		EventRecord *record = (EventRecord *)g_hash_table_lookup (
+			priv->records, (const gchar *)uids->data);
+		if (record) event_model_remove_record (self, record);
+	}
+}
+
+static gboolean
+event_model_remove_record_cb (gpointer key, gpointer value,
+			      gpointer user_data)
+{
+	EventRecord *record = (EventRecord *)value;
+
+	while (record->instances) {
+		event_instance_free ((EventInstance *)record->instances->data);
+		record->instances = g_list_delete_link (
+			record->instances, record->instances);
+	}
+
+	return TRUE;
+}
+
+static void
+event_model_clear (JanaGtkEventModel *self)
+{
+	JanaGtkEventModelPrivate *priv = EVENT_MODEL_PRIVATE (self);
+
+	/* Delete from the end so nothing needs to move or be renumbered */
+	while (priv->rows->len) {
+		GtkTreePath *path = gtk_tree_path_new_from_indices (
+			priv->rows->len - 1, -1);
+		g_ptr_array_set_size (priv->rows, priv->rows->len - 1);
+		gtk_tree_model_row_deleted (GTK_TREE_MODEL (self), path);
+		gtk_tree_path_free (path);
+	}
+
+	g_hash_table_foreach_remove (priv->records,
+		event_model_remove_record_cb, NULL);
+}
+
+static GtkTreeModelFlags
+event_model_get_flags (GtkTreeModel *model)
+{
+	return GTK_TREE_MODEL_ITERS_PERSIST | GTK_TREE_MODEL_LIST_ONLY;
+}
+
+static gint
+event_model_get_n_columns (GtkTreeModel *model)
+{
+	return JANA_GTK_EVENT_STORE_COL_LAST;
+}
+
+static GType
+event_model_get_column_type (GtkTreeModel *model, gint index)
+{
+	g_return_val_if_fail ((index >= 0) &&
+		(index < JANA_GTK_EVENT_STORE_COL_LAST), G_TYPE_INVALID);
+
+	switch (index) {
+	    case JANA_GTK_EVENT_STORE_COL_CATEGORIES :
+		return G_TYPE_STRV;
+	    case JANA_GTK_EVENT_STORE_COL_RECUR_TYPE :
+		return JANA_TYPE_RECURRENCE;
+	    default :
+		return column_types[index];
+	}
+}
+
+static gboolean
+event_model_get_iter (GtkTreeModel *model, GtkTreeIter *iter,
+		      GtkTreePath *path)
+{
+	gint index;
+
+	JanaGtkEventModelPrivate *priv = EVENT_MODEL_PRIVATE (model);
+
+	if (gtk_tree_path_get_depth (path) != 1) return FALSE;
+
+	index = gtk_tree_path_get_indices (path)[0];
+	if ((index < 0) || (index >= priv->rows->len)) return FALSE;
+
+	event_model_set_iter (JANA_GTK_EVENT_MODEL (model), iter,
+		(EventInstance *)priv->rows->pdata[index]);
+
+	return TRUE;
+}
+
+static GtkTreePath *
+event_model_get_path (GtkTreeModel *model, GtkTreeIter *iter)
+{
+	EventInstance *instance;
+
+	JanaGtkEventModelPrivate *priv = EVENT_MODEL_PRIVATE (model);
+
+	g_return_val_if_fail (iter->stamp == priv->stamp, NULL);
+
+	instance = (EventInstance *)iter->user_data;
+	return gtk_tree_path_new_from_indices (instance->index, -1);
+}
+
+static void
+event_model_get_value (GtkTreeModel *model, GtkTreeIter *iter, gint column,
+		       GValue *value)
+{
+	EventInstance *instance;
+	EventRecord *record;
+
+	JanaGtkEventModelPrivate *priv = EVENT_MODEL_PRIVATE (model);
+
+	g_return_if_fail (iter->stamp == priv->stamp);
+
+	instance = (EventInstance *)iter->user_data;
+	record = instance->record;
+
+	g_value_init (value, event_model_get_column_type (model, column));
+	switch (column) {
+	    case JANA_GTK_EVENT_STORE_COL_UID :
+		g_value_set_string (value, record->uid);
+		break;
+	    case JANA_GTK_EVENT_STORE_COL_SUMMARY :
+		g_value_set_string (value, record->summary);
+		break;
+	    case JANA_GTK_EVENT_STORE_COL_DESCRIPTION :
+		g_value_set_string (value, record->description);
+		break;
+	    case JANA_GTK_EVENT_STORE_COL_LOCATION :
+		g_value_set_string (value, record->location);
+		break;
+	    case JANA_GTK_EVENT_STORE_COL_CATEGORIES :
+		g_value_set_boxed (value, record->categories);
+		break;
+	    case JANA_GTK_EVENT_STORE_COL_START :
+		g_value_set_object (value, instance->start);
+		break;
+	    case JANA_GTK_EVENT_STORE_COL_END :
+		g_value_set_object (value, instance->end);
+		break;
+	    case JANA_GTK_EVENT_STORE_COL_FIRST_INSTANCE :
+		g_value_set_boolean (value, instance->first);
+		break;
+	    case JANA_GTK_EVENT_STORE_COL_LAST_INSTANCE :
+		g_value_set_boolean (value, instance->last);
+		break;
+	    case JANA_GTK_EVENT_STORE_COL_HAS_RECURRENCES :
+		g_value_set_boolean (value, record->has_recurrences);
+		break;
+	    case JANA_GTK_EVENT_STORE_COL_HAS_ALARM :
+		g_value_set_boolean (value, record->has_alarm);
+		break;
+	    case JANA_GTK_EVENT_STORE_COL_RECUR_TYPE :
+		g_value_set_boxed (value, record->recur);
+		break;
+	    case JANA_GTK_EVENT_STORE_COL_CATEGORY_MASK :
+		g_value_set_uint64 (value, record->category_mask);
+		break;
+	}
+}
+
+static gboolean
+event_model_iter_next (GtkTreeModel *model, GtkTreeIter *iter)
+{
+	guint index;
+
+	JanaGtkEventModelPrivate *priv = EVENT_MODEL_PRIVATE (model);
+
+	g_return_val_if_fail (iter->stamp == priv->stamp, FALSE);
+
+	index = ((EventInstance *)iter->user_data)->index + 1;
+	if (index >= priv->rows->len) {
+		iter->stamp = 0;
+		return FALSE;
+	}
+
+	iter->user_data = priv->rows->pdata[index];
+	return TRUE;
+}
+
+static gboolean
+event_model_iter_nth_child (GtkTreeModel *model, GtkTreeIter *iter,
+			    GtkTreeIter *parent, gint n)
+{
+	JanaGtkEventModelPrivate *priv = EVENT_MODEL_PRIVATE (model);
+
+	if (parent || (n < 0) || (n >= priv->rows->len)) return FALSE;
+
+	event_model_set_iter (JANA_GTK_EVENT_MODEL (model), iter,
+		(EventInstance *)priv->rows->pdata[n]);
+
+	return TRUE;
+}
+
+static gboolean
+event_model_iter_children (GtkTreeModel *model, GtkTreeIter *iter,
+			   GtkTreeIter *parent)
+{
+	return event_model_iter_nth_child (model, iter, parent, 0);
+}
+
+static gboolean
+event_model_iter_has_child (GtkTreeModel *model, GtkTreeIter *iter)
+{
+	return FALSE;
+}
+
+static gint
+event_model_iter_n_children (GtkTreeModel *model, GtkTreeIter *iter)
+{
+	JanaGtkEventModelPrivate *priv = EVENT_MODEL_PRIVATE (model);
+
+	return iter ? 0 : priv->rows->len;
+}
+
+static gboolean
+event_model_iter_parent (GtkTreeModel *model, GtkTreeIter *iter,
+			 GtkTreeIter *child)
+{
+	return FALSE;
+}
+
+static void
+event_model_tree_model_init (GtkTreeModelIface *iface)
+{
+	iface->get_flags = event_model_get_flags;
+	iface->get_n_columns = event_model_get_n_columns;
+	iface->get_column_type = event_model_get_column_type;
+	iface->get_iter = event_model_get_iter;
+	iface->get_path = event_model_get_path;
+	iface->get_value = event_model_get_value;
+	iface->iter_next = event_model_iter_next;
+	iface->iter_children = event_model_iter_children;
+	iface->iter_has_child = event_model_iter_has_child;
+	iface->iter_n_children = event_model_iter_n_children;
+	iface->iter_nth_child = event_model_iter_nth_child;
+	iface->iter_parent = event_model_iter_parent;
+}
+
+static gboolean
+event_model_get_sort_column_id (GtkTreeSortable *sortable,
+				gint *sort_column_id, GtkSortType *order)
+{
+	JanaGtkEventModelPrivate *priv = EVENT_MODEL_PRIVATE (sortable);
+
+	if (sort_column_id) *sort_column_id = priv->sort_column_id;
+	if (order) *order = priv->order;
+
+	return ((priv->sort_column_id !=
+		 GTK_TREE_SORTABLE_DEFAULT_SORT_COLUMN_ID) &&
+		(priv->sort_column_id !=
+		 GTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID));
+}
+
+static void
+event_model_set_sort_column_id (GtkTreeSortable *sortable,
+				gint sort_column_id, GtkSortType order)
+{
+	JanaGtkEventModelPrivate *priv = EVENT_MODEL_PRIVATE (sortable);
+
+	if ((priv->sort_column_id == sort_column_id) &&
+	    (priv->order == order))
+		return;
+
+	priv->sort_column_id = sort_column_id;
+	priv->order = order;
+
+	gtk_tree_sortable_sort_column_changed (sortable);
+	event_model_resort (JANA_GTK_EVENT_MODEL (sortable));
+}
+
+static void
+event_model_sort_func_free (EventModelSortFunc *sort)
+{
+	if (sort->destroy) sort->destroy (sort->data);
+	g_slice_free (EventModelSortFunc, sort);
+}
+
+static void
+event_model_set_sort_func (GtkTreeSortable *sortable, gint sort_column_id,
+			   GtkTreeIterCompareFunc func, gpointer data,
+			   GDestroyNotify destroy)
+{
+	EventModelSortFunc *sort;
+	GList *f;
+
+	JanaGtkEventModelPrivate *priv = EVENT_MODEL_PRIVATE (sortable);
+
+	for (f = priv->sort_funcs; f; f = f->next) {
+		sort = (EventModelSortFunc *)f->data;
+		if (sort->column == sort_column_id) {
+			event_model_sort_func_free (sort);
+			priv->sort_funcs = g_list_delete_link (
+				priv->sort_funcs, f);
+			break;
+		}
+	}
+
+	if (func) {
+		sort = g_slice_new (EventModelSortFunc);
+		sort->column = sort_column_id;
+		sort->func = func;
+		sort->data = data;
+		sort->destroy = destroy;
+		priv->sort_funcs = g_list_prepend (priv->sort_funcs, sort);
+	}
+
+	if (priv->sort_column_id == sort_column_id)
+		event_model_resort (JANA_GTK_EVENT_MODEL (sortable));
+}
+
+static void
+event_model_set_default_sort_func (GtkTreeSortable *sortable,
+				   GtkTreeIterCompareFunc func, gpointer data,
+				   GDestroyNotify destroy)
+{
+	JanaGtkEventModelPrivate *priv = EVENT_MODEL_PRIVATE (sortable);
+
+	if (priv->default_sort_destroy)
+		priv->default_sort_destroy (priv->default_sort_data);
+
+	priv->default_sort_func = func;
+	priv->default_sort_data = data;
+	priv->default_sort_destroy = destroy;
+
+	if (priv->sort_column_id == GTK_TREE_SORTABLE_DEFAULT_SORT_COLUMN_ID)
+		event_model_resort (JANA_GTK_EVENT_MODEL (sortable));
+}
+
+static gboolean
+event_model_has_default_sort_func (GtkTreeSortable *sortable)
+{
+	JanaGtkEventModelPrivate *priv = EVENT_MODEL_PRIVATE (sortable);
+
+	return priv->default_sort_func ? TRUE : FALSE;
+}
+
+static void
+event_model_tree_sortable_init (GtkTreeSortableIface *iface)
+{
+	iface->get_sort_column_id = event_model_get_sort_column_id;
+	iface->set_sort_column_id = event_model_set_sort_column_id;
+	iface->set_sort_func = event_model_set_sort_func;
+	iface->set_default_sort_func = event_model_set_default_sort_func;
+	iface->has_default_sort_func = event_model_has_default_sort_func;
+}
+
+static void
+jana_gtk_event_model_get_property (GObject *object, guint property_id,
+				   GValue *value, GParamSpec *pspec)
+{
+	JanaGtkEventModelPrivate *priv = EVENT_MODEL_PRIVATE (object);
+
+	switch (property_id) {
+	    case PROP_VIEW :
+		g_value_set_object (value, priv->view);
+		break;
+	    case PROP_OFFSET :
+		g_value_set_long (value, priv->offset);
+		break;
+	    default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+	}
+}
+
+static void
+jana_gtk_event_model_set_property (GObject *object, guint property_id,
+				   const GValue *value, GParamSpec *pspec)
+{
+	switch (property_id) {
+	    case PROP_VIEW :
+		jana_gtk_event_model_set_view (JANA_GTK_EVENT_MODEL (object),
+			g_value_get_object (value));
+		break;
+	    case PROP_OFFSET :
+		jana_gtk_event_model_set_offset (JANA_GTK_EVENT_MODEL (object),
+			g_value_get_long (value));
+		break;
+	    default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+	}
+}
+
+static void
+jana_gtk_event_model_dispose (GObject *object)
+{
+	jana_gtk_event_model_set_view (JANA_GTK_EVENT_MODEL (object), NULL);
+
+	if (G_OBJECT_CLASS (jana_gtk_event_model_parent_class)->dispose)
+		G_OBJECT_CLASS (jana_gtk_event_model_parent_class)->dispose (
+			object);
+}
+
+static void
+jana_gtk_event_model_finalize (GObject *object)
+{
+	JanaGtkEventModelPrivate *priv = EVENT_MODEL_PRIVATE (object);
+
+	while (priv->sort_funcs) {
+		event_model_sort_func_free (
+			(EventModelSortFunc *)priv->sort_funcs->data);
+		priv->sort_funcs = g_list_delete_link (
+			priv->sort_funcs, priv->sort_funcs);
+	}
+	if (priv->default_sort_destroy)
+		priv->default_sort_destroy (priv->default_sort_data);
+
+	g_hash_table_destroy (priv->records);
+	g_ptr_array_free (priv->rows, TRUE);
+	g_ptr_array_free (priv->moved, TRUE);
+
+	G_OBJECT_CLASS (jana_gtk_event_model_parent_class)->finalize (object);
+}
+
+static void
+jana_gtk_event_model_class_init (JanaGtkEventModelClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+	g_type_class_add_private (klass, sizeof (JanaGtkEventModelPrivate));
+
+	object_class->get_property = jana_gtk_event_model_get_property;
+	object_class->set_property = jana_gtk_event_model_set_property;
+	object_class->dispose = jana_gtk_event_model_dispose;
+	object_class->finalize = jana_gtk_event_model_finalize;
+
+	g_object_class_install_property (
+		object_class,
+		PROP_VIEW,
+		g_param_spec_object (
+			"view",
+			"JanaStoreView *",
+			"The JanaStoreView monitored.",
+			G_TYPE_OBJECT,
+			G_PARAM_READWRITE));
+
+	g_object_class_install_property (
+		object_class,
+		PROP_OFFSET,
+		g_param_spec_long (
+			"offset",
+			"glong",
+			"The time offset to use when instancing events.",
+			-G_MAXLONG, G_MAXLONG, 0,
+			G_PARAM_READWRITE));
+}
+
+static void
+jana_gtk_event_model_init (JanaGtkEventModel *self)
+{
+	JanaGtkEventModelPrivate *priv = EVENT_MODEL_PRIVATE (self);
+
+	priv->rows = g_ptr_array_new ();
+	priv->moved = g_ptr_array_new ();
+	priv->records = g_hash_table_new_full (g_str_hash, g_str_equal,
+		NULL, event_record_unref);
+	priv->stamp = g_random_int ();
+
+	priv->sort_column_id = JANA_GTK_EVENT_STORE_COL_START;
+	priv->order = GTK_SORT_ASCENDING;
+}
+
+/**
+ * jana_gtk_event_model_new:
+ *
+ * Creates a new, empty #JanaGtkEventModel.
+ *
+ * Returns: A new #JanaGtkEventModel, cast as a #GtkTreeModel.
+ */
+GtkTreeModel *
+jana_gtk_event_model_new (void)
+{
+	return (GtkTreeModel *)g_object_new (JANA_GTK_TYPE_EVENT_MODEL, NULL);
+}
+
+/**
+ * jana_gtk_event_model_new_full:
+ * @view: A #JanaStoreView
+ * @offset: Time offset, in seconds
+ *
+ * Creates a new #JanaGtkEventModel that monitors @view, splitting events
+ * into day instances using @offset.
+ *
+ * Returns: A new #JanaGtkEventModel, cast as a #GtkTreeModel.
+ */
+GtkTreeModel *
+jana_gtk_event_model_new_full (JanaStoreView *view, glong offset)
+{
+	return (GtkTreeModel *)g_object_new (JANA_GTK_TYPE_EVENT_MODEL,
+		"view", view, "offset", offset, NULL);
+}
+
+/**
+ * jana_gtk_event_model_set_view:
+ * @self: A #JanaGtkEventModel
+ * @view: A #JanaStoreView, or %NULL
+ *
+ * Sets the #JanaStoreView that @self monitors. Any rows from a previously
+ * set view will be removed.
+ */
+void
+jana_gtk_event_model_set_view (JanaGtkEventModel *self, JanaStoreView *view)
+{
+	JanaGtkEventModelPrivate *priv = EVENT_MODEL_PRIVATE (self);
+
+	if (priv->view) {
+		g_signal_handlers_disconnect_by_func (
+			priv->view, event_model_added_cb, self);
+		g_signal_handlers_disconnect_by_func (
+			priv->view, event_model_modified_cb, self);
+		g_signal_handlers_disconnect_by_func (
+			priv->view, event_model_removed_cb, self);
+		g_object_unref (priv->view);
+		priv->view = NULL;
+		event_model_clear (self);
+	}
+	if (view) {
+		priv->view = g_object_ref (view);
+		g_signal_connect (priv->view, "added",
+			G_CALLBACK (event_model_added_cb), self);
+		g_signal_connect (priv->view, "modified",
+			G_CALLBACK (event_model_modified_cb), self);
+		g_signal_connect (priv->view, "removed",
+			G_CALLBACK (event_model_removed_cb), self);
+	}
+}
+
+/**
+ * jana_gtk_event_model_get_view:
+ * @self: A #JanaGtkEventModel
+ *
+ * Retrieves the #JanaStoreView monitored by @self.
+ *
+ * Returns: A new reference to the #JanaStoreView, or %NULL.
+ */
+JanaStoreView *
+jana_gtk_event_model_get_view (JanaGtkEventModel *self)
+{
+	JanaGtkEventModelPrivate *priv = EVENT_MODEL_PRIVATE (self);
+
+	return priv->view ? g_object_ref (priv->view) : NULL;
+}
+
+/**
+ * jana_gtk_event_model_get_store:
+ * @self: A #JanaGtkEventModel
+ *
+ * Retrieves the #JanaStore of the #JanaStoreView monitored by @self.
+ *
+ * Returns: A new reference to the #JanaStore, or %NULL.
+ */
+JanaStore *
+jana_gtk_event_model_get_store (JanaGtkEventModel *self)
+{
+	JanaGtkEventModelPrivate *priv = EVENT_MODEL_PRIVATE (self);
+
+	if (priv->view) {
+		return jana_store_view_get_store (priv->view);
+	} else return NULL;
+}
+
+typedef struct {
+	JanaStore *store;
+	GList *components;
+} EventModelComponentsData;
+
+static void
+event_model_get_component_cb (gpointer key, gpointer value,
+			      gpointer user_data)
+{
+	EventModelComponentsData *data = (EventModelComponentsData *)user_data;
+
+	data->components = g_list_prepend (data->components,
+		jana_store_get_component (data->store, (const gchar *)key));
+}
+
+/**
+ * jana_gtk_event_model_set_offset:
+ * @self: A #JanaGtkEventModel
+ * @offset: Time offset, in seconds
+ *
+ * Sets the time offset that should be used when splitting events into day
+ * instances.
+ */
+void
+jana_gtk_event_model_set_offset (JanaGtkEventModel *self, glong offset)
+{
+	EventModelComponentsData data;
+
+	JanaGtkEventModelPrivate *priv = EVENT_MODEL_PRIVATE (self);
+
+	if (priv->offset == offset) return;
+
+	priv->offset = offset;
+	if (!priv->view) return;
+
+	/* Re-instance all events */
+	data.store = jana_store_view_get_store (priv->view);
+	data.components = NULL;
+	g_hash_table_foreach (priv->records,
+		event_model_get_component_cb, &data);
+
+	event_model_update (self, data.components, TRUE);
+
+	while (data.components) {
+		g_object_unref ((GObject *)data.components->data);
+		data.components = g_list_delete_link (
+			data.components, data.components);
+	}
+	g_object_unref (data.store);
+}
+
+/**
+ * jana_gtk_event_model_get_iter_from_uid:
+ * @self: A #JanaGtkEventModel
+ * @uid: The UID of an event
+ * @iter: An uninitialised #GtkTreeIter
+ *
+ * Sets @iter to the first instance of the event with the given UID. This
+ * doesn't require a search of the model.
+ *
+ * Returns: %TRUE if @iter was set, %FALSE if the event has no instances in
+ * @self.
+ */
+gboolean
+jana_gtk_event_model_get_iter_from_uid (JanaGtkEventModel *self,
+					const gchar *uid, GtkTreeIter *iter)
+{
+	EventRecord *record;
+
+	JanaGtkEventModelPrivate *priv = EVENT_MODEL_PRIVATE (self);
+
+	record = (EventRecord *)g_hash_table_lookup (priv->records, uid);
+	if (!record || !record->instances) return FALSE;
+
+	event_model_set_iter (self, iter,
+		(EventInstance *)record->instances->data);
+
+	return TRUE;
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2009 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St - Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef _JANA_GTK_EVENT_MODEL
+#define _JANA_GTK_EVENT_MODEL
+
+#include <gtk/gtk.h>
+#include <glib-object.h>
+#include <libjana/jana-store-view.h>
+#include <libjana-gtk/jana-gtk-event-store.h>
+
+G_BEGIN_DECLS
+
+#define JANA_GTK_TYPE_EVENT_MODEL jana_gtk_event_model_get_type()
+
+#define JANA_GTK_EVENT_MODEL(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST ((obj), \
+  JANA_GTK_TYPE_EVENT_MODEL, JanaGtkEventModel))
+
+#define JANA_GTK_EVENT_MODEL_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_CAST ((klass), \
+  JANA_GTK_TYPE_EVENT_MODEL, JanaGtkEventModelClass))
+
+#define JANA_GTK_IS_EVENT_MODEL(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE ((obj), \
+  JANA_GTK_TYPE_EVENT_MODEL))
+
+#define JANA_GTK_IS_EVENT_MODEL_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_TYPE ((klass), \
+  JANA_GTK_TYPE_EVENT_MODEL))
+
+#define JANA_GTK_EVENT_MODEL_GET_CLASS(obj) \
+  (G_TYPE_INSTANCE_GET_CLASS ((obj), \
+  JANA_GTK_TYPE_EVENT_MODEL, JanaGtkEventModelClass))
+
+/**
+ * JanaGtkEventModel:
+ *
+ * The #JanaGtkEventModel struct contains only private data.
+ */
+typedef struct {
+	GObject parent;
+} JanaGtkEventModel;
+
+typedef struct {
+	GObjectClass parent_class;
+} JanaGtkEventModelClass;
+
+GType jana_gtk_event_model_get_type (void);
+
+GtkTreeModel * jana_gtk_event_model_new (void);
+GtkTreeModel * jana_gtk_event_model_new_full (JanaStoreView *view,
+					       glong offset);
+void jana_gtk_event_model_set_view (JanaGtkEventModel *self,
+				    JanaStoreView *view);
+JanaStoreView * jana_gtk_event_model_get_view (JanaGtkEventModel *self);
+JanaStore * jana_gtk_event_model_get_store (JanaGtkEventModel *self);
+void jana_gtk_event_model_set_offset (JanaGtkEventModel *self, glong offset);
+gboolean jana_gtk_event_model_get_iter_from_uid (JanaGtkEventModel *self,
+						 const gchar *uid,
+						 GtkTreeIter *iter);
+
+G_END_DECLS
+
+#endif /* _JANA_GTK_EVENT_MODEL */
+
@@ -17,6 +17,26 @@
  * Inc., 51 Franklin St - Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+/**
+ * SECTION:jana-gtk-event-store
+ * @short_description: A #GtkListStore of the events in a #JanaStoreView
+ * @see_also: #JanaGtkEventModel
+ *
+ * #JanaGtkEventStore is a #GtkListStore with a row for each day instance of
+ * the events in a #JanaStoreView, which it keeps up to date as the view
+ * changes. It presents the JANA_GTK_EVENT_STORE_COL_* columns through the
+ * #GtkTreeModel interface.
+ *
+ * Only the instance specific columns are stored in the underlying list
+ * store. The rest are looked up, when read, in a record shared by every
+ * instance of an event, so the list store's own columns don't match the
+ * public column indices. Rows must only be changed through the store view;
+ * gtk_list_store_set() and gtk_list_store_set_value() shouldn't be used
+ * with JANA_GTK_EVENT_STORE_COL_* indices, as they would either set a
+ * column of the wrong type or be rejected as out of range. The same goes
+ * for gtk_list_store_set_column_types(), and rows added with the
+ * #GtkListStore functions have no event to report.
+ */
 
 #include <string.h>
 #include <gtk/gtk.h>
@@ -26,11 +46,19 @@
 #include <libjana/jana-utils.h>
 #include "jana-gtk-event-store.h"
 
-G_DEFINE_TYPE (JanaGtkEventStore, jana_gtk_event_store, GTK_TYPE_LIST_STORE)
+static void	event_store_tree_model_init	(GtkTreeModelIface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (JanaGtkEventStore,
+			 jana_gtk_event_store,
+			 GTK_TYPE_LIST_STORE,
+			 G_IMPLEMENT_INTERFACE (GTK_TYPE_TREE_MODEL,
+						event_store_tree_model_init))
 
 #define EVENT_STORE_PRIVATE(o) \
 (G_TYPE_INSTANCE_GET_PRIVATE ((o), JANA_GTK_TYPE_EVENT_STORE, JanaGtkEventStorePrivate))
 
+#define EVENT_STORE_TYPE_RECORD (event_store_record_get_type ())
+
 typedef struct _JanaGtkEventStorePrivate JanaGtkEventStorePrivate;
 
 struct _JanaGtkEventStorePrivate
@@ -42,11 +70,145 @@ struct _JanaGtkEventStorePrivate
 	glong offset;
 };
 
+/* The descriptive fields of an event. These are the same for every instance
+ * of an event, so they're stored once and shared by all of its rows.
+ */
+typedef struct {
+	gint ref_count;
+
+	gchar *uid;
+	gchar *summary;
+	gchar *description;
+	gchar *location;
+	gchar **categories;
+	guint64 category_mask;
+	gboolean has_recurrences;
+	gboolean has_alarm;
+	JanaRecurrence *recur;
+
+	GList *iters;
+} EventStoreRecord;
+
+/* The columns of the underlying list store. Everything that isn't instance
+ * specific is looked up in the record when the public columns are read.
+ */
+enum {
+	STORE_COL_RECORD,
+	STORE_COL_START,
+	STORE_COL_END,
+	STORE_COL_FIRST_INSTANCE,
+	STORE_COL_LAST_INSTANCE,
+	STORE_COL_LAST
+};
+
 enum {
 	PROP_VIEW = 1,
 	PROP_OFFSET,
 };
 
+static GtkTreeModelIface *parent_tree_model_iface = NULL;
+
+static EventStoreRecord *
+event_store_record_new (gchar *uid)
+{
+	EventStoreRecord *record = g_slice_new0 (EventStoreRecord);
+
+	record->ref_count = 1;
+	record->uid = uid;
+
+	return record;
+}
+
+static void
+event_store_record_clear (EventStoreRecord *record)
+{
+	g_free (record->summary);
+	g_free (record->description);
+	g_free (record->location);
+	g_strfreev (record->categories);
+	if (record->recur) jana_recurrence_free (record->recur);
+}
+
+static void
+event_store_record_set_event (EventStoreRecord *record, JanaEvent *event)
+{
+	event_store_record_clear (record);
+
+	record->summary = g_strdup (jana_event_peek_summary (event));
+	record->description = g_strdup (jana_event_peek_description (event));
+	record->location = g_strdup (jana_event_peek_location (event));
+	record->categories = jana_event_get_categories (event);
+	record->category_mask = jana_utils_category_get_mask (
+		(const gchar **)record->categories);
+	record->has_recurrences = jana_event_has_recurrence (event);
+	record->has_alarm = jana_event_has_alarm (event);
+	record->recur = jana_event_get_recurrence (event);
+}
+
+static EventStoreRecord *
+event_store_record_ref (EventStoreRecord *record)
+{
+	record->ref_count ++;
+	return record;
+}
+
+static void
+event_store_record_unref (EventStoreRecord *record)
+{
+	if (--record->ref_count > 0) return;
+
+	event_store_record_clear (record);
+	g_free (record->uid);
+	g_slice_free (EventStoreRecord, record);
+}
+
+static GType
+event_store_record_get_type (void)
+{
+	static GType our_type = 0;
+
+	if (!our_type)
+		our_type = g_boxed_type_register_static (
+			"JanaGtkEventStoreRecord",
+			(GBoxedCopyFunc) event_store_record_ref,
+			(GBoxedFreeFunc) event_store_record_unref);
+
+	return our_type;
+}
+
+/* Frees the iters of a record when it's removed from the events hash. The
+ * record itself lives on until the last row referencing it is removed.
+ */
+static void
+event_store_record_destroy (gpointer data)
+{
+	EventStoreRecord *record = (EventStoreRecord *)data;
+
+	while (record->iters) {
+		g_slice_free (GtkTreeIter, record->iters->data);
+		record->iters = g_list_delete_link (
+			record->iters, record->iters);
+	}
+	event_store_record_unref (record);
+}
+
+static void
+event_store_insert_instance (JanaGtkEventStore *store,
+			     EventStoreRecord *record, JanaDuration *duration,
+			     gboolean first, gboolean last)
+{
+	GtkTreeIter *iter = g_slice_new (GtkTreeIter);
+
+	gtk_list_store_insert_with_values (GTK_LIST_STORE (store), iter, 0,
+		STORE_COL_RECORD, record,
+		STORE_COL_START, duration->start,
+		STORE_COL_END, duration->end,
+		STORE_COL_FIRST_INSTANCE, first,
+		STORE_COL_LAST_INSTANCE, last,
+		-1);
+	record->iters = g_list_append (record->iters, iter);
+}
+
 static void
 event_store_added_cb (JanaStoreView *view, GList *components,
 		      JanaGtkEventStore *store)
@@ -59,11 +221,10 @@ event_store_added_cb (JanaStoreView *view, GList *components,
 		&range_start, &range_end);
 
 	for (; components; components = components->next) {
-		gchar *uid, *summary, *description, *location, **categories;
+		EventStoreRecord *record;
 		JanaTime *start, *end;
-		JanaRecurrence *recur;
 		JanaEvent *event;
-		GList *instance, *instances, *iter_list = NULL;
+		GList *instance, *instances;
 		gint days, inst_days;
 		glong seconds;
 		
@@ -71,14 +232,11 @@ event_store_added_cb (JanaStoreView *view, GList *components,
 		    components->data)) != JANA_COMPONENT_EVENT) continue;
 		event = JANA_EVENT (components->data);
 		
-		uid = jana_component_get_uid (JANA_COMPONENT (event));
-		summary = jana_event_get_summary (event);
-		description = jana_event_get_description (event);
-		location = jana_event_get_location (event);
-		categories = jana_event_get_categories (event);
+		record = event_store_record_new (
+			jana_component_get_uid (JANA_COMPONENT (event)));
+		event_store_record_set_event (record, event);
 		start = jana_event_get_start (event);
 		end = jana_event_get_end (event);
-		recur = jana_event_get_recurrence (event);
 		
 		/* See how many days are between the start and the end so we
 		 * can set the first_instance and last_instance parameters 
@@ -93,8 +251,6 @@ event_store_added_cb (JanaStoreView *view, GList *components,
 			range_start, range_end, priv->offset);
 		for (instance = instances; instance; instance = instance->next){
 			JanaDuration *duration = (JanaDuration *)instance->data;
-			GtkTreeIter *iter = g_slice_new (GtkTreeIter);
-			iter_list = g_list_append (iter_list, iter);
 			gboolean first, last;
 			
 			if (inst_days == 0) first = TRUE;
@@ -105,40 +261,19 @@ event_store_added_cb (JanaStoreView *view, GList *components,
 			} else
 				last = FALSE;
 			
-			gtk_list_store_insert_with_values (
-				GTK_LIST_STORE (store), iter, 0,
-				JANA_GTK_EVENT_STORE_COL_UID, uid,
-				JANA_GTK_EVENT_STORE_COL_SUMMARY, summary,
-				JANA_GTK_EVENT_STORE_COL_DESCRIPTION,
-					description,
-				JANA_GTK_EVENT_STORE_COL_LOCATION, location,
-				JANA_GTK_EVENT_STORE_COL_CATEGORIES, categories,
-				JANA_GTK_EVENT_STORE_COL_START, duration->start,
-				JANA_GTK_EVENT_STORE_COL_END, duration->end,
-				JANA_GTK_EVENT_STORE_COL_FIRST_INSTANCE, first,
-				JANA_GTK_EVENT_STORE_COL_LAST_INSTANCE, last,
-				JANA_GTK_EVENT_STORE_COL_HAS_RECURRENCES,
-					jana_event_has_recurrence (event),
-				JANA_GTK_EVENT_STORE_COL_HAS_ALARM,
-					jana_event_has_alarm (event),
-				JANA_GTK_EVENT_STORE_COL_RECUR_TYPE, recur,
-				-1);
+			event_store_insert_instance (store, record, duration,
+				first, last);
 			
 			inst_days ++;
 		}
-		g_hash_table_insert (priv->events_hash,
-			(gpointer)uid, iter_list);
+		/* The hash table holds the initial reference on the record,
+		 * and its uid is used as the key.
+		 */
+		g_hash_table_replace (priv->events_hash, record->uid, record);
 		jana_utils_instance_list_free (instances);
 		
-		/* Don't free uid, it'll be freed by the hash table */
-		/*g_free (uid);*/
-		g_free (summary);
-		g_free (description);
-		g_free (location);
-		g_strfreev (categories);
 		g_object_unref (start);
 		g_object_unref (end);
-		jana_recurrence_free (recur);
 	}
 
 	if (range_start) g_object_unref (range_start);
@@ -156,38 +291,33 @@ event_store_modified_cb (JanaStoreView *view, GList *components,
 		&range_start, &range_end);
 
 	for (; components; components = components->next) {
-		GList *instance, *instances, *iter_list;
-		gchar *uid, *summary, *description, *location, **categories;
-		gpointer orig_uid, orig_list;
+		GList *instance, *instances;
+		EventStoreRecord *record;
 		JanaTime *start, *end;
-		JanaRecurrence *recur;
 		gint days, inst_days;
 		gint iter_count = 0;
 		GtkTreeIter *iter;
 		JanaEvent *event;
 		glong seconds;
+		gchar *uid;
 		
 		if (jana_component_get_component_type (components->data) !=
 		    JANA_COMPONENT_EVENT) continue;
 		event = JANA_EVENT (components->data);
 
 		uid = jana_component_get_uid (JANA_COMPONENT (event));
-
-		if (!g_hash_table_lookup_extended (
-		     priv->events_hash, uid, &orig_uid, &orig_list)) {
-			g_free (uid);
-			continue;
-		}
-		
-		iter_list = (GList *)orig_list;
+		record = (EventStoreRecord *)g_hash_table_lookup (
+			priv->events_hash, uid);
+		g_free (uid);
+		if (!record) continue;
 		
-		summary = jana_event_get_summary (event);
-		description = jana_event_get_description (event);
-		location = jana_event_get_location (event);
-		categories = jana_event_get_categories (event);
+		/* Every row shares the record, so updating it once updates
+		 * all of them. Setting each row's instance data below emits
+		 * row-changed so that views pick up the new fields.
+		 */
+		event_store_record_set_event (record, event);
 		start = jana_event_get_start (event);
 		end = jana_event_get_end (event);
-		recur = jana_event_get_recurrence (event);
 		
 		jana_utils_time_diff (start, end, NULL, NULL, &days,
 			NULL, NULL, &seconds);
@@ -214,89 +344,38 @@ event_store_modified_cb (JanaStoreView *view, GList *components,
 				last = FALSE;
 
 			iter = (GtkTreeIter *)g_list_nth_data (
-				iter_list, iter_count);
+				record->iters, iter_count);
 			
 			if (iter) {
 				/* Change row */
 				gtk_list_store_set (
 				    GTK_LIST_STORE (store), iter,
-				    JANA_GTK_EVENT_STORE_COL_UID, uid,
-				    JANA_GTK_EVENT_STORE_COL_SUMMARY,
-					summary,
-				    JANA_GTK_EVENT_STORE_COL_DESCRIPTION,
-					description,
-				    JANA_GTK_EVENT_STORE_COL_LOCATION,
-					location,
-				    JANA_GTK_EVENT_STORE_COL_CATEGORIES,
-					categories,
-				    JANA_GTK_EVENT_STORE_COL_START,
-					duration->start,
-				    JANA_GTK_EVENT_STORE_COL_END,
-					duration->end,
-				    JANA_GTK_EVENT_STORE_COL_FIRST_INSTANCE,
-					first,
-				    JANA_GTK_EVENT_STORE_COL_LAST_INSTANCE,
-					last,
-				    JANA_GTK_EVENT_STORE_COL_HAS_RECURRENCES,
-					jana_event_has_recurrence (event),
-				    JANA_GTK_EVENT_STORE_COL_HAS_ALARM,
-					jana_event_has_alarm (event),
-				    JANA_GTK_EVENT_STORE_COL_RECUR_TYPE,
-					recur, -1);
+				    STORE_COL_START, duration->start,
+				    STORE_COL_END, duration->end,
+				    STORE_COL_FIRST_INSTANCE, first,
+				    STORE_COL_LAST_INSTANCE, last,
+				    -1);
 			} else {
 				/* Add new row */
-				iter = g_slice_new (GtkTreeIter);
-				gtk_list_store_insert_with_values (
-				    GTK_LIST_STORE (store), iter, 0,
-				    JANA_GTK_EVENT_STORE_COL_UID, uid,
-				    JANA_GTK_EVENT_STORE_COL_SUMMARY,
-					summary,
-				    JANA_GTK_EVENT_STORE_COL_DESCRIPTION,
-					description,
-				    JANA_GTK_EVENT_STORE_COL_LOCATION,
-					location,
-				    JANA_GTK_EVENT_STORE_COL_CATEGORIES,
-					categories,
-				    JANA_GTK_EVENT_STORE_COL_START,
-					duration->start,
-				    JANA_GTK_EVENT_STORE_COL_END,
-					duration->end,
-				    JANA_GTK_EVENT_STORE_COL_FIRST_INSTANCE,
-					first,
-				    JANA_GTK_EVENT_STORE_COL_LAST_INSTANCE,
-					last,
-				    JANA_GTK_EVENT_STORE_COL_HAS_RECURRENCES,
-					jana_event_has_recurrence (event),
-				    JANA_GTK_EVENT_STORE_COL_HAS_ALARM,
-					jana_event_has_alarm (event),
-				    JANA_GTK_EVENT_STORE_COL_RECUR_TYPE,
-					recur, -1);
-				iter_list = g_list_append (iter_list, iter);
+				event_store_insert_instance (store, record,
+					duration, first, last);
 			}
 			iter_count ++;
 			inst_days ++;
 		}
 		/* Trim off instances if there are too many */
-		while ((instance = g_list_nth (iter_list, iter_count))) {
+		while ((instance = g_list_nth (record->iters, iter_count))) {
 			iter = (GtkTreeIter *)instance->data;
 			gtk_list_store_remove (
 				GTK_LIST_STORE (store), iter);
 			g_slice_free (GtkTreeIter, iter);
-			iter_list = g_list_delete_link (iter_list, instance);
+			record->iters = g_list_delete_link (
+				record->iters, instance);
 		}
 		jana_utils_instance_list_free (instances);
 		
-		g_hash_table_steal (priv->events_hash, orig_uid);
-		g_free (orig_uid);
-		g_hash_table_insert (priv->events_hash, uid, iter_list);
-		
-		g_free (summary);
-		g_free (description);
-		g_free (location);
-		g_strfreev (categories);
 		g_object_unref (start);
 		g_object_unref (end);
-		jana_recurrence_free (recur);
 	}
 
 	if (range_start) g_object_unref (range_start);
@@ -311,13 +390,15 @@ event_store_removed_cb (JanaStoreView *view, GList *uids,
 
 	for (; uids; uids = uids->next) {
 		const gchar *uid = (const gchar *)uids->data;
+		EventStoreRecord *record;
 		GList *iter_list;
 		
-		iter_list = (GList *)g_hash_table_lookup (
+		record = (EventStoreRecord *)g_hash_table_lookup (
 			priv->events_hash, uid);
-		if (!iter_list) continue;
+		if (!record) continue;
 		
-		for (; iter_list; iter_list = iter_list->next) {
+		for (iter_list = record->iters; iter_list;
+		     iter_list = iter_list->next) {
 			GtkTreeIter *iter = (GtkTreeIter *)iter_list->data;
 			gtk_list_store_remove (GTK_LIST_STORE (store), iter);
 		}
@@ -325,6 +406,116 @@ event_store_removed_cb (JanaStoreView *view, GList *uids,
 	}
 }
 
+static gint
+event_store_get_n_columns (GtkTreeModel *model)
+{
+	return JANA_GTK_EVENT_STORE_COL_LAST;
+}
+
+static GType
+event_store_get_column_type (GtkTreeModel *model, gint index)
+{
+	switch (index) {
+	    case JANA_GTK_EVENT_STORE_COL_UID :
+	    case JANA_GTK_EVENT_STORE_COL_SUMMARY :
+	    case JANA_GTK_EVENT_STORE_COL_DESCRIPTION :
+	    case JANA_GTK_EVENT_STORE_COL_LOCATION :
+		return G_TYPE_STRING;
+	    case JANA_GTK_EVENT_STORE_COL_CATEGORIES :
+		return G_TYPE_STRV;
+	    case JANA_GTK_EVENT_STORE_COL_START :
+	    case JANA_GTK_EVENT_STORE_COL_END :
+		return G_TYPE_OBJECT;
+	    case JANA_GTK_EVENT_STORE_COL_FIRST_INSTANCE :
+	    case JANA_GTK_EVENT_STORE_COL_LAST_INSTANCE :
+	    case JANA_GTK_EVENT_STORE_COL_HAS_RECURRENCES :
+	    case JANA_GTK_EVENT_STORE_COL_HAS_ALARM :
+		return G_TYPE_BOOLEAN;
+	    case JANA_GTK_EVENT_STORE_COL_RECUR_TYPE :
+		return JANA_TYPE_RECURRENCE;
+	    case JANA_GTK_EVENT_STORE_COL_CATEGORY_MASK :
+		return G_TYPE_UINT64;
+	    default :
+		g_warning ("Invalid column %d", index);
+		return G_TYPE_INVALID;
+	}
+}
+
+static void
+event_store_get_value (GtkTreeModel *model, GtkTreeIter *iter, gint column,
+		       GValue *value)
+{
+	GValue record_value = { 0, };
+	EventStoreRecord *record;
+
+	/* Instance data is stored in the list store itself */
+	switch (column) {
+	    case JANA_GTK_EVENT_STORE_COL_START :
+		parent_tree_model_iface->get_value (model, iter,
+			STORE_COL_START, value);
+		return;
+	    case JANA_GTK_EVENT_STORE_COL_END :
+		parent_tree_model_iface->get_value (model, iter,
+			STORE_COL_END, value);
+		return;
+	    case JANA_GTK_EVENT_STORE_COL_FIRST_INSTANCE :
+		parent_tree_model_iface->get_value (model, iter,
+			STORE_COL_FIRST_INSTANCE, value);
+		return;
+	    case JANA_GTK_EVENT_STORE_COL_LAST_INSTANCE :
+		parent_tree_model_iface->get_value (model, iter,
+			STORE_COL_LAST_INSTANCE, value);
+		return;
+	}
+
+	parent_tree_model_iface->get_value (model, iter,
+		STORE_COL_RECORD, &record_value);
+	record = (EventStoreRecord *)g_value_get_boxed (&record_value);
+
+	g_value_init (value, event_store_get_column_type (model, column));
+	if (record) switch (column) {
+	    case JANA_GTK_EVENT_STORE_COL_UID :
+		g_value_set_string (value, record->uid);
+		break;
+	    case JANA_GTK_EVENT_STORE_COL_SUMMARY :
+		g_value_set_string (value, record->summary);
+		break;
+	    case JANA_GTK_EVENT_STORE_COL_DESCRIPTION :
+		g_value_set_string (value, record->description);
+		break;
+	    case JANA_GTK_EVENT_STORE_COL_LOCATION :
+		g_value_set_string (value, record->location);
+		break;
+	    case JANA_GTK_EVENT_STORE_COL_CATEGORIES :
+		g_value_set_boxed (value, record->categories);
+		break;
+	    case JANA_GTK_EVENT_STORE_COL_HAS_RECURRENCES :
+		g_value_set_boolean (value, record->has_recurrences);
+		break;
+	    case JANA_GTK_EVENT_STORE_COL_HAS_ALARM :
+		g_value_set_boolean (value, record->has_alarm);
+		break;
+	    case JANA_GTK_EVENT_STORE_COL_RECUR_TYPE :
+		g_value_set_boxed (value, record->recur);
+		break;
+	    case JANA_GTK_EVENT_STORE_COL_CATEGORY_MASK :
+		g_value_set_uint64 (value, record->category_mask);
+		break;
+	}
+
+	g_value_unset (&record_value);
+}
+
+static void
+event_store_tree_model_init (GtkTreeModelIface *iface)
+{
+	parent_tree_model_iface = g_type_interface_peek_parent (iface);
+
+	iface->get_n_columns = event_store_get_n_columns;
+	iface->get_column_type = event_store_get_column_type;
+	iface->get_value = event_store_get_value;
+}
+
 static void
 jana_gtk_event_store_get_property (GObject *object, guint property_id,
 				    GValue *value, GParamSpec *pspec)
@@ -455,41 +646,112 @@ jana_gtk_event_store_compare (GtkTreeModel *model, GtkTreeIter *a,
 	return result;
 }
 
-void
-event_store_free_iter_list (gpointer data)
+/* GtkListStore only knows about the internal columns, so its default sort
+ * functions would compare the wrong values. Every public column gets this
+ * one instead, falling back to the start order for equal values.
+ */
+static gint
+jana_gtk_event_store_compare_column (GtkTreeModel *model, GtkTreeIter *a,
+				     GtkTreeIter *b, gpointer user_data)
 {
-	GList *iter_list = (GList *)data;
+	GValue value1 = { 0, }, value2 = { 0, };
+	gint column = GPOINTER_TO_INT (user_data);
+	gint result = 0;
+	
+	gtk_tree_model_get_value (model, a, column, &value1);
+	gtk_tree_model_get_value (model, b, column, &value2);
 	
-	while (iter_list) {
-		g_slice_free (GtkTreeIter, iter_list->data);
-		iter_list = g_list_delete_link (iter_list, iter_list);
+	switch (column) {
+	    case JANA_GTK_EVENT_STORE_COL_UID :
+	    case JANA_GTK_EVENT_STORE_COL_SUMMARY :
+	    case JANA_GTK_EVENT_STORE_COL_DESCRIPTION :
+	    case JANA_GTK_EVENT_STORE_COL_LOCATION : {
+		const gchar *string1 = g_value_get_string (&value1);
+		const gchar *string2 = g_value_get_string (&value2);
+		if (string1 && string2)
+			result = g_utf8_collate (string1, string2);
+		else
+			result = (string1 ? 1 : 0) - (string2 ? 1 : 0);
+		break;
+	    }
+	    case JANA_GTK_EVENT_STORE_COL_CATEGORIES : {
+		/* Order by the first category */
+		gchar **categories1 = g_value_get_boxed (&value1);
+		gchar **categories2 = g_value_get_boxed (&value2);
+		const gchar *string1 = categories1 ? categories1[0] : NULL;
+		const gchar *string2 = categories2 ? categories2[0] : NULL;
+		if (string1 && string2)
+			result = g_utf8_collate (string1, string2);
+		else
+			result = (string1 ? 1 : 0) - (string2 ? 1 : 0);
+		break;
+	    }
+	    case JANA_GTK_EVENT_STORE_COL_START :
+	    case JANA_GTK_EVENT_STORE_COL_END : {
+		JanaTime *time1 = g_value_get_object (&value1);
+		JanaTime *time2 = g_value_get_object (&value2);
+		if (time1 && time2)
+			result = jana_utils_time_compare (time1, time2, FALSE);
+		else
+			result = (time1 ? 1 : 0) - (time2 ? 1 : 0);
+		break;
+	    }
+	    case JANA_GTK_EVENT_STORE_COL_FIRST_INSTANCE :
+	    case JANA_GTK_EVENT_STORE_COL_LAST_INSTANCE :
+	    case JANA_GTK_EVENT_STORE_COL_HAS_RECURRENCES :
+	    case JANA_GTK_EVENT_STORE_COL_HAS_ALARM :
+		result = (g_value_get_boolean (&value1) ? 1 : 0) -
+			(g_value_get_boolean (&value2) ? 1 : 0);
+		break;
+	    case JANA_GTK_EVENT_STORE_COL_RECUR_TYPE : {
+		/* Order by recurrence type, non-recurring events first */
+		JanaRecurrence *recur1 = g_value_get_boxed (&value1);
+		JanaRecurrence *recur2 = g_value_get_boxed (&value2);
+		result = (recur1 ? (gint)recur1->type + 1 : 0) -
+			(recur2 ? (gint)recur2->type + 1 : 0);
+		break;
+	    }
+	    case JANA_GTK_EVENT_STORE_COL_CATEGORY_MASK : {
+		guint64 mask1 = g_value_get_uint64 (&value1);
+		guint64 mask2 = g_value_get_uint64 (&value2);
+		result = (mask1 > mask2) ? 1 : ((mask1 < mask2) ? -1 : 0);
+		break;
+	    }
 	}
+	
+	g_value_unset (&value1);
+	g_value_unset (&value2);
+	
+	if (result == 0)
+		result = jana_gtk_event_store_compare (model, a, b, model);
+	
+	return result;
 }
 
 static void
 jana_gtk_event_store_init (JanaGtkEventStore *self)
 {
+	gint i;
+
 	JanaGtkEventStorePrivate *priv = EVENT_STORE_PRIVATE (self);
 
 	priv->view = NULL;
+	/* Keys are owned by the records */
 	priv->events_hash = g_hash_table_new_full (g_str_hash, g_str_equal,
-		g_free, event_store_free_iter_list);
+		NULL, event_store_record_destroy);
 	
 	gtk_list_store_set_column_types (GTK_LIST_STORE (self),
-		JANA_GTK_EVENT_STORE_COL_LAST,
-		(GType []){G_TYPE_STRING,	/* UID */
-			   G_TYPE_STRING,	/* SUMMARY */
-			   G_TYPE_STRING,	/* DESCRIPTION */
-			   G_TYPE_STRING,	/* LOCATION */
-			   G_TYPE_STRV,		/* CATEGORIES */
-			   G_TYPE_OBJECT,	/* START */
-			   G_TYPE_OBJECT,	/* END */
-			   G_TYPE_BOOLEAN,	/* FIRST_INSTANCE */
-			   G_TYPE_BOOLEAN,	/* LAST_INSTANCE */
-			   G_TYPE_BOOLEAN,	/* HAS_RECURRENCES */
-			   G_TYPE_BOOLEAN,	/* HAS_ALARM */
-			   JANA_TYPE_RECURRENCE,/* RECUR_TYPE */
+		STORE_COL_LAST,
+		(GType []){EVENT_STORE_TYPE_RECORD,	/* RECORD */
+			   G_TYPE_OBJECT,		/* START */
+			   G_TYPE_OBJECT,		/* END */
+			   G_TYPE_BOOLEAN,		/* FIRST_INSTANCE */
+			   G_TYPE_BOOLEAN,		/* LAST_INSTANCE */
 		});
+	for (i = 0; i < JANA_GTK_EVENT_STORE_COL_LAST; i++)
+		gtk_tree_sortable_set_sort_func (GTK_TREE_SORTABLE (self), i,
+			jana_gtk_event_store_compare_column,
+			GINT_TO_POINTER (i), NULL);
 	gtk_tree_sortable_set_sort_func (GTK_TREE_SORTABLE (self),
 		JANA_GTK_EVENT_STORE_COL_START, jana_gtk_event_store_compare,
 		self, NULL);
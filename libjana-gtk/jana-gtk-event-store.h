@@ -70,6 +70,7 @@ enum {
 	JANA_GTK_EVENT_STORE_COL_HAS_RECURRENCES,
 	JANA_GTK_EVENT_STORE_COL_HAS_ALARM,
 	JANA_GTK_EVENT_STORE_COL_RECUR_TYPE,
+	JANA_GTK_EVENT_STORE_COL_CATEGORY_MASK,
 	JANA_GTK_EVENT_STORE_COL_LAST
 };
 
@@ -22,6 +22,7 @@
 #include <locale.h>
 #include <langinfo.h>
 #include <libjana-gtk/jana-gtk-tree-layout.h>
+#include <libjana-gtk/jana-gtk-utils.h>
 #include <libjana/jana-utils.h>
 #include "jana-gtk-month-view.h"
 
@@ -49,6 +50,23 @@ struct _JanaGtkMonthViewPrivate
 	gchar *style_hint;
 	guint spacing;
 	JanaTime *highlighted_time;
+
+	GList *stores;
+	/* Store -> GPtrArray of MonthViewRow, by row number */
+	GHashTable *rows;
+	GtkTreeModelFilterVisibleFunc visible_cb;
+	gpointer visible_data;
+	GList **days;
+	gboolean *dirty_days;
+	gint *hidden_events;
+	gint n_days;
+	gint month_offset;
+
+	GdkPixmap *background;
+	gint col0_width;
+	gint row0_height;
+	gint col_width;
+	gint row_height;
 };
 
 enum {
@@ -66,7 +84,29 @@ enum {
 
 static guint signals[LAST_SIGNAL] = { 0 };
 
+/* An event in a day bucket. Only visible events take a place in the day
+ * box or count towards its overflow.
+ */
+typedef struct {
+	GtkTreeRowReference *row;
+	gint day;
+	gboolean visible;
+} MonthViewRow;
+
 static void relayout (JanaGtkMonthView *self);
+static void free_background (JanaGtkMonthView *self);
+static void free_days (JanaGtkMonthView *self);
+static gint compare_rows (GtkTreeRowReference *row_a,
+			  GtkTreeRowReference *row_b);
+static void row_changed_cb (GtkTreeModel *tree_model, GtkTreePath *path,
+			    GtkTreeIter *iter, JanaGtkMonthView *self);
+static void row_inserted_cb (GtkTreeModel *tree_model, GtkTreePath *path,
+			     GtkTreeIter *iter, JanaGtkMonthView *self);
+static void row_deleted_cb (GtkTreeModel *tree_model, GtkTreePath *path,
+			    JanaGtkMonthView *self);
+static void rows_reordered_cb (GtkTreeModel *tree_model, GtkTreePath *path,
+			       GtkTreeIter *iter, gint *new_order,
+			       JanaGtkMonthView *self);
 
 
 static void
@@ -123,6 +163,7 @@ jana_gtk_month_view_set_property (GObject *object, guint property_id,
 			priv->style_hint = NULL;
 		}
 		priv->style_hint = g_value_dup_string (value);
+		free_background (JANA_GTK_MONTH_VIEW (object));
 		gtk_widget_queue_draw (GTK_WIDGET (object));
 		break;
 	    case PROP_SELECTION :
@@ -144,11 +185,27 @@ jana_gtk_month_view_dispose (GObject *object)
 {
 	JanaGtkMonthViewPrivate *priv = MONTH_VIEW_PRIVATE (object);
 
+	jana_gtk_utils_cancel_updates (object);
+
 	if (priv->event_renderer) {
 		g_object_unref (priv->event_renderer);
 		priv->event_renderer = NULL;
 	}
 	
+	while (priv->stores) {
+		GObject *store = (GObject *)priv->stores->data;
+		g_signal_handlers_disconnect_by_func (
+			store, row_inserted_cb, object);
+		g_signal_handlers_disconnect_by_func (
+			store, row_changed_cb, object);
+		g_signal_handlers_disconnect_by_func (
+			store, row_deleted_cb, object);
+		g_signal_handlers_disconnect_by_func (
+			store, rows_reordered_cb, object);
+		g_object_unref (store);
+		priv->stores = g_list_delete_link (priv->stores, priv->stores);
+	}
+	
 	if (G_OBJECT_CLASS (jana_gtk_month_view_parent_class)->dispose)
 		G_OBJECT_CLASS (jana_gtk_month_view_parent_class)->
 			dispose (object);
@@ -188,26 +245,41 @@ jana_gtk_month_view_finalize (GObject *object)
 		g_free (priv->style_hint);
 		priv->style_hint = NULL;
 	}
+	
+	free_background (JANA_GTK_MONTH_VIEW (object));
+	free_days (JANA_GTK_MONTH_VIEW (object));
+	g_hash_table_destroy (priv->rows);
 
 	G_OBJECT_CLASS (jana_gtk_month_view_parent_class)->finalize (object);
 }
 
-static gboolean
-jana_gtk_month_view_expose_event (GtkWidget *widget, GdkEventExpose *event)
+static void
+free_background (JanaGtkMonthView *self)
+{
+	JanaGtkMonthViewPrivate *priv = MONTH_VIEW_PRIVATE (self);
+	
+	if (priv->background) {
+		g_object_unref (priv->background);
+		priv->background = NULL;
+	}
+}
+
+/* Paints the grid, the month, day and week labels and the out-of-month
+ * days into a pixmap. They only change with the month, size or style, so
+ * exposes just copy it and draw the selection and date labels on top.
+ */
+static void
+paint_background (JanaGtkMonthView *self, GdkDrawable *drawable)
 {
 	JanaTime *time;
 	gint week;
-	gint x, y, box_y, row0_height, row_height = 0,
-		col0_width, col_width = 0;
+	gint x, y, box_y;
 	GtkStyle *dark_style, *light_style, *style;
 	PangoLayout *layout;
-	JanaGtkMonthViewPrivate *priv = MONTH_VIEW_PRIVATE (widget);
-	
-	if (!priv->month) return FALSE;
+	GtkWidget *widget = GTK_WIDGET (self);
+	JanaGtkMonthViewPrivate *priv = MONTH_VIEW_PRIVATE (self);
 	
-	/* Draw background */
 	box_y = 0;
-	row_height = widget->allocation.height / (priv->visible_weeks + 1);
 
 	layout = gtk_widget_create_pango_layout (widget, NULL);
 
@@ -235,44 +307,12 @@ jana_gtk_month_view_expose_event (GtkWidget *widget, GdkEventExpose *event)
 			
 			if (y == 0) {
 				if (x == 0) {
-					guint top, left;
-					
 					/* Month label */
 					pango_layout_set_text (layout,
 						nl_langinfo (ABMON_1 +
 							(jana_time_get_month (
 							 priv->month) - 1)),
 						-1);
-					
-					pango_layout_get_pixel_size (
-						layout, &col0_width,
-						&row0_height);
-					
-					/* The first column/row will fit to the
-					 * text size (+ spacing)
-					 */
-					col0_width += priv->spacing * 2;
-					row0_height += priv->spacing * 2;
-					col_width = (widget->allocation.width -
-						col0_width) / 7;
-					row_height = (widget->allocation.height-
-						row0_height) /
-						priv->visible_weeks;
-					
-					/* Align the tree layout to the events
-					 * area.
-					 */
-					gtk_alignment_get_padding (
-						GTK_ALIGNMENT (priv->alignment),
-						&top, NULL, &left, NULL);
-					if ((top != row0_height) ||
-					    (left != col0_width)) {
-						gtk_alignment_set_padding (
-							GTK_ALIGNMENT (priv->
-								alignment),
-							row0_height, 0,
-							col0_width, 0);
-					}
 				} else {
 					/* Day label */
 					pango_layout_set_text (layout,
@@ -289,12 +329,8 @@ jana_gtk_month_view_expose_event (GtkWidget *widget, GdkEventExpose *event)
 				 * the month (and if not, set insensitive),
 				 * and increment day.
 				 */
-				if ((priv->selection) &&
-				    (jana_utils_time_compare (time,
-				     priv->selection, TRUE) == 0)) {
-					state = GTK_STATE_SELECTED;
-				} else if (jana_time_get_month (time) !=
-					   jana_time_get_month (priv->month)) {
+				if (jana_time_get_month (time) !=
+				    jana_time_get_month (priv->month)) {
 					state = GTK_STATE_INSENSITIVE;
 				}
 
@@ -307,19 +343,19 @@ jana_gtk_month_view_expose_event (GtkWidget *widget, GdkEventExpose *event)
 				style = dark_style;
 			}
 			
-			if (x == 0) box_width = col0_width;
-			else box_width = col_width;
-			if (y == 0) box_height = row0_height;
-			else box_height = row_height;
+			if (x == 0) box_width = priv->col0_width;
+			else box_width = priv->col_width;
+			if (y == 0) box_height = priv->row0_height;
+			else box_height = priv->row_height;
 			
-			gtk_paint_flat_box (style, widget->window,
+			gtk_paint_flat_box (style, (GdkWindow *)drawable,
 				state, shadow,
-				&event->area, widget, priv->style_hint,
+				NULL, widget, priv->style_hint,
 				box_x, box_y,
 				box_width, box_height);
-			gtk_paint_shadow (style, widget->window,
+			gtk_paint_shadow (style, (GdkWindow *)drawable,
 				state, shadow,
-				&event->area, widget, priv->style_hint,
+				NULL, widget, priv->style_hint,
 				box_x, box_y,
 				box_width, box_height);
 			
@@ -327,8 +363,8 @@ jana_gtk_month_view_expose_event (GtkWidget *widget, GdkEventExpose *event)
 				layout, &text_width, &text_height);
 			
 			if ((x == 0) || (y == 0))
-				gtk_paint_layout (style, widget->window,
-					state, FALSE, &event->area,
+				gtk_paint_layout (style, (GdkWindow *)drawable,
+					state, FALSE, NULL,
 					widget, priv->style_hint,
 					box_x + (box_width / 2) -
 						  (text_width / 2),
@@ -341,6 +377,152 @@ jana_gtk_month_view_expose_event (GtkWidget *widget, GdkEventExpose *event)
 		box_y += box_height;
 	}
 	gtk_style_detach (dark_style);
+	gtk_style_detach (light_style);
+
+	g_object_unref (layout);
+	g_object_unref (time);
+}
+
+/* The first column/row will fit to the month label size (+ spacing) */
+static void
+measure_headers (JanaGtkMonthView *self)
+{
+	gint text_width, text_height;
+	PangoLayout *layout;
+	JanaGtkMonthViewPrivate *priv = MONTH_VIEW_PRIVATE (self);
+	
+	layout = gtk_widget_create_pango_layout (GTK_WIDGET (self),
+		nl_langinfo (ABMON_1 +
+			(jana_time_get_month (priv->month) - 1)));
+	pango_layout_get_pixel_size (layout, &text_width, &text_height);
+	g_object_unref (layout);
+	
+	priv->col0_width = text_width + (priv->spacing * 2);
+	priv->row0_height = text_height + (priv->spacing * 2);
+}
+
+/* Aligns the tree layout to the events area. This changes the size of the
+ * layout, so it's queued rather than done while drawing.
+ */
+static void
+update_padding (JanaGtkMonthView *self)
+{
+	guint top, left;
+	JanaGtkMonthViewPrivate *priv = MONTH_VIEW_PRIVATE (self);
+	
+	if (!priv->month) return;
+	
+	measure_headers (self);
+	gtk_alignment_get_padding (GTK_ALIGNMENT (priv->alignment),
+		&top, NULL, &left, NULL);
+	if ((top != priv->row0_height) || (left != priv->col0_width)) {
+		gtk_alignment_set_padding (GTK_ALIGNMENT (priv->alignment),
+			priv->row0_height, 0, priv->col0_width, 0);
+	}
+}
+
+static void
+style_set_cb (GtkWidget *widget, GtkStyle *previous_style,
+	      gpointer user_data)
+{
+	jana_gtk_utils_queue_update (widget,
+		(JanaGtkUtilsUpdateFunc)update_padding);
+}
+
+static void
+update_background (JanaGtkMonthView *self)
+{
+	GtkWidget *widget = GTK_WIDGET (self);
+	JanaGtkMonthViewPrivate *priv = MONTH_VIEW_PRIVATE (self);
+	
+	if (priv->background) {
+		gint width, height;
+		
+		gdk_drawable_get_size (priv->background, &width, &height);
+		if ((width == widget->allocation.width) &&
+		    (height == widget->allocation.height) &&
+		    (g_object_get_data (G_OBJECT (priv->background),
+		     "style") == widget->style))
+			return;
+		free_background (self);
+	}
+	
+	measure_headers (self);
+	priv->col_width = (widget->allocation.width - priv->col0_width) / 7;
+	priv->row_height = (widget->allocation.height - priv->row0_height) /
+		priv->visible_weeks;
+	
+	priv->background = gdk_pixmap_new (widget->window,
+		MAX (widget->allocation.width, 1),
+		MAX (widget->allocation.height, 1), -1);
+	g_object_set_data_full (G_OBJECT (priv->background), "style",
+		g_object_ref (widget->style), g_object_unref);
+	
+	paint_background (self, priv->background);
+}
+
+static gboolean
+jana_gtk_month_view_expose_event (GtkWidget *widget, GdkEventExpose *event)
+{
+	JanaTime *time;
+	gint x, y, row0_height, row_height, col0_width, col_width;
+	GtkStyle *light_style;
+	PangoLayout *layout;
+	JanaGtkMonthViewPrivate *priv = MONTH_VIEW_PRIVATE (widget);
+	
+	if (!priv->month) return FALSE;
+	
+	/* Draw background */
+	update_background (JANA_GTK_MONTH_VIEW (widget));
+	gdk_draw_drawable (widget->window,
+		widget->style->fg_gc[GTK_WIDGET_STATE (widget)],
+		priv->background, event->area.x, event->area.y,
+		event->area.x, event->area.y,
+		event->area.width, event->area.height);
+	
+	col0_width = priv->col0_width;
+	row0_height = priv->row0_height;
+	col_width = priv->col_width;
+	row_height = priv->row_height;
+
+	layout = gtk_widget_create_pango_layout (widget, NULL);
+
+	light_style = gtk_style_copy (widget->style);
+	light_style->bg[GTK_STATE_NORMAL] = light_style->base[GTK_STATE_NORMAL];
+	light_style->bg[GTK_STATE_SELECTED] =
+		light_style->base[GTK_STATE_SELECTED];
+	light_style = gtk_style_attach (light_style, widget->window);
+	
+	time = jana_time_duplicate (priv->start);
+	
+	/* Draw the selected day box */
+	if (priv->selection) {
+		for (y = 0; y < priv->visible_weeks; y++) {
+			for (x = 0; x < 7; x++) {
+				if (jana_utils_time_compare (time,
+				    priv->selection, TRUE) == 0) {
+					gtk_paint_flat_box (light_style,
+						widget->window,
+						GTK_STATE_SELECTED,
+						GTK_SHADOW_IN, &event->area,
+						widget, priv->style_hint,
+						col0_width + (x * col_width),
+						row0_height + (y * row_height),
+						col_width, row_height);
+					gtk_paint_shadow (light_style,
+						widget->window,
+						GTK_STATE_SELECTED,
+						GTK_SHADOW_IN, &event->area,
+						widget, priv->style_hint,
+						col0_width + (x * col_width),
+						row0_height + (y * row_height),
+						col_width, row_height);
+				}
+				jana_time_set_day (time,
+					jana_time_get_day (time) + 1);
+			}
+		}
+	}
 	
 	GTK_WIDGET_CLASS (jana_gtk_month_view_parent_class)->
 		expose_event (widget, event);
@@ -388,6 +570,27 @@ jana_gtk_month_view_expose_event (GtkWidget *widget, GdkEventExpose *event)
 					(row_height / 2) - (text_height / 2),
 				layout);
 			
+			/* Count of events that didn't fit in the box */
+			if (priv->hidden_events &&
+			    priv->hidden_events[(y * 7) + x]) {
+				gchar *more = g_strdup_printf (
+					"<small>+%d</small>",
+					priv->hidden_events[(y * 7) + x]);
+				pango_layout_set_markup (layout, more, -1);
+				g_free (more);
+				
+				pango_layout_get_pixel_size (
+					layout, &text_width, &text_height);
+				gtk_paint_layout (light_style, widget->window,
+					state, TRUE, &event->area,
+					widget, priv->style_hint,
+					((x + 1) * col_width) + col0_width -
+						text_width - priv->spacing,
+					((y + 1) * row_height) + row0_height -
+						text_height - priv->spacing,
+					layout);
+			}
+			
 			jana_time_set_day (time,
 				jana_time_get_day (time) + 1);
 		}
@@ -400,129 +603,331 @@ jana_gtk_month_view_expose_event (GtkWidget *widget, GdkEventExpose *event)
 	return FALSE;
 }
 
+/* Events are kept in a bucket per visible day, sorted by start time, so
+ * a change only needs the days it touched laying out again. Only the
+ * events that fit in a day box get a cell. Each store also has an index
+ * of its bucketed rows by row number, shifted along with the rows, so
+ * that a changed or deleted row finds its bucket directly.
+ */
+static void
+free_row_index (GPtrArray *rows)
+{
+	g_ptr_array_free (rows, TRUE);
+}
+
 static void
-relayout (JanaGtkMonthView *self)
+free_days (JanaGtkMonthView *self)
 {
-	gint x, y, width, height;
-	JanaTime *time;
-	GList *cell, *cells;
+	gint i;
+	JanaGtkMonthViewPrivate *priv = MONTH_VIEW_PRIVATE (self);
+	
+	g_hash_table_remove_all (priv->rows);
+	
+	if (!priv->days) return;
+	
+	for (i = 0; i < priv->n_days; i++) {
+		while (priv->days[i]) {
+			MonthViewRow *mrow = (MonthViewRow *)
+				priv->days[i]->data;
+			gtk_tree_row_reference_free (mrow->row);
+			g_slice_free (MonthViewRow, mrow);
+			priv->days[i] = g_list_delete_link (priv->days[i],
+				priv->days[i]);
+		}
+	}
+	g_free (priv->days);
+	g_free (priv->dirty_days);
+	g_free (priv->hidden_events);
+	priv->days = NULL;
+	priv->dirty_days = NULL;
+	priv->hidden_events = NULL;
+	priv->n_days = 0;
+}
+
+static gint
+get_day_index (JanaGtkMonthView *self, JanaTime *time)
+{
+	GDate *first, *date;
+	gint day;
+	JanaGtkMonthViewPrivate *priv = MONTH_VIEW_PRIVATE (self);
+	
+	first = jana_utils_time_to_gdate (priv->start);
+	date = jana_utils_time_to_gdate (time);
+	day = g_date_days_between (first, date);
+	g_date_free (first);
+	g_date_free (date);
+	
+	return ((day >= 0) && (day < priv->n_days)) ? day : -1;
+}
+
+static gint
+compare_month_rows (MonthViewRow *mrow_a, MonthViewRow *mrow_b)
+{
+	return compare_rows (mrow_a->row, mrow_b->row);
+}
+
+/* Takes the bucketed row at @path out of the index of @model. If @deleted,
+ * the rows after it move up to close the gap.
+ */
+static MonthViewRow *
+take_row (JanaGtkMonthView *self, GtkTreeModel *model, GtkTreePath *path,
+	  gboolean deleted)
+{
+	GPtrArray *rows;
+	MonthViewRow *mrow;
+	guint n = gtk_tree_path_get_indices (path)[0];
+	JanaGtkMonthViewPrivate *priv = MONTH_VIEW_PRIVATE (self);
+	
+	if (!(rows = g_hash_table_lookup (priv->rows, model))) return NULL;
+	if (n >= rows->len) return NULL;
+	
+	if (deleted) return g_ptr_array_remove_index (rows, n);
+	
+	mrow = g_ptr_array_index (rows, n);
+	g_ptr_array_index (rows, n) = NULL;
+	
+	return mrow;
+}
+
+static void
+bucket_row (JanaGtkMonthView *self, GtkTreeModel *model, GtkTreePath *path,
+	    GtkTreeIter *iter)
+{
+	gint day;
+	guint n;
+	JanaTime *start;
+	GPtrArray *rows;
+	MonthViewRow *mrow;
 	JanaGtkMonthViewPrivate *priv = MONTH_VIEW_PRIVATE (self);
+	
+	if (!priv->days) return;
+	
+	gtk_tree_model_get (model, iter,
+		JANA_GTK_EVENT_STORE_COL_START, &start, -1);
+	if (!start) return;
+	day = get_day_index (self, start);
+	g_object_unref (start);
+	if (day < 0) return;
+	
+	mrow = g_slice_new (MonthViewRow);
+	mrow->row = gtk_tree_row_reference_new (model, path);
+	mrow->day = day;
+	mrow->visible = priv->visible_cb ?
+		priv->visible_cb (model, iter, priv->visible_data) : TRUE;
+	
+	priv->days[day] = g_list_insert_sorted (priv->days[day], mrow,
+		(GCompareFunc)compare_month_rows);
+	priv->dirty_days[day] = TRUE;
+	
+	if (!(rows = g_hash_table_lookup (priv->rows, model))) {
+		rows = g_ptr_array_new ();
+		g_hash_table_insert (priv->rows, model, rows);
+	}
+	n = gtk_tree_path_get_indices (path)[0];
+	if (n >= rows->len) g_ptr_array_set_size (rows, n + 1);
+	g_ptr_array_index (rows, n) = mrow;
+}
+
+/* Takes @mrow out of its bucket. Cells of deleted rows are removed by the
+ * layout itself, so @remove_cell should be %FALSE for those.
+ */
+static void
+unbucket_row (JanaGtkMonthView *self, MonthViewRow *mrow,
+	      gboolean remove_cell)
+{
+	JanaGtkMonthViewPrivate *priv = MONTH_VIEW_PRIVATE (self);
+	
+	if (remove_cell)
+		jana_gtk_tree_layout_remove_cell (
+			JANA_GTK_TREE_LAYOUT (priv->layout), mrow->row);
+	
+	priv->days[mrow->day] = g_list_remove (priv->days[mrow->day], mrow);
+	priv->dirty_days[mrow->day] = TRUE;
+	
+	gtk_tree_row_reference_free (mrow->row);
+	g_slice_free (MonthViewRow, mrow);
+}
+
+static void
+unbucket_store (JanaGtkMonthView *self, GtkTreeModel *model)
+{
+	guint i;
+	GPtrArray *rows;
+	JanaGtkMonthViewPrivate *priv = MONTH_VIEW_PRIVATE (self);
+	
+	if (!(rows = g_hash_table_lookup (priv->rows, model))) return;
+	
+	for (i = 0; i < rows->len; i++) {
+		MonthViewRow *mrow = g_ptr_array_index (rows, i);
+		if (mrow) unbucket_row (self, mrow, TRUE);
+	}
+	g_hash_table_remove (priv->rows, model);
+}
+
+static void
+bucket_store (JanaGtkMonthView *self, GtkTreeModel *model)
+{
+	GtkTreeIter iter;
+	
+	if (gtk_tree_model_get_iter_first (model, &iter)) do {
+		GtkTreePath *path = gtk_tree_model_get_path (model, &iter);
+		bucket_row (self, model, path, &iter);
+		gtk_tree_path_free (path);
+	} while (gtk_tree_model_iter_next (model, &iter));
+}
 
+static void
+rebucket (JanaGtkMonthView *self)
+{
+	GList *s;
+	GDate *first, *date;
+	JanaGtkMonthViewPrivate *priv = MONTH_VIEW_PRIVATE (self);
+	
+	jana_gtk_tree_layout_clear (JANA_GTK_TREE_LAYOUT (priv->layout));
+	free_days (self);
+	
 	if (!priv->month) return;
 	
-	cells = jana_gtk_tree_layout_get_cells (
-		JANA_GTK_TREE_LAYOUT (priv->layout));
+	priv->n_days = priv->visible_weeks * 7;
+	priv->days = g_new0 (GList *, priv->n_days);
+	priv->dirty_days = g_new0 (gboolean, priv->n_days);
+	priv->hidden_events = g_new0 (gint, priv->n_days);
 	
-	if (!cells) return;
+	first = jana_utils_time_to_gdate (priv->start);
+	date = jana_utils_time_to_gdate (priv->month);
+	priv->month_offset = g_date_days_between (first, date);
+	g_date_free (first);
+	g_date_free (date);
 	
-	/* Place cells in their day boxes, 4 events per box */
+	for (s = priv->stores; s; s = s->next)
+		bucket_store (self, GTK_TREE_MODEL (s->data));
+}
+
+static void
+relayout_days (JanaGtkMonthView *self)
+{
+	gint i, width, height, days_in_month;
+	gboolean redraw = FALSE;
+	JanaGtkTreeLayout *layout;
+	JanaGtkMonthViewPrivate *priv = MONTH_VIEW_PRIVATE (self);
+
+	if ((!priv->month) || (!priv->days)) return;
+	
+	layout = JANA_GTK_TREE_LAYOUT (priv->layout);
+	days_in_month = jana_utils_time_days_in_month (
+		jana_time_get_year (priv->month),
+		jana_time_get_month (priv->month));
+	
+	/* Place cells in their day boxes, 4 visible events per box, or 3
+	 * and a count of the rest.
+	 */
 	width = priv->layout->allocation.width / 7;
 	height = priv->layout->allocation.height / priv->visible_weeks;
-	cell = cells;
-	time = jana_time_duplicate (priv->start);
-	for (y = 0; (y < priv->visible_weeks) && (cell); y++) {
-		for (x = 0; (x < 7) && (cell); x++) {
-			gint events = 0;
-			do {
-				JanaGtkTreeLayoutCellInfo *info =
-					(JanaGtkTreeLayoutCellInfo *)cell->data;
-				GtkTreeModel *model;
-				GtkTreePath *path;
-				GtkTreeIter iter;
-				JanaTime *start;
-
-				/* Work out what month the cell is in */
-				model = gtk_tree_row_reference_get_model (info->row);
-				path = gtk_tree_row_reference_get_path (info->row);
-				gtk_tree_model_get_iter (model, &iter, path);
-				gtk_tree_path_free (path);
+	for (i = 0; i < priv->n_days; i++) {
+		gint x, y, events, shown, count;
+		gboolean sensitive;
+		GList *r;
+		
+		if (!priv->dirty_days[i]) continue;
+		priv->dirty_days[i] = FALSE;
+		
+		x = i % 7;
+		y = i / 7;
+		sensitive = (i >= priv->month_offset) &&
+			(i < priv->month_offset + days_in_month);
+		
+		for (r = priv->days[i], count = 0; r; r = r->next)
+			if (((MonthViewRow *)r->data)->visible) count++;
+		shown = (count > 4) ? 3 : count;
+		if (priv->hidden_events[i] != count - shown) {
+			priv->hidden_events[i] = count - shown;
+			redraw = TRUE;
+		}
+		
+		for (r = priv->days[i], events = 0; r; r = r->next) {
+			MonthViewRow *mrow = (MonthViewRow *)r->data;
+			GtkTreeRowReference *row = mrow->row;
+			gint event_x, event_y, event_width, event_height;
 			
-				gtk_tree_model_get (model, &iter,
-					JANA_GTK_EVENT_STORE_COL_START, &start,
-					-1);
-
-				if (start && (jana_utils_time_compare (
-				    start, time, TRUE) == 0)) {
-					gint event_x, event_y, event_width,
-						event_height;
-
-					event_width = (width/2) -
-						(priv->spacing * 1.5);
-					event_height = (height/2) -
-						(priv->spacing * 1.5);
-					switch (events) {
-					    case 0 :
-						/* Upper-left quadrant */
-						event_x = (x * width) +
-							priv->spacing;
-						event_y = (y * height) +
-							priv->spacing;
-						break;
-					    case 1 :
-						/* Upper-right quadrant */
-						event_x = (x * width) +
-							(width/2) +
-							(priv->spacing / 2);
-						event_y = (y * height) +
-							priv->spacing;
-						break;
-					    case 2 :
-						/* Lower-left quadrant */
-						event_x = (x * width) +
-							priv->spacing;
-						event_y = (y * height) +
-							(height / 2) +
-							(priv->spacing / 2);
-						break;
-					    case 3 :
-					    default :
-						/* Lower-right quadrant */
-						event_x = (x * width) +
-							(width/2) +
-							(priv->spacing / 2);
-						event_y = (y * height) +
-							(height / 2) +
-							(priv->spacing / 2);
-						break;
-					}
-					if (jana_time_get_month (start) ==
-					    jana_time_get_month (priv->month))
-						jana_gtk_tree_layout_set_cell_sensitive (
-							JANA_GTK_TREE_LAYOUT (
-								priv->layout),
-							info->row, TRUE);
-					else
-						jana_gtk_tree_layout_set_cell_sensitive (
-							JANA_GTK_TREE_LAYOUT (
-								priv->layout),
-							info->row, FALSE);
-					
-					jana_gtk_tree_layout_move_cell (
-						JANA_GTK_TREE_LAYOUT (
-							priv->layout),
-						info->row, event_x, event_y,
-						event_width, event_height);
-					events ++;
-					g_object_unref (start);
-				} else if (start) {
-					/* Make cell invisible (it isn't in
-					 * range).
-					 */
-					jana_gtk_tree_layout_move_cell (
-						JANA_GTK_TREE_LAYOUT (
-							priv->layout),
-						info->row, 0, 0, 0, 0);
-					g_object_unref (start);
-					break;
-				}
-				cell = cell->next;
-			} while (cell);
-			jana_time_set_day (time, jana_time_get_day (time) + 1);
+			if ((!mrow->visible) || (events >= shown)) {
+				/* Filtered out, or hidden behind the
+				 * overflow count
+				 */
+				jana_gtk_tree_layout_remove_cell (layout, row);
+				continue;
+			}
+			
+			if (!jana_gtk_tree_layout_get_cell (layout, row))
+				jana_gtk_tree_layout_add_cell (layout,
+					row, 0, 0, 0, 0, priv->event_renderer,
+					"uid", JANA_GTK_EVENT_STORE_COL_UID,
+					"categories",
+					JANA_GTK_EVENT_STORE_COL_CATEGORIES,
+					"summary",
+					JANA_GTK_EVENT_STORE_COL_SUMMARY,
+					"description",
+					JANA_GTK_EVENT_STORE_COL_DESCRIPTION,
+					"start", JANA_GTK_EVENT_STORE_COL_START,
+					"end", JANA_GTK_EVENT_STORE_COL_END,
+					"first_instance",
+					JANA_GTK_EVENT_STORE_COL_FIRST_INSTANCE,
+					"last_instance",
+					JANA_GTK_EVENT_STORE_COL_LAST_INSTANCE,
+					"has_recurrences",
+					JANA_GTK_EVENT_STORE_COL_HAS_RECURRENCES,
+					"has_alarm",
+					JANA_GTK_EVENT_STORE_COL_HAS_ALARM,
+					NULL);
+
+			event_width = (width/2) - (priv->spacing * 1.5);
+			event_height = (height/2) - (priv->spacing * 1.5);
+			switch (events) {
+			    case 0 :
+				/* Upper-left quadrant */
+				event_x = (x * width) + priv->spacing;
+				event_y = (y * height) + priv->spacing;
+				break;
+			    case 1 :
+				/* Upper-right quadrant */
+				event_x = (x * width) + (width/2) +
+					(priv->spacing / 2);
+				event_y = (y * height) + priv->spacing;
+				break;
+			    case 2 :
+				/* Lower-left quadrant */
+				event_x = (x * width) + priv->spacing;
+				event_y = (y * height) + (height / 2) +
+					(priv->spacing / 2);
+				break;
+			    case 3 :
+			    default :
+				/* Lower-right quadrant */
+				event_x = (x * width) + (width/2) +
+					(priv->spacing / 2);
+				event_y = (y * height) + (height / 2) +
+					(priv->spacing / 2);
+				break;
+			}
+			
+			jana_gtk_tree_layout_set_cell_sensitive (
+				layout, row, sensitive);
+			jana_gtk_tree_layout_move_cell (layout, row,
+				event_x, event_y, event_width, event_height);
+			events++;
 		}
 	}
 	
-	g_object_unref (time);
-	g_list_free (cells);
+	if (redraw) gtk_widget_queue_draw (GTK_WIDGET (self));
+}
+
+static void
+relayout (JanaGtkMonthView *self)
+{
+	gint i;
+	JanaGtkMonthViewPrivate *priv = MONTH_VIEW_PRIVATE (self);
+	
+	for (i = 0; i < priv->n_days; i++) priv->dirty_days[i] = TRUE;
+	relayout_days (self);
 }
 
 static void
@@ -654,8 +1059,7 @@ jana_gtk_month_view_class_init (JanaGtkMonthViewClass *klass)
 }
 
 static gint
-sort_cells_cb (JanaGtkTreeLayoutCellInfo *info_a,
-	       JanaGtkTreeLayoutCellInfo *info_b)
+compare_rows (GtkTreeRowReference *row_a, GtkTreeRowReference *row_b)
 {
 	GtkTreeModel *model;
 	GtkTreePath *path;
@@ -664,8 +1068,8 @@ sort_cells_cb (JanaGtkTreeLayoutCellInfo *info_a,
 	gchar *summary_a, *summary_b;
 	gint result = 0;
 
-	model = gtk_tree_row_reference_get_model (info_a->row);
-	path = gtk_tree_row_reference_get_path (info_a->row);
+	model = gtk_tree_row_reference_get_model (row_a);
+	path = gtk_tree_row_reference_get_path (row_a);
 	gtk_tree_model_get_iter (model, &iter, path);
 	gtk_tree_path_free (path);
 	
@@ -674,8 +1078,8 @@ sort_cells_cb (JanaGtkTreeLayoutCellInfo *info_a,
 		JANA_GTK_EVENT_STORE_COL_END, &end_a,
 		JANA_GTK_EVENT_STORE_COL_SUMMARY, &summary_a, -1);
 
-	model = gtk_tree_row_reference_get_model (info_b->row);
-	path = gtk_tree_row_reference_get_path (info_b->row);
+	model = gtk_tree_row_reference_get_model (row_b);
+	path = gtk_tree_row_reference_get_path (row_b);
 	gtk_tree_model_get_iter (model, &iter, path);
 	gtk_tree_path_free (path);
 	
@@ -703,6 +1107,13 @@ sort_cells_cb (JanaGtkTreeLayoutCellInfo *info_a,
 	return result;
 }
 
+static gint
+sort_cells_cb (JanaGtkTreeLayoutCellInfo *info_a,
+	       JanaGtkTreeLayoutCellInfo *info_b)
+{
+	return compare_rows (info_a->row, info_b->row);
+}
+
 static void
 jana_gtk_month_view_init (JanaGtkMonthView *self)
 {
@@ -717,6 +1128,8 @@ jana_gtk_month_view_init (JanaGtkMonthView *self)
 	gtk_widget_set_app_paintable (GTK_WIDGET (self), TRUE);
 
 	priv->spacing = 2;
+	priv->rows = g_hash_table_new_full (NULL, NULL, NULL,
+		(GDestroyNotify)free_row_index);
 	priv->alignment = gtk_alignment_new (0.5, 0.5, 1, 1);
 	priv->layout = jana_gtk_tree_layout_new ();
 	g_object_set (G_OBJECT (priv->layout),
@@ -740,6 +1153,8 @@ jana_gtk_month_view_init (JanaGtkMonthView *self)
 		G_CALLBACK (size_allocate_cb), self);
 	g_signal_connect (priv->layout, "button-press-event",
 		G_CALLBACK (button_press_event_cb), self);
+	g_signal_connect (self, "style-set",
+		G_CALLBACK (style_set_cb), NULL);
 }
 
 GtkWidget *
@@ -753,81 +1168,81 @@ static void
 row_changed_cb (GtkTreeModel *tree_model, GtkTreePath *path,
 		GtkTreeIter *iter, JanaGtkMonthView *self)
 {
-	relayout (self);
+	MonthViewRow *mrow;
+	
+	/* The start time may have changed, so re-bucket the row */
+	if ((mrow = take_row (self, tree_model, path, FALSE)))
+		unbucket_row (self, mrow, TRUE);
+	bucket_row (self, tree_model, path, iter);
+	jana_gtk_utils_queue_update (self,
+		(JanaGtkUtilsUpdateFunc)relayout_days);
 }
 
 static void
 row_inserted_cb (GtkTreeModel *tree_model, GtkTreePath *path,
 		 GtkTreeIter *iter, JanaGtkMonthView *self)
 {
-	GtkTreeRowReference *row;
+	GPtrArray *rows;
 	JanaGtkMonthViewPrivate *priv = MONTH_VIEW_PRIVATE (self);
 	
-	/* Add row to layout */
-	row = gtk_tree_row_reference_new (tree_model, path);
-	
-	jana_gtk_tree_layout_add_cell (JANA_GTK_TREE_LAYOUT (priv->layout),
-		row, 0, 0, 0, 0, priv->event_renderer,
-		"uid", JANA_GTK_EVENT_STORE_COL_UID,
-		"categories", JANA_GTK_EVENT_STORE_COL_CATEGORIES,
-		"summary", JANA_GTK_EVENT_STORE_COL_SUMMARY,
-		"description", JANA_GTK_EVENT_STORE_COL_DESCRIPTION,
-		"start", JANA_GTK_EVENT_STORE_COL_START,
-		"end", JANA_GTK_EVENT_STORE_COL_END,
-		"first_instance", JANA_GTK_EVENT_STORE_COL_FIRST_INSTANCE,
-		"last_instance", JANA_GTK_EVENT_STORE_COL_LAST_INSTANCE,
-		"has_recurrences", JANA_GTK_EVENT_STORE_COL_HAS_RECURRENCES,
-		"has_alarm", JANA_GTK_EVENT_STORE_COL_HAS_ALARM,
-		NULL);
-	
-	gtk_tree_row_reference_free (row);
+	/* Make room in the index of the store */
+	if ((rows = g_hash_table_lookup (priv->rows, tree_model))) {
+		guint n = gtk_tree_path_get_indices (path)[0];
+		if (n < rows->len) {
+			g_ptr_array_add (rows, NULL);
+			g_memmove (&rows->pdata[n + 1], &rows->pdata[n],
+				(rows->len - n - 1) * sizeof (gpointer));
+			rows->pdata[n] = NULL;
+		}
+	}
 	
-	relayout (self);
-}
-
-static void
-row_deleted_cb (GtkTreeModel *tree_model, GtkTreePath *path,
-		JanaGtkMonthView *self)
-{
-	relayout (self);
+	bucket_row (self, tree_model, path, iter);
+	jana_gtk_utils_queue_update (self,
+		(JanaGtkUtilsUpdateFunc)relayout_days);
 }
 
 static void
-insert_rows (JanaGtkMonthView *self, JanaGtkEventStore *store)
+rows_reordered_cb (GtkTreeModel *tree_model, GtkTreePath *path,
+		   GtkTreeIter *iter, gint *new_order, JanaGtkMonthView *self)
 {
-	GtkTreeIter iter;
+	gint i, n_rows;
+	GPtrArray *rows, *old_rows;
+	JanaGtkMonthViewPrivate *priv = MONTH_VIEW_PRIVATE (self);
 	
-	if (gtk_tree_model_get_iter_first (GTK_TREE_MODEL (store), &iter)) do {
-		GtkTreePath *path = gtk_tree_model_get_path (
-			(GtkTreeModel *)store, &iter);
-		row_inserted_cb ((GtkTreeModel *)store, path, &iter, self);
-		gtk_tree_path_free (path);
-	} while (gtk_tree_model_iter_next ((GtkTreeModel *)store, &iter));
+	if (!(old_rows = g_hash_table_lookup (priv->rows, tree_model)))
+		return;
+	
+	/* new_order maps new positions to old ones */
+	n_rows = gtk_tree_model_iter_n_children (tree_model, NULL);
+	rows = g_ptr_array_sized_new (n_rows);
+	for (i = 0; i < n_rows; i++) {
+		guint row = new_order[i];
+		g_ptr_array_add (rows, (row < old_rows->len) ?
+			g_ptr_array_index (old_rows, row) : NULL);
+	}
+	g_hash_table_insert (priv->rows, tree_model, rows);
 }
 
 static void
-remove_rows (JanaGtkMonthView *self, JanaGtkEventStore *store)
+row_deleted_cb (GtkTreeModel *tree_model, GtkTreePath *path,
+		JanaGtkMonthView *self)
 {
-	JanaGtkMonthViewPrivate *priv = MONTH_VIEW_PRIVATE (self);
-	GList *cell, *cells = jana_gtk_tree_layout_get_cells (
-		JANA_GTK_TREE_LAYOUT (priv->layout));
+	MonthViewRow *mrow;
 	
-	for (cell = cells; cell; cell = cell->next) {
-		JanaGtkTreeLayoutCellInfo *info =
-			(JanaGtkTreeLayoutCellInfo *)cell->data;
-		if (gtk_tree_row_reference_get_model (info->row) ==
-		    (GtkTreeModel *)store)
-			jana_gtk_tree_layout_remove_cell (
-				(JanaGtkTreeLayout *)self, info->row);
-	}
-	
-	g_list_free (cells);
+	if ((mrow = take_row (self, tree_model, path, TRUE)))
+		unbucket_row (self, mrow, FALSE);
+	jana_gtk_utils_queue_update (self,
+		(JanaGtkUtilsUpdateFunc)relayout_days);
 }
 
 void
 jana_gtk_month_view_add_store (JanaGtkMonthView *self, JanaGtkEventStore *store)
 {
-	insert_rows (self, store);
+	JanaGtkMonthViewPrivate *priv = MONTH_VIEW_PRIVATE (self);
+	
+	priv->stores = g_list_prepend (priv->stores, g_object_ref (store));
+	bucket_store (self, GTK_TREE_MODEL (store));
+	relayout_days (self);
 	
 	g_signal_connect (store, "row-inserted",
 		G_CALLBACK (row_inserted_cb), self);
@@ -835,17 +1250,29 @@ jana_gtk_month_view_add_store (JanaGtkMonthView *self, JanaGtkEventStore *store)
 		G_CALLBACK (row_changed_cb), self);
 	g_signal_connect_after (store, "row-deleted",
 		G_CALLBACK (row_deleted_cb), self);
+	g_signal_connect (store, "rows-reordered",
+		G_CALLBACK (rows_reordered_cb), self);
 }
 
 void
 jana_gtk_month_view_remove_store (JanaGtkMonthView *self,
 				  JanaGtkEventStore *store)
 {
+	GList *link;
+	JanaGtkMonthViewPrivate *priv = MONTH_VIEW_PRIVATE (self);
+	
+	if (!(link = g_list_find (priv->stores, store))) return;
+	
 	g_signal_handlers_disconnect_by_func (store, row_inserted_cb, self);
 	g_signal_handlers_disconnect_by_func (store, row_changed_cb, self);
 	g_signal_handlers_disconnect_by_func (store, row_deleted_cb, self);
+	g_signal_handlers_disconnect_by_func (store, rows_reordered_cb, self);
 	
-	remove_rows (self, store);
+	priv->stores = g_list_delete_link (priv->stores, link);
+	unbucket_store (self, GTK_TREE_MODEL (store));
+	relayout_days (self);
+	
+	g_object_unref (store);
 }
 
 JanaGtkCellRendererEvent *
@@ -899,7 +1326,11 @@ jana_gtk_month_view_set_month (JanaGtkMonthView *self, JanaTime *month)
 		priv->selection = NULL;
 		g_signal_emit (self, signals[SELECTION_CHANGED], 0, NULL);
 	}
+	free_background (self);
+	rebucket (self);
 	relayout (self);
+	jana_gtk_utils_queue_update (self,
+		(JanaGtkUtilsUpdateFunc)update_padding);
 	gtk_widget_queue_draw (GTK_WIDGET (self));
 }
 
@@ -917,6 +1348,9 @@ jana_gtk_month_view_set_spacing (JanaGtkMonthView *self, guint spacing)
 	JanaGtkMonthViewPrivate *priv = MONTH_VIEW_PRIVATE (self);
 	
 	priv->spacing = spacing;
+	free_background (self);
+	jana_gtk_utils_queue_update (self,
+		(JanaGtkUtilsUpdateFunc)update_padding);
 	gtk_widget_queue_draw (GTK_WIDGET (self));
 }
 
@@ -954,6 +1388,47 @@ jana_gtk_month_view_get_selection (JanaGtkMonthView *self)
 	return priv->selection ? jana_time_duplicate (priv->selection) : NULL;
 }
 
+/* Re-evaluates the visibility of the bucketed rows @affected_cb returns
+ * %TRUE for, or of all of them if it's %NULL, and lays out again the days
+ * whose visible events changed.
+ */
+static void
+refilter_days (JanaGtkMonthView *self,
+	       GtkTreeModelFilterVisibleFunc affected_cb, gpointer data)
+{
+	gint i;
+	JanaGtkMonthViewPrivate *priv = MONTH_VIEW_PRIVATE (self);
+	
+	for (i = 0; i < priv->n_days; i++) {
+		GList *r;
+		
+		for (r = priv->days[i]; r; r = r->next) {
+			MonthViewRow *mrow = (MonthViewRow *)r->data;
+			GtkTreeModel *model;
+			GtkTreePath *path;
+			GtkTreeIter iter;
+			gboolean visible;
+			
+			model = gtk_tree_row_reference_get_model (mrow->row);
+			path = gtk_tree_row_reference_get_path (mrow->row);
+			gtk_tree_model_get_iter (model, &iter, path);
+			gtk_tree_path_free (path);
+			
+			if (affected_cb && (!affected_cb (model, &iter, data)))
+				continue;
+			
+			visible = priv->visible_cb ? priv->visible_cb (
+				model, &iter, priv->visible_data) : TRUE;
+			if (visible != mrow->visible) {
+				mrow->visible = visible;
+				priv->dirty_days[i] = TRUE;
+			}
+		}
+	}
+	
+	relayout_days (self);
+}
+
 void
 jana_gtk_month_view_set_visible_func (JanaGtkMonthView *self,
 				      GtkTreeModelFilterVisibleFunc visible_cb,
@@ -961,8 +1436,11 @@ jana_gtk_month_view_set_visible_func (JanaGtkMonthView *self,
 {
 	JanaGtkMonthViewPrivate *priv = MONTH_VIEW_PRIVATE (self);
 	
+	priv->visible_cb = visible_cb;
+	priv->visible_data = data;
 	jana_gtk_tree_layout_set_visible_func (
 		JANA_GTK_TREE_LAYOUT (priv->layout), visible_cb, data);
+	refilter_days (self, NULL, NULL);
 }
 
 void
@@ -971,6 +1449,27 @@ jana_gtk_month_view_refilter (JanaGtkMonthView *self)
 	JanaGtkMonthViewPrivate *priv = MONTH_VIEW_PRIVATE (self);
 	
 	jana_gtk_tree_layout_refilter (JANA_GTK_TREE_LAYOUT (priv->layout));
+	refilter_days (self, NULL, NULL);
+}
+
+static gboolean
+month_view_has_category_cb (GtkTreeModel *model, GtkTreeIter *iter,
+			    gpointer data)
+{
+	return jana_gtk_utils_model_has_category (model, iter,
+		JANA_GTK_EVENT_STORE_COL_CATEGORY_MASK,
+		JANA_GTK_EVENT_STORE_COL_CATEGORIES, GPOINTER_TO_UINT (data));
+}
+
+void
+jana_gtk_month_view_refilter_category (JanaGtkMonthView *self, guint atom)
+{
+	JanaGtkMonthViewPrivate *priv = MONTH_VIEW_PRIVATE (self);
+	
+	jana_gtk_tree_layout_refilter_rows (JANA_GTK_TREE_LAYOUT (priv->layout),
+		month_view_has_category_cb, GUINT_TO_POINTER (atom));
+	refilter_days (self, month_view_has_category_cb,
+		GUINT_TO_POINTER (atom));
 }
 
 void
@@ -98,6 +98,8 @@ void	jana_gtk_month_view_set_visible_func	(JanaGtkMonthView *self,
 						 gpointer data);
 
 void	jana_gtk_month_view_refilter		(JanaGtkMonthView *self);
+void	jana_gtk_month_view_refilter_category	(JanaGtkMonthView *self,
+						 guint atom);
 
 void	jana_gtk_month_view_set_highlighted_time(JanaGtkMonthView *self,
 						 JanaTime *time);
@@ -163,6 +163,7 @@ jana_gtk_note_store_init (JanaGtkNoteStore *self)
 			   G_TYPE_STRING,	/* BODY */
 			   G_TYPE_OBJECT,	/* CREATED */
 			   G_TYPE_OBJECT,	/* MODIFIED */
+			   G_TYPE_UINT64,	/* CATEGORY_MASK */
 		});
 	gtk_tree_sortable_set_sort_func (GTK_TREE_SORTABLE (self),
 		JANA_GTK_NOTE_STORE_COL_CREATED, jana_gtk_note_store_compare,
@@ -190,7 +191,8 @@ note_store_added_cb (JanaStoreView *view, GList *components,
 	JanaGtkNoteStorePrivate *priv = NOTE_STORE_PRIVATE (store);
 
 	for (; components; components = components->next) {
-		gchar *uid, **categories, *author, *recipient, *body;
+		const gchar *author, *recipient, *body;
+		gchar *uid, **categories;
 		JanaTime *creation, *modified;
 		JanaNote *note;
 		GtkTreeIter *iter;
@@ -206,9 +208,9 @@ note_store_added_cb (JanaStoreView *view, GList *components,
 		uid = jana_component_get_uid (JANA_COMPONENT (note));
 		categories = jana_component_get_categories (
 			JANA_COMPONENT (note));
-		author = jana_note_get_author (note);
-		recipient = jana_note_get_recipient (note);
-		body = jana_note_get_body (note);
+		author = jana_note_peek_author (note);
+		recipient = jana_note_peek_recipient (note);
+		body = jana_note_peek_body (note);
 		creation = jana_note_get_creation_time (note);
 		modified = jana_note_get_modified_time (note);
 		
@@ -220,14 +222,14 @@ note_store_added_cb (JanaStoreView *view, GList *components,
 			JANA_GTK_NOTE_STORE_COL_RECIPIENT, recipient,
 			JANA_GTK_NOTE_STORE_COL_BODY, body,
 			JANA_GTK_NOTE_STORE_COL_CREATED, creation,
-			JANA_GTK_NOTE_STORE_COL_MODIFIED, modified, -1);
+			JANA_GTK_NOTE_STORE_COL_MODIFIED, modified,
+			JANA_GTK_NOTE_STORE_COL_CATEGORY_MASK,
+				jana_utils_category_get_mask (
+					(const gchar **)categories), -1);
 		
 		g_hash_table_insert (priv->notes_hash, uid, iter);
 		
 		g_strfreev (categories);
-		g_free (author);
-		g_free (recipient);
-		g_free (body);
 		if (creation) g_object_unref (creation);
 		if (modified) g_object_unref (modified);
 	}
@@ -240,7 +242,8 @@ note_store_modified_cb (JanaStoreView *view, GList *components,
 	JanaGtkNoteStorePrivate *priv = NOTE_STORE_PRIVATE (store);
 
 	for (; components; components = components->next) {
-		gchar *uid, **categories, *author, *recipient, *body;
+		const gchar *author, *recipient, *body;
+		gchar *uid, **categories;
 		JanaTime *creation, *modified;
 		JanaNote *note;
 		GtkTreeIter *iter;
@@ -261,9 +264,9 @@ note_store_modified_cb (JanaStoreView *view, GList *components,
 		note = JANA_NOTE (components->data);
 		categories = jana_component_get_categories (
 			JANA_COMPONENT (note));
-		author = jana_note_get_author (note);
-		recipient = jana_note_get_recipient (note);
-		body = jana_note_get_body (note);
+		author = jana_note_peek_author (note);
+		recipient = jana_note_peek_recipient (note);
+		body = jana_note_peek_body (note);
 		creation = jana_note_get_creation_time (note);
 		modified = jana_note_get_modified_time (note);
 		
@@ -273,13 +276,13 @@ note_store_modified_cb (JanaStoreView *view, GList *components,
 			JANA_GTK_NOTE_STORE_COL_RECIPIENT, recipient,
 			JANA_GTK_NOTE_STORE_COL_BODY, body,
 			JANA_GTK_NOTE_STORE_COL_CREATED, creation,
-			JANA_GTK_NOTE_STORE_COL_MODIFIED, modified, -1);
+			JANA_GTK_NOTE_STORE_COL_MODIFIED, modified,
+			JANA_GTK_NOTE_STORE_COL_CATEGORY_MASK,
+				jana_utils_category_get_mask (
+					(const gchar **)categories), -1);
 
 		g_free (uid);
 		g_strfreev (categories);
-		g_free (author);
-		g_free (recipient);
-		g_free (body);
 		if (creation) g_object_unref (creation);
 		if (modified) g_object_unref (modified);
 	}
@@ -65,6 +65,7 @@ enum {
 	JANA_GTK_NOTE_STORE_COL_BODY,
 	JANA_GTK_NOTE_STORE_COL_CREATED,
 	JANA_GTK_NOTE_STORE_COL_MODIFIED,
+	JANA_GTK_NOTE_STORE_COL_CATEGORY_MASK,
 	JANA_GTK_NOTE_STORE_COL_LAST
 };
 
@@ -41,10 +41,12 @@ struct _JanaGtkTreeLayoutPrivate {
 	GList *cells;
 	GList *visible_cells;
 	GList **cells_ptr;
+	gboolean sorted;
+	gboolean visible_dirty;
 	GHashTable *models;
 	
 	JanaGtkTreeLayoutCellInfo *hover;
-	GList *select;
+	GHashTable *select;
 	guint select_idle;
 };
 
@@ -67,6 +69,27 @@ enum {
 
 static guint signals[LAST_SIGNAL] = { 0 };
 
+/* Per-model book-keeping. Cells of flat lists are indexed by row number,
+ * cells of trees by the string form of their row's path. Row references
+ * are updated before any row-inserted handler runs, but a view may add the
+ * cell of a new row from its own handler before the layout's has run, so
+ * an insertion marks the index dirty and it's rebuilt from the row
+ * references on the next lookup. A list's index is shifted in place for
+ * deletions and reorders while it's clean, a tree's is marked dirty as a
+ * change to one branch can move the rows of many.
+ */
+typedef struct {
+	gint refs;
+	gboolean list;
+	/* Row number -> GList link of the cell, or NULL */
+	GPtrArray *cells;
+	/* Path string -> GList link of the cell */
+	GHashTable *rows;
+	gboolean dirty;
+	/* Cell being removed by the row-deleted handler */
+	GList *deleted;
+} TreeLayoutModel;
+
 
 static void	tree_layout_add_cell		(JanaGtkTreeLayout *self,
 						 GtkTreeRowReference *row,
@@ -98,22 +121,207 @@ find_point_cb (gconstpointer a, gconstpointer b)
 	else return 0;
 }
 
-static gint
-find_row_cb (gconstpointer a, gconstpointer b)
+static TreeLayoutModel *
+tree_layout_model_new (GtkTreeModel *model)
 {
-	gint result;
-	GtkTreePath *path_a, *path_b;
+	TreeLayoutModel *model_info = g_slice_new (TreeLayoutModel);
 	
-	path_a = gtk_tree_row_reference_get_path (
-		((JanaGtkTreeLayoutCellInfo *)a)->row);
-	path_b = gtk_tree_row_reference_get_path ((GtkTreeRowReference *)b);
+	model_info->refs = 0;
+	model_info->list = (gtk_tree_model_get_flags (model) &
+		GTK_TREE_MODEL_LIST_ONLY) ? TRUE : FALSE;
+	model_info->cells = g_ptr_array_new ();
+	model_info->rows = g_hash_table_new_full (
+		g_str_hash, g_str_equal, g_free, NULL);
+	model_info->dirty = FALSE;
+	model_info->deleted = NULL;
 	
-	result = gtk_tree_path_compare (path_a, path_b);
+	return model_info;
+}
+
+static void
+tree_layout_model_free (TreeLayoutModel *model_info)
+{
+	g_ptr_array_free (model_info->cells, TRUE);
+	g_hash_table_destroy (model_info->rows);
+	g_slice_free (TreeLayoutModel, model_info);
+}
+
+static GList *
+tree_layout_model_lookup (TreeLayoutModel *model_info, GtkTreePath *path)
+{
+	gchar *key;
+	GList *info_list;
 	
-	gtk_tree_path_free (path_a);
-	gtk_tree_path_free (path_b);
+	if (model_info->list) {
+		guint row = gtk_tree_path_get_indices (path)[0];
+		return (row < model_info->cells->len) ?
+			g_ptr_array_index (model_info->cells, row) : NULL;
+	}
+	
+	key = gtk_tree_path_to_string (path);
+	info_list = g_hash_table_lookup (model_info->rows, key);
+	g_free (key);
 	
-	return result;
+	return info_list;
+}
+
+static void
+tree_layout_model_insert (TreeLayoutModel *model_info, GtkTreePath *path,
+			  GList *info_list)
+{
+	/* A dirty index picks the cell up when it's rebuilt */
+	if (model_info->dirty) return;
+	
+	if (model_info->list) {
+		guint row = gtk_tree_path_get_indices (path)[0];
+		if (row >= model_info->cells->len)
+			g_ptr_array_set_size (model_info->cells, row + 1);
+		
+		/* Another cell at this row means the model changed and the
+		 * layout's handler hasn't caught up yet.
+		 */
+		if (g_ptr_array_index (model_info->cells, row))
+			model_info->dirty = TRUE;
+		else
+			g_ptr_array_index (model_info->cells, row) = info_list;
+	} else {
+		g_hash_table_replace (model_info->rows,
+			gtk_tree_path_to_string (path), info_list);
+	}
+}
+
+/* Only drops the entry at @path if it still belongs to @info_list */
+static void
+tree_layout_model_unset (TreeLayoutModel *model_info, GtkTreePath *path,
+			 GList *info_list)
+{
+	if (tree_layout_model_lookup (model_info, path) != info_list) return;
+	
+	if (model_info->list) {
+		g_ptr_array_index (model_info->cells,
+			gtk_tree_path_get_indices (path)[0]) = NULL;
+	} else {
+		gchar *key = gtk_tree_path_to_string (path);
+		g_hash_table_remove (model_info->rows, key);
+		g_free (key);
+	}
+}
+
+/* Rebuilds the row index of a model from the row references of its cells.
+ * Cells whose rows no longer exist are returned, so that the caller can
+ * remove them.
+ */
+static GList *
+tree_layout_model_reindex (JanaGtkTreeLayout *self, GtkTreeModel *model,
+			   TreeLayoutModel *model_info)
+{
+	GList *c, *invalid = NULL;
+	JanaGtkTreeLayoutPrivate *priv = TREE_LAYOUT_PRIVATE (self);
+	
+	if (model_info->list) g_ptr_array_set_size (model_info->cells, 0);
+	else g_hash_table_remove_all (model_info->rows);
+	model_info->dirty = FALSE;
+	
+	for (c = priv->cells; c; c = c->next) {
+		JanaGtkTreeLayoutCellInfo *info =
+			(JanaGtkTreeLayoutCellInfo *)c->data;
+		
+		GtkTreePath *path;
+		
+		if (gtk_tree_row_reference_get_model (info->row) != model)
+			continue;
+		
+		if ((path = gtk_tree_row_reference_get_path (info->row))) {
+			tree_layout_model_insert (model_info, path, c);
+			gtk_tree_path_free (path);
+		} else
+			invalid = g_list_prepend (invalid, c);
+	}
+	
+	return invalid;
+}
+
+static GList *
+tree_layout_find_cell (JanaGtkTreeLayout *self, GtkTreeModel *model,
+		       GtkTreePath *path)
+{
+	TreeLayoutModel *model_info;
+	JanaGtkTreeLayoutPrivate *priv = TREE_LAYOUT_PRIVATE (self);
+	
+	if (!path) return NULL;
+	if (!(model_info = g_hash_table_lookup (priv->models, model)))
+		return NULL;
+	
+	if (model_info->dirty) {
+		GList *invalid = tree_layout_model_reindex (
+			self, model, model_info);
+		
+		/* Cells of deleted rows are removed by the row-deleted
+		 * handler, they're only skipped here.
+		 */
+		g_list_free (invalid);
+	}
+	
+	return tree_layout_model_lookup (model_info, path);
+}
+
+static GList *
+tree_layout_find_row (JanaGtkTreeLayout *self, GtkTreeRowReference *row)
+{
+	GList *info_list;
+	GtkTreePath *path;
+	
+	if (!(path = gtk_tree_row_reference_get_path (row))) return NULL;
+	info_list = tree_layout_find_cell (self,
+		gtk_tree_row_reference_get_model (row), path);
+	gtk_tree_path_free (path);
+	
+	return info_list;
+}
+
+/* Closes the gap left in a list's index by the row deleted at @row, and
+ * returns the cell that was there.
+ */
+static GList *
+tree_layout_model_shift_down (TreeLayoutModel *model_info, guint row)
+{
+	if (row >= model_info->cells->len) return NULL;
+	
+	return g_ptr_array_remove_index (model_info->cells, row);
+}
+
+/* Moves and row changes only mark the cell order stale, the list is
+ * sorted once before it's next measured, drawn or hit-tested. Visibility
+ * is kept on the cells themselves, so the visible list is then rebuilt in
+ * a single pass over the sorted cells rather than sorted separately.
+ */
+static void
+tree_layout_sort (JanaGtkTreeLayout *self)
+{
+	GList *c;
+	JanaGtkTreeLayoutPrivate *priv = TREE_LAYOUT_PRIVATE (self);
+	
+	if (!priv->sorted) {
+		priv->sorted = TRUE;
+		if (priv->sort_cb) {
+			priv->cells = g_list_sort_with_data (priv->cells,
+				priv->sort_cb, priv->sort_data);
+			priv->visible_dirty = TRUE;
+		}
+	}
+	
+	if ((!priv->visible_cb) || (!priv->visible_dirty)) return;
+	priv->visible_dirty = FALSE;
+	
+	g_list_free (priv->visible_cells);
+	priv->visible_cells = NULL;
+	for (c = g_list_last (priv->cells); c; c = c->prev) {
+		JanaGtkTreeLayoutCellInfo *info =
+			(JanaGtkTreeLayoutCellInfo *)c->data;
+		if (info->visible)
+			priv->visible_cells = g_list_prepend (
+				priv->visible_cells, info);
+	}
 }
 
 static void
@@ -138,22 +346,15 @@ tree_layout_row_changed_cb (GtkTreeModel *model, GtkTreePath *path,
 			    GtkTreeIter *iter, JanaGtkTreeLayout *self)
 {
 	JanaGtkTreeLayoutPrivate *priv = TREE_LAYOUT_PRIVATE (self);
-	GtkTreeRowReference *row;
 	GList *info_list;
 	
-	row = gtk_tree_row_reference_new (model, path);
-	info_list = g_list_find_custom (
-		priv->cells, row, find_row_cb);
-	gtk_tree_row_reference_free (row);
+	info_list = tree_layout_find_cell (self, model, path);
 	
 	if (info_list) {
 		JanaGtkTreeLayoutCellInfo *info =
 			(JanaGtkTreeLayoutCellInfo *)info_list->data;
 		
-		if (priv->sort_cb) {
-			priv->cells = g_list_sort_with_data (priv->cells,
-				priv->sort_cb, priv->sort_data);
-		}
+		priv->sorted = FALSE;
 		
 		gtk_widget_queue_draw_area (GTK_WIDGET (self),
 			info->real_x + GTK_WIDGET (self)->allocation.x,
@@ -161,82 +362,107 @@ tree_layout_row_changed_cb (GtkTreeModel *model, GtkTreePath *path,
 			info->real_width, info->real_height);
 		
 		if (priv->visible_cb) {
-			info_list = g_list_find (priv->visible_cells, info);
-			if (priv->visible_cb (model, iter, priv->visible_data)){
-				if (info_list) {
-					if (priv->sort_cb) {
-						priv->visible_cells =
-							g_list_sort_with_data (
-							    priv->visible_cells,
-							    priv->sort_cb,
-							    priv->sort_data);
-					}
-				} else {
-					priv->visible_cells =
-						g_list_insert_sorted_with_data (
-							priv->visible_cells,
-							info, priv->sort_cb,
-							priv->sort_data);
-				}
-			} else if (info_list) {
-				priv->visible_cells =
-					g_list_delete_link (
-						priv->visible_cells,
-						info_list);
+			gboolean visible = priv->visible_cb (
+				model, iter, priv->visible_data);
+			if (visible != info->visible) {
+				info->visible = visible;
+				priv->visible_dirty = TRUE;
+				gtk_widget_queue_resize (GTK_WIDGET (self));
 			}
 		}
 	}
 }
 
 static void
-tree_layout_row_deleted_cb (GtkTreeModel *model, GtkTreePath *path,
-			    JanaGtkTreeLayout *self)
+tree_layout_row_inserted_cb (GtkTreeModel *model, GtkTreePath *path,
+			     GtkTreeIter *iter, JanaGtkTreeLayout *self)
 {
+	TreeLayoutModel *model_info;
 	JanaGtkTreeLayoutPrivate *priv = TREE_LAYOUT_PRIVATE (self);
-	GList *info_list = priv->cells;
 	
-	/* Iterate through cells and remove invalid - we can't search for
-	 * a particular row as the row reference is now invalid :(
-	 */
-	while (info_list) {
-		GList *prev_info = info_list;
-		JanaGtkTreeLayoutCellInfo *info =
-			(JanaGtkTreeLayoutCellInfo *)info_list->data;
-		info_list = info_list->next;
-		if (!gtk_tree_row_reference_valid (info->row)) {
-			/* No need to queue a redraw, the widget will be
-			 * redrawn due to a possible new size request
-			 */
-			tree_layout_remove_cell_with_list (
-				self, prev_info);
-		}
-	}
+	if ((model_info = g_hash_table_lookup (priv->models, model)))
+		model_info->dirty = TRUE;
 }
 
-static GList *
-get_visible_cells (JanaGtkTreeLayout *self)
+static void
+tree_layout_rows_reordered_cb (GtkTreeModel *model, GtkTreePath *path,
+			       GtkTreeIter *iter, gint *new_order,
+			       JanaGtkTreeLayout *self)
 {
-	GList *cell, *cells = NULL;
+	gint i, n_rows;
+	GPtrArray *cells;
+	TreeLayoutModel *model_info;
+	JanaGtkTreeLayoutPrivate *priv = TREE_LAYOUT_PRIVATE (self);
+	
+	if (!(model_info = g_hash_table_lookup (priv->models, model))) return;
+	if ((!model_info->list) || model_info->dirty) {
+		model_info->dirty = TRUE;
+		return;
+	}
 	
+	/* new_order maps new positions to old ones */
+	n_rows = gtk_tree_model_iter_n_children (model, NULL);
+	cells = g_ptr_array_sized_new (n_rows);
+	for (i = 0; i < n_rows; i++) {
+		guint row = new_order[i];
+		g_ptr_array_add (cells, (row < model_info->cells->len) ?
+			g_ptr_array_index (model_info->cells, row) : NULL);
+	}
+	g_ptr_array_free (model_info->cells, TRUE);
+	model_info->cells = cells;
+}
+
+/* Removes the cell of a deleted row that's no longer in the index */
+static void
+tree_layout_remove_deleted_cell (JanaGtkTreeLayout *self, GtkTreeModel *model,
+				 GList *info_list)
+{
+	TreeLayoutModel *model_info;
 	JanaGtkTreeLayoutPrivate *priv = TREE_LAYOUT_PRIVATE (self);
+	
+	model_info = g_hash_table_lookup (priv->models, model);
+	model_info->deleted = info_list;
+	tree_layout_remove_cell_with_list (self, info_list);
+	
+	/* The book-keeping goes with the model's last cell */
+	if ((model_info = g_hash_table_lookup (priv->models, model)))
+		model_info->deleted = NULL;
+}
 
-	for (cell = priv->cells; cell; cell = cell->next) {
-		JanaGtkTreeLayoutCellInfo *info;
-		GtkTreeModel *model;
-		GtkTreePath *path;
-		GtkTreeIter iter;
-		
-		info = (JanaGtkTreeLayoutCellInfo *)cell->data;
-		model = gtk_tree_row_reference_get_model (info->row);
-		path = gtk_tree_row_reference_get_path (info->row);
-		gtk_tree_model_get_iter (model, &iter, path);
-		gtk_tree_path_free (path);
+static void
+tree_layout_row_deleted_cb (GtkTreeModel *model, GtkTreePath *path,
+			    JanaGtkTreeLayout *self)
+{
+	GList *invalid;
+	TreeLayoutModel *model_info;
+	JanaGtkTreeLayoutPrivate *priv = TREE_LAYOUT_PRIVATE (self);
+	
+	if (!(model_info = g_hash_table_lookup (priv->models, model))) return;
+	
+	/* The row reference of the deleted row is already invalid, but
+	 * a clean list index still knows which cell was at the deleted row.
+	 * Deleting from a tree may take children with it though, so fall
+	 * back to rebuilding the index and collecting the cells with invalid
+	 * rows.
+	 */
+	if (model_info->list && (!model_info->dirty)) {
+		GList *info_list = tree_layout_model_shift_down (model_info,
+			gtk_tree_path_get_indices (path)[0]);
 		
-		if (priv->visible_cb (model, &iter, priv->visible_data))
-			cells = g_list_append (cells, info);
+		/* No need to queue a redraw, the widget will be redrawn
+		 * due to a possible new size request
+		 */
+		if (info_list)
+			tree_layout_remove_deleted_cell (
+				self, model, info_list);
+		return;
 	}
 	
-	return cells;
+	invalid = tree_layout_model_reindex (self, model, model_info);
+	while (invalid) {
+		tree_layout_remove_deleted_cell (self, model, invalid->data);
+		invalid = g_list_delete_link (invalid, invalid);
+	}
 }
 
 static void
@@ -284,17 +510,12 @@ jana_gtk_tree_layout_set_property (GObject *object, guint property_id,
 	switch (property_id) {
 	    case PROP_SORT_CB :
 		priv->sort_cb = g_value_get_pointer (value);
-		if (priv->sort_cb) {
-			priv->cells = g_list_sort_with_data (priv->cells,
-				priv->sort_cb, priv->sort_data);
-			if (priv->visible_cb)
-				priv->visible_cells = g_list_sort_with_data (
-					priv->visible_cells, priv->sort_cb,
-					priv->sort_data);
-		}
+		priv->sorted = FALSE;
+		gtk_widget_queue_draw (GTK_WIDGET (object));
 		break;
 	    case PROP_SORT_DATA :
 		priv->sort_data = g_value_get_pointer (value);
+		priv->sorted = FALSE;
 		break;
 	    case PROP_SINGLE_CLICK :
 		priv->single_click = g_value_get_boolean (value);
@@ -337,10 +558,149 @@ jana_gtk_tree_layout_finalize (GObject *object)
 	JanaGtkTreeLayoutPrivate *priv = TREE_LAYOUT_PRIVATE (object);
 	
 	g_hash_table_destroy (priv->models);
+	g_hash_table_destroy (priv->select);
+	g_list_free (priv->visible_cells);
 	
 	G_OBJECT_CLASS (jana_gtk_tree_layout_parent_class)->finalize (object);
 }
 
+/* Invalidates just the area covered by a cell */
+static void
+tree_layout_queue_draw_cell (JanaGtkTreeLayout *self,
+			     JanaGtkTreeLayoutCellInfo *info)
+{
+	GtkWidget *widget = GTK_WIDGET (self);
+	
+	if ((info->real_width < 0) || (info->real_height < 0)) return;
+	
+	gtk_widget_queue_draw_area (widget,
+		info->real_x + widget->allocation.x,
+		info->real_y + widget->allocation.y,
+		info->real_width, info->real_height);
+}
+
+static void
+tree_layout_queue_draw_cell_cb (gpointer key, gpointer value,
+				gpointer user_data)
+{
+	tree_layout_queue_draw_cell ((JanaGtkTreeLayout *)user_data,
+		(JanaGtkTreeLayoutCellInfo *)key);
+}
+
+static void
+tree_layout_get_selection_cb (gpointer key, gpointer value,
+			      gpointer user_data)
+{
+	GList **selection = (GList **)user_data;
+	
+	*selection = g_list_prepend (*selection, key);
+}
+
+typedef struct {
+	JanaGtkTreeLayout *self;
+	GtkTreeModelFilterVisibleFunc affected_cb;
+	gpointer affected_data;
+	gboolean changed;
+} TreeLayoutRefilter;
+
+static void
+tree_layout_refilter_cell (TreeLayoutRefilter *refilter, GList *info_list,
+			   GtkTreeModel *model, GtkTreeIter *iter)
+{
+	gboolean visible;
+	JanaGtkTreeLayoutCellInfo *info =
+		(JanaGtkTreeLayoutCellInfo *)info_list->data;
+	JanaGtkTreeLayoutPrivate *priv = TREE_LAYOUT_PRIVATE (refilter->self);
+	
+	visible = priv->visible_cb (model, iter, priv->visible_data);
+	if (visible != info->visible) {
+		info->visible = visible;
+		tree_layout_queue_draw_cell (refilter->self, info);
+		refilter->changed = TRUE;
+	}
+}
+
+static gboolean
+tree_layout_refilter_row_cb (GtkTreeModel *model, GtkTreePath *path,
+			     GtkTreeIter *iter, TreeLayoutRefilter *refilter)
+{
+	GList *info_list;
+	
+	if (refilter->affected_cb && !refilter->affected_cb (
+	     model, iter, refilter->affected_data))
+		return FALSE;
+	
+	if ((info_list = tree_layout_find_cell (refilter->self, model, path)))
+		tree_layout_refilter_cell (refilter, info_list, model, iter);
+	
+	return FALSE;
+}
+
+static void
+tree_layout_refilter_model_cb (GtkTreeModel *model,
+			       TreeLayoutModel *model_info,
+			       TreeLayoutRefilter *refilter)
+{
+	guint row;
+	gboolean valid;
+	GtkTreeIter iter;
+	
+	if (!model_info->list) {
+		gtk_tree_model_foreach (model, (GtkTreeModelForeachFunc)
+			tree_layout_refilter_row_cb, refilter);
+		return;
+	}
+	
+	/* Cells of deleted rows are removed by the row-deleted handler */
+	if (model_info->dirty)
+		g_list_free (tree_layout_model_reindex (
+			refilter->self, model, model_info));
+	
+	/* Walking the rows alongside the index gives an iter for each cell 
+	 * without resolving its row reference.
+	 */
+	for (row = 0, valid = gtk_tree_model_get_iter_first (model, &iter);
+	     valid && (row < model_info->cells->len);
+	     row++, valid = gtk_tree_model_iter_next (model, &iter)) {
+		GList *info_list = g_ptr_array_index (model_info->cells, row);
+		
+		if ((!info_list) || (refilter->affected_cb &&
+		     !refilter->affected_cb (model, &iter,
+		     refilter->affected_data)))
+			continue;
+		
+		tree_layout_refilter_cell (refilter, info_list, model, &iter);
+	}
+}
+
+/* Re-evaluates the visibility of the cells whose rows pass affected_cb (or
+ * of all cells, if it's NULL) and only redraws the cells that changed.
+ * Rows are checked against affected_cb as the models are walked, before 
+ * looking for a cell, so unaffected cells cost nothing more than that.
+ * Newly shown cells haven't been allocated, so a resize is queued too.
+ */
+static void
+tree_layout_refilter (JanaGtkTreeLayout *self,
+		      GtkTreeModelFilterVisibleFunc affected_cb,
+		      gpointer affected_data)
+{
+	TreeLayoutRefilter refilter;
+	JanaGtkTreeLayoutPrivate *priv = TREE_LAYOUT_PRIVATE (self);
+	
+	refilter.self = self;
+	refilter.affected_cb = affected_cb;
+	refilter.affected_data = affected_data;
+	refilter.changed = FALSE;
+	
+	g_hash_table_foreach (priv->models,
+		(GHFunc)tree_layout_refilter_model_cb, &refilter);
+	
+	if (refilter.changed) {
+		priv->visible_dirty = TRUE;
+		gtk_widget_queue_resize (GTK_WIDGET (self));
+	}
+}
+
 static void
 tree_layout_set_properties (JanaGtkTreeLayoutCellInfo *info)
 {
@@ -372,6 +732,8 @@ jana_gtk_tree_layout_expose_event (GtkWidget *widget, GdkEventExpose *event)
 	GList *c;
 	JanaGtkTreeLayoutPrivate *priv = TREE_LAYOUT_PRIVATE (widget);
 	
+	tree_layout_sort (JANA_GTK_TREE_LAYOUT (widget));
+	
 	/* Draw these in the reverse order to how we handle mouse operations,
 	 * that way cells that obscure other cells appear to have priority.
 	 */
@@ -383,15 +745,22 @@ jana_gtk_tree_layout_expose_event (GtkWidget *widget, GdkEventExpose *event)
 		
 		if ((info->real_width < 0) || (info->real_height < 0)) continue;
 		
-		tree_layout_set_properties (info);
-		
 		cell_area.x = info->real_x + widget->allocation.x;
 		cell_area.y = info->real_y + widget->allocation.y;
 		cell_area.width = info->real_width;
 		cell_area.height = info->real_height;
 		
+		/* Hover and selection changes only damage the cells involved,
+		 * so skip everything else rather than re-rendering it.
+		 */
+		if (gdk_region_rect_in (event->region, &cell_area) ==
+		    GDK_OVERLAP_RECTANGLE_OUT)
+			continue;
+		
+		tree_layout_set_properties (info);
+		
 		if (info == priv->hover) state |= GTK_CELL_RENDERER_PRELIT;
-		if (g_list_find (priv->select, info))
+		if (g_hash_table_lookup (priv->select, info))
 			state |= GTK_CELL_RENDERER_SELECTED;
 		if (!info->sensitive)
 			state |= GTK_CELL_RENDERER_INSENSITIVE;
@@ -409,6 +778,8 @@ tree_layout_get_size (JanaGtkTreeLayout *self, gint *width, gint *height)
 	GList *c;
 	JanaGtkTreeLayoutPrivate *priv = TREE_LAYOUT_PRIVATE (self);
 
+	tree_layout_sort (self);
+	
 	if (width) *width = 0;
 	if (height) *height = 0;
 
@@ -454,6 +825,8 @@ jana_gtk_tree_layout_size_allocate (GtkWidget *widget,
 	GTK_WIDGET_CLASS (jana_gtk_tree_layout_parent_class)->size_allocate (
 		widget, allocation);
 
+	tree_layout_sort (JANA_GTK_TREE_LAYOUT (widget));
+	
 	/* Work out real size of cells (necessary for width|height == -1) */
 	for (c = *priv->cells_ptr; c; c = c->next) {
 		gint x_offset, y_offset, old_width, old_height, width, height;
@@ -555,6 +928,8 @@ jana_gtk_tree_layout_button_press_event (GtkWidget *widget,
 	JanaGtkTreeLayoutCellInfo *info;
 	JanaGtkTreeLayoutPrivate *priv = TREE_LAYOUT_PRIVATE (widget);
 
+	tree_layout_sort (JANA_GTK_TREE_LAYOUT (widget));
+	
 	if (priv->select_mode == GTK_SELECTION_NONE) {
 		GdkPoint point;
 
@@ -604,20 +979,11 @@ jana_gtk_tree_layout_button_press_event (GtkWidget *widget,
 	if (((priv->select_mode != GTK_SELECTION_BROWSE) &&
 	     (!(event->state & GDK_CONTROL_MASK))) ||
 	     ((priv->select_mode != GTK_SELECTION_MULTIPLE) &&
-		   priv->select && info && (priv->select->data != info))) {
-		for (info_list = priv->select; info_list;
-		     info_list = info_list->next) {
-			JanaGtkTreeLayoutCellInfo *old_info =
-				(JanaGtkTreeLayoutCellInfo *)
-					info_list->data;
-			gtk_widget_queue_draw_area (widget,
-				old_info->real_x + widget->allocation.x,
-				old_info->real_y + widget->allocation.y,
-				old_info->real_width,
-				old_info->real_height);
-		}
-		g_list_free (priv->select);
-		priv->select = NULL;
+		   g_hash_table_size (priv->select) && info &&
+		   (!g_hash_table_lookup (priv->select, info)))) {
+		g_hash_table_foreach (priv->select,
+			tree_layout_queue_draw_cell_cb, widget);
+		g_hash_table_remove_all (priv->select);
 		if (!priv->select_idle) priv->select_idle = g_idle_add (
 			select_idle_cb, widget);
 	}
@@ -627,14 +993,9 @@ jana_gtk_tree_layout_button_press_event (GtkWidget *widget,
 		if ((priv->select_mode != GTK_SELECTION_BROWSE) &&
 		    (event->state & GDK_CONTROL_MASK)) {
 			/* Deselect row if it's already selected */
-			GList *selected = g_list_find (priv->select, info);
-			if (selected) {
-				priv->select = g_list_remove (
-					priv->select, info);
-				gtk_widget_queue_draw_area (widget,
-					info->real_x + widget->allocation.x,
-					info->real_y + widget->allocation.y,
-					info->real_width, info->real_height);
+			if (g_hash_table_remove (priv->select, info)) {
+				tree_layout_queue_draw_cell (
+					JANA_GTK_TREE_LAYOUT (widget), info);
 
 				if (!priv->select_idle) priv->select_idle =
 					g_idle_add (select_idle_cb, widget);
@@ -648,8 +1009,12 @@ jana_gtk_tree_layout_button_press_event (GtkWidget *widget,
 		 * selecting multiple events would become near-impossible)
 		 */
 		if ((event->type == GDK_2BUTTON_PRESS) ||
-		    (priv->single_click && (!priv->select))) {
-			for (info_list = priv->select; info_list;
+		    (priv->single_click &&
+		     (!g_hash_table_size (priv->select)))) {
+			GList *selection = jana_gtk_tree_layout_get_selection (
+				JANA_GTK_TREE_LAYOUT (widget));
+			
+			for (info_list = selection; info_list;
 			     info_list = info_list->next) {
 				gchar *path_string;
 				GdkRectangle cell_area;
@@ -681,15 +1046,14 @@ jana_gtk_tree_layout_button_press_event (GtkWidget *widget,
 				g_signal_emit (widget, signals[CELL_ACTIVATED],
 					0, old_info);
 			}
+			g_list_free (selection);
 		}
 		
 		/* Add new cell to selection */
 		if (info->sensitive) {
-			priv->select = g_list_prepend (priv->select, info);
-			gtk_widget_queue_draw_area (widget,
-				info->real_x + widget->allocation.x,
-				info->real_y + widget->allocation.y,
-				info->real_width, info->real_height);
+			g_hash_table_insert (priv->select, info, info);
+			tree_layout_queue_draw_cell (
+				JANA_GTK_TREE_LAYOUT (widget), info);
 			if (!priv->select_idle) priv->select_idle =
 				g_idle_add (select_idle_cb, widget);
 		}
@@ -706,6 +1070,8 @@ jana_gtk_tree_layout_motion_notify_event (GtkWidget *widget,
 	GList *info_list;
 	JanaGtkTreeLayoutPrivate *priv = TREE_LAYOUT_PRIVATE (widget);
 
+	tree_layout_sort (JANA_GTK_TREE_LAYOUT (widget));
+	
 	/* Find the cell we're hovered over and redraw it if necessary */
 	point.x = event->x;
 	point.y = event->y;
@@ -714,28 +1080,15 @@ jana_gtk_tree_layout_motion_notify_event (GtkWidget *widget,
 		JanaGtkTreeLayoutCellInfo *info =
 			(JanaGtkTreeLayoutCellInfo *)info_list->data;
 		if (priv->hover != info) {
-			if (priv->hover)
-				gtk_widget_queue_draw_area (
-					widget,
-					priv->hover->real_x +
-						widget->allocation.x,
-					priv->hover->real_y +
-						widget->allocation.y,
-					priv->hover->real_width,
-					priv->hover->real_height);
+			if (priv->hover) tree_layout_queue_draw_cell (
+				JANA_GTK_TREE_LAYOUT (widget), priv->hover);
 			priv->hover = info;
-			gtk_widget_queue_draw_area (widget,
-				priv->hover->real_x + widget->allocation.x,
-				priv->hover->real_y + widget->allocation.y,
-				priv->hover->real_width,
-				priv->hover->real_height);
+			tree_layout_queue_draw_cell (
+				JANA_GTK_TREE_LAYOUT (widget), priv->hover);
 		}
 	} else if (priv->hover) {
-		gtk_widget_queue_draw_area (widget,
-			priv->hover->real_x + widget->allocation.x,
-			priv->hover->real_y + widget->allocation.y,
-			priv->hover->real_width,
-			priv->hover->real_height);
+		tree_layout_queue_draw_cell (
+			JANA_GTK_TREE_LAYOUT (widget), priv->hover);
 		priv->hover = NULL;
 		return FALSE;
 	}
@@ -881,9 +1234,12 @@ jana_gtk_tree_layout_init (JanaGtkTreeLayout *self)
 {
 	JanaGtkTreeLayoutPrivate *priv = TREE_LAYOUT_PRIVATE (self);
 
-	priv->models = g_hash_table_new (g_direct_hash, g_int_equal);
+	priv->models = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+		NULL, (GDestroyNotify)tree_layout_model_free);
+	priv->select = g_hash_table_new (g_direct_hash, g_direct_equal);
 	priv->select_mode = GTK_SELECTION_SINGLE;
 	priv->cells_ptr = &priv->cells;
+	priv->sorted = TRUE;
 
 	gtk_widget_set_app_paintable (GTK_WIDGET (self), TRUE);
 	gtk_event_box_set_visible_window (GTK_EVENT_BOX (self), FALSE);
@@ -902,11 +1258,11 @@ tree_layout_add_cell (JanaGtkTreeLayout *self,
 		      GtkTreeRowReference *row, gint x, gint y, gint width,
 		      gint height, GtkCellRenderer *renderer, va_list args)
 {
-	gint refs;
 	const gchar *prop;
 	GtkTreeModel *model;
 	GtkTreePath *path;
 	GtkTreeIter iter;
+	TreeLayoutModel *model_info;
 	JanaGtkTreeLayoutCellInfo *info;
 	JanaGtkTreeLayoutPrivate *priv = TREE_LAYOUT_PRIVATE (self);
 	
@@ -923,6 +1279,7 @@ tree_layout_add_cell (JanaGtkTreeLayout *self,
 	info->sensitive = TRUE;
 	info->renderer = g_object_ref (renderer);
 	info->attributes = NULL;
+	info->visible = TRUE;
 	
 	for (prop = va_arg (args, const gchar *); prop;
 	     prop = va_arg (args, const gchar *)) {
@@ -934,42 +1291,45 @@ tree_layout_add_cell (JanaGtkTreeLayout *self,
 	}
 	
 	model = gtk_tree_row_reference_get_model (info->row);
-	if ((refs = GPOINTER_TO_INT (g_hash_table_lookup (
-	     priv->models, model)))) {
-		/* Increment local ref-count */
-		g_hash_table_replace (priv->models, model,
-			GINT_TO_POINTER (refs + 1));
-	} else {
+	if (!(model_info = g_hash_table_lookup (priv->models, model))) {
 		/* Attach to signals for row updates */
 		g_signal_connect (G_OBJECT (model), "row-changed",
 			G_CALLBACK (tree_layout_row_changed_cb), self);
 
+		g_signal_connect (G_OBJECT (model), "row-inserted",
+			G_CALLBACK (tree_layout_row_inserted_cb), self);
+
 		g_signal_connect (G_OBJECT (model), "row-deleted",
 			G_CALLBACK (tree_layout_row_deleted_cb), self);
 
+		g_signal_connect (G_OBJECT (model), "rows-reordered",
+			G_CALLBACK (tree_layout_rows_reordered_cb), self);
+
+		model_info = tree_layout_model_new (model);
 		g_hash_table_insert (priv->models,
-			g_object_ref (model), GINT_TO_POINTER (1));
+			g_object_ref (model), model_info);
 	}
+	/* Increment local ref-count */
+	model_info->refs ++;
 	
-	if (priv->sort_cb)
-		priv->cells = g_list_insert_sorted_with_data (priv->cells, info,
-			priv->sort_cb, priv->sort_data);
-	else
-		priv->cells = g_list_prepend (priv->cells, info);
+	/* New cells go to the front and the list is sorted as a whole
+	 * before it's next used, as with moved cells.
+	 */
+	priv->cells = g_list_prepend (priv->cells, info);
+	if (priv->sort_cb) priv->sorted = FALSE;
 	
+	/* GList links don't move when the list is sorted, so the index can
+	 * point straight at them.
+	 */
 	path = gtk_tree_row_reference_get_path (row);
+	tree_layout_model_insert (model_info, path, priv->cells);
 	gtk_tree_model_get_iter (model, &iter, path);
 	gtk_tree_path_free (path);
 	
-	if (priv->visible_cb &&
-	    priv->visible_cb (model, &iter, priv->visible_data)) {
-		if (priv->sort_cb)
-			priv->visible_cells = g_list_insert_sorted_with_data (
-				priv->visible_cells, info, priv->sort_cb,
-				priv->sort_data);
-		else
-			priv->visible_cells = g_list_prepend (
-				priv->visible_cells, info);
+	if (priv->visible_cb) {
+		info->visible = priv->visible_cb (
+			model, &iter, priv->visible_data);
+		if (info->visible) priv->visible_dirty = TRUE;
 	}
 	
 	gtk_widget_queue_resize (GTK_WIDGET (self));
@@ -983,7 +1343,7 @@ tree_layout_move_cell (JanaGtkTreeLayout *self,
 {
 	JanaGtkTreeLayoutCellInfo *info;
 	JanaGtkTreeLayoutPrivate *priv = TREE_LAYOUT_PRIVATE (self);
-	GList *info_list = g_list_find_custom (priv->cells, row, find_row_cb);
+	GList *info_list = tree_layout_find_row (self, row);
 	
 	if (!info_list) return;
 	
@@ -998,10 +1358,7 @@ tree_layout_move_cell (JanaGtkTreeLayout *self,
 	info->real_height = height;
 
 	if (priv->hover == info) priv->hover = NULL;
-
-	if (priv->sort_cb)
-		priv->cells = g_list_sort_with_data (priv->cells,
-			priv->sort_cb, priv->sort_data);
+	priv->sorted = FALSE;
 
 	gtk_widget_queue_resize (GTK_WIDGET (self));
 	gtk_widget_queue_draw (GTK_WIDGET (self));
@@ -1010,50 +1367,63 @@ tree_layout_move_cell (JanaGtkTreeLayout *self,
 static void
 tree_layout_remove_cell_with_list (JanaGtkTreeLayout *self, GList *info_list)
 {
-	gint refs;
-	GList *selected;
 	GtkTreeModel *model;
+	TreeLayoutModel *model_info;
 	JanaGtkTreeLayoutPrivate *priv = TREE_LAYOUT_PRIVATE (self);
 	JanaGtkTreeLayoutCellInfo *info =
 		(JanaGtkTreeLayoutCellInfo *)info_list->data;
 
-	if ((selected = g_list_find (priv->select, info))) {
-		priv->select = g_list_delete_link (priv->select, selected);
+	if (g_hash_table_remove (priv->select, info)) {
 		if (!priv->select_idle) priv->select_idle = g_idle_add (
 			select_idle_cb, self);
 	}
 	if (priv->hover == info) priv->hover = NULL;
 	
 	model = gtk_tree_row_reference_get_model (info->row);
-	if ((refs = GPOINTER_TO_INT (g_hash_table_lookup (
-	     priv->models, model)))) {
-		refs --;
-		if (refs) {
-			/* Decrement local ref-count */
-			g_hash_table_replace (priv->models, model,
-				GINT_TO_POINTER (refs));
+	if ((model_info = g_hash_table_lookup (priv->models, model))) {
+		/* Decrement local ref-count */
+		if (-- model_info->refs) {
+			GtkTreePath *path;
+			
+			/* A cell whose row was deleted can't be found by
+			 * path any more. Unless the row-deleted handler
+			 * already dropped it, rebuild the index rather than
+			 * leave it pointing at the freed cell.
+			 */
+			if ((!model_info->dirty) &&
+			    (info_list != model_info->deleted)) {
+				path = gtk_tree_row_reference_get_path (
+					info->row);
+				if (path) {
+					tree_layout_model_unset (
+						model_info, path, info_list);
+					gtk_tree_path_free (path);
+				} else
+					model_info->dirty = TRUE;
+			}
 		} else {
 			/* Remove signals and unref model */
 			g_signal_handlers_disconnect_by_func (model,
 				tree_layout_row_changed_cb, self);
+			g_signal_handlers_disconnect_by_func (model,
+				tree_layout_row_inserted_cb, self);
 			g_signal_handlers_disconnect_by_func (model,
 				tree_layout_row_deleted_cb, self);
+			g_signal_handlers_disconnect_by_func (model,
+				tree_layout_rows_reordered_cb, self);
 			
 			g_hash_table_remove (priv->models, model);
 			g_object_unref (model);
 		}
 	}
 	
+	/* The visible list is only read after tree_layout_sort, which
+	 * rebuilds it without the stale link.
+	 */
+	if (priv->visible_cb && info->visible) priv->visible_dirty = TRUE;
+	
 	free_info ((JanaGtkTreeLayoutCellInfo *)info_list->data);
 	priv->cells = g_list_delete_link (priv->cells, info_list);
-	
-	if (priv->visible_cb) {
-		GList *link = g_list_find (
-			priv->visible_cells, info);
-		if (link)
-			priv->visible_cells = g_list_delete_link (
-				priv->visible_cells, link);
-	}
 
 	gtk_widget_queue_resize (GTK_WIDGET (self));
 	gtk_widget_queue_draw (GTK_WIDGET (self));
@@ -1062,8 +1432,7 @@ tree_layout_remove_cell_with_list (JanaGtkTreeLayout *self, GList *info_list)
 static void
 tree_layout_remove_cell (JanaGtkTreeLayout *self, GtkTreeRowReference *row)
 {
-	JanaGtkTreeLayoutPrivate *priv = TREE_LAYOUT_PRIVATE (self);
-	GList *info_list = g_list_find_custom (priv->cells, row, find_row_cb);
+	GList *info_list = tree_layout_find_row (self, row);
 	
 	if (info_list) tree_layout_remove_cell_with_list (self, info_list);
 }
@@ -1086,14 +1455,21 @@ jana_gtk_tree_layout_new (void)
 GList *
 jana_gtk_tree_layout_get_selection (JanaGtkTreeLayout *self)
 {
+	GList *selection = NULL;
 	JanaGtkTreeLayoutPrivate *priv = TREE_LAYOUT_PRIVATE (self);
-	return g_list_copy (priv->select);
+	
+	g_hash_table_foreach (priv->select,
+		tree_layout_get_selection_cb, &selection);
+	
+	return selection;
 }
 
 GList *
 jana_gtk_tree_layout_get_cells (JanaGtkTreeLayout *self)
 {
 	JanaGtkTreeLayoutPrivate *priv = TREE_LAYOUT_PRIVATE (self);
+	
+	tree_layout_sort (self);
 	return g_list_copy (priv->cells);
 }
 
@@ -1141,17 +1517,23 @@ jana_gtk_tree_layout_set_selection (JanaGtkTreeLayout *self,
 {
 	JanaGtkTreeLayoutPrivate *priv = TREE_LAYOUT_PRIVATE (self);
 
-	g_list_free (priv->select);
-	priv->select = g_list_copy (selection);
-	gtk_widget_queue_draw (GTK_WIDGET (self));
+	/* Only redraw the cells that were or will be selected */
+	g_hash_table_foreach (priv->select,
+		tree_layout_queue_draw_cell_cb, self);
+	g_hash_table_remove_all (priv->select);
+	for (; selection; selection = selection->next) {
+		g_hash_table_insert (priv->select,
+			selection->data, selection->data);
+		tree_layout_queue_draw_cell (self,
+			(JanaGtkTreeLayoutCellInfo *)selection->data);
+	}
 }
 
 const JanaGtkTreeLayoutCellInfo *
 jana_gtk_tree_layout_get_cell (JanaGtkTreeLayout *self,
 			       GtkTreeRowReference *row)
 {
-	JanaGtkTreeLayoutPrivate *priv = TREE_LAYOUT_PRIVATE (self);
-	GList *info_list = g_list_find_custom (priv->cells, row, find_row_cb);
+	GList *info_list = tree_layout_find_row (self, row);
 	
 	if (info_list)
 		return (const JanaGtkTreeLayoutCellInfo *)info_list->data;
@@ -1164,8 +1546,7 @@ jana_gtk_tree_layout_set_cell_sensitive (JanaGtkTreeLayout *self,
 					 GtkTreeRowReference *row,
 					 gboolean sensitive)
 {
-	JanaGtkTreeLayoutPrivate *priv = TREE_LAYOUT_PRIVATE (self);
-	GList *info_list = g_list_find_custom (priv->cells, row, find_row_cb);
+	GList *info_list = tree_layout_find_row (self, row);
 	
 	if (info_list) {
 		JanaGtkTreeLayoutCellInfo *info;
@@ -1173,10 +1554,7 @@ jana_gtk_tree_layout_set_cell_sensitive (JanaGtkTreeLayout *self,
 		info = (JanaGtkTreeLayoutCellInfo *)info_list->data;
 		if (info->sensitive != sensitive) {
 			info->sensitive = sensitive;
-			gtk_widget_queue_draw_area (GTK_WIDGET (self),
-				info->real_x + GTK_WIDGET (self)->allocation.x,
-				info->real_y + GTK_WIDGET (self)->allocation.y,
-				info->real_width, info->real_height);
+			tree_layout_queue_draw_cell (self, info);
 		}
 	}
 }
@@ -1186,17 +1564,23 @@ jana_gtk_tree_layout_set_visible_func (JanaGtkTreeLayout *self,
 				       GtkTreeModelFilterVisibleFunc visible_cb,
 				       gpointer data)
 {
+	GList *c;
 	JanaGtkTreeLayoutPrivate *priv = TREE_LAYOUT_PRIVATE (self);
 	
-	if (priv->visible_cb) g_list_free (priv->visible_cells);
 	priv->visible_cb = visible_cb;
 	priv->visible_data = data;
 	
 	if (priv->visible_cb) {
-		priv->visible_cells = get_visible_cells (self);
+		tree_layout_refilter (self, NULL, NULL);
+		priv->visible_dirty = TRUE;
 		priv->cells_ptr = &priv->visible_cells;
-	} else
+	} else {
+		for (c = priv->cells; c; c = c->next)
+			((JanaGtkTreeLayoutCellInfo *)c->data)->visible = TRUE;
+		g_list_free (priv->visible_cells);
+		priv->visible_cells = NULL;
 		priv->cells_ptr = &priv->cells;
+	}
 	
 	gtk_widget_queue_draw (GTK_WIDGET (self));
 }
@@ -1206,9 +1590,15 @@ jana_gtk_tree_layout_refilter (JanaGtkTreeLayout *self)
 {
 	JanaGtkTreeLayoutPrivate *priv = TREE_LAYOUT_PRIVATE (self);
 	
-	if (priv->visible_cb) {
-		g_list_free (priv->visible_cells);
-		priv->visible_cells = get_visible_cells (self);
-		gtk_widget_queue_draw (GTK_WIDGET (self));
-	}
+	if (priv->visible_cb) tree_layout_refilter (self, NULL, NULL);
+}
+
+void
+jana_gtk_tree_layout_refilter_rows (JanaGtkTreeLayout *self,
+				    GtkTreeModelFilterVisibleFunc affected_cb,
+				    gpointer data)
+{
+	JanaGtkTreeLayoutPrivate *priv = TREE_LAYOUT_PRIVATE (self);
+	
+	if (priv->visible_cb) tree_layout_refilter (self, affected_cb, data);
 }
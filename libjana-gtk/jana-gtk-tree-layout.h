@@ -61,6 +61,7 @@ typedef struct {
 	gboolean sensitive;
 	GtkCellRenderer *renderer;
 	GList *attributes;
+	gboolean visible;
 } JanaGtkTreeLayoutCellInfo;
 
 typedef struct {
@@ -132,6 +133,10 @@ void	jana_gtk_tree_layout_set_visible_func	(JanaGtkTreeLayout *self,
 						 gpointer data);
 
 void	jana_gtk_tree_layout_refilter		(JanaGtkTreeLayout *self);
+void	jana_gtk_tree_layout_refilter_rows	(JanaGtkTreeLayout *self,
+						 GtkTreeModelFilterVisibleFunc
+							  affected_cb,
+						 gpointer data);
 
 G_END_DECLS
 
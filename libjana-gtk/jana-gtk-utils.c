@@ -18,8 +18,22 @@
  */
 
 
+#include <string.h>
+#include <libjana/jana-utils.h>
 #include "jana-gtk-utils.h"
 
+typedef struct {
+	gpointer data;
+	JanaGtkUtilsUpdateFunc func;
+} UtilsUpdate;
+
+/* Updates waiting for the next frame, most recently queued first, and
+ * those still to be run in the current one.
+ */
+static GList *queued_updates = NULL;
+static GList *running_updates = NULL;
+static guint update_source = 0;
+
 /**
  * jana_gtk_utils_treeview_resize:
  * @tree_view: A #GtkTreeView
@@ -59,3 +73,142 @@ jana_gtk_utils_treeview_resize (GtkWidget *tree_view, GtkAllocation *allocation,
 		gtk_tree_view_columns_autosize (GTK_TREE_VIEW (tree_view));
 	}
 }
+
+/**
+ * jana_gtk_utils_model_has_category:
+ * @model: A #GtkTreeModel
+ * @iter: A #GtkTreeIter pointing to a row in @model
+ * @mask_column: The column holding the row's category mask
+ * @categories_column: The column holding the row's category list
+ * @atom: A category atom, see jana_utils_category_get_atom()
+ *
+ * Checks whether the row at @iter has the category represented by @atom. 
+ * This is meant for use in visibility filter functions on a 
+ * #JanaGtkEventStore or #JanaGtkNoteStore (or a model wrapping one), where 
+ * @mask_column would be %JANA_GTK_EVENT_STORE_COL_CATEGORY_MASK and 
+ * @categories_column %JANA_GTK_EVENT_STORE_COL_CATEGORIES, for example. 
+ * In most cases the check is a single bit test; the category list is only 
+ * read for atoms that don't have a mask bit of their own.
+ *
+ * Returns: %TRUE if the row has the category, %FALSE otherwise.
+ */
+gboolean
+jana_gtk_utils_model_has_category (GtkTreeModel *model, GtkTreeIter *iter,
+				   gint mask_column, gint categories_column,
+				   guint atom)
+{
+	gint i;
+	guint64 mask, bit;
+	gchar **categories;
+	const gchar *category;
+	gboolean result = FALSE;
+	
+	if (!(bit = jana_utils_category_atom_to_mask (atom))) return FALSE;
+	
+	gtk_tree_model_get (model, iter, mask_column, &mask, -1);
+	if (!(mask & bit)) return FALSE;
+	if (bit != JANA_UTILS_CATEGORY_MASK_SHARED) return TRUE;
+	
+	category = jana_utils_category_get_name (atom);
+	gtk_tree_model_get (model, iter, categories_column, &categories, -1);
+	for (i = 0; categories && categories[i]; i++) {
+		if (strcmp (categories[i], category) == 0) {
+			result = TRUE;
+			break;
+		}
+	}
+	g_strfreev (categories);
+	
+	return result;
+}
+
+static gboolean
+utils_run_updates_cb (gpointer user_data)
+{
+	running_updates = g_list_reverse (queued_updates);
+	queued_updates = NULL;
+	update_source = 0;
+
+	/* Updates queued from here on will wait for the next frame */
+	while (running_updates) {
+		UtilsUpdate *update = (UtilsUpdate *)running_updates->data;
+		running_updates = g_list_delete_link (
+			running_updates, running_updates);
+		update->func (update->data);
+		g_slice_free (UtilsUpdate, update);
+	}
+
+	return FALSE;
+}
+
+/**
+ * jana_gtk_utils_queue_update:
+ * @data: Data to pass to @func, usually a widget
+ * @func: The update to run
+ *
+ * Queues @func to be called with @data before the next redraw. Updates are 
+ * shared between all the widgets in libjana-gtk and run together, once per 
+ * frame, at a priority just above that of redrawing. Queueing an update 
+ * that is already pending has no effect, so this can be called from 
+ * #GtkTreeModel signal handlers to turn a burst of row changes into a 
+ * single relayout.
+ *
+ * Any pending updates for @data must be removed with 
+ * jana_gtk_utils_cancel_updates() before @data is freed.
+ */
+void
+jana_gtk_utils_queue_update (gpointer data, JanaGtkUtilsUpdateFunc func)
+{
+	UtilsUpdate *update;
+	GList *u;
+
+	for (u = queued_updates; u; u = u->next) {
+		update = (UtilsUpdate *)u->data;
+		if ((update->data == data) && (update->func == func)) return;
+	}
+
+	update = g_slice_new (UtilsUpdate);
+	update->data = data;
+	update->func = func;
+	queued_updates = g_list_prepend (queued_updates, update);
+
+	if (!update_source) update_source = g_idle_add_full (
+		GDK_PRIORITY_REDRAW - 1, utils_run_updates_cb, NULL, NULL);
+}
+
+static GList *
+utils_cancel_updates (GList *updates, gpointer data)
+{
+	GList *u = updates;
+
+	while (u) {
+		GList *next = u->next;
+		UtilsUpdate *update = (UtilsUpdate *)u->data;
+		if (update->data == data) {
+			g_slice_free (UtilsUpdate, update);
+			updates = g_list_delete_link (updates, u);
+		}
+		u = next;
+	}
+
+	return updates;
+}
+
+/**
+ * jana_gtk_utils_cancel_updates:
+ * @data: The data updates were queued with
+ *
+ * Removes any updates queued with jana_gtk_utils_queue_update() for @data 
+ * that haven't run yet.
+ */
+void
+jana_gtk_utils_cancel_updates (gpointer data)
+{
+	queued_updates = utils_cancel_updates (queued_updates, data);
+	running_updates = utils_cancel_updates (running_updates, data);
+
+	if ((!queued_updates) && update_source) {
+		g_source_remove (update_source);
+		update_source = 0;
+	}
+}
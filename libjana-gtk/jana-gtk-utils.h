@@ -27,4 +27,23 @@ void	jana_gtk_utils_treeview_resize (GtkWidget *tree_view,
 					GtkAllocation *allocation,
 					gpointer cell_renderer);
 
+gboolean jana_gtk_utils_model_has_category (GtkTreeModel *model,
+					    GtkTreeIter *iter,
+					    gint mask_column,
+					    gint categories_column,
+					    guint atom);
+
+/**
+ * JanaGtkUtilsUpdateFunc:
+ * @data: The data the update was queued with
+ *
+ * A deferred update, see jana_gtk_utils_queue_update().
+ */
+typedef void (*JanaGtkUtilsUpdateFunc) (gpointer data);
+
+void	jana_gtk_utils_queue_update (gpointer data,
+				     JanaGtkUtilsUpdateFunc func);
+
+void	jana_gtk_utils_cancel_updates (gpointer data);
+
 #endif /* JANA_GTK_UTILS_H */
@@ -22,6 +22,7 @@
 #include <locale.h>
 #include <langinfo.h>
 #include "jana-gtk-year-view.h"
+#include "jana-gtk-utils.h"
 
 G_DEFINE_TYPE (JanaGtkYearView, jana_gtk_year_view, GTK_TYPE_TABLE)
 
@@ -167,14 +168,16 @@ static void
 row_deleted_cb (GtkTreeModel *tree_model, GtkTreePath *path,
 		JanaGtkYearView *self)
 {
-	recount_events (self);
+	jana_gtk_utils_queue_update (self,
+		(JanaGtkUtilsUpdateFunc)recount_events);
 }
 
 static void
 row_changed_cb (GtkTreeModel *tree_model, GtkTreePath *path,
 		GtkTreeIter *iter, JanaGtkYearView *self)
 {
-	recount_events (self);
+	jana_gtk_utils_queue_update (self,
+		(JanaGtkUtilsUpdateFunc)recount_events);
 }
 
 static void
@@ -184,7 +187,8 @@ row_inserted_cb (GtkTreeModel *tree_model, GtkTreePath *path,
 	/* TODO: Just consider this one row rather than recounting all the
 	 *       events.
 	 */
-	recount_events (self);
+	jana_gtk_utils_queue_update (self,
+		(JanaGtkUtilsUpdateFunc)recount_events);
 }
 
 static void
@@ -194,6 +198,8 @@ jana_gtk_year_view_dispose (GObject *object)
 	
 	JanaGtkYearViewPrivate *priv = YEAR_VIEW_PRIVATE (object);
 
+	jana_gtk_utils_cancel_updates (object);
+
 	for (i = 0; i < 12; i++) {
 		if (priv->boxes[i]) {
 			g_object_unref (priv->boxes[i]);
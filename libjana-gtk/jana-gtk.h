@@ -28,6 +28,7 @@
 
 #include <libjana-gtk/jana-gtk-cell-renderer-event.h>
 #include <libjana-gtk/jana-gtk-event-store.h>
+#include <libjana-gtk/jana-gtk-event-model.h>
 #include <libjana-gtk/jana-gtk-tree-layout.h>
 #include <libjana-gtk/jana-gtk-event-list.h>
 #include <libjana-gtk/jana-gtk-date-time.h>
@@ -232,6 +232,35 @@ jana_component_set_custom_prop (JanaComponent *self, const gchar *name,
 		set_custom_prop (self, name, value);
 }
 
+/**
+ * jana_component_get_custom_props:
+ * @self: A #JanaComponent
+ * @names: A %NULL-terminated array of property names
+ * @values: An array with room for as many strings as there are in @names
+ *
+ * Retrieves several custom properties set on @self at once. Each element 
+ * of @values is set to a newly allocated string with the value of the 
+ * property named by the corresponding element of @names, or %NULL if that 
+ * property has not been set. This is equivalent to calling 
+ * jana_component_get_custom_prop() for each name, but implementations may 
+ * do it in a single pass over the component.
+ */
+void
+jana_component_get_custom_props (JanaComponent *self, const gchar **names,
+				 gchar **values)
+{
+	gint i;
+	JanaComponentInterface *iface = JANA_COMPONENT_GET_INTERFACE (self);
+	
+	if (iface->get_custom_props) {
+		iface->get_custom_props (self, names, values);
+		return;
+	}
+	
+	for (i = 0; names[i]; i++)
+		values[i] = iface->get_custom_prop (self, names[i]);
+}
+
 /**
  * jana_component_props_list_free:
  * @props: A property list returned by jana_component_get_custom_props_list()
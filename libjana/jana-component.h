@@ -77,6 +77,10 @@ struct _JanaComponentInterface {
 	gboolean	(*set_custom_prop)		(JanaComponent *self,
 							 const gchar *name,
 							 const gchar *value);
+	
+	void		(*get_custom_props)		(JanaComponent *self,
+							 const gchar **names,
+							 gchar **values);
 };
 
 GType jana_component_get_type (void);
@@ -99,6 +103,9 @@ gchar *		jana_component_get_custom_prop		(JanaComponent *self,
 gboolean	jana_component_set_custom_prop		(JanaComponent *self,
 							 const gchar *name,
 							 const gchar *value);
+void		jana_component_get_custom_props		(JanaComponent *self,
+							 const gchar **names,
+							 gchar **values);
 
 /* Props list is a list of key-name pairs as gchar **'s */
 void		jana_component_props_list_free		(GList *props);
@@ -154,6 +154,9 @@ jana_exceptions_free (GList *exceptions)
  *
  * Retrieves the summary associated with the event.
  *
+ * This function returns a newly allocated string. To avoid this allocation 
+ * please use jana_event_peek_summary().
+ *
  * Returns: A newly allocated string, containing the summary.
  * See jana_event_set_summary().
  */
@@ -194,6 +197,88 @@ jana_event_get_location (JanaEvent *self)
 	return JANA_EVENT_GET_INTERFACE (self)->get_location (self);
 }
 
+/* Implementations that predate the peek functions fall back to keeping the 
+ * allocated copy on the object, so the returned string is still owned by it.
+ */
+static const gchar *
+event_peek_fallback (JanaEvent *self, const gchar *key, gchar *value)
+{
+	g_object_set_data_full (G_OBJECT (self), key, value, g_free);
+	return value;
+}
+
+/**
+ * jana_event_peek_summary:
+ * @self: A #JanaEvent
+ *
+ * Retrieves the summary associated with the event. Unlike 
+ * jana_event_get_summary(), this function does not return a newly allocated 
+ * string.
+ *
+ * Returns: The summary of the event, or %NULL. This string is owned by @self 
+ * and must not be freed or modified. It is only valid until @self is 
+ * modified or destroyed.
+ */
+const gchar *
+jana_event_peek_summary (JanaEvent *self)
+{
+	JanaEventInterface *iface = JANA_EVENT_GET_INTERFACE (self);
+
+	if (iface->peek_summary)
+		return iface->peek_summary (self);
+	else
+		return event_peek_fallback (self, "jana-event-summary",
+			iface->get_summary (self));
+}
+
+/**
+ * jana_event_peek_description:
+ * @self: A #JanaEvent
+ *
+ * Retrieves the description associated with the event. Unlike 
+ * jana_event_get_description(), this function does not return a newly 
+ * allocated string.
+ *
+ * Returns: The description of the event, or %NULL. This string is owned by 
+ * @self and must not be freed or modified. It is only valid until @self is 
+ * modified or destroyed.
+ */
+const gchar *
+jana_event_peek_description (JanaEvent *self)
+{
+	JanaEventInterface *iface = JANA_EVENT_GET_INTERFACE (self);
+
+	if (iface->peek_description)
+		return iface->peek_description (self);
+	else
+		return event_peek_fallback (self, "jana-event-description",
+			iface->get_description (self));
+}
+
+/**
+ * jana_event_peek_location:
+ * @self: A #JanaEvent
+ *
+ * Retrieves the location associated with the event. Unlike 
+ * jana_event_get_location(), this function does not return a newly allocated 
+ * string.
+ *
+ * Returns: The location of the event, or %NULL. This string is owned by @self 
+ * and must not be freed or modified. It is only valid until @self is 
+ * modified or destroyed.
+ */
+const gchar *
+jana_event_peek_location (JanaEvent *self)
+{
+	JanaEventInterface *iface = JANA_EVENT_GET_INTERFACE (self);
+
+	if (iface->peek_location)
+		return iface->peek_location (self);
+	else
+		return event_peek_fallback (self, "jana-event-location",
+			iface->get_location (self));
+}
+
 /**
  * jana_event_get_start:
  * @self: A #JanaEvent
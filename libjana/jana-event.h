@@ -132,6 +132,11 @@ struct _JanaEventInterface {
 					 const JanaRecurrence *recurrence);
 	
 	void	(*set_exceptions)	(JanaEvent *self, GList *exceptions);
+
+	/* Non-allocating getters */
+	const gchar *	(*peek_summary)		(JanaEvent *self);
+	const gchar *	(*peek_description)	(JanaEvent *self);
+	const gchar *	(*peek_location)	(JanaEvent *self);
 };
 
 GType jana_event_get_type (void);
@@ -146,6 +151,9 @@ void jana_exceptions_free (GList *exceptions);
 gchar * 	jana_event_get_summary		(JanaEvent *self);
 gchar * 	jana_event_get_description	(JanaEvent *self);
 gchar * 	jana_event_get_location		(JanaEvent *self);
+const gchar *	jana_event_peek_summary		(JanaEvent *self);
+const gchar *	jana_event_peek_description	(JanaEvent *self);
+const gchar *	jana_event_peek_location	(JanaEvent *self);
 JanaTime * 	jana_event_get_start		(JanaEvent *self);
 JanaTime *	jana_event_get_end		(JanaEvent *self);
 gchar **	jana_event_get_categories	(JanaEvent *self);
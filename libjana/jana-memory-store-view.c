@@ -0,0 +1,743 @@
+/*
+ * Copyright (C) 2009 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St - Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+/**
+ * SECTION:jana-memory-store-view
+ * @short_description: An implementation of #JanaStoreView for 
+ * #JanaMemoryStore
+ *
+ * #JanaMemoryStoreView is an implementation of #JanaStoreView over a 
+ * #JanaMemoryStore. It reports components in the same way as other store 
+ * views: after jana_store_view_start() is called, everything in range is 
+ * reported from idle time with the ::added signal, followed by ::progress 
+ * at 100, and changes to the store are reported as they happen.
+ */
+
+#include <string.h>
+#include "jana-utils.h"
+#include "jana-memory-store-view.h"
+
+static void store_view_interface_init (gpointer g_iface, gpointer iface_data);
+
+static void	store_view_get_range	(JanaStoreView *self,
+					 JanaTime **start,
+					 JanaTime **end);
+
+static void	store_view_set_range	(JanaStoreView *self,
+					 JanaTime *start,
+					 JanaTime *end);
+
+static JanaStoreViewMatch *store_view_add_match (JanaStoreView *self,
+						 JanaStoreViewField field,
+						 const gchar *data);
+
+static GList * store_view_get_matches	(JanaStoreView *self);
+
+static void	store_view_remove_match	(JanaStoreView *self,
+					 JanaStoreViewMatch *match);
+
+static void	store_view_clear_matches(JanaStoreView *self);
+
+static void	store_view_start	(JanaStoreView *self);
+
+static JanaStore *store_view_get_store	(JanaStoreView *self);
+
+static void	store_view_begin_update	(JanaStoreView *self);
+
+static void	store_view_commit_update(JanaStoreView *self);
+
+static void	store_view_set_limit	(JanaStoreView *self, guint limit);
+
+static guint	store_view_get_limit	(JanaStoreView *self);
+
+static void	store_view_schedule_refresh (JanaMemoryStoreView *self);
+
+static void	store_view_set_parent	(JanaMemoryStoreView *self,
+					 JanaMemoryStore *parent);
+
+G_DEFINE_TYPE_WITH_CODE (JanaMemoryStoreView, 
+                        jana_memory_store_view, 
+                        G_TYPE_OBJECT,
+                        G_IMPLEMENT_INTERFACE (JANA_TYPE_STORE_VIEW,
+                                               store_view_interface_init));
+
+#define MEMORY_STORE_VIEW_PRIVATE(o) (G_TYPE_INSTANCE_GET_PRIVATE ((o), \
+			  JANA_TYPE_MEMORY_STORE_VIEW, \
+			  JanaMemoryStoreViewPrivate))
+
+typedef struct _JanaMemoryStoreViewPrivate JanaMemoryStoreViewPrivate;
+
+struct _JanaMemoryStoreViewPrivate
+{
+	JanaMemoryStore *parent;
+	JanaTime *start;
+	JanaTime *end;
+	GList *matches;
+	JanaStoreViewPredicate *predicate;
+	
+	/* The uids of the components currently in view */
+	GHashTable *uids;
+	gboolean started;
+	
+	guint refresh_id;
+	guint update_depth;
+	
+	/* When set, only the events that occur soonest after start are in 
+	 * view, and any change to the store results in a refresh to rank 
+	 * them again.
+	 */
+	guint limit;
+};
+
+enum {
+	PROP_PARENT = 1,
+	PROP_START,
+	PROP_END,
+};
+
+static void
+jana_memory_store_view_get_property (GObject *object, guint property_id,
+				     GValue *value, GParamSpec *pspec)
+{
+	JanaMemoryStoreViewPrivate *priv = MEMORY_STORE_VIEW_PRIVATE (object);
+
+	switch (property_id) {
+	    case PROP_PARENT :
+		g_value_set_object (value, priv->parent);
+		break;
+	    case PROP_START :
+		g_value_take_object (value, priv->start ?
+			jana_time_duplicate (priv->start) : NULL);
+		break;
+	    case PROP_END :
+		g_value_take_object (value, priv->end ?
+			jana_time_duplicate (priv->end) : NULL);
+		break;
+	    default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+	}
+}
+
+static void
+jana_memory_store_view_set_property (GObject *object, guint property_id,
+				     const GValue *value, GParamSpec *pspec)
+{
+	JanaMemoryStoreViewPrivate *priv = MEMORY_STORE_VIEW_PRIVATE (object);
+
+	switch (property_id) {
+	    case PROP_PARENT :
+		store_view_set_parent (JANA_MEMORY_STORE_VIEW (object),
+			JANA_MEMORY_STORE (g_value_get_object (value)));
+		break;
+	    case PROP_START :
+		jana_store_view_set_range (JANA_STORE_VIEW (object), 
+			JANA_TIME (g_value_get_object (value)), priv->end);
+		break;
+	    case PROP_END :
+		jana_store_view_set_range (JANA_STORE_VIEW (object), 
+			priv->start, JANA_TIME (g_value_get_object (value)));
+		break;
+	    default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+	}
+}
+
+static void
+jana_memory_store_view_dispose (GObject *object)
+{
+	JanaMemoryStoreViewPrivate *priv = MEMORY_STORE_VIEW_PRIVATE (object);
+	
+	if (priv->refresh_id) {
+		g_source_remove (priv->refresh_id);
+		priv->refresh_id = 0;
+	}
+	
+	if (priv->parent) {
+		g_signal_handlers_disconnect_matched (priv->parent,
+			G_SIGNAL_MATCH_DATA, 0, 0, NULL, NULL, object);
+		g_object_unref (priv->parent);
+		priv->parent = NULL;
+	}
+	
+	if (priv->start) {
+		g_object_unref (priv->start);
+		priv->start = NULL;
+	}
+	
+	if (priv->end) {
+		g_object_unref (priv->end);
+		priv->end = NULL;
+	}
+
+	if (G_OBJECT_CLASS (jana_memory_store_view_parent_class)->dispose)
+		G_OBJECT_CLASS (jana_memory_store_view_parent_class)->dispose (
+			object);
+}
+
+static void
+jana_memory_store_view_finalize (GObject *object)
+{
+	JanaMemoryStoreViewPrivate *priv = MEMORY_STORE_VIEW_PRIVATE (object);
+	
+	while (priv->matches) {
+		JanaStoreViewMatch *match =
+			(JanaStoreViewMatch *)priv->matches->data;
+		g_free (match->data);
+		g_slice_free (JanaStoreViewMatch, match);
+		priv->matches = g_list_delete_link (priv->matches,
+			priv->matches);
+	}
+	
+	if (priv->predicate)
+		jana_store_view_predicate_free (priv->predicate);
+	
+	g_hash_table_destroy (priv->uids);
+
+	G_OBJECT_CLASS (jana_memory_store_view_parent_class)->finalize (
+		object);
+}
+
+static void
+store_view_interface_init (gpointer g_iface, gpointer iface_data)
+{
+	JanaStoreViewInterface *iface = (JanaStoreViewInterface *)g_iface;
+	
+	iface->get_range = store_view_get_range;
+	iface->set_range = store_view_set_range;
+	iface->add_match = store_view_add_match;
+	iface->get_matches = store_view_get_matches;
+	iface->remove_match = store_view_remove_match;
+	iface->clear_matches = store_view_clear_matches;
+
+	iface->start = store_view_start;
+	
+	iface->get_store = store_view_get_store;
+	
+	iface->begin_update = store_view_begin_update;
+	iface->commit_update = store_view_commit_update;
+	
+	iface->set_limit = store_view_set_limit;
+	iface->get_limit = store_view_get_limit;
+}
+
+static void
+jana_memory_store_view_class_init (JanaMemoryStoreViewClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+	g_type_class_add_private (klass, sizeof (JanaMemoryStoreViewPrivate));
+
+	object_class->get_property = jana_memory_store_view_get_property;
+	object_class->set_property = jana_memory_store_view_set_property;
+	object_class->dispose = jana_memory_store_view_dispose;
+	object_class->finalize = jana_memory_store_view_finalize;
+
+	g_object_class_install_property (
+		object_class,
+		PROP_PARENT,
+		g_param_spec_object (
+			"parent",
+			"JanaMemoryStore *",
+			"The JanaMemoryStore this view is filtering.",
+			JANA_TYPE_MEMORY_STORE,
+			G_PARAM_READWRITE |
+			G_PARAM_CONSTRUCT_ONLY));
+
+	g_object_class_install_property (
+		object_class,
+		PROP_START,
+		g_param_spec_object (
+			"start",
+			"JanaTime *",
+			"The start of the range being queried.",
+			G_TYPE_OBJECT,
+			G_PARAM_READWRITE));
+
+	g_object_class_install_property (
+		object_class,
+		PROP_END,
+		g_param_spec_object (
+			"end",
+			"JanaTime *",
+			"The end of the range being queried.",
+			G_TYPE_OBJECT,
+			G_PARAM_READWRITE));
+}
+
+static void
+jana_memory_store_view_init (JanaMemoryStoreView *self)
+{
+	JanaMemoryStoreViewPrivate *priv = MEMORY_STORE_VIEW_PRIVATE (self);
+	
+	priv->uids = g_hash_table_new_full (g_str_hash, g_str_equal,
+		g_free, NULL);
+}
+
+/**
+ * jana_memory_store_view_new:
+ * @store: A #JanaMemoryStore
+ *
+ * Creates a new #JanaMemoryStoreView on the given store.
+ *
+ * Returns: A new #JanaMemoryStoreView, cast as a #JanaStoreView.
+ */
+JanaStoreView *
+jana_memory_store_view_new (JanaMemoryStore *store)
+{
+	return JANA_STORE_VIEW (g_object_new (JANA_TYPE_MEMORY_STORE_VIEW,
+		"parent", store, NULL));
+}
+
+static gboolean
+store_view_is_limited (JanaMemoryStoreView *self)
+{
+	JanaMemoryStoreViewPrivate *priv = MEMORY_STORE_VIEW_PRIVATE (self);
+	
+	return (priv->limit && priv->start);
+}
+
+static gboolean
+store_view_is_visible (JanaMemoryStoreView *self, JanaComponent *comp)
+{
+	JanaMemoryStoreViewPrivate *priv = MEMORY_STORE_VIEW_PRIVATE (self);
+	
+	if (priv->predicate &&
+	    !jana_store_view_predicate_match (priv->predicate, comp))
+		return FALSE;
+	
+	return jana_memory_store_component_occurs (priv->parent, comp,
+		priv->start, priv->end);
+}
+
+static void
+store_view_emit_removed (JanaMemoryStoreView *self, GList *uids)
+{
+	if (uids) g_signal_emit_by_name (self, "removed", uids);
+	
+	while (uids) {
+		g_free (uids->data);
+		uids = g_list_delete_link (uids, uids);
+	}
+}
+
+static void
+store_view_components_added_cb (JanaMemoryStore *store, GList *components,
+				JanaMemoryStoreView *self)
+{
+	GList *added = NULL;
+	JanaMemoryStoreViewPrivate *priv = MEMORY_STORE_VIEW_PRIVATE (self);
+	
+	if (!priv->started) return;
+	
+	if (store_view_is_limited (self)) {
+		store_view_schedule_refresh (self);
+		return;
+	}
+	
+	for (; components; components = components->next) {
+		JanaComponent *comp = JANA_COMPONENT (components->data);
+		const gchar *uid = jana_component_peek_uid (comp);
+		
+		if (!store_view_is_visible (self, comp)) continue;
+		
+		g_hash_table_insert (priv->uids, g_strdup (uid), NULL);
+		added = g_list_prepend (added, comp);
+	}
+	
+	if (added) {
+		g_signal_emit_by_name (self, "added", added);
+		g_list_free (added);
+	}
+}
+
+static void
+store_view_components_modified_cb (JanaMemoryStore *store,
+				   GList *components,
+				   JanaMemoryStoreView *self)
+{
+	GList *added = NULL, *modified = NULL, *removed = NULL;
+	JanaMemoryStoreViewPrivate *priv = MEMORY_STORE_VIEW_PRIVATE (self);
+	
+	if (!priv->started) return;
+	
+	for (; components; components = components->next) {
+		JanaComponent *comp = JANA_COMPONENT (components->data);
+		const gchar *uid = jana_component_peek_uid (comp);
+		gboolean visible = store_view_is_visible (self, comp);
+		
+		/* Components can be modified into or out of the range. When 
+		 * limited, they may also have moved in or out of the soonest, 
+		 * which the refresh below works out.
+		 */
+		if (store_view_is_limited (self)) {
+			if (visible && g_hash_table_lookup_extended (
+			     priv->uids, uid, NULL, NULL))
+				modified = g_list_prepend (modified, comp);
+		} else if (g_hash_table_lookup_extended (
+		     priv->uids, uid, NULL, NULL)) {
+			if (visible)
+				modified = g_list_prepend (modified, comp);
+			else {
+				removed = g_list_prepend (removed,
+					g_strdup (uid));
+				g_hash_table_remove (priv->uids, uid);
+			}
+		} else if (visible) {
+			g_hash_table_insert (priv->uids, g_strdup (uid), NULL);
+			added = g_list_prepend (added, comp);
+		}
+	}
+	
+	if (added) g_signal_emit_by_name (self, "added", added);
+	if (modified) g_signal_emit_by_name (self, "modified", modified);
+	store_view_emit_removed (self, removed);
+	
+	g_list_free (added);
+	g_list_free (modified);
+	
+	if (store_view_is_limited (self)) store_view_schedule_refresh (self);
+}
+
+static void
+store_view_components_removed_cb (JanaMemoryStore *store, GList *uids,
+				  JanaMemoryStoreView *self)
+{
+	GList *removed = NULL;
+	JanaMemoryStoreViewPrivate *priv = MEMORY_STORE_VIEW_PRIVATE (self);
+	
+	if (!priv->started) return;
+	
+	for (; uids; uids = uids->next) {
+		if (!g_hash_table_remove (priv->uids, uids->data)) continue;
+		removed = g_list_prepend (removed, g_strdup (uids->data));
+	}
+	
+	/* Something else may now be among the soonest */
+	if (removed && store_view_is_limited (self))
+		store_view_schedule_refresh (self);
+	
+	store_view_emit_removed (self, removed);
+}
+
+static void
+store_view_set_parent (JanaMemoryStoreView *self, JanaMemoryStore *parent)
+{
+	JanaMemoryStoreViewPrivate *priv = MEMORY_STORE_VIEW_PRIVATE (self);
+	
+	priv->parent = g_object_ref (parent);
+	
+	g_signal_connect (parent, "components-added",
+		G_CALLBACK (store_view_components_added_cb), self);
+	g_signal_connect (parent, "components-modified",
+		G_CALLBACK (store_view_components_modified_cb), self);
+	g_signal_connect (parent, "components-removed",
+		G_CALLBACK (store_view_components_removed_cb), self);
+}
+
+typedef struct {
+	JanaComponent *comp;
+	gint64 next;
+} StoreViewRanked;
+
+static gint
+store_view_ranked_compare (gconstpointer a, gconstpointer b)
+{
+	const StoreViewRanked *ranked1 = (const StoreViewRanked *)a;
+	const StoreViewRanked *ranked2 = (const StoreViewRanked *)b;
+	
+	if (ranked1->next != ranked2->next)
+		return (ranked1->next < ranked2->next) ? -1 : 1;
+	
+	return strcmp (jana_component_peek_uid (ranked1->comp),
+		jana_component_peek_uid (ranked2->comp));
+}
+
+/* Keeps only the events that occur soonest after the start of the range */
+static GList *
+store_view_limit_components (JanaMemoryStoreView *self, GList *components)
+{
+	GList *c, *limited = NULL;
+	GArray *ranked;
+	guint i;
+	JanaMemoryStoreViewPrivate *priv = MEMORY_STORE_VIEW_PRIVATE (self);
+	
+	ranked = g_array_new (FALSE, FALSE, sizeof (StoreViewRanked));
+	for (c = components; c; c = c->next) {
+		StoreViewRanked entry;
+		JanaDuration *next;
+		
+		entry.comp = JANA_COMPONENT (c->data);
+		if ((jana_component_get_component_type (entry.comp) !=
+		     JANA_COMPONENT_EVENT) ||
+		    !(next = jana_utils_event_get_next_instance (
+		      JANA_EVENT (entry.comp), priv->start)))
+			continue;
+		
+		entry.next = jana_utils_time_to_seconds (next->start);
+		jana_duration_free (next);
+		g_array_append_val (ranked, entry);
+	}
+	g_list_free (components);
+	
+	g_array_sort (ranked, store_view_ranked_compare);
+	for (i = MIN (ranked->len, priv->limit); i > 0; i--) {
+		limited = g_list_prepend (limited, g_array_index (
+			ranked, StoreViewRanked, i - 1).comp);
+	}
+	g_array_free (ranked, TRUE);
+	
+	return limited;
+}
+
+/* Works out what has come into and gone out of view since the last 
+ * refresh, and reports the difference.
+ */
+static void
+store_view_refresh (JanaMemoryStoreView *self)
+{
+	GList *c, *components, *added = NULL, *removed = NULL;
+	GHashTable *uids;
+	GHashTableIter iter;
+	gpointer uid;
+	JanaMemoryStoreViewPrivate *priv = MEMORY_STORE_VIEW_PRIVATE (self);
+	
+	uids = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	components = jana_memory_store_get_components (priv->parent,
+		priv->start, priv->end);
+	
+	/* Filtered first, so that matches can't push events out */
+	if (priv->predicate) {
+		for (c = components; c;) {
+			GList *next = c->next;
+			if (!jana_store_view_predicate_match (priv->predicate,
+			     JANA_COMPONENT (c->data)))
+				components = g_list_delete_link (
+					components, c);
+			c = next;
+		}
+	}
+	if (store_view_is_limited (self))
+		components = store_view_limit_components (self, components);
+	
+	for (c = components; c; c = c->next) {
+		JanaComponent *comp = JANA_COMPONENT (c->data);
+		const gchar *uid = jana_component_peek_uid (comp);
+		
+		g_hash_table_insert (uids, g_strdup (uid), NULL);
+		if (!g_hash_table_remove (priv->uids, uid))
+			added = g_list_prepend (added, comp);
+	}
+	g_list_free (components);
+	
+	/* Whatever is left is no longer in view */
+	g_hash_table_iter_init (&iter, priv->uids);
+	while (g_hash_table_iter_next (&iter, &uid, NULL)) {
+		removed = g_list_prepend (removed, uid);
+		g_hash_table_iter_steal (&iter);
+	}
+	g_hash_table_destroy (priv->uids);
+	priv->uids = uids;
+	
+	if (added) {
+		g_signal_emit_by_name (self, "added", added);
+		g_list_free (added);
+	}
+	store_view_emit_removed (self, removed);
+	
+	g_signal_emit_by_name (self, "progress", 100);
+}
+
+static gboolean
+store_view_refresh_cb (JanaMemoryStoreView *self)
+{
+	JanaMemoryStoreViewPrivate *priv = MEMORY_STORE_VIEW_PRIVATE (self);
+	
+	priv->refresh_id = 0;
+	store_view_refresh (self);
+	
+	return FALSE;
+}
+
+/* As with other store views, changes are applied from idle time or at the 
+ * end of an update, so that several in a row result in one refresh.
+ */
+static void
+store_view_schedule_refresh (JanaMemoryStoreView *self)
+{
+	JanaMemoryStoreViewPrivate *priv = MEMORY_STORE_VIEW_PRIVATE (self);
+	
+	if ((!priv->started) || priv->update_depth || priv->refresh_id)
+		return;
+	
+	priv->refresh_id = g_idle_add (
+		(GSourceFunc)store_view_refresh_cb, self);
+}
+
+static void
+store_view_matches_changed (JanaMemoryStoreView *self)
+{
+	JanaMemoryStoreViewPrivate *priv = MEMORY_STORE_VIEW_PRIVATE (self);
+	
+	if (priv->predicate)
+		jana_store_view_predicate_free (priv->predicate);
+	priv->predicate = priv->matches ?
+		jana_store_view_predicate_new (priv->matches) : NULL;
+	
+	store_view_schedule_refresh (self);
+}
+
+static void
+store_view_begin_update (JanaStoreView *self)
+{
+	JanaMemoryStoreViewPrivate *priv = MEMORY_STORE_VIEW_PRIVATE (self);
+	
+	priv->update_depth ++;
+}
+
+static void
+store_view_commit_update (JanaStoreView *self)
+{
+	JanaMemoryStoreViewPrivate *priv = MEMORY_STORE_VIEW_PRIVATE (self);
+	
+	g_return_if_fail (priv->update_depth > 0);
+	
+	if (--priv->update_depth) return;
+	
+	if (priv->refresh_id) {
+		g_source_remove (priv->refresh_id);
+		priv->refresh_id = 0;
+	}
+	if (priv->started) store_view_refresh (JANA_MEMORY_STORE_VIEW (self));
+}
+
+static void
+store_view_get_range (JanaStoreView *self,
+		      JanaTime **start,
+		      JanaTime **end)
+{
+	g_object_get (self, "start", start, "end", end, NULL);
+}
+
+static void
+store_view_set_range (JanaStoreView *self,
+		      JanaTime *start,
+		      JanaTime *end)
+{
+	JanaMemoryStoreViewPrivate *priv = MEMORY_STORE_VIEW_PRIVATE (self);
+	
+	/* Duplicated first, in case either is the current start or end */
+	start = start ? jana_time_duplicate (start) : NULL;
+	end = end ? jana_time_duplicate (end) : NULL;
+	
+	if (priv->start) g_object_unref (priv->start);
+	if (priv->end) g_object_unref (priv->end);
+	priv->start = start;
+	priv->end = end;
+	
+	store_view_schedule_refresh (JANA_MEMORY_STORE_VIEW (self));
+}
+
+static JanaStoreViewMatch *
+store_view_add_match (JanaStoreView *self, JanaStoreViewField field,
+		      const gchar *data)
+{
+	JanaStoreViewMatch *match;
+	JanaMemoryStoreViewPrivate *priv = MEMORY_STORE_VIEW_PRIVATE (self);
+	
+	g_assert (data);
+	
+	match = g_slice_new (JanaStoreViewMatch);
+	match->field = field;
+	match->data = g_strdup (data);
+	priv->matches = g_list_prepend (priv->matches, match);
+	
+	store_view_matches_changed (JANA_MEMORY_STORE_VIEW (self));
+
+	return match;
+}
+
+static GList *
+store_view_get_matches (JanaStoreView *self)
+{
+	JanaMemoryStoreViewPrivate *priv = MEMORY_STORE_VIEW_PRIVATE (self);
+	
+	return g_list_copy (priv->matches);
+}
+
+static void
+store_view_remove_match (JanaStoreView *self, JanaStoreViewMatch *match)
+{
+	JanaMemoryStoreViewPrivate *priv = MEMORY_STORE_VIEW_PRIVATE (self);
+	
+	priv->matches = g_list_remove (priv->matches, match);
+	g_free (match->data);
+	g_slice_free (JanaStoreViewMatch, match);
+
+	store_view_matches_changed (JANA_MEMORY_STORE_VIEW (self));
+}
+
+static void
+store_view_clear_matches (JanaStoreView *self)
+{
+	JanaMemoryStoreViewPrivate *priv = MEMORY_STORE_VIEW_PRIVATE (self);
+	
+	while (priv->matches) {
+		store_view_remove_match (self,
+			(JanaStoreViewMatch *)priv->matches->data);
+	}
+}
+
+static void
+store_view_start (JanaStoreView *self)
+{
+	JanaMemoryStoreViewPrivate *priv = MEMORY_STORE_VIEW_PRIVATE (self);
+
+	if (priv->started) return;
+	
+	priv->started = TRUE;
+	store_view_schedule_refresh (JANA_MEMORY_STORE_VIEW (self));
+}
+
+static void
+store_view_set_limit (JanaStoreView *self, guint limit)
+{
+	JanaMemoryStoreViewPrivate *priv = MEMORY_STORE_VIEW_PRIVATE (self);
+	
+	if (priv->limit == limit) return;
+	
+	priv->limit = limit;
+	store_view_schedule_refresh (JANA_MEMORY_STORE_VIEW (self));
+}
+
+static guint
+store_view_get_limit (JanaStoreView *self)
+{
+	JanaMemoryStoreViewPrivate *priv = MEMORY_STORE_VIEW_PRIVATE (self);
+	
+	return priv->limit;
+}
+
+static JanaStore *
+store_view_get_store (JanaStoreView *self)
+{
+	JanaStore *store;
+	
+	g_object_get (self, "parent", &store, NULL);
+	
+	return store;
+}
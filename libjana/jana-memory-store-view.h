@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2009 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St - Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef JANA_MEMORY_STORE_VIEW_H
+#define JANA_MEMORY_STORE_VIEW_H
+
+#include <glib-object.h>
+#include <libjana/jana-store-view.h>
+#include <libjana/jana-memory-store.h>
+
+#define JANA_TYPE_MEMORY_STORE_VIEW	(jana_memory_store_view_get_type ())
+#define JANA_MEMORY_STORE_VIEW(obj)	(G_TYPE_CHECK_INSTANCE_CAST ((obj), \
+					 JANA_TYPE_MEMORY_STORE_VIEW, \
+					 JanaMemoryStoreView))
+#define JANA_MEMORY_STORE_VIEW_CLASS(vtable)	(G_TYPE_CHECK_CLASS_CAST \
+						 ((vtable), \
+						 JANA_TYPE_MEMORY_STORE_VIEW, \
+						 JanaMemoryStoreViewClass))
+#define JANA_IS_MEMORY_STORE_VIEW(obj)	(G_TYPE_CHECK_INSTANCE_TYPE ((obj), \
+					 JANA_TYPE_MEMORY_STORE_VIEW))
+#define JANA_IS_MEMORY_STORE_VIEW_CLASS(vtable)	(G_TYPE_CHECK_CLASS_TYPE \
+						 ((vtable), \
+						 JANA_TYPE_MEMORY_STORE_VIEW))
+#define JANA_MEMORY_STORE_VIEW_GET_CLASS(inst)	(G_TYPE_INSTANCE_GET_CLASS \
+						 ((inst), \
+						 JANA_TYPE_MEMORY_STORE_VIEW, \
+						 JanaMemoryStoreViewClass))
+
+
+typedef struct _JanaMemoryStoreView JanaMemoryStoreView;
+typedef struct _JanaMemoryStoreViewClass JanaMemoryStoreViewClass;
+
+/**
+ * JanaMemoryStoreView:
+ *
+ * The #JanaMemoryStoreView struct contains only private data.
+ */
+struct _JanaMemoryStoreView {
+	GObject parent;
+};
+
+struct _JanaMemoryStoreViewClass {
+	GObjectClass parent;
+};
+
+GType jana_memory_store_view_get_type (void);
+
+JanaStoreView *jana_memory_store_view_new (JanaMemoryStore *store);
+
+#endif /* JANA_MEMORY_STORE_VIEW_H */
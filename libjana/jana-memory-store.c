@@ -0,0 +1,592 @@
+/*
+ * Copyright (C) 2009 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St - Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+/**
+ * SECTION:jana-memory-store
+ * @short_description: An in-memory implementation of #JanaStore
+ *
+ * #JanaMemoryStore is an implementation of #JanaStore that keeps its 
+ * components in memory and never touches the disk or any server. It is 
+ * useful for testing and benchmarking code that uses #JanaStore, and as a 
+ * local cache in front of a slower store.
+ *
+ * Components added to a #JanaMemoryStore are kept by reference rather than 
+ * copied, so changes made to them should be followed by a call to 
+ * jana_store_modify_component(). As #JanaComponent has no way of setting 
+ * a uid, components must already have one when they are added. Events 
+ * that don't recur are indexed by time, so that views on a narrow range 
+ * don't need to look at every component in the store.
+ */
+
+#include <string.h>
+#include "jana-utils.h"
+#include "jana-memory-store.h"
+#include "jana-memory-store-view.h"
+
+static void store_interface_init (gpointer g_iface, gpointer iface_data);
+
+static void		store_open			(JanaStore *self);
+
+static JanaComponent *	 store_get_component		(JanaStore *self,
+							 const gchar *uid);
+
+static JanaStoreView *	 store_get_view			(JanaStore *self);
+
+static void	store_add_component	(JanaStore *self, JanaComponent *comp);
+static void	store_modify_component	(JanaStore *self, JanaComponent *comp);
+static void	store_remove_component	(JanaStore *self, JanaComponent *comp);
+
+G_DEFINE_TYPE_WITH_CODE (JanaMemoryStore,
+                        jana_memory_store, 
+                        G_TYPE_OBJECT,
+                        G_IMPLEMENT_INTERFACE (JANA_TYPE_STORE,
+                                               store_interface_init));
+
+#define MEMORY_STORE_PRIVATE(o) (G_TYPE_INSTANCE_GET_PRIVATE ((o), \
+			  JANA_TYPE_MEMORY_STORE, JanaMemoryStorePrivate))
+
+typedef struct _JanaMemoryStorePrivate JanaMemoryStorePrivate;
+typedef struct _MemoryStoreEntry MemoryStoreEntry;
+
+struct _JanaMemoryStorePrivate
+{
+	/* uid -> MemoryStoreEntry */
+	GHashTable *entries;
+	
+	/* Entries with a single, known extent, sorted by start time unless 
+	 * index_dirty is set. No entry in the index lasts longer than 
+	 * max_duration, which bounds how far back a range query has to look. 
+	 * When the longest entry is removed, max_duration is worked out 
+	 * again on the next query.
+	 */
+	GPtrArray *index;
+	gboolean index_dirty;
+	gint64 max_duration;
+	gboolean max_duration_dirty;
+	
+	/* Recurring and undated entries, which are checked one by one */
+	GList *unindexed;
+};
+
+struct _MemoryStoreEntry {
+	JanaComponent *component;
+	/* See jana_utils_time_to_seconds() */
+	gint64 start;
+	gint64 end;
+	gboolean dated;
+	gboolean recurs;
+};
+
+enum {
+	COMPONENTS_ADDED,
+	COMPONENTS_MODIFIED,
+	COMPONENTS_REMOVED,
+	LAST_SIGNAL
+};
+
+static guint signals[LAST_SIGNAL] = { 0 };
+
+static void
+memory_store_entry_free (MemoryStoreEntry *entry)
+{
+	g_object_unref (entry->component);
+	g_slice_free (MemoryStoreEntry, entry);
+}
+
+static void
+jana_memory_store_finalize (GObject *object)
+{
+	JanaMemoryStorePrivate *priv = MEMORY_STORE_PRIVATE (object);
+	
+	g_list_free (priv->unindexed);
+	g_ptr_array_free (priv->index, TRUE);
+	g_hash_table_destroy (priv->entries);
+	
+	G_OBJECT_CLASS (jana_memory_store_parent_class)->finalize (object);
+}
+
+static void
+store_interface_init (gpointer g_iface, gpointer iface_data)
+{
+	JanaStoreInterface *iface = (JanaStoreInterface *)g_iface;
+	
+	iface->open = store_open;
+	
+	iface->get_component = store_get_component;
+	
+	iface->get_view = store_get_view;
+	
+	iface->add_component = store_add_component;
+	iface->modify_component = store_modify_component;
+	iface->remove_component = store_remove_component;
+}
+
+static void
+jana_memory_store_class_init (JanaMemoryStoreClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+	g_type_class_add_private (klass, sizeof (JanaMemoryStorePrivate));
+
+	object_class->finalize = jana_memory_store_finalize;
+	
+	/**
+	 * JanaMemoryStore::components-added:
+	 * @store: the store that received the signal
+	 * @components: A list of #JanaComponent<!-- -->s
+	 *
+	 * The ::components-added signal is emitted when components are added 
+	 * to the store.
+	 **/
+	signals[COMPONENTS_ADDED] = g_signal_new ("components-added",
+		G_OBJECT_CLASS_TYPE (object_class),
+		G_SIGNAL_RUN_LAST,
+		G_STRUCT_OFFSET (JanaMemoryStoreClass, components_added),
+		NULL, NULL,
+		g_cclosure_marshal_VOID__POINTER,
+		G_TYPE_NONE, 1, G_TYPE_POINTER);
+
+	/**
+	 * JanaMemoryStore::components-modified:
+	 * @store: the store that received the signal
+	 * @components: A list of #JanaComponent<!-- -->s
+	 *
+	 * The ::components-modified signal is emitted when components in the 
+	 * store are modified.
+	 **/
+	signals[COMPONENTS_MODIFIED] = g_signal_new ("components-modified",
+		G_OBJECT_CLASS_TYPE (object_class),
+		G_SIGNAL_RUN_LAST,
+		G_STRUCT_OFFSET (JanaMemoryStoreClass, components_modified),
+		NULL, NULL,
+		g_cclosure_marshal_VOID__POINTER,
+		G_TYPE_NONE, 1, G_TYPE_POINTER);
+
+	/**
+	 * JanaMemoryStore::components-removed:
+	 * @store: the store that received the signal
+	 * @uids: A list of uids
+	 *
+	 * The ::components-removed signal is emitted when components are 
+	 * removed from the store.
+	 **/
+	signals[COMPONENTS_REMOVED] = g_signal_new ("components-removed",
+		G_OBJECT_CLASS_TYPE (object_class),
+		G_SIGNAL_RUN_LAST,
+		G_STRUCT_OFFSET (JanaMemoryStoreClass, components_removed),
+		NULL, NULL,
+		g_cclosure_marshal_VOID__POINTER,
+		G_TYPE_NONE, 1, G_TYPE_POINTER);
+}
+
+static void
+jana_memory_store_init (JanaMemoryStore *self)
+{
+	JanaMemoryStorePrivate *priv = MEMORY_STORE_PRIVATE (self);
+	
+	priv->entries = g_hash_table_new_full (g_str_hash, g_str_equal,
+		g_free, (GDestroyNotify)memory_store_entry_free);
+	priv->index = g_ptr_array_new ();
+}
+
+/**
+ * jana_memory_store_new:
+ *
+ * Creates a new, empty #JanaMemoryStore.
+ *
+ * Returns: A new #JanaMemoryStore, cast as a #JanaStore.
+ */
+JanaStore *
+jana_memory_store_new (void)
+{
+	return JANA_STORE (g_object_new (JANA_TYPE_MEMORY_STORE, NULL));
+}
+
+static void
+memory_store_entry_update (MemoryStoreEntry *entry)
+{
+	JanaTime *start = NULL, *end = NULL;
+	
+	entry->recurs = FALSE;
+	
+	switch (jana_component_get_component_type (entry->component)) {
+	    case JANA_COMPONENT_EVENT :
+		start = jana_event_get_start (JANA_EVENT (entry->component));
+		end = jana_event_get_end (JANA_EVENT (entry->component));
+		entry->recurs = jana_event_has_recurrence (
+			JANA_EVENT (entry->component));
+		break;
+	    case JANA_COMPONENT_NOTE :
+		start = jana_note_get_creation_time (
+			JANA_NOTE (entry->component));
+		break;
+	    case JANA_COMPONENT_TASK :
+		start = jana_task_get_due_date (JANA_TASK (entry->component));
+		break;
+	    default :
+		break;
+	}
+	
+	/* A time that isn't set can come back invalid rather than %NULL */
+	entry->start = jana_utils_time_to_seconds (start);
+	entry->end = jana_utils_time_to_seconds (end);
+	entry->dated = (entry->start != G_MININT64);
+	if (entry->end < entry->start) entry->end = entry->start;
+	
+	if (start) g_object_unref (start);
+	if (end) g_object_unref (end);
+}
+
+static gint
+memory_store_entry_compare (gconstpointer a, gconstpointer b)
+{
+	const MemoryStoreEntry *entry1 = *((MemoryStoreEntry **)a);
+	const MemoryStoreEntry *entry2 = *((MemoryStoreEntry **)b);
+	
+	return (entry1->start < entry2->start) ? -1 :
+		((entry1->start > entry2->start) ? 1 : 0);
+}
+
+/* Returns the position of the first indexed entry starting at or after 
+ * @start.
+ */
+static guint
+memory_store_index_search (JanaMemoryStorePrivate *priv, gint64 start)
+{
+	guint low = 0, high = priv->index->len;
+	
+	if (priv->index_dirty) {
+		g_ptr_array_sort (priv->index, memory_store_entry_compare);
+		priv->index_dirty = FALSE;
+	}
+	
+	while (low < high) {
+		guint middle = (low + high) / 2;
+		MemoryStoreEntry *entry = (MemoryStoreEntry *)
+			g_ptr_array_index (priv->index, middle);
+		
+		if (entry->start < start)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+	
+	return low;
+}
+
+static void
+memory_store_index_insert (JanaMemoryStorePrivate *priv,
+			   MemoryStoreEntry *entry)
+{
+	MemoryStoreEntry *last;
+	
+	if ((!entry->dated) || entry->recurs) {
+		priv->unindexed = g_list_prepend (priv->unindexed, entry);
+		return;
+	}
+	
+	/* Adding lots of components in one go is common (loading a file, 
+	 * for example), so rather than inserting in order, sort the index 
+	 * when it's next searched.
+	 */
+	last = priv->index->len ? (MemoryStoreEntry *)g_ptr_array_index (
+		priv->index, priv->index->len - 1) : NULL;
+	if (last && (last->start > entry->start))
+		priv->index_dirty = TRUE;
+	g_ptr_array_add (priv->index, entry);
+	
+	priv->max_duration = MAX (priv->max_duration,
+		entry->end - entry->start);
+}
+
+static void
+memory_store_index_remove (JanaMemoryStorePrivate *priv,
+			   MemoryStoreEntry *entry)
+{
+	guint i;
+	
+	if ((!entry->dated) || entry->recurs) {
+		priv->unindexed = g_list_remove (priv->unindexed, entry);
+		return;
+	}
+	
+	i = priv->index_dirty ? 0 :
+		memory_store_index_search (priv, entry->start);
+	for (; i < priv->index->len; i++) {
+		if (g_ptr_array_index (priv->index, i) == entry) {
+			g_ptr_array_remove_index (priv->index, i);
+			break;
+		}
+	}
+	
+	if (priv->max_duration &&
+	    ((entry->end - entry->start) >= priv->max_duration))
+		priv->max_duration_dirty = TRUE;
+}
+
+static gint64
+memory_store_get_max_duration (JanaMemoryStorePrivate *priv)
+{
+	guint i;
+	
+	if (!priv->max_duration_dirty) return priv->max_duration;
+	
+	priv->max_duration = 0;
+	for (i = 0; i < priv->index->len; i++) {
+		MemoryStoreEntry *entry = (MemoryStoreEntry *)
+			g_ptr_array_index (priv->index, i);
+		priv->max_duration = MAX (priv->max_duration,
+			entry->end - entry->start);
+	}
+	priv->max_duration_dirty = FALSE;
+	
+	return priv->max_duration;
+}
+
+static gboolean
+memory_store_entry_occurs (MemoryStoreEntry *entry, gint64 start,
+			   gint64 end, JanaTime *range_start,
+			   JanaTime *range_end)
+{
+	GList *instances;
+	
+	/* There's nothing to place undated components by, so they're 
+	 * always in range.
+	 */
+	if (!entry->dated) return TRUE;
+	
+	if (entry->start >= end) return FALSE;
+	
+	if (entry->recurs) {
+		if ((!range_start) || (!range_end)) return TRUE;
+		
+		instances = jana_utils_event_get_instances (
+			JANA_EVENT (entry->component),
+			range_start, range_end, 0);
+		jana_utils_instance_list_free (instances);
+		
+		return (instances != NULL);
+	}
+	
+	/* Components without a duration occur at their start */
+	return (entry->end > start) || (entry->start >= start);
+}
+
+static void
+memory_store_get_range (JanaTime *range_start, JanaTime *range_end,
+			gint64 *start, gint64 *end)
+{
+	*start = range_start ?
+		jana_utils_time_to_seconds (range_start) : G_MININT64;
+	*end = range_end ?
+		jana_utils_time_to_seconds (range_end) : G_MAXINT64;
+}
+
+/**
+ * jana_memory_store_get_components:
+ * @self: A #JanaMemoryStore
+ * @start: The start of the range, or %NULL
+ * @end: The end of the range, or %NULL
+ *
+ * Retrieves the components in the store that occur between @start and 
+ * @end. A %NULL @start or @end leaves the range open at that end. 
+ * Components that have no time associated with them (a task without a due 
+ * date, for example) are always included.
+ *
+ * Returns: A newly allocated #GList of #JanaComponent<!-- -->s, which 
+ * should be freed with g_list_free(). The components belong to the store 
+ * and should be referenced if they need to be kept.
+ */
+GList *
+jana_memory_store_get_components (JanaMemoryStore *self, JanaTime *start,
+				  JanaTime *end)
+{
+	GList *u, *components = NULL;
+	gint64 start_seconds, end_seconds;
+	guint i;
+	JanaMemoryStorePrivate *priv = MEMORY_STORE_PRIVATE (self);
+	
+	memory_store_get_range (start, end, &start_seconds, &end_seconds);
+	
+	/* Nothing in the index lasts longer than max_duration, so anything 
+	 * that starts before that far back from the start of the range has 
+	 * already ended.
+	 */
+	i = start ? memory_store_index_search (priv,
+		start_seconds - memory_store_get_max_duration (priv)) : 0;
+	for (; i < priv->index->len; i++) {
+		MemoryStoreEntry *entry = (MemoryStoreEntry *)
+			g_ptr_array_index (priv->index, i);
+		
+		if (entry->start >= end_seconds) break;
+		if (memory_store_entry_occurs (entry, start_seconds,
+		     end_seconds, start, end))
+			components = g_list_prepend (components,
+				entry->component);
+	}
+	
+	for (u = priv->unindexed; u; u = u->next) {
+		MemoryStoreEntry *entry = (MemoryStoreEntry *)u->data;
+		
+		if (memory_store_entry_occurs (entry, start_seconds,
+		     end_seconds, start, end))
+			components = g_list_prepend (components,
+				entry->component);
+	}
+	
+	return components;
+}
+
+/**
+ * jana_memory_store_component_occurs:
+ * @self: A #JanaMemoryStore
+ * @component: A #JanaComponent
+ * @start: The start of the range, or %NULL
+ * @end: The end of the range, or %NULL
+ *
+ * Determines whether @component would be returned by 
+ * jana_memory_store_get_components() for the given range, were it in the 
+ * store.
+ *
+ * Returns: %TRUE if @component occurs between @start and @end, %FALSE 
+ * otherwise.
+ */
+gboolean
+jana_memory_store_component_occurs (JanaMemoryStore *self,
+				    JanaComponent *component,
+				    JanaTime *start, JanaTime *end)
+{
+	MemoryStoreEntry entry;
+	gint64 start_seconds, end_seconds;
+	
+	entry.component = component;
+	memory_store_entry_update (&entry);
+	memory_store_get_range (start, end, &start_seconds, &end_seconds);
+	
+	return memory_store_entry_occurs (&entry, start_seconds, end_seconds,
+		start, end);
+}
+
+static gboolean
+store_opened_cb (JanaStore *self)
+{
+	g_signal_emit_by_name (self, "opened");
+	return FALSE;
+}
+
+static void
+store_open (JanaStore *self)
+{
+	/* There's nothing to open, but ::opened is expected to come later */
+	g_idle_add_full (G_PRIORITY_DEFAULT_IDLE, (GSourceFunc)store_opened_cb,
+		g_object_ref (self), g_object_unref);
+}
+
+static JanaComponent *
+store_get_component (JanaStore *self, const gchar *uid)
+{
+	MemoryStoreEntry *entry;
+	JanaMemoryStorePrivate *priv = MEMORY_STORE_PRIVATE (self);
+	
+	entry = g_hash_table_lookup (priv->entries, uid);
+	
+	return entry ? g_object_ref (entry->component) : NULL;
+}
+
+static JanaStoreView *
+store_get_view (JanaStore *self)
+{
+	return jana_memory_store_view_new (JANA_MEMORY_STORE (self));
+}
+
+static void
+store_add_component (JanaStore *self, JanaComponent *comp)
+{
+	GList *components;
+	MemoryStoreEntry *entry;
+	const gchar *uid = jana_component_peek_uid (comp);
+	JanaMemoryStorePrivate *priv = MEMORY_STORE_PRIVATE (self);
+	
+	if ((!uid) || g_hash_table_lookup (priv->entries, uid)) {
+		g_warning ("%s: Component with missing or duplicate uid '%s'",
+			G_STRFUNC, uid ? uid : "");
+		return;
+	}
+	
+	entry = g_slice_new (MemoryStoreEntry);
+	entry->component = g_object_ref (comp);
+	memory_store_entry_update (entry);
+	memory_store_index_insert (priv, entry);
+	g_hash_table_insert (priv->entries, g_strdup (uid), entry);
+	
+	components = g_list_prepend (NULL, comp);
+	g_signal_emit (self, signals[COMPONENTS_ADDED], 0, components);
+	g_list_free (components);
+}
+
+static void
+store_modify_component (JanaStore *self, JanaComponent *comp)
+{
+	GList *components;
+	MemoryStoreEntry *entry;
+	const gchar *uid = jana_component_peek_uid (comp);
+	JanaMemoryStorePrivate *priv = MEMORY_STORE_PRIVATE (self);
+	
+	if ((!uid) || !(entry = g_hash_table_lookup (priv->entries, uid))) {
+		g_warning ("%s: Component '%s' not in store",
+			G_STRFUNC, uid ? uid : "");
+		return;
+	}
+	
+	/* Taken out with its old times, in case they've changed */
+	memory_store_index_remove (priv, entry);
+	if (entry->component != comp) {
+		g_object_unref (entry->component);
+		entry->component = g_object_ref (comp);
+	}
+	memory_store_entry_update (entry);
+	memory_store_index_insert (priv, entry);
+	
+	components = g_list_prepend (NULL, comp);
+	g_signal_emit (self, signals[COMPONENTS_MODIFIED], 0, components);
+	g_list_free (components);
+}
+
+static void
+store_remove_component (JanaStore *self, JanaComponent *comp)
+{
+	GList *uids;
+	MemoryStoreEntry *entry;
+	const gchar *uid = jana_component_peek_uid (comp);
+	JanaMemoryStorePrivate *priv = MEMORY_STORE_PRIVATE (self);
+	
+	if ((!uid) || !(entry = g_hash_table_lookup (priv->entries, uid))) {
+		g_warning ("%s: Component '%s' not in store",
+			G_STRFUNC, uid ? uid : "");
+		return;
+	}
+	
+	uids = g_list_prepend (NULL, g_strdup (uid));
+	memory_store_index_remove (priv, entry);
+	g_hash_table_remove (priv->entries, uid);
+	
+	g_signal_emit (self, signals[COMPONENTS_REMOVED], 0, uids);
+	
+	g_free (uids->data);
+	g_list_free (uids);
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2009 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St - Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef JANA_MEMORY_STORE_H
+#define JANA_MEMORY_STORE_H
+
+#include <glib-object.h>
+#include <libjana/jana-store.h>
+
+#define JANA_TYPE_MEMORY_STORE	(jana_memory_store_get_type ())
+#define JANA_MEMORY_STORE(obj)	(G_TYPE_CHECK_INSTANCE_CAST ((obj), \
+				 JANA_TYPE_MEMORY_STORE, JanaMemoryStore))
+#define JANA_MEMORY_STORE_CLASS(vtable)	(G_TYPE_CHECK_CLASS_CAST ((vtable), \
+					 JANA_TYPE_MEMORY_STORE, \
+					 JanaMemoryStoreClass))
+#define JANA_IS_MEMORY_STORE(obj)	(G_TYPE_CHECK_INSTANCE_TYPE ((obj), \
+					 JANA_TYPE_MEMORY_STORE))
+#define JANA_IS_MEMORY_STORE_CLASS(vtable)(G_TYPE_CHECK_CLASS_TYPE ((vtable), \
+					 JANA_TYPE_MEMORY_STORE))
+#define JANA_MEMORY_STORE_GET_CLASS(inst)	(G_TYPE_INSTANCE_GET_CLASS ((inst), \
+					 JANA_TYPE_MEMORY_STORE, \
+					 JanaMemoryStoreClass))
+
+
+typedef struct _JanaMemoryStore JanaMemoryStore;
+typedef struct _JanaMemoryStoreClass JanaMemoryStoreClass;
+
+/**
+ * JanaMemoryStore:
+ *
+ * The #JanaMemoryStore struct contains only private data.
+ */
+struct _JanaMemoryStore {
+	GObject parent;
+};
+
+struct _JanaMemoryStoreClass {
+	GObjectClass parent;
+	
+	/* Signals */
+	void	(*components_added)	(JanaMemoryStore *self,
+					 GList *components);
+	void	(*components_modified)	(JanaMemoryStore *self,
+					 GList *components);
+	void	(*components_removed)	(JanaMemoryStore *self,
+					 GList *uids);
+};
+
+GType jana_memory_store_get_type (void);
+
+JanaStore *jana_memory_store_new	(void);
+
+GList *	jana_memory_store_get_components	(JanaMemoryStore *self,
+						 JanaTime *start,
+						 JanaTime *end);
+gboolean jana_memory_store_component_occurs	(JanaMemoryStore *self,
+						 JanaComponent *component,
+						 JanaTime *start,
+						 JanaTime *end);
+
+#endif /* JANA_MEMORY_STORE_H */
@@ -102,6 +102,82 @@ jana_note_get_body (JanaNote *note)
 	return JANA_NOTE_GET_INTERFACE (note)->get_body (note);
 }
 
+/* For implementations without peek_*, hang the copy off the note */
+static const gchar *
+note_peek_fallback (JanaNote *note, const gchar *key, gchar *value)
+{
+	g_object_set_data_full (G_OBJECT (note), key, value, g_free);
+	return value;
+}
+
+/**
+ * jana_note_peek_author:
+ * @note: A #JanaNote
+ *
+ * Retrieves the author of the note, without copying it. See 
+ * jana_note_get_author().
+ *
+ * Returns: The author of the note, or %NULL. This string is owned by @note 
+ * and must not be freed or modified. It is only valid until @note is 
+ * modified or destroyed.
+ */
+const gchar *
+jana_note_peek_author (JanaNote *note)
+{
+	JanaNoteInterface *iface = JANA_NOTE_GET_INTERFACE (note);
+
+	if (iface->peek_author)
+		return iface->peek_author (note);
+	else
+		return note_peek_fallback (note, "jana-note-author",
+			iface->get_author (note));
+}
+
+/**
+ * jana_note_peek_recipient:
+ * @note: A #JanaNote
+ *
+ * Retrieves the recipient of the note, without copying it. See 
+ * jana_note_get_recipient().
+ *
+ * Returns: The recipient of the note, or %NULL. This string is owned by 
+ * @note and must not be freed or modified. It is only valid until @note is 
+ * modified or destroyed.
+ */
+const gchar *
+jana_note_peek_recipient (JanaNote *note)
+{
+	JanaNoteInterface *iface = JANA_NOTE_GET_INTERFACE (note);
+
+	if (iface->peek_recipient)
+		return iface->peek_recipient (note);
+	else
+		return note_peek_fallback (note, "jana-note-recipient",
+			iface->get_recipient (note));
+}
+
+/**
+ * jana_note_peek_body:
+ * @note: A #JanaNote
+ *
+ * Retrieves the note body, without copying it. See jana_note_get_body().
+ *
+ * Returns: The body of the note, or %NULL. This string is owned by @note 
+ * and must not be freed or modified. It is only valid until @note is 
+ * modified or destroyed.
+ */
+const gchar *
+jana_note_peek_body (JanaNote *note)
+{
+	JanaNoteInterface *iface = JANA_NOTE_GET_INTERFACE (note);
+
+	if (iface->peek_body)
+		return iface->peek_body (note);
+	else
+		return note_peek_fallback (note, "jana-note-body",
+			iface->get_body (note));
+}
+
 /**
  * jana_note_get_creation_time:
  * @note: A #JanaNote
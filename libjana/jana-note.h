@@ -55,6 +55,11 @@ struct _JanaNoteInterface {
 	void	(*set_recipient)(JanaNote *self, const gchar *recipient);
 	void	(*set_body)	(JanaNote *self, const gchar *body);
 	void	(*set_creation_time)	(JanaNote *self, JanaTime *time);
+
+	/* Non-allocating getters */
+	const gchar *	(*peek_author)		(JanaNote *self);
+	const gchar *	(*peek_recipient)	(JanaNote *self);
+	const gchar *	(*peek_body)		(JanaNote *self);
 };
 
 GType jana_note_get_type (void);
@@ -65,6 +70,12 @@ gchar *jana_note_get_recipient (JanaNote *note);
 
 gchar *jana_note_get_body (JanaNote *note);
 
+const gchar *jana_note_peek_author (JanaNote *note);
+
+const gchar *jana_note_peek_recipient (JanaNote *note);
+
+const gchar *jana_note_peek_body (JanaNote *note);
+
 JanaTime *jana_note_get_creation_time (JanaNote *note);
 
 JanaTime *jana_note_get_modified_time (JanaNote *note);
@@ -0,0 +1,736 @@
+/*
+ * Copyright (C) 2009 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St - Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+/**
+ * SECTION:jana-occurrence-index
+ * @short_description: A time index of the events in a store view
+ * @see_also: #JanaStoreView
+ *
+ * #JanaOccurrenceIndex follows a #JanaStoreView and keeps the occurrences 
+ * of the events it reports in an interval tree, so that those overlapping 
+ * a given range can be found in logarithmic time, rather than by walking 
+ * every event. Recurring events are expanded over the range of the view, 
+ * and re-expanded when that changes.
+ *
+ * Several indexes can be combined to find busy periods, with 
+ * jana_occurrence_index_get_busy(), or the events that would clash with a 
+ * new one, with jana_occurrence_index_get_conflicts().
+ */
+
+#include "jana-utils.h"
+#include "jana-occurrence-index.h"
+
+G_DEFINE_TYPE (JanaOccurrenceIndex, jana_occurrence_index, G_TYPE_OBJECT)
+
+#define OCCURRENCE_INDEX_PRIVATE(o) (G_TYPE_INSTANCE_GET_PRIVATE ((o), \
+			  JANA_TYPE_OCCURRENCE_INDEX, \
+			  JanaOccurrenceIndexPrivate))
+
+typedef struct _JanaOccurrenceIndexPrivate JanaOccurrenceIndexPrivate;
+typedef struct _OccurrenceNode OccurrenceNode;
+
+struct _JanaOccurrenceIndexPrivate
+{
+	JanaStoreView *view;
+	
+	/* The root of a treap ordered by start time. Each node also holds 
+	 * the latest end in its subtree, so that subtrees which end before 
+	 * a range can be skipped.
+	 */
+	OccurrenceNode *root;
+	guint size;
+	
+	/* uid -> GSList of OccurrenceNode */
+	GHashTable *uids;
+	
+	/* uid -> JanaComponent, for recurring events and the range they 
+	 * were last expanded over.
+	 */
+	GHashTable *recurring;
+	JanaTime *start;
+	JanaTime *end;
+};
+
+struct _OccurrenceNode {
+	JanaOccurrence occurrence;
+	
+	/* Occurrences with no duration are treated as lasting a second, so 
+	 * that they aren't lost when pruning by end time.
+	 */
+	gint64 end;
+	gint64 max_end;
+	guint32 priority;
+	OccurrenceNode *left;
+	OccurrenceNode *right;
+};
+
+enum {
+	PROP_VIEW = 1,
+};
+
+static void	occurrence_index_set_view	(JanaOccurrenceIndex *self,
+						 JanaStoreView *view);
+
+static void
+occurrence_node_free (OccurrenceNode *node)
+{
+	g_object_unref (node->occurrence.component);
+	jana_duration_free (node->occurrence.duration);
+	g_slice_free (OccurrenceNode, node);
+}
+
+static void
+occurrence_node_list_free (GSList *nodes)
+{
+	g_slist_foreach (nodes, (GFunc)occurrence_node_free, NULL);
+	g_slist_free (nodes);
+}
+
+static void
+jana_occurrence_index_get_property (GObject *object, guint property_id,
+				    GValue *value, GParamSpec *pspec)
+{
+	JanaOccurrenceIndexPrivate *priv = OCCURRENCE_INDEX_PRIVATE (object);
+
+	switch (property_id) {
+	    case PROP_VIEW :
+		g_value_set_object (value, priv->view);
+		break;
+	    default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+	}
+}
+
+static void
+jana_occurrence_index_set_property (GObject *object, guint property_id,
+				    const GValue *value, GParamSpec *pspec)
+{
+	switch (property_id) {
+	    case PROP_VIEW :
+		occurrence_index_set_view (JANA_OCCURRENCE_INDEX (object),
+			JANA_STORE_VIEW (g_value_get_object (value)));
+		break;
+	    default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+	}
+}
+
+static void
+jana_occurrence_index_dispose (GObject *object)
+{
+	JanaOccurrenceIndexPrivate *priv = OCCURRENCE_INDEX_PRIVATE (object);
+	
+	if (priv->view) {
+		g_signal_handlers_disconnect_matched (priv->view,
+			G_SIGNAL_MATCH_DATA, 0, 0, NULL, NULL, object);
+		g_object_unref (priv->view);
+		priv->view = NULL;
+	}
+	
+	if (priv->start) {
+		g_object_unref (priv->start);
+		priv->start = NULL;
+	}
+	
+	if (priv->end) {
+		g_object_unref (priv->end);
+		priv->end = NULL;
+	}
+	
+	G_OBJECT_CLASS (jana_occurrence_index_parent_class)->dispose (object);
+}
+
+static void
+jana_occurrence_index_finalize (GObject *object)
+{
+	JanaOccurrenceIndexPrivate *priv = OCCURRENCE_INDEX_PRIVATE (object);
+	
+	/* The nodes are all freed from the uid lists */
+	priv->root = NULL;
+	g_hash_table_destroy (priv->uids);
+	g_hash_table_destroy (priv->recurring);
+	
+	G_OBJECT_CLASS (jana_occurrence_index_parent_class)->finalize (object);
+}
+
+static void
+jana_occurrence_index_class_init (JanaOccurrenceIndexClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+	g_type_class_add_private (klass, sizeof (JanaOccurrenceIndexPrivate));
+
+	object_class->get_property = jana_occurrence_index_get_property;
+	object_class->set_property = jana_occurrence_index_set_property;
+	object_class->dispose = jana_occurrence_index_dispose;
+	object_class->finalize = jana_occurrence_index_finalize;
+
+	g_object_class_install_property (
+		object_class,
+		PROP_VIEW,
+		g_param_spec_object (
+			"view",
+			"JanaStoreView *",
+			"The JanaStoreView whose events are indexed.",
+			G_TYPE_OBJECT,
+			G_PARAM_READWRITE |
+			G_PARAM_CONSTRUCT_ONLY));
+}
+
+static void
+jana_occurrence_index_init (JanaOccurrenceIndex *self)
+{
+	JanaOccurrenceIndexPrivate *priv = OCCURRENCE_INDEX_PRIVATE (self);
+	
+	priv->uids = g_hash_table_new_full (g_str_hash, g_str_equal,
+		g_free, (GDestroyNotify)occurrence_node_list_free);
+	priv->recurring = g_hash_table_new_full (g_str_hash, g_str_equal,
+		g_free, g_object_unref);
+}
+
+/**
+ * jana_occurrence_index_new:
+ * @view: A #JanaStoreView
+ *
+ * Creates a new #JanaOccurrenceIndex, which indexes the events reported by 
+ * @view from then on. The index should usually be created before @view is 
+ * started. Components other than events are ignored.
+ *
+ * Returns: A new #JanaOccurrenceIndex.
+ */
+JanaOccurrenceIndex *
+jana_occurrence_index_new (JanaStoreView *view)
+{
+	return JANA_OCCURRENCE_INDEX (g_object_new (JANA_TYPE_OCCURRENCE_INDEX,
+		"view", view, NULL));
+}
+
+static void
+tree_update (OccurrenceNode *node)
+{
+	node->max_end = node->end;
+	if (node->left && (node->left->max_end > node->max_end))
+		node->max_end = node->left->max_end;
+	if (node->right && (node->right->max_end > node->max_end))
+		node->max_end = node->right->max_end;
+}
+
+/* Nodes are ordered by start time, and then by address so that every node 
+ * has a distinct position to be found at.
+ */
+static gint
+tree_compare (OccurrenceNode *node1, OccurrenceNode *node2)
+{
+	if (node1->occurrence.start != node2->occurrence.start)
+		return (node1->occurrence.start < node2->occurrence.start) ?
+			-1 : 1;
+	
+	return (node1 < node2) ? -1 : ((node1 > node2) ? 1 : 0);
+}
+
+/* Splits @tree into the nodes before @key and the rest */
+static void
+tree_split (OccurrenceNode *tree, OccurrenceNode *key,
+	    OccurrenceNode **left, OccurrenceNode **right)
+{
+	if (!tree) {
+		*left = *right = NULL;
+		return;
+	}
+	
+	if (tree_compare (tree, key) < 0) {
+		tree_split (tree->right, key, &tree->right, right);
+		*left = tree;
+	} else {
+		tree_split (tree->left, key, left, &tree->left);
+		*right = tree;
+	}
+	tree_update (tree);
+}
+
+/* Joins two trees, where every node in @left comes before those in @right */
+static OccurrenceNode *
+tree_merge (OccurrenceNode *left, OccurrenceNode *right)
+{
+	if (!left) return right;
+	if (!right) return left;
+	
+	if (left->priority > right->priority) {
+		left->right = tree_merge (left->right, right);
+		tree_update (left);
+		return left;
+	} else {
+		right->left = tree_merge (left, right->left);
+		tree_update (right);
+		return right;
+	}
+}
+
+static OccurrenceNode *
+tree_insert (OccurrenceNode *tree, OccurrenceNode *node)
+{
+	OccurrenceNode *left, *right;
+	
+	tree_split (tree, node, &left, &right);
+	
+	return tree_merge (tree_merge (left, node), right);
+}
+
+static OccurrenceNode *
+tree_remove (OccurrenceNode *tree, OccurrenceNode *node)
+{
+	if (!tree) return NULL;
+	
+	if (tree == node)
+		return tree_merge (tree->left, tree->right);
+	
+	if (tree_compare (node, tree) < 0)
+		tree->left = tree_remove (tree->left, node);
+	else
+		tree->right = tree_remove (tree->right, node);
+	tree_update (tree);
+	
+	return tree;
+}
+
+/* Finds the nodes overlapping [@start, @end), in reverse order */
+static void
+tree_query (OccurrenceNode *tree, gint64 start, gint64 end, GList **results)
+{
+	if ((!tree) || (tree->max_end <= start)) return;
+	
+	tree_query (tree->left, start, end, results);
+	
+	/* Everything further right starts later still */
+	if (tree->occurrence.start >= end) return;
+	
+	if (tree->end > start)
+		*results = g_list_prepend (*results, &tree->occurrence);
+	
+	tree_query (tree->right, start, end, results);
+}
+
+static OccurrenceNode *
+occurrence_node_new (JanaComponent *component, JanaDuration *duration)
+{
+	OccurrenceNode *node = g_slice_new0 (OccurrenceNode);
+	
+	node->occurrence.component = g_object_ref (component);
+	node->occurrence.duration = duration;
+	node->occurrence.start = jana_utils_time_to_seconds (duration->start);
+	node->occurrence.end = duration->end ?
+		jana_utils_time_to_seconds (duration->end) :
+		node->occurrence.start;
+	node->end = MAX (node->occurrence.end, node->occurrence.start + 1);
+	node->max_end = node->end;
+	node->priority = g_random_int ();
+	
+	return node;
+}
+
+static GSList *
+occurrence_index_expand (JanaOccurrenceIndex *self, JanaEvent *event)
+{
+	JanaTime *start, *end;
+	GList *instances, *i;
+	GSList *nodes = NULL;
+	OccurrenceNode *last = NULL;
+	gboolean isdate, has_end;
+	JanaOccurrenceIndexPrivate *priv = OCCURRENCE_INDEX_PRIVATE (self);
+	
+	if (!(start = jana_event_get_start (event))) return NULL;
+	
+	if (!jana_event_has_recurrence (event)) {
+		end = jana_event_get_end (event);
+		nodes = g_slist_prepend (NULL, occurrence_node_new (
+			JANA_COMPONENT (event), jana_duration_new (start, end)));
+		g_object_unref (start);
+		if (end) g_object_unref (end);
+		
+		return nodes;
+	}
+	
+	/* Without an end, each occurrence is just the point it starts at, 
+	 * and is indexed with no end like a single event would be.
+	 */
+	end = jana_event_get_end (event);
+	has_end = (end != NULL);
+	if (end) g_object_unref (end);
+	
+	isdate = jana_time_get_isdate (start);
+	instances = jana_utils_event_get_instances (event,
+		priv->start ? priv->start : start, priv->end, 0);
+	
+	for (i = instances; i; i = i->next) {
+		JanaDuration *piece = (JanaDuration *)i->data;
+		
+		if (!has_end) {
+			nodes = g_slist_prepend (nodes, occurrence_node_new (
+				JANA_COMPONENT (event),
+				jana_duration_new (piece->start, NULL)));
+			continue;
+		}
+		
+		/* Instances come split into days. The days after the first 
+		 * start at midnight, as date-only times, which tells them 
+		 * apart from the start of the next instance for events that 
+		 * aren't all-day.
+		 */
+		if (last && (!isdate) && jana_time_get_isdate (piece->start) &&
+		    (jana_utils_time_to_seconds (piece->start) ==
+		     last->occurrence.end)) {
+			jana_duration_set_end (last->occurrence.duration,
+				piece->end);
+			last->occurrence.end =
+				jana_utils_time_to_seconds (piece->end);
+			last->end = MAX (last->occurrence.end,
+				last->occurrence.start + 1);
+			last->max_end = last->end;
+			continue;
+		}
+		
+		last = occurrence_node_new (JANA_COMPONENT (event),
+			jana_duration_copy (piece));
+		nodes = g_slist_prepend (nodes, last);
+	}
+	
+	jana_utils_instance_list_free (instances);
+	g_object_unref (start);
+	
+	return nodes;
+}
+
+static void
+occurrence_index_remove (JanaOccurrenceIndex *self, const gchar *uid)
+{
+	GSList *n;
+	JanaOccurrenceIndexPrivate *priv = OCCURRENCE_INDEX_PRIVATE (self);
+	
+	for (n = g_hash_table_lookup (priv->uids, uid); n; n = n->next) {
+		priv->root = tree_remove (priv->root, (OccurrenceNode *)n->data);
+		priv->size --;
+	}
+	
+	g_hash_table_remove (priv->uids, uid);
+	g_hash_table_remove (priv->recurring, uid);
+}
+
+/* Replaces whatever was indexed under the uid of @component. Views can 
+ * report the same uid more than once, and the old nodes have to leave the 
+ * tree before their list is freed.
+ */
+static void
+occurrence_index_add (JanaOccurrenceIndex *self, JanaComponent *component)
+{
+	GSList *n, *nodes;
+	const gchar *uid;
+	JanaOccurrenceIndexPrivate *priv = OCCURRENCE_INDEX_PRIVATE (self);
+	
+	if (jana_component_get_component_type (component) !=
+	    JANA_COMPONENT_EVENT)
+		return;
+	
+	uid = jana_component_peek_uid (component);
+	occurrence_index_remove (self, uid);
+	
+	if (jana_event_has_recurrence (JANA_EVENT (component)))
+		g_hash_table_replace (priv->recurring, g_strdup (uid),
+			g_object_ref (component));
+	
+	nodes = occurrence_index_expand (self, JANA_EVENT (component));
+	for (n = nodes; n; n = n->next) {
+		priv->root = tree_insert (priv->root, (OccurrenceNode *)n->data);
+		priv->size ++;
+	}
+	
+	if (nodes)
+		g_hash_table_insert (priv->uids, g_strdup (uid), nodes);
+}
+
+static gboolean
+occurrence_index_time_equal (JanaTime *time1, JanaTime *time2)
+{
+	if ((!time1) || (!time2)) return (time1 == time2);
+	
+	return (jana_utils_time_compare (time1, time2, FALSE) == 0);
+}
+
+/* Recurring events are only expanded over the range of the view, so when 
+ * that changes, they need expanding again.
+ */
+static void
+occurrence_index_update_range (JanaOccurrenceIndex *self)
+{
+	GList *c, *components;
+	JanaTime *start, *end;
+	JanaOccurrenceIndexPrivate *priv = OCCURRENCE_INDEX_PRIVATE (self);
+	
+	jana_store_view_get_range (priv->view, &start, &end);
+	
+	if (occurrence_index_time_equal (start, priv->start) &&
+	    occurrence_index_time_equal (end, priv->end)) {
+		if (start) g_object_unref (start);
+		if (end) g_object_unref (end);
+		return;
+	}
+	
+	if (priv->start) g_object_unref (priv->start);
+	if (priv->end) g_object_unref (priv->end);
+	priv->start = start;
+	priv->end = end;
+	
+	components = g_hash_table_get_values (priv->recurring);
+	g_list_foreach (components, (GFunc)g_object_ref, NULL);
+	for (c = components; c; c = c->next) {
+		JanaComponent *component = JANA_COMPONENT (c->data);
+		occurrence_index_add (self, component);
+		g_object_unref (component);
+	}
+	g_list_free (components);
+}
+
+static void
+occurrence_index_added_cb (JanaStoreView *view, GList *components,
+			   JanaOccurrenceIndex *self)
+{
+	occurrence_index_update_range (self);
+	
+	for (; components; components = components->next)
+		occurrence_index_add (self, JANA_COMPONENT (components->data));
+}
+
+static void
+occurrence_index_modified_cb (JanaStoreView *view, GList *components,
+			      JanaOccurrenceIndex *self)
+{
+	occurrence_index_update_range (self);
+	
+	for (; components; components = components->next)
+		occurrence_index_add (self, JANA_COMPONENT (components->data));
+}
+
+static void
+occurrence_index_removed_cb (JanaStoreView *view, GList *uids,
+			     JanaOccurrenceIndex *self)
+{
+	for (; uids; uids = uids->next)
+		occurrence_index_remove (self, (const gchar *)uids->data);
+}
+
+static void
+occurrence_index_set_view (JanaOccurrenceIndex *self, JanaStoreView *view)
+{
+	JanaOccurrenceIndexPrivate *priv = OCCURRENCE_INDEX_PRIVATE (self);
+	
+	priv->view = g_object_ref (view);
+	jana_store_view_get_range (view, &priv->start, &priv->end);
+	
+	g_signal_connect (view, "added",
+		G_CALLBACK (occurrence_index_added_cb), self);
+	g_signal_connect (view, "modified",
+		G_CALLBACK (occurrence_index_modified_cb), self);
+	g_signal_connect (view, "removed",
+		G_CALLBACK (occurrence_index_removed_cb), self);
+}
+
+/**
+ * jana_occurrence_index_query_seconds:
+ * @self: A #JanaOccurrenceIndex
+ * @start: The start of the range, see jana_utils_time_to_seconds()
+ * @end: The end of the range, see jana_utils_time_to_seconds()
+ *
+ * Finds the occurrences that overlap the range from @start up to, but not 
+ * including, @end. Occurrences with no duration are included if they fall 
+ * within the range.
+ *
+ * Returns: A newly allocated #GList of #JanaOccurrence structs, sorted by 
+ * start time, to be freed with g_list_free(). The occurrences belong to 
+ * the index, and are only valid until the view next reports a change.
+ */
+GList *
+jana_occurrence_index_query_seconds (JanaOccurrenceIndex *self,
+				     gint64 start, gint64 end)
+{
+	GList *results = NULL;
+	JanaOccurrenceIndexPrivate *priv = OCCURRENCE_INDEX_PRIVATE (self);
+	
+	occurrence_index_update_range (self);
+	tree_query (priv->root, start, end, &results);
+	
+	return g_list_reverse (results);
+}
+
+/**
+ * jana_occurrence_index_query:
+ * @self: A #JanaOccurrenceIndex
+ * @start: The start of the range, or %NULL
+ * @end: The end of the range, or %NULL
+ *
+ * Finds the occurrences that overlap the range from @start up to, but not 
+ * including, @end. See jana_occurrence_index_query_seconds().
+ *
+ * Returns: A newly allocated #GList of #JanaOccurrence structs, sorted by 
+ * start time, to be freed with g_list_free().
+ */
+GList *
+jana_occurrence_index_query (JanaOccurrenceIndex *self, JanaTime *start,
+			     JanaTime *end)
+{
+	return jana_occurrence_index_query_seconds (self,
+		start ? jana_utils_time_to_seconds (start) : G_MININT64,
+		end ? jana_utils_time_to_seconds (end) : G_MAXINT64);
+}
+
+/**
+ * jana_occurrence_index_get_size:
+ * @self: A #JanaOccurrenceIndex
+ *
+ * Retrieves the number of occurrences in the index.
+ *
+ * Returns: The number of occurrences in the index.
+ */
+guint
+jana_occurrence_index_get_size (JanaOccurrenceIndex *self)
+{
+	JanaOccurrenceIndexPrivate *priv = OCCURRENCE_INDEX_PRIVATE (self);
+	
+	return priv->size;
+}
+
+static gint
+occurrence_compare (gconstpointer a, gconstpointer b)
+{
+	const JanaOccurrence *occurrence1 = (const JanaOccurrence *)a;
+	const JanaOccurrence *occurrence2 = (const JanaOccurrence *)b;
+	
+	if (occurrence1->start != occurrence2->start)
+		return (occurrence1->start < occurrence2->start) ? -1 : 1;
+	if (occurrence1->end != occurrence2->end)
+		return (occurrence1->end < occurrence2->end) ? -1 : 1;
+	
+	return 0;
+}
+
+/* Queries each index in turn and merges the results into start order */
+static GList *
+occurrence_index_list_query (GList *indexes, gint64 start, gint64 end)
+{
+	GList *results = NULL;
+	gboolean sort = (indexes && indexes->next);
+	
+	for (; indexes; indexes = indexes->next) {
+		results = g_list_concat (jana_occurrence_index_query_seconds (
+			JANA_OCCURRENCE_INDEX (indexes->data), start, end),
+			results);
+	}
+	
+	return sort ? g_list_sort (results, occurrence_compare) : results;
+}
+
+/**
+ * jana_occurrence_index_get_busy:
+ * @indexes: A list of #JanaOccurrenceIndex
+ * @start: The start of the range, or %NULL
+ * @end: The end of the range, or %NULL
+ *
+ * Works out the periods of time between @start and @end that are taken up 
+ * by events in any of @indexes. Overlapping and adjacent occurrences are 
+ * merged into a single busy block, and occurrences with no duration are 
+ * ignored. Blocks that begin before @start or finish after @end are not 
+ * clipped to the range.
+ *
+ * Returns: A newly allocated list of #JanaDuration, in order, to be freed 
+ * with jana_utils_instance_list_free().
+ */
+GList *
+jana_occurrence_index_get_busy (GList *indexes, JanaTime *start,
+				JanaTime *end)
+{
+	GList *o, *occurrences, *blocks = NULL;
+	JanaDuration *block = NULL;
+	gint64 block_end = 0;
+	
+	occurrences = occurrence_index_list_query (indexes,
+		start ? jana_utils_time_to_seconds (start) : G_MININT64,
+		end ? jana_utils_time_to_seconds (end) : G_MAXINT64);
+	
+	/* As the occurrences are in start order, each one either extends 
+	 * the current block or begins a new one.
+	 */
+	for (o = occurrences; o; o = o->next) {
+		JanaOccurrence *occurrence = (JanaOccurrence *)o->data;
+		
+		if (occurrence->end <= occurrence->start) continue;
+		
+		if (block && (occurrence->start <= block_end)) {
+			if (occurrence->end > block_end) {
+				jana_duration_set_end (block,
+					occurrence->duration->end);
+				block_end = occurrence->end;
+			}
+			continue;
+		}
+		
+		block = jana_duration_copy (occurrence->duration);
+		block_end = occurrence->end;
+		blocks = g_list_prepend (blocks, block);
+	}
+	g_list_free (occurrences);
+	
+	return g_list_reverse (blocks);
+}
+
+/**
+ * jana_occurrence_index_get_conflicts:
+ * @indexes: A list of #JanaOccurrenceIndex
+ * @duration: A candidate #JanaDuration
+ *
+ * Finds the occurrences in any of @indexes that would clash with an event 
+ * taking place over @duration. If @duration has no end, or ends when it 
+ * starts, the occurrences in progress at its start are returned. 
+ * Occurrences with no duration never clash.
+ *
+ * Returns: A newly allocated #GList of #JanaOccurrence structs, sorted by 
+ * start time, to be freed with g_list_free(). See 
+ * jana_occurrence_index_query_seconds().
+ */
+GList *
+jana_occurrence_index_get_conflicts (GList *indexes, JanaDuration *duration)
+{
+	GList *o, *occurrences;
+	gint64 start, end;
+	
+	g_return_val_if_fail (duration && duration->start, NULL);
+	
+	start = jana_utils_time_to_seconds (duration->start);
+	end = duration->end ? jana_utils_time_to_seconds (duration->end) : start;
+	
+	occurrences = occurrence_index_list_query (indexes,
+		start, MAX (end, start + 1));
+	
+	for (o = occurrences; o;) {
+		JanaOccurrence *occurrence = (JanaOccurrence *)o->data;
+		GList *next = o->next;
+		
+		if (occurrence->end <= occurrence->start)
+			occurrences = g_list_delete_link (occurrences, o);
+		o = next;
+	}
+	
+	return occurrences;
+}
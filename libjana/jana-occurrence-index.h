@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2009 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St - Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef JANA_OCCURRENCE_INDEX_H
+#define JANA_OCCURRENCE_INDEX_H
+
+#include <glib-object.h>
+#include <libjana/jana-component.h>
+#include <libjana/jana-store-view.h>
+#include <libjana/jana-time.h>
+
+#define JANA_TYPE_OCCURRENCE_INDEX	(jana_occurrence_index_get_type ())
+#define JANA_OCCURRENCE_INDEX(obj)	(G_TYPE_CHECK_INSTANCE_CAST ((obj), \
+					 JANA_TYPE_OCCURRENCE_INDEX, \
+					 JanaOccurrenceIndex))
+#define JANA_OCCURRENCE_INDEX_CLASS(vtable)	(G_TYPE_CHECK_CLASS_CAST \
+						 ((vtable), \
+						 JANA_TYPE_OCCURRENCE_INDEX, \
+						 JanaOccurrenceIndexClass))
+#define JANA_IS_OCCURRENCE_INDEX(obj)	(G_TYPE_CHECK_INSTANCE_TYPE ((obj), \
+					 JANA_TYPE_OCCURRENCE_INDEX))
+#define JANA_IS_OCCURRENCE_INDEX_CLASS(vtable)	(G_TYPE_CHECK_CLASS_TYPE \
+						 ((vtable), \
+						 JANA_TYPE_OCCURRENCE_INDEX))
+#define JANA_OCCURRENCE_INDEX_GET_CLASS(inst)	(G_TYPE_INSTANCE_GET_CLASS \
+						 ((inst), \
+						 JANA_TYPE_OCCURRENCE_INDEX, \
+						 JanaOccurrenceIndexClass))
+
+
+typedef struct _JanaOccurrenceIndex JanaOccurrenceIndex;
+typedef struct _JanaOccurrenceIndexClass JanaOccurrenceIndexClass;
+
+/**
+ * JanaOccurrenceIndex:
+ *
+ * The #JanaOccurrenceIndex struct contains only private data.
+ */
+struct _JanaOccurrenceIndex {
+	GObject parent;
+};
+
+struct _JanaOccurrenceIndexClass {
+	GObjectClass parent;
+};
+
+/**
+ * JanaOccurrence:
+ * @component: The #JanaEvent that occurs
+ * @duration: When it occurs
+ * @start: The start of @duration, see jana_utils_time_to_seconds()
+ * @end: The end of @duration, see jana_utils_time_to_seconds()
+ *
+ * A single occurrence of an event in a #JanaOccurrenceIndex.
+ */
+typedef struct {
+	JanaComponent *component;
+	JanaDuration *duration;
+	gint64 start;
+	gint64 end;
+} JanaOccurrence;
+
+GType jana_occurrence_index_get_type (void);
+
+JanaOccurrenceIndex *jana_occurrence_index_new	(JanaStoreView *view);
+
+GList *	jana_occurrence_index_query		(JanaOccurrenceIndex *self,
+						 JanaTime *start,
+						 JanaTime *end);
+GList *	jana_occurrence_index_query_seconds	(JanaOccurrenceIndex *self,
+						 gint64 start,
+						 gint64 end);
+guint	jana_occurrence_index_get_size		(JanaOccurrenceIndex *self);
+
+GList *	jana_occurrence_index_get_busy		(GList *indexes,
+						 JanaTime *start,
+						 JanaTime *end);
+GList *	jana_occurrence_index_get_conflicts	(GList *indexes,
+						 JanaDuration *duration);
+
+#endif /* JANA_OCCURRENCE_INDEX_H */
@@ -27,7 +27,12 @@
  * store view has functions to query a particular time range of components.
  */
 
+#include <string.h>
 #include "jana-store-view.h"
+#include "jana-event.h"
+#include "jana-note.h"
+#include "jana-task.h"
+#include "jana-utils.h"
 
 enum {
 	ADDED,
@@ -242,6 +247,123 @@ jana_store_view_start (JanaStoreView *self)
 	JANA_STORE_VIEW_GET_INTERFACE (self)->start (self);
 }
 
+/**
+ * jana_store_view_begin_update:
+ * @self: A #JanaStoreView
+ *
+ * Starts a batch of changes to the range and matches of @self. Until the 
+ * matching call to jana_store_view_commit_update(), changes are recorded 
+ * but the store is not queried again, so setting a new range and a new set 
+ * of matches together only results in one query. Calls may be nested.
+ */
+void
+jana_store_view_begin_update (JanaStoreView *self)
+{
+	JanaStoreViewInterface *iface = JANA_STORE_VIEW_GET_INTERFACE (self);
+	
+	if (iface->begin_update) iface->begin_update (self);
+}
+
+/**
+ * jana_store_view_commit_update:
+ * @self: A #JanaStoreView
+ *
+ * Ends a batch of changes started with jana_store_view_begin_update(). 
+ * When the outermost batch is committed, the changes made during it are 
+ * applied at once.
+ */
+void
+jana_store_view_commit_update (JanaStoreView *self)
+{
+	JanaStoreViewInterface *iface = JANA_STORE_VIEW_GET_INTERFACE (self);
+	
+	if (iface->commit_update) iface->commit_update (self);
+}
+
+/**
+ * jana_store_view_set_limit:
+ * @self: A #JanaStoreView
+ * @limit: The number of events to report, or 0 for no limit
+ *
+ * Limits @self to the @limit events whose next occurrence, from the start 
+ * of its range, is soonest. Events in progress at the start of the range 
+ * count as occurring then. As events are added, changed and removed, the 
+ * view reports components entering and leaving the limited set, so it 
+ * always holds the soonest events known. While a limit is set, components 
+ * other than events are not reported, and the limit has no effect if the 
+ * range has no start.
+ *
+ * This allows the next few events to be found without the store reporting 
+ * everything after the start of the range. Not every store view supports 
+ * limits; those that don't ignore this call.
+ */
+void
+jana_store_view_set_limit (JanaStoreView *self, guint limit)
+{
+	JanaStoreViewInterface *iface = JANA_STORE_VIEW_GET_INTERFACE (self);
+	
+	if (iface->set_limit) iface->set_limit (self, limit);
+}
+
+/**
+ * jana_store_view_get_limit:
+ * @self: A #JanaStoreView
+ *
+ * Retrieves the limit set with jana_store_view_set_limit().
+ *
+ * Returns: The number of events @self is limited to, or 0 if it isn't 
+ * limited.
+ */
+guint
+jana_store_view_get_limit (JanaStoreView *self)
+{
+	JanaStoreViewInterface *iface = JANA_STORE_VIEW_GET_INTERFACE (self);
+	
+	return iface->get_limit ? iface->get_limit (self) : 0;
+}
+
+/**
+ * jana_store_view_set_projection:
+ * @self: A #JanaStoreView
+ * @projection: The #JanaStoreViewProjection fields needed
+ *
+ * Tells @self which fields of its components are needed, so that the rest 
+ * can be left out of the components it reports. A view that only counts 
+ * events, for example, might only ask for #JANA_STORE_VIEW_PROJECT_TIMES. 
+ * Changes that only affect fields that were left out may not be reported. 
+ * Matches still apply to every field.
+ *
+ * This is only a hint, and views may report more than was asked for. 
+ * Components already reported are reported again as modified, with the 
+ * new fields. The default is #JANA_STORE_VIEW_PROJECT_ALL.
+ */
+void
+jana_store_view_set_projection (JanaStoreView *self,
+				JanaStoreViewProjection projection)
+{
+	JanaStoreViewInterface *iface = JANA_STORE_VIEW_GET_INTERFACE (self);
+	
+	if (iface->set_projection) iface->set_projection (self, projection);
+}
+
+/**
+ * jana_store_view_get_projection:
+ * @self: A #JanaStoreView
+ *
+ * Retrieves the fields that the components reported by @self contain. See 
+ * jana_store_view_set_projection().
+ *
+ * Returns: The #JanaStoreViewProjection of @self.
+ */
+JanaStoreViewProjection
+jana_store_view_get_projection (JanaStoreView *self)
+{
+	JanaStoreViewInterface *iface = JANA_STORE_VIEW_GET_INTERFACE (self);
+	
+	return iface->get_projection ? iface->get_projection (self) :
+		JANA_STORE_VIEW_PROJECT_ALL;
+}
+
 /**
  * jana_store_view_get_store:
  * @self: A #JanaStoreView
@@ -256,3 +378,265 @@ jana_store_view_get_store (JanaStoreView *self)
 	return JANA_STORE_VIEW_GET_INTERFACE (self)->get_store (self);
 }
 
+
+typedef enum {
+	PREDICATE_SUMMARY,
+	PREDICATE_LOCATION,
+	PREDICATE_DESCRIPTION,
+	PREDICATE_ANY,
+	PREDICATE_CATEGORY,
+} PredicateField;
+
+typedef struct {
+	PredicateField field;
+	/* Case-folded text, or the category name */
+	gchar *needle;
+	guint atom;
+} PredicateTerm;
+
+struct _JanaStoreViewPredicate {
+	PredicateTerm *terms;
+	guint n_terms;
+};
+
+/**
+ * jana_store_view_predicate_new:
+ * @matches: A #GList of #JanaStoreViewMatch structs
+ *
+ * Compiles a list of matches, as returned by jana_store_view_get_matches(), 
+ * so that they can be checked against components without going through 
+ * the store. A component satisfies the predicate if it satisfies any one 
+ * of the matches, and every component satisfies a predicate with no 
+ * matches. Text is matched case-insensitively as a substring, and 
+ * categories are matched exactly.
+ *
+ * Returns: A new #JanaStoreViewPredicate, to be freed with 
+ * jana_store_view_predicate_free().
+ */
+JanaStoreViewPredicate *
+jana_store_view_predicate_new (GList *matches)
+{
+	guint i;
+	JanaStoreViewPredicate *predicate;
+	
+	predicate = g_slice_new (JanaStoreViewPredicate);
+	predicate->n_terms = g_list_length (matches);
+	predicate->terms = g_new (PredicateTerm, predicate->n_terms);
+	
+	for (i = 0; matches; matches = matches->next, i++) {
+		JanaStoreViewMatch *match = (JanaStoreViewMatch *)matches->data;
+		PredicateTerm *term = &predicate->terms[i];
+		
+		term->atom = 0;
+		switch (match->field) {
+		    case JANA_STORE_VIEW_SUMMARY :
+		    case JANA_STORE_VIEW_AUTHOR :
+			term->field = PREDICATE_SUMMARY;
+			break;
+		    case JANA_STORE_VIEW_LOCATION :
+		    case JANA_STORE_VIEW_RECIPIENT :
+			term->field = PREDICATE_LOCATION;
+			break;
+		    case JANA_STORE_VIEW_DESCRIPTION :
+		    case JANA_STORE_VIEW_BODY :
+			term->field = PREDICATE_DESCRIPTION;
+			break;
+		    case JANA_STORE_VIEW_CATEGORY :
+			term->field = PREDICATE_CATEGORY;
+			break;
+		    case JANA_STORE_VIEW_ANYFIELD :
+		    default :
+			term->field = PREDICATE_ANY;
+			break;
+		}
+		
+		if (term->field == PREDICATE_CATEGORY) {
+			term->needle = g_strdup (match->data);
+			term->atom = jana_utils_category_get_atom (match->data);
+		} else
+			term->needle = g_utf8_casefold (match->data, -1);
+	}
+	
+	return predicate;
+}
+
+/**
+ * jana_store_view_predicate_free:
+ * @predicate: A #JanaStoreViewPredicate
+ *
+ * Frees a predicate created with jana_store_view_predicate_new().
+ */
+void
+jana_store_view_predicate_free (JanaStoreViewPredicate *predicate)
+{
+	guint i;
+	
+	for (i = 0; i < predicate->n_terms; i++)
+		g_free (predicate->terms[i].needle);
+	g_free (predicate->terms);
+	g_slice_free (JanaStoreViewPredicate, predicate);
+}
+
+static const gchar *
+predicate_peek_field (JanaComponent *component, PredicateField field)
+{
+	switch (jana_component_get_component_type (component)) {
+	    case JANA_COMPONENT_EVENT :
+		switch (field) {
+		    case PREDICATE_SUMMARY :
+			return jana_event_peek_summary (JANA_EVENT (component));
+		    case PREDICATE_LOCATION :
+			return jana_event_peek_location (
+				JANA_EVENT (component));
+		    case PREDICATE_DESCRIPTION :
+			return jana_event_peek_description (
+				JANA_EVENT (component));
+		    default :
+			return NULL;
+		}
+	    case JANA_COMPONENT_NOTE :
+		switch (field) {
+		    case PREDICATE_SUMMARY :
+			return jana_note_peek_author (JANA_NOTE (component));
+		    case PREDICATE_LOCATION :
+			return jana_note_peek_recipient (JANA_NOTE (component));
+		    case PREDICATE_DESCRIPTION :
+			return jana_note_peek_body (JANA_NOTE (component));
+		    default :
+			return NULL;
+		}
+	    case JANA_COMPONENT_TASK :
+		switch (field) {
+		    case PREDICATE_SUMMARY :
+			return jana_task_peek_summary (JANA_TASK (component));
+		    case PREDICATE_DESCRIPTION :
+			return jana_task_peek_description (
+				JANA_TASK (component));
+		    default :
+			return NULL;
+		}
+	    default :
+		return NULL;
+	}
+}
+
+/**
+ * jana_store_view_predicate_match:
+ * @predicate: A #JanaStoreViewPredicate
+ * @component: A #JanaComponent
+ *
+ * Checks a component against a predicate. Matches on 
+ * %JANA_STORE_VIEW_ANYFIELD consider the summary, location and description 
+ * of events (or their equivalents for other component types).
+ *
+ * Returns: %TRUE if @component satisfies @predicate, %FALSE otherwise.
+ */
+gboolean
+jana_store_view_predicate_match (JanaStoreViewPredicate *predicate,
+				 JanaComponent *component)
+{
+	guint i;
+	PredicateField f;
+	gboolean result = FALSE;
+	gboolean have_mask = FALSE;
+	guint64 mask = 0;
+	/* Each field is only case-folded once, and only if needed */
+	gchar *folded[PREDICATE_ANY] = { NULL, };
+	gboolean have_folded[PREDICATE_ANY] = { FALSE, };
+	
+	if (!predicate->n_terms) return TRUE;
+	
+	for (i = 0; (i < predicate->n_terms) && (!result); i++) {
+		PredicateTerm *term = &predicate->terms[i];
+		
+		if (term->field == PREDICATE_CATEGORY) {
+			guint64 bit = jana_utils_category_atom_to_mask (
+				term->atom);
+			
+			if (!have_mask) {
+				mask = jana_utils_component_get_category_mask (
+					component);
+				have_mask = TRUE;
+			}
+			
+			if (!(mask & bit)) continue;
+			result = (bit != JANA_UTILS_CATEGORY_MASK_SHARED) ||
+				jana_utils_component_has_category (
+					component, term->needle);
+			continue;
+		}
+		
+		for (f = PREDICATE_SUMMARY; f < PREDICATE_ANY; f++) {
+			if ((term->field != PREDICATE_ANY) &&
+			    (term->field != f))
+				continue;
+			
+			if (!have_folded[f]) {
+				const gchar *text = predicate_peek_field (
+					component, f);
+				folded[f] = text ?
+					g_utf8_casefold (text, -1) : NULL;
+				have_folded[f] = TRUE;
+			}
+			
+			if (folded[f] && strstr (folded[f], term->needle)) {
+				result = TRUE;
+				break;
+			}
+		}
+	}
+	
+	for (f = PREDICATE_SUMMARY; f < PREDICATE_ANY; f++)
+		g_free (folded[f]);
+	
+	return result;
+}
+
+static gboolean
+predicate_term_implies (PredicateTerm *term, PredicateTerm *other)
+{
+	if (term->field == PREDICATE_CATEGORY)
+		return (other->field == PREDICATE_CATEGORY) &&
+			(term->atom == other->atom);
+	
+	if ((other->field != term->field) && (other->field != PREDICATE_ANY))
+		return FALSE;
+	
+	/* A longer search string only finds a subset of what it contains */
+	return (strstr (term->needle, other->needle) != NULL);
+}
+
+/**
+ * jana_store_view_predicate_narrows:
+ * @predicate: A #JanaStoreViewPredicate
+ * @other: Another #JanaStoreViewPredicate
+ *
+ * Determines whether every component that satisfies @predicate also 
+ * satisfies @other. When this is the case, a view that changes its matches 
+ * from @other to @predicate can filter the components it already has 
+ * instead of querying its store again. This is a conservative check, and 
+ * may return %FALSE for predicates that are equivalent.
+ *
+ * Returns: %TRUE if @predicate is at least as narrow as @other, %FALSE 
+ * otherwise.
+ */
+gboolean
+jana_store_view_predicate_narrows (JanaStoreViewPredicate *predicate,
+				   JanaStoreViewPredicate *other)
+{
+	guint i, j;
+	
+	if (!other->n_terms) return TRUE;
+	if (!predicate->n_terms) return FALSE;
+	
+	for (i = 0; i < predicate->n_terms; i++) {
+		for (j = 0; j < other->n_terms; j++) {
+			if (predicate_term_implies (&predicate->terms[i],
+			    &other->terms[j]))
+				break;
+		}
+		if (j == other->n_terms) return FALSE;
+	}
+	
+	return TRUE;
+}
@@ -44,6 +44,7 @@ typedef struct _JanaStoreViewInterface JanaStoreViewInterface;
 
 #include <libjana/jana-time.h>
 #include <libjana/jana-store.h>
+#include <libjana/jana-component.h>
 
 /**
  * JanaStoreViewField:
@@ -71,6 +72,31 @@ typedef enum {
 	JANA_STORE_VIEW_ANYFIELD,
 } JanaStoreViewField;
 
+/**
+ * JanaStoreViewProjection:
+ * @JANA_STORE_VIEW_PROJECT_UID: The uid, which is always included
+ * @JANA_STORE_VIEW_PROJECT_TIMES: Start, end and due times, and recurrence
+ * @JANA_STORE_VIEW_PROJECT_SUMMARY: The summary, or note author
+ * @JANA_STORE_VIEW_PROJECT_LOCATION: The location, or note recipient
+ * @JANA_STORE_VIEW_PROJECT_DESCRIPTION: The description, or note body
+ * @JANA_STORE_VIEW_PROJECT_CATEGORIES: The categories
+ * @JANA_STORE_VIEW_PROJECT_OTHER: Everything else, such as custom properties
+ * @JANA_STORE_VIEW_PROJECT_ALL: Every field
+ *
+ * Flags for the fields of the components reported by a #JanaStoreView, 
+ * used with jana_store_view_set_projection().
+ **/
+typedef enum {
+	JANA_STORE_VIEW_PROJECT_UID		= 0,
+	JANA_STORE_VIEW_PROJECT_TIMES		= 1 << 0,
+	JANA_STORE_VIEW_PROJECT_SUMMARY		= 1 << 1,
+	JANA_STORE_VIEW_PROJECT_LOCATION	= 1 << 2,
+	JANA_STORE_VIEW_PROJECT_DESCRIPTION	= 1 << 3,
+	JANA_STORE_VIEW_PROJECT_CATEGORIES	= 1 << 4,
+	JANA_STORE_VIEW_PROJECT_OTHER		= 1 << 5,
+	JANA_STORE_VIEW_PROJECT_ALL		= (1 << 6) - 1,
+} JanaStoreViewProjection;
+
 /**
  * JanaStoreViewMatch:
  * @field: The #JanaStoreViewField to match against
@@ -84,6 +110,15 @@ typedef struct {
 	gchar *data;
 } JanaStoreViewMatch;
 
+/**
+ * JanaStoreViewPredicate:
+ *
+ * An opaque structure holding a list of #JanaStoreViewMatch structs in a 
+ * form that can be evaluated against components, created with 
+ * jana_store_view_predicate_new().
+ */
+typedef struct _JanaStoreViewPredicate JanaStoreViewPredicate;
+
 struct _JanaStoreViewInterface {
 	GTypeInterface parent;
 	
@@ -113,6 +148,16 @@ struct _JanaStoreViewInterface {
 	void	(*modified)	(JanaStoreView *self, GList *components);
 	void	(*removed)	(JanaStoreView *self, GList *uids);
 	void	(*progress)	(JanaStoreView *self, gint percent);
+	
+	void	(*begin_update)	(JanaStoreView *self);
+	void	(*commit_update)(JanaStoreView *self);
+	
+	void	(*set_limit)	(JanaStoreView *self, guint limit);
+	guint	(*get_limit)	(JanaStoreView *self);
+	
+	void	(*set_projection)	(JanaStoreView *self,
+					 JanaStoreViewProjection projection);
+	JanaStoreViewProjection	(*get_projection)	(JanaStoreView *self);
 };
 
 GType jana_store_view_get_type (void);
@@ -138,5 +183,25 @@ void	jana_store_view_start		(JanaStoreView *self);
 
 JanaStore * jana_store_view_get_store	(JanaStoreView *self);
 
+void	jana_store_view_begin_update	(JanaStoreView *self);
+
+void	jana_store_view_commit_update	(JanaStoreView *self);
+
+void	jana_store_view_set_limit	(JanaStoreView *self, guint limit);
+
+guint	jana_store_view_get_limit	(JanaStoreView *self);
+
+void	jana_store_view_set_projection	(JanaStoreView *self,
+					 JanaStoreViewProjection projection);
+
+JanaStoreViewProjection jana_store_view_get_projection (JanaStoreView *self);
+
+JanaStoreViewPredicate *jana_store_view_predicate_new	(GList *matches);
+void	jana_store_view_predicate_free		(JanaStoreViewPredicate *predicate);
+gboolean jana_store_view_predicate_match	(JanaStoreViewPredicate *predicate,
+						 JanaComponent *component);
+gboolean jana_store_view_predicate_narrows	(JanaStoreViewPredicate *predicate,
+						 JanaStoreViewPredicate *other);
+
 #endif /* JANA_STORE_VIEW_H */
 
@@ -69,6 +69,60 @@ jana_task_get_description (JanaTask *self)
 	return JANA_TASK_GET_INTERFACE (self)->get_description (self);
 }
 
+/* For implementations without peek_*, hang the copy off the task */
+static const gchar *
+task_peek_fallback (JanaTask *self, const gchar *key, gchar *value)
+{
+	g_object_set_data_full (G_OBJECT (self), key, value, g_free);
+	return value;
+}
+
+/**
+ * jana_task_peek_summary:
+ * @self: A #JanaTask
+ *
+ * Retrieves the summary of the task, without copying it. See 
+ * jana_task_get_summary().
+ *
+ * Returns: The summary of the task, or %NULL. This string is owned by @self 
+ * and must not be freed or modified. It is only valid until @self is 
+ * modified or destroyed.
+ */
+const gchar *
+jana_task_peek_summary (JanaTask *self)
+{
+	JanaTaskInterface *iface = JANA_TASK_GET_INTERFACE (self);
+
+	if (iface->peek_summary)
+		return iface->peek_summary (self);
+	else
+		return task_peek_fallback (self, "jana-task-summary",
+			iface->get_summary (self));
+}
+
+/**
+ * jana_task_peek_description:
+ * @self: A #JanaTask
+ *
+ * Retrieves the description of the task, without copying it. See 
+ * jana_task_get_description().
+ *
+ * Returns: The description of the task, or %NULL. This string is owned by 
+ * @self and must not be freed or modified. It is only valid until @self is 
+ * modified or destroyed.
+ */
+const gchar *
+jana_task_peek_description (JanaTask *self)
+{
+	JanaTaskInterface *iface = JANA_TASK_GET_INTERFACE (self);
+
+	if (iface->peek_description)
+		return iface->peek_description (self);
+	else
+		return task_peek_fallback (self, "jana-task-description",
+			iface->get_description (self));
+}
+
 gboolean
 jana_task_get_completed (JanaTask *self)
 {
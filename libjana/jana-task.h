@@ -54,12 +54,18 @@ struct _JanaTaskInterface {
 	void		(*set_completed)	(JanaTask *self, gboolean completed);
 	void		(*set_due_date)		(JanaTask *self, JanaTime *time);
 	void		(*set_priority)		(JanaTask *self, gint priority);
+
+	/* Non-allocating getters */
+	const gchar *			(*peek_summary)		(JanaTask *self);
+	const gchar *			(*peek_description)	(JanaTask *self);
 };
 
 GType jana_task_get_type (void);
 
 gchar *		jana_task_get_summary			(JanaTask *self);
 gchar *		jana_task_get_description		(JanaTask *self);
+const gchar *	jana_task_peek_summary			(JanaTask *self);
+const gchar *	jana_task_peek_description		(JanaTask *self);
 gboolean	jana_task_get_completed			(JanaTask *self);
 JanaTime *	jana_task_get_due_date			(JanaTask *self);
 gint		jana_task_get_priority			(JanaTask *self);
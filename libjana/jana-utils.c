@@ -549,6 +549,50 @@ jana_utils_time_adjust (JanaTime *time, gint year, gint month, gint day,
 		time, jana_time_get_year (time) + year);
 }
 
+/**
+ * jana_utils_time_to_seconds:
+ * @time: A #JanaTime
+ *
+ * Converts a time to the number of seconds since the Unix epoch, in UTC. 
+ * Date-only times are taken to be at the start of their day. This is 
+ * mainly useful for ordering and indexing large numbers of times, where 
+ * jana_utils_time_compare() would be too slow.
+ *
+ * Returns: The number of seconds between the Unix epoch and @time, or 
+ * %G_MININT64 if @time is %NULL or doesn't hold a valid date (as for a 
+ * component without that time set, for example).
+ */
+gint64
+jana_utils_time_to_seconds (JanaTime *time)
+{
+	GDate date;
+	gint64 seconds;
+	gint day, month, year;
+	
+	if (!time) return G_MININT64;
+	
+	day = jana_time_get_day (time);
+	month = jana_time_get_month (time);
+	year = jana_time_get_year (time);
+	if ((day < 1) || (day > 31) || (month < 1) || (month > 12) ||
+	    (year < 1) || (year > G_MAXUINT16) ||
+	    (!g_date_valid_dmy (day, month, year)))
+		return G_MININT64;
+	
+	g_date_clear (&date, 1);
+	g_date_set_dmy (&date, day, month, year);
+	
+	/* 719163 is the Julian day of the 1st of January, 1970 */
+	seconds = ((gint64)g_date_get_julian (&date) - 719163) * 24 * 60 * 60;
+	if (!jana_time_get_isdate (time)) {
+		seconds += (jana_time_get_hours (time) * 60 * 60) +
+			(jana_time_get_minutes (time) * 60) +
+			jana_time_get_seconds (time);
+	}
+	
+	return seconds - jana_time_get_offset (time);
+}
+
 /**
  * jana_utils_time_now:
  * @time: A #JanaTime to overwrite
@@ -624,20 +668,11 @@ copy_component_fields (JanaComponent *source, JanaComponent *dest)
 JanaEvent *
 jana_utils_event_copy (JanaEvent *source, JanaEvent *dest)
 {
-	gchar *string;
 	JanaTime *time;
 
-	string = jana_event_get_summary (source);
-	jana_event_set_summary (dest, string);
-	g_free (string);
-	
-	string = jana_event_get_description (source);
-	jana_event_set_description (dest, string);
-	g_free (string);
-	
-	string = jana_event_get_location (source);
-	jana_event_set_location (dest, string);
-	g_free (string);
+	jana_event_set_summary (dest, jana_event_peek_summary (source));
+	jana_event_set_description (dest, jana_event_peek_description (source));
+	jana_event_set_location (dest, jana_event_peek_location (source));
 	
 	time = jana_event_get_start (source);
 	jana_event_set_start (dest, time);
@@ -696,20 +731,11 @@ jana_utils_event_copy (JanaEvent *source, JanaEvent *dest)
 JanaNote *
 jana_utils_note_copy (JanaNote *source, JanaNote *dest)
 {
-	gchar *string;
 	JanaTime *time;
 
-	string = jana_note_get_author (source);
-	jana_note_set_author (dest, string);
-	g_free (string);
-	
-	string = jana_note_get_recipient (source);
-	jana_note_set_recipient (dest, string);
-	g_free (string);
-	
-	string = jana_note_get_body (source);
-	jana_note_set_body (dest, string);
-	g_free (string);
+	jana_note_set_author (dest, jana_note_peek_author (source));
+	jana_note_set_recipient (dest, jana_note_peek_recipient (source));
+	jana_note_set_body (dest, jana_note_peek_body (source));
 	
 	time = jana_note_get_creation_time (source);
 	jana_note_set_creation_time (dest, time);
@@ -733,18 +759,12 @@ jana_utils_note_copy (JanaNote *source, JanaNote *dest)
 JanaTask *
 jana_utils_task_copy (JanaTask *source, JanaTask *dest)
 {
-	gchar *string;
 	JanaTime *time;
 	gint priority;
 	gboolean completed;
 
-	string = jana_task_get_summary (source);
-	jana_task_set_summary (dest, string);
-	g_free (string);
-	
-	string = jana_task_get_description (source);
-	jana_task_set_description (dest, string);
-	g_free (string);
+	jana_task_set_summary (dest, jana_task_peek_summary (source));
+	jana_task_set_description (dest, jana_task_peek_description (source));
 	
 	completed = jana_task_get_completed (source);
 	jana_task_set_completed (dest, completed);
@@ -771,9 +791,23 @@ jana_utils_event_get_instances_cb (JanaTime *start, JanaTime *end,
 	
 	/* TODO: Exception support */
 	
-	/* Split instances into days */
 	instance_start = jana_time_duplicate (start);
 	jana_time_set_offset (instance_start, offset);
+	
+	/* Without an end, an event only occupies the point it starts at */
+	if (!end) {
+		if (((!range_end) || (jana_utils_time_compare (
+		     instance_start, range_end, FALSE) < 0)) &&
+		    ((!range_start) || (jana_utils_time_compare (
+		     instance_start, range_start, FALSE) >= 0)))
+			instances = g_list_append (instances,
+				jana_duration_new (instance_start,
+					instance_start));
+		g_object_unref (instance_start);
+		return instances;
+	}
+	
+	/* Split instances into days */
 	instance_end = jana_time_duplicate (instance_start);
 	jana_time_set_isdate (instance_end, TRUE);
 	jana_time_set_day (instance_end, jana_time_get_day (instance_end) + 1);
@@ -825,9 +859,11 @@ jana_utils_event_get_instances_cb (JanaTime *start, JanaTime *end,
  * last instances have their start and end adjusted correctly. If the event 
  * doesn't occur over more than one day, the list will contain just one 
  * duration whose start and end match the start and end of the event, adjusted 
- * by @offset. If @range_end is %NULL and @event has an indefinite 
- * recurrence, the recurrence will be ignored. This is to avoid 
- * infinite loops; it is discouraged to call this function without bounds.
+ * by @offset. An event without an end occurs only at its start, and gives 
+ * a duration whose start and end are the same. If @range_end is %NULL and 
+ * @event has an indefinite recurrence, the recurrence will be ignored. 
+ * This is to avoid infinite loops; it is discouraged to call this function 
+ * without bounds.
  *
  * Returns: A list of #JanaDuration's for each day @event occurs. This list 
  * should be freed with jana_utils_instance_list_free().
@@ -836,14 +872,15 @@ GList *
 jana_utils_event_get_instances (JanaEvent *event, JanaTime *range_start,
 				JanaTime *range_end, glong offset)
 {
-	JanaTime *start, *end;
+	JanaTime *start, *end, *real_end;
 	GList *instances = NULL;
 	
+	if (!(start = jana_event_get_start (event))) return NULL;
+	
 	if (jana_event_has_recurrence (event)) {
 		gint range_year;
 		JanaRecurrence *recur = jana_event_get_recurrence (event);
 		
-		start = jana_event_get_start (event);
 		/* All recurrences re-occur yearly, so we can skip to the
 		 * same year as the range_start at least.
 		 * FIXME: Verify this is ok in the situation of events
@@ -853,7 +890,11 @@ jana_utils_event_get_instances (JanaEvent *event, JanaTime *range_start,
 		if (jana_time_get_year (start) < range_year) {
 			jana_time_set_year (start, range_year);
 		}
-		end = jana_event_get_end (event);
+		/* An event without an end occurs as a point at each start, 
+		 * but end is still stepped along with start below.
+		 */
+		real_end = end = jana_event_get_end (event);
+		if (!end) end = jana_time_duplicate (start);
 
 		/* Skip recurrences if an ending bound isn't set, or if the 
 		 * interval is invalid
@@ -861,7 +902,8 @@ jana_utils_event_get_instances (JanaEvent *event, JanaTime *range_start,
 		if (((!range_end) && (!recur->end)) ||
 		    (recur->interval == 0)) {
 			instances = jana_utils_event_get_instances_cb (
-				start, end, range_start, range_end, offset);
+				start, real_end, range_start, range_end,
+				offset);
 		} else switch (recur->type) {
 		    case JANA_RECURRENCE_DAILY :
 			while (((!recur->end) || (jana_utils_time_compare (
@@ -870,7 +912,7 @@ jana_utils_event_get_instances (JanaEvent *event, JanaTime *range_start,
 				start, range_end, FALSE) < 0))) {
 				instances = g_list_concat (instances,
 					jana_utils_event_get_instances_cb (
-						start, end, range_start,
+						start, real_end, range_start,
 						range_end, offset));
 				
 				/* Increment days by the interval size */
@@ -891,7 +933,7 @@ jana_utils_event_get_instances (JanaEvent *event, JanaTime *range_start,
 				GDateWeekday day;
 				instances = g_list_concat (instances,
 					jana_utils_event_get_instances_cb (
-						start, end, range_start,
+						start, real_end, range_start,
 						range_end, offset));
 				
 				day = jana_utils_time_day_of_week (start);
@@ -950,7 +992,7 @@ jana_utils_event_get_instances (JanaEvent *event, JanaTime *range_start,
 				start, range_end, FALSE) < 0))) {
 				instances = g_list_concat (instances,
 					jana_utils_event_get_instances_cb (
-						start, end, range_start,
+						start, real_end, range_start,
 						range_end, offset));
 				
 				/* Skip months depending on interval */
@@ -1044,7 +1086,7 @@ jana_utils_event_get_instances (JanaEvent *event, JanaTime *range_start,
 				start, range_end, FALSE) < 0))) {
 				instances = g_list_concat (instances,
 					jana_utils_event_get_instances_cb (
-						start, end, range_start,
+						start, real_end, range_start,
 						range_end, offset));
 				
 				/* Increment years by the interval size */
@@ -1064,18 +1106,111 @@ jana_utils_event_get_instances (JanaEvent *event, JanaTime *range_start,
 		
 		return instances;
 	} else {
-		start = jana_event_get_start (event);
 		end = jana_event_get_end (event);
 		instances = jana_utils_event_get_instances_cb (
 			start, end, range_start, range_end, offset);
 		
 		g_object_unref (start);
-		g_object_unref (end);
+		if (end) g_object_unref (end);
 		
 		return instances;
 	}
 }
 
+/**
+ * jana_utils_event_get_next_instance:
+ * @event: A #JanaEvent
+ * @time: The time to look from
+ *
+ * Finds the first occurrence of @event that hasn't finished by @time. This 
+ * may be an occurrence that is still in progress at @time, in which case 
+ * only the part of it from the day @time falls on is returned. Unlike 
+ * jana_utils_event_get_instances(), the occurrence is not split into days, 
+ * and indefinite recurrences are followed without needing an end bound.
+ *
+ * Returns: A newly allocated #JanaDuration, to be freed with 
+ * jana_duration_free(), or %NULL if @event doesn't occur after @time.
+ */
+JanaDuration *
+jana_utils_event_get_next_instance (JanaEvent *event, JanaTime *time)
+{
+	JanaTime *start, *end, *range_end;
+	JanaRecurrence *recur;
+	GList *instances, *i;
+	JanaDuration *instance = NULL;
+	gint days;
+	
+	if (!(start = jana_event_get_start (event))) return NULL;
+	
+	if (!jana_event_has_recurrence (event)) {
+		end = jana_event_get_end (event);
+		if ((end && (jana_utils_time_compare (end, time, FALSE) > 0)) ||
+		    ((!end) && (jana_utils_time_compare (
+		     start, time, FALSE) >= 0)))
+			instance = jana_duration_new (start, end);
+		
+		g_object_unref (start);
+		if (end) g_object_unref (end);
+		
+		return instance;
+	}
+	
+	/* An event that recurs at all will recur within one interval of 
+	 * any time after it starts, so there's no need to look further.
+	 */
+	recur = jana_event_get_recurrence (event);
+	switch (recur->type) {
+	    case JANA_RECURRENCE_WEEKLY :
+		days = 7;
+		break;
+	    case JANA_RECURRENCE_MONTHLY :
+		days = 31;
+		break;
+	    case JANA_RECURRENCE_YEARLY :
+		days = 366;
+		break;
+	    case JANA_RECURRENCE_DAILY :
+	    default :
+		days = 1;
+		break;
+	}
+	days = (days * MAX (recur->interval, 1)) + 1;
+	jana_recurrence_free (recur);
+	
+	range_end = jana_time_duplicate ((jana_utils_time_compare (
+		start, time, FALSE) > 0) ? start : time);
+	jana_utils_time_adjust (range_end, 0, 0, days, 0, 0, 0);
+	instances = jana_utils_event_get_instances (event, time, range_end, 0);
+	g_object_unref (range_end);
+	
+	for (i = instances; i; i = i->next) {
+		JanaDuration *piece = (JanaDuration *)i->data;
+		
+		if (!instance) {
+			if (jana_utils_time_compare (
+			     piece->end, time, FALSE) > 0)
+				instance = jana_duration_copy (piece);
+			continue;
+		}
+		
+		/* The days after the first start at midnight, as date-only 
+		 * times, unless the event is all-day.
+		 */
+		if (jana_time_get_isdate (start) ||
+		    (!jana_time_get_isdate (piece->start)) ||
+		    (jana_utils_time_compare (
+		     piece->start, instance->end, FALSE) != 0))
+			break;
+		
+		jana_duration_set_end (instance, piece->end);
+	}
+	
+	jana_utils_instance_list_free (instances);
+	g_object_unref (start);
+	
+	return instance;
+}
+
 /**
  * jana_utils_component_insert_category:
  * @component: A #JanaComponent
@@ -1142,7 +1277,7 @@ jana_utils_component_remove_category (JanaComponent *component,
 	size = sizeof (gchar *) * length;
 	new_categories = g_slice_alloc0 (size);
 	
-	for (i = 0, j = 0; i < g_strv_length (categories); i++, j++) {
+	for (i = 0, j = 0; i < length; i++, j++) {
 		if (strcmp (categories[i], category) == 0) j--;
 		else new_categories[j] = categories[i];
 	}
@@ -1172,22 +1307,168 @@ jana_utils_component_has_category (JanaComponent *component,
 {
 	gint i;
 	gchar **categories;
+	gboolean result = FALSE;
 	
 	if (!category) return FALSE;
 	
 	categories = jana_component_get_categories (component);
 	if (!categories) return FALSE;
 	
-	for (i = 0; i < g_strv_length (categories); i++) {
+	for (i = 0; categories[i]; i++) {
 		if (strcmp (categories[i], category) == 0) {
-			g_strfreev (categories);
-			return TRUE;
+			result = TRUE;
+			break;
 		}
 	}
 
 	g_strfreev (categories);
 	
-	return FALSE;
+	return result;
+}
+
+/* Category names interned to atoms. Atom 0 is never handed out, so that it 
+ * can be used to mean 'no category'.
+ */
+static GHashTable *category_atoms = NULL;
+static GPtrArray *category_names = NULL;
+
+/**
+ * jana_utils_category_get_atom:
+ * @category: A category name
+ *
+ * Interns @category and returns a small, non-zero integer that identifies 
+ * it for the lifetime of the process. Atoms are handed out in increasing 
+ * order, starting at 1, so the categories that are seen first get the 
+ * lowest atoms and an exact bit in a category mask. See 
+ * jana_utils_category_get_mask().
+ *
+ * Returns: The atom for @category.
+ */
+guint
+jana_utils_category_get_atom (const gchar *category)
+{
+	guint atom;
+	gchar *name;
+	
+	g_return_val_if_fail (category != NULL, 0);
+	
+	if ((atom = jana_utils_category_lookup_atom (category))) return atom;
+	
+	if (!category_atoms) {
+		category_atoms = g_hash_table_new (g_str_hash, g_str_equal);
+		category_names = g_ptr_array_new ();
+		g_ptr_array_add (category_names, NULL);
+	}
+	
+	name = g_strdup (category);
+	atom = category_names->len;
+	g_ptr_array_add (category_names, name);
+	g_hash_table_insert (category_atoms, name, GUINT_TO_POINTER (atom));
+	
+	return atom;
+}
+
+/**
+ * jana_utils_category_lookup_atom:
+ * @category: A category name
+ *
+ * Looks up the atom for @category, without interning it. This is useful 
+ * when testing for a category, as a category that has never been interned 
+ * can't be set in any mask.
+ *
+ * Returns: The atom for @category, or 0 if it hasn't been interned.
+ */
+guint
+jana_utils_category_lookup_atom (const gchar *category)
+{
+	if ((!category) || (!category_atoms)) return 0;
+	
+	return GPOINTER_TO_UINT (g_hash_table_lookup (
+		category_atoms, category));
+}
+
+/**
+ * jana_utils_category_get_name:
+ * @atom: A category atom
+ *
+ * Retrieves the category name that @atom was created for.
+ *
+ * Returns: The name of the category. This string is owned by libjana and 
+ * must not be freed.
+ */
+const gchar *
+jana_utils_category_get_name (guint atom)
+{
+	if ((!category_names) || (atom >= category_names->len)) return NULL;
+	
+	return g_ptr_array_index (category_names, atom);
+}
+
+/**
+ * jana_utils_category_atom_to_mask:
+ * @atom: A category atom
+ *
+ * Gets the bit that represents @atom in a category mask. Atoms up to 63 
+ * have a bit of their own, all higher atoms share 
+ * %JANA_UTILS_CATEGORY_MASK_SHARED.
+ *
+ * Returns: The mask bit for @atom, or 0 if @atom is 0.
+ */
+guint64
+jana_utils_category_atom_to_mask (guint atom)
+{
+	if (atom == 0) return 0;
+	if (atom >= 64) return JANA_UTILS_CATEGORY_MASK_SHARED;
+	
+	return G_GUINT64_CONSTANT (1) << (atom - 1);
+}
+
+/**
+ * jana_utils_category_get_mask:
+ * @categories: A %NULL-terminated array of category names, or %NULL
+ *
+ * Interns all the categories in @categories and combines their mask bits 
+ * (see jana_utils_category_atom_to_mask()). Testing a category against 
+ * the resulting mask is a single bit test. If the bit for the category is 
+ * %JANA_UTILS_CATEGORY_MASK_SHARED, a set bit only means that the category 
+ * may be present and the category names have to be checked.
+ *
+ * Returns: The category mask for @categories.
+ */
+guint64
+jana_utils_category_get_mask (const gchar **categories)
+{
+	gint i;
+	guint64 mask = 0;
+	
+	for (i = 0; categories && categories[i]; i++) {
+		if (categories[i][0] == '\0') continue;
+		mask |= jana_utils_category_atom_to_mask (
+			jana_utils_category_get_atom (categories[i]));
+	}
+	
+	return mask;
+}
+
+/**
+ * jana_utils_component_get_category_mask:
+ * @component: A #JanaComponent
+ *
+ * Gets the category mask for the categories of @component. See 
+ * jana_utils_category_get_mask().
+ *
+ * Returns: The category mask of @component.
+ */
+guint64
+jana_utils_component_get_category_mask (JanaComponent *component)
+{
+	guint64 mask;
+	gchar **categories = jana_component_get_categories (component);
+	
+	mask = jana_utils_category_get_mask ((const gchar **)categories);
+	g_strfreev (categories);
+	
+	return mask;
 }
 
 /**
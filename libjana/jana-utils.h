@@ -61,6 +61,8 @@ void jana_utils_time_adjust (JanaTime *time, gint year, gint month, gint day,
 
 JanaTime * jana_utils_time_now (JanaTime *time);
 
+gint64 jana_utils_time_to_seconds (JanaTime *time);
+
 gboolean jana_utils_duration_contains (JanaDuration *duration, JanaTime *time);
 
 JanaEvent * jana_utils_event_copy (JanaEvent *source, JanaEvent *dest);
@@ -72,6 +74,9 @@ JanaTask * jana_utils_task_copy (JanaTask *source, JanaTask *dest);
 GList * jana_utils_event_get_instances (JanaEvent *event, JanaTime *range_start,
 					JanaTime *range_end, glong offset);
 
+JanaDuration * jana_utils_event_get_next_instance (JanaEvent *event,
+						   JanaTime *time);
+
 void jana_utils_component_insert_category (JanaComponent *component,
 					   const gchar *category,
 					   gint position);
@@ -82,6 +87,25 @@ gboolean jana_utils_component_remove_category (JanaComponent *component,
 gboolean jana_utils_component_has_category (JanaComponent *component,
 					    const gchar *category);
 
+/**
+ * JANA_UTILS_CATEGORY_MASK_SHARED:
+ *
+ * The category mask bit shared by all category atoms above 63.
+ */
+#define JANA_UTILS_CATEGORY_MASK_SHARED (G_GUINT64_CONSTANT (1) << 63)
+
+guint jana_utils_category_get_atom (const gchar *category);
+
+guint jana_utils_category_lookup_atom (const gchar *category);
+
+const gchar * jana_utils_category_get_name (guint atom);
+
+guint64 jana_utils_category_atom_to_mask (guint atom);
+
+guint64 jana_utils_category_get_mask (const gchar **categories);
+
+guint64 jana_utils_component_get_category_mask (JanaComponent *component);
+
 void jana_utils_instance_list_free (GList *instances);
 
 gchar * jana_utils_get_local_tzname ();
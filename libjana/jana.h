@@ -29,7 +29,10 @@
 
 #include <libjana/jana-component.h>
 #include <libjana/jana-event.h>
+#include <libjana/jana-memory-store.h>
+#include <libjana/jana-memory-store-view.h>
 #include <libjana/jana-note.h>
+#include <libjana/jana-occurrence-index.h>
 #include <libjana/jana-store.h>
 #include <libjana/jana-store-view.h>
 #include <libjana/jana-task.h>
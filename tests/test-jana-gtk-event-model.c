@@ -0,0 +1,280 @@
+/*
+ * Copyright (C) 2009 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St - Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include <string.h>
+#include <glib.h>
+#include <gtk/gtk.h>
+#include <libical/icaltimezone.h>
+#include <libical/icaltime.h>
+#include <libjana/jana-time.h>
+#include <libjana/jana-event.h>
+#include <libjana/jana-store.h>
+#include <libjana/jana-store-view.h>
+#include <libjana/jana-memory-store.h>
+#include <libjana-ecal/jana-ecal-time.h>
+#include <libjana-ecal/jana-ecal-event.h>
+#include <libjana-gtk/jana-gtk-event-model.h>
+#include <libjana-gtk/jana-gtk-event-store.h>
+
+/* Test if JanaGtkEventModel follows its view: Add three events on
+ * consecutive days to a memory store and open a model on a view of the
+ * store. Once the view has finished, check the rows are sorted by start,
+ * then move the first event to after the others and check it's moved with
+ * a single ::rows-reordered, remove an event and check its row goes, and
+ * finally change the model's offset and check the rows are re-instanced
+ * with it.
+ *
+ * This doesn't need evolution-data-server and should complete almost
+ * immediately. If it doesn't complete within 10 seconds, it counts as a
+ * failure.
+ *
+ * Returns 0 on success and 1 on error.
+ */
+
+static GMainLoop *main_loop;
+static int error_code;
+static gint reordered = 0;
+static JanaStore *store;
+static GtkTreeModel *model;
+static JanaEvent *event1, *event2;
+
+static void
+rows_reordered_cb (GtkTreeModel *model, GtkTreePath *path, GtkTreeIter *iter,
+		   gpointer new_order, gpointer user_data)
+{
+	reordered ++;
+}
+
+/* Checks the model's rows have the given summaries, in order */
+static gboolean
+check_rows (const gchar **summaries)
+{
+	GtkTreeIter iter;
+	gboolean valid;
+
+	if (gtk_tree_model_iter_n_children (model, NULL) !=
+	    g_strv_length ((gchar **)summaries)) return FALSE;
+
+	for (valid = gtk_tree_model_get_iter_first (model, &iter);
+	     valid; valid = gtk_tree_model_iter_next (model, &iter)) {
+		gchar *summary;
+		gboolean match;
+
+		gtk_tree_model_get (model, &iter,
+			JANA_GTK_EVENT_STORE_COL_SUMMARY, &summary, -1);
+		match = (summary && (strcmp (summary, *summaries) == 0));
+		g_free (summary);
+
+		if (!match) return FALSE;
+		summaries ++;
+	}
+
+	return TRUE;
+}
+
+/* Checks every row's start has the given offset */
+static gboolean
+check_offset (glong offset)
+{
+	GtkTreeIter iter;
+	gboolean valid;
+
+	for (valid = gtk_tree_model_get_iter_first (model, &iter);
+	     valid; valid = gtk_tree_model_iter_next (model, &iter)) {
+		JanaTime *start;
+		gboolean match;
+
+		gtk_tree_model_get (model, &iter,
+			JANA_GTK_EVENT_STORE_COL_START, &start, -1);
+		match = (start && (jana_time_get_offset (start) == offset));
+		if (start) g_object_unref (start);
+
+		if (!match) return FALSE;
+	}
+
+	return TRUE;
+}
+
+static void
+progress_cb (JanaStoreView *store_view, gint percent, gpointer user_data)
+{
+	const gchar *added[] = { "libjana event 1", "libjana event 2",
+		"libjana event 3", NULL };
+	const gchar *modified[] = { "libjana event 2", "libjana event 3",
+		"libjana event 1", NULL };
+	const gchar *removed[] = { "libjana event 3", "libjana event 1", NULL };
+	JanaTime *start, *end;
+
+	if (percent != 100) return;
+
+	if (!check_rows (added)) {
+		g_warning ("Rows not added in order");
+		g_main_loop_quit (main_loop);
+		return;
+	}
+
+	/* Move the first event after the others; the memory store emits the
+	 * change straight away.
+	 */
+	start = jana_event_get_start (event1);
+	end = jana_event_get_end (event1);
+	jana_time_set_day (start, jana_time_get_day (start) + 3);
+	jana_time_set_day (end, jana_time_get_day (end) + 3);
+	jana_event_set_start (event1, start);
+	jana_event_set_end (event1, end);
+	g_object_unref (start);
+	g_object_unref (end);
+
+	reordered = 0;
+	jana_store_modify_component (store, JANA_COMPONENT (event1));
+	if ((!check_rows (modified)) || (reordered != 1)) {
+		g_warning ("Modified row not moved");
+		g_main_loop_quit (main_loop);
+		return;
+	}
+
+	jana_store_remove_component (store, JANA_COMPONENT (event2));
+	if (!check_rows (removed)) {
+		g_warning ("Removed row still in model");
+		g_main_loop_quit (main_loop);
+		return;
+	}
+
+	jana_gtk_event_model_set_offset (JANA_GTK_EVENT_MODEL (model), 3600);
+	if ((!check_rows (removed)) || (!check_offset (3600))) {
+		g_warning ("Rows not re-instanced with new offset");
+		g_main_loop_quit (main_loop);
+		return;
+	}
+
+	error_code = 0;
+	g_main_loop_quit (main_loop);
+}
+
+static JanaEvent *
+add_event (JanaStore *store, const gchar *uid, const gchar *summary,
+	   JanaTime *start, JanaTime *end)
+{
+	JanaEvent *event;
+	ECalComponent *comp;
+
+	event = jana_ecal_event_new ();
+	g_object_get (event, "ecalcomp", &comp, NULL);
+	e_cal_component_set_uid (comp, uid);
+	g_object_unref (comp);
+
+	jana_event_set_summary (event, summary);
+	jana_event_set_start (event, start);
+	jana_event_set_end (event, end);
+	jana_store_add_component (store, JANA_COMPONENT (event));
+
+	return event;
+}
+
+static gboolean
+timeout_cb (gpointer user_data)
+{
+	g_main_loop_quit (main_loop);
+
+	return FALSE;
+}
+
+int
+main (int argc, char **argv)
+{
+	JanaStoreView *store_view;
+	JanaTime *range_start, *range_end, *start, *end;
+	JanaEvent *event3;
+	icaltimetype ical_time;
+	const icaltimezone *zone;
+
+	error_code = 1;
+
+	g_type_init ();
+
+	store = jana_memory_store_new ();
+
+	/* Events are at midday, so none of them cross into the next day
+	 * when the offset changes.
+	 */
+	zone = (const icaltimezone *)icaltimezone_get_builtin_timezone (
+		"Europe/London");
+	ical_time = icaltime_current_time_with_zone (zone);
+	ical_time.zone = zone;
+	ical_time.hour = 12;
+	ical_time.minute = 0;
+	ical_time.second = 0;
+
+	range_start = jana_ecal_time_new_from_icaltime (&ical_time);
+	range_end = jana_ecal_time_new_from_icaltime (&ical_time);
+	start = jana_ecal_time_new_from_icaltime (&ical_time);
+	end = jana_ecal_time_new_from_icaltime (&ical_time);
+
+	jana_time_set_hours (end, jana_time_get_hours (end) + 1);
+	jana_time_set_day (range_start, jana_time_get_day (range_start) - 1);
+	jana_time_set_day (range_end, jana_time_get_day (range_end) + 5);
+
+	event1 = add_event (store, "libjana-test-1", "libjana event 1",
+		start, end);
+
+	jana_time_set_day (start, jana_time_get_day (start) + 1);
+	jana_time_set_day (end, jana_time_get_day (end) + 1);
+	event2 = add_event (store, "libjana-test-2", "libjana event 2",
+		start, end);
+
+	jana_time_set_day (start, jana_time_get_day (start) + 1);
+	jana_time_set_day (end, jana_time_get_day (end) + 1);
+	event3 = add_event (store, "libjana-test-3", "libjana event 3",
+		start, end);
+
+	g_object_unref (start);
+	g_object_unref (end);
+
+	store_view = jana_store_get_view (store);
+	jana_store_view_set_range (store_view, range_start, range_end);
+
+	model = jana_gtk_event_model_new_full (store_view, 0);
+	gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (model),
+		JANA_GTK_EVENT_STORE_COL_START, GTK_SORT_ASCENDING);
+
+	g_signal_connect (G_OBJECT (model), "rows-reordered",
+		G_CALLBACK (rows_reordered_cb), NULL);
+	g_signal_connect (G_OBJECT (store_view), "progress",
+		G_CALLBACK (progress_cb), NULL);
+
+	jana_store_view_start (store_view);
+
+	g_timeout_add (10000, (GSourceFunc)timeout_cb, NULL);
+
+	main_loop = g_main_loop_new (NULL, FALSE);
+	g_main_loop_run (main_loop);
+
+	if (error_code != 0) g_warning ("Error");
+	else g_message ("Success");
+
+	g_object_unref (model);
+	g_object_unref (event1);
+	g_object_unref (event2);
+	g_object_unref (event3);
+	g_object_unref (range_start);
+	g_object_unref (range_end);
+	g_object_unref (store_view);
+	g_object_unref (store);
+
+	return error_code;
+}
@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2009 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St - Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include <glib.h>
+#include <libical/icaltimezone.h>
+#include <libical/icaltime.h>
+#include <libjana/jana-time.h>
+#include <libjana/jana-event.h>
+#include <libjana/jana-store.h>
+#include <libjana/jana-store-view.h>
+#include <libjana/jana-memory-store.h>
+#include <libjana-ecal/jana-ecal-time.h>
+#include <libjana-ecal/jana-ecal-event.h>
+
+/* Test if basic functions work for JanaMemoryStore and JanaMemoryStoreView:
+ * Add three events on differing dates to a memory store. Then open a view on 
+ * the store, initially narrowed to see just one date, then widen to view all 
+ * events, then add a match that only one event satisfies, and finally remove 
+ * the match and limit the view to the two soonest events after its start.
+ *
+ * Unlike test-jana-ecal-store-view, this doesn't need evolution-data-server 
+ * and should complete almost immediately. If it doesn't complete within 10 
+ * seconds, it counts as a failure.
+ *
+ * Returns 0 on success and 1 on error.
+ */
+
+static GMainLoop *main_loop;
+static int error_code;
+static gint stage = 0;
+static guint in_view = 0;
+static JanaTime *range_start, *range_end;
+static JanaStoreView *store_view;
+
+static void
+added_cb (JanaStoreView *store_view, GList *components, gpointer user_data)
+{
+	in_view += g_list_length (components);
+}
+
+static void
+removed_cb (JanaStoreView *store_view, GList *uids, gpointer user_data)
+{
+	in_view -= g_list_length (uids);
+}
+
+static void
+progress_cb (JanaStoreView *store_view, gint percent, gpointer user_data)
+{
+	if (percent != 100) return;
+	
+	switch (stage) {
+	    case 0 :
+		if (in_view != 1) break;
+		
+		/* Widen the view */
+		jana_time_set_day (range_end,
+			jana_time_get_day (range_end) + 2);
+		jana_time_set_day (range_start,
+			jana_time_get_day (range_start) - 2);
+		jana_store_view_set_range (store_view,
+			range_start, range_end);
+		stage ++;
+		return;
+	    case 1 :
+		if (in_view != 3) break;
+		
+		jana_store_view_add_match (store_view,
+			JANA_STORE_VIEW_SUMMARY, "EVENT 3");
+		stage ++;
+		return;
+	    case 2 :
+		if (in_view != 1) break;
+		
+		jana_store_view_begin_update (store_view);
+		jana_store_view_clear_matches (store_view);
+		jana_store_view_set_range (store_view, range_start, NULL);
+		jana_store_view_set_limit (store_view, 2);
+		jana_store_view_commit_update (store_view);
+		stage ++;
+		return;
+	    case 3 :
+		if (in_view != 2) break;
+		
+		error_code = 0;
+		break;
+	}
+	
+	g_main_loop_quit (main_loop);
+}
+
+static void
+add_event (JanaStore *store, const gchar *uid, const gchar *summary,
+	   JanaTime *start, JanaTime *end)
+{
+	JanaEvent *event;
+	ECalComponent *comp;
+	
+	event = jana_ecal_event_new ();
+	g_object_get (event, "ecalcomp", &comp, NULL);
+	e_cal_component_set_uid (comp, uid);
+	g_object_unref (comp);
+	
+	jana_event_set_summary (event, summary);
+	jana_event_set_start (event, start);
+	jana_event_set_end (event, end);
+	jana_store_add_component (store, JANA_COMPONENT (event));
+	
+	g_object_unref (event);
+}
+
+static gboolean
+timeout_cb (gpointer user_data)
+{
+	g_main_loop_quit (main_loop);
+	
+	return FALSE;
+}
+
+int
+main (int argc, char **argv)
+{
+	JanaStore *store;
+	icaltimetype ical_time;
+	const icaltimezone *zone;
+	JanaTime *start, *end;
+	
+	error_code = 1;
+	
+	g_type_init ();
+	
+	store = jana_memory_store_new ();
+	
+	zone = (const icaltimezone *)icaltimezone_get_builtin_timezone (
+		"Europe/London");
+	ical_time = icaltime_current_time_with_zone (zone);
+	ical_time.zone = zone;
+
+	range_start = jana_ecal_time_new_from_icaltime (&ical_time);
+	range_end = jana_ecal_time_new_from_icaltime (&ical_time);
+	start = jana_ecal_time_new_from_icaltime (&ical_time);
+	end = jana_ecal_time_new_from_icaltime (&ical_time);
+	
+	jana_time_set_hours (end, jana_time_get_hours (end) + 1);
+	jana_time_set_day (range_end, jana_time_get_day (range_end) + 1);
+	jana_time_set_day (range_start, jana_time_get_day (range_start) - 1);
+	
+	add_event (store, "libjana-test-1", "libjana event 1", start, end);
+	
+	jana_time_set_day (start, jana_time_get_day (start) - 2);
+	jana_time_set_day (end, jana_time_get_day (end) - 2);
+	add_event (store, "libjana-test-2", "libjana event 2", start, end);
+	
+	jana_time_set_day (start, jana_time_get_day (start) + 4);
+	jana_time_set_day (end, jana_time_get_day (end) + 4);
+	add_event (store, "libjana-test-3", "libjana event 3", start, end);
+	
+	g_object_unref (start);
+	g_object_unref (end);
+	
+	store_view = jana_store_get_view (store);
+	jana_store_view_set_range (store_view, range_start, range_end);
+
+	g_signal_connect (G_OBJECT (store_view), "added",
+		G_CALLBACK (added_cb), NULL);
+	g_signal_connect (G_OBJECT (store_view), "removed",
+		G_CALLBACK (removed_cb), NULL);
+	g_signal_connect (G_OBJECT (store_view), "progress",
+		G_CALLBACK (progress_cb), NULL);
+	
+	jana_store_view_start (store_view);
+	
+	g_timeout_add (10000, (GSourceFunc)timeout_cb, NULL);
+	
+	main_loop = g_main_loop_new (NULL, FALSE);
+	g_main_loop_run (main_loop);
+	
+	if (error_code != 0) g_warning ("Error");
+	else g_message ("Success");
+	
+	g_object_unref (range_start);
+	g_object_unref (range_end);
+	g_object_unref (store_view);
+	g_object_unref (store);
+	
+	return error_code;
+}
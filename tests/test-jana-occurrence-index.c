@@ -0,0 +1,350 @@
+/*
+ * Copyright (C) 2009 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St - Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include <glib.h>
+#include <libical/icaltimezone.h>
+#include <libical/icaltime.h>
+#include <libjana/jana-time.h>
+#include <libjana/jana-event.h>
+#include <libjana/jana-store.h>
+#include <libjana/jana-store-view.h>
+#include <libjana/jana-memory-store.h>
+#include <libjana/jana-occurrence-index.h>
+#include <libjana/jana-utils.h>
+#include <libjana-ecal/jana-ecal-time.h>
+#include <libjana-ecal/jana-ecal-event.h>
+
+/* Test if JanaOccurrenceIndex keeps track of the events in a view:
+ * Add two overlapping events, a later event and an event recurring daily
+ * for three days to a memory store, and index a view of the week around
+ * them. Once the view is done, check range queries, busy periods and
+ * conflicts, then remove one of the overlapping events, add it back, move
+ * the later event so that it overlaps too and report the recurring event
+ * again, checking the index after each step.
+ *
+ * This doesn't need evolution-data-server and should complete almost
+ * immediately. If it doesn't complete within 10 seconds, it counts as a
+ * failure.
+ *
+ * Returns 0 on success and 1 on error.
+ */
+
+static GMainLoop *main_loop;
+static int error_code;
+static gint stage = 0;
+static JanaTime *base;
+static JanaStore *store;
+static JanaStoreView *store_view;
+static JanaOccurrenceIndex *occurrence_index;
+
+static JanaTime *
+time_at (gint day, gint hours, gint minutes)
+{
+	JanaTime *time = jana_time_duplicate (base);
+	
+	jana_time_set_day (time, jana_time_get_day (time) + day);
+	jana_time_set_hours (time, hours);
+	jana_time_set_minutes (time, minutes);
+	
+	return time;
+}
+
+static gint64
+seconds_at (gint day, gint hours, gint minutes)
+{
+	gint64 seconds;
+	JanaTime *time = time_at (day, hours, minutes);
+	
+	seconds = jana_utils_time_to_seconds (time);
+	g_object_unref (time);
+	
+	return seconds;
+}
+
+static JanaEvent *
+new_event (const gchar *uid, gint day, gint start_hours, gint start_minutes,
+	   gint end_hours, gint end_minutes)
+{
+	JanaEvent *event;
+	ECalComponent *comp;
+	JanaTime *start, *end;
+	
+	event = jana_ecal_event_new ();
+	g_object_get (event, "ecalcomp", &comp, NULL);
+	e_cal_component_set_uid (comp, uid);
+	g_object_unref (comp);
+	
+	start = time_at (day, start_hours, start_minutes);
+	end = time_at (day, end_hours, end_minutes);
+	jana_event_set_summary (event, uid);
+	jana_event_set_start (event, start);
+	jana_event_set_end (event, end);
+	g_object_unref (start);
+	g_object_unref (end);
+	
+	return event;
+}
+
+static void
+add_event (JanaEvent *event)
+{
+	jana_store_add_component (store, JANA_COMPONENT (event));
+	g_object_unref (event);
+}
+
+static gboolean
+check_query (gint day, gint start_hours, gint start_minutes,
+	     gint end_hours, gint end_minutes, guint expected)
+{
+	GList *o, *occurrences;
+	gint64 last = G_MININT64;
+	gboolean result;
+	
+	occurrences = jana_occurrence_index_query_seconds (occurrence_index,
+		seconds_at (day, start_hours, start_minutes),
+		seconds_at (day, end_hours, end_minutes));
+	result = (g_list_length (occurrences) == expected);
+	
+	/* Results come in start order */
+	for (o = occurrences; o; o = o->next) {
+		JanaOccurrence *occurrence = (JanaOccurrence *)o->data;
+		if (occurrence->start < last) result = FALSE;
+		last = occurrence->start;
+	}
+	g_list_free (occurrences);
+	
+	if (!result) g_warning ("Unexpected query result at stage %d", stage);
+	
+	return result;
+}
+
+/* @blocks holds the start and end hours of each expected busy block */
+static gboolean
+check_busy (const gint *blocks, guint n_blocks)
+{
+	guint i;
+	GList *b, *busy, *indexes;
+	JanaTime *start, *end;
+	gboolean result;
+	
+	indexes = g_list_prepend (NULL, occurrence_index);
+	start = time_at (0, 0, 0);
+	end = time_at (1, 0, 0);
+	busy = jana_occurrence_index_get_busy (indexes, start, end);
+	g_object_unref (start);
+	g_object_unref (end);
+	g_list_free (indexes);
+	
+	result = (g_list_length (busy) == n_blocks);
+	for (b = busy, i = 0; result && b; b = b->next, i++) {
+		JanaDuration *block = (JanaDuration *)b->data;
+		if ((jana_utils_time_to_seconds (block->start) !=
+		     seconds_at (0, blocks[i * 2], 0)) ||
+		    (jana_utils_time_to_seconds (block->end) !=
+		     seconds_at (0, blocks[i * 2 + 1], 0)))
+			result = FALSE;
+	}
+	jana_utils_instance_list_free (busy);
+	
+	if (!result) g_warning ("Unexpected busy blocks at stage %d", stage);
+	
+	return result;
+}
+
+static gboolean
+check_conflicts (gint start_hours, gint start_minutes, gint end_hours,
+		 gint end_minutes, guint expected)
+{
+	GList *conflicts, *indexes;
+	JanaDuration *duration;
+	JanaTime *start, *end;
+	gboolean result;
+	
+	indexes = g_list_prepend (NULL, occurrence_index);
+	start = time_at (0, start_hours, start_minutes);
+	end = time_at (0, end_hours, end_minutes);
+	duration = jana_duration_new (start, end);
+	conflicts = jana_occurrence_index_get_conflicts (indexes, duration);
+	jana_duration_free (duration);
+	g_object_unref (start);
+	g_object_unref (end);
+	g_list_free (indexes);
+	
+	result = (g_list_length (conflicts) == expected);
+	g_list_free (conflicts);
+	
+	if (!result) g_warning ("Unexpected conflicts at stage %d", stage);
+	
+	return result;
+}
+
+static gboolean
+check_size (guint expected)
+{
+	if (jana_occurrence_index_get_size (occurrence_index) == expected)
+		return TRUE;
+	
+	g_warning ("Unexpected index size at stage %d", stage);
+	return FALSE;
+}
+
+static gboolean
+run_checks (void)
+{
+	GList *components;
+	JanaComponent *component;
+	const gint busy_initial[] = { 8, 9, 10, 12, 14, 15 };
+	const gint busy_removed[] = { 8, 9, 10, 11, 14, 15 };
+	const gint busy_moved[] = { 8, 9, 10, 13 };
+	
+	/* Three events today and three occurrences of the recurring one */
+	if (!check_size (6)) return FALSE;
+	if (!check_query (0, 0, 0, 23, 59, 4)) return FALSE;
+	if (!check_query (1, 0, 0, 23, 59, 1)) return FALSE;
+	if (!check_query (3, 0, 0, 23, 59, 0)) return FALSE;
+	if (!check_query (0, 10, 45, 10, 50, 2)) return FALSE;
+	if (!check_query (0, 12, 0, 14, 0, 0)) return FALSE;
+	if (!check_busy (busy_initial, 3)) return FALSE;
+	if (!check_conflicts (11, 30, 14, 30, 2)) return FALSE;
+	if (!check_conflicts (9, 0, 10, 0, 0)) return FALSE;
+	stage ++;
+	
+	/* Remove one of the overlapping events */
+	component = jana_store_get_component (store, "libjana-test-b");
+	jana_store_remove_component (store, component);
+	g_object_unref (component);
+	if (!check_size (5)) return FALSE;
+	if (!check_query (0, 10, 45, 10, 50, 1)) return FALSE;
+	if (!check_busy (busy_removed, 3)) return FALSE;
+	if (!check_conflicts (11, 30, 14, 30, 1)) return FALSE;
+	stage ++;
+	
+	/* And add it back */
+	add_event (new_event ("libjana-test-b", 0, 10, 30, 12, 0));
+	if (!check_size (6)) return FALSE;
+	if (!check_query (0, 10, 45, 10, 50, 2)) return FALSE;
+	if (!check_busy (busy_initial, 3)) return FALSE;
+	stage ++;
+	
+	/* Move the later event so that it overlaps the others */
+	component = JANA_COMPONENT (new_event (
+		"libjana-test-c", 0, 11, 0, 13, 0));
+	jana_store_modify_component (store, component);
+	g_object_unref (component);
+	if (!check_size (6)) return FALSE;
+	if (!check_query (0, 11, 30, 11, 45, 2)) return FALSE;
+	if (!check_query (0, 14, 0, 15, 0, 0)) return FALSE;
+	if (!check_busy (busy_moved, 2)) return FALSE;
+	stage ++;
+	
+	/* Report an event that's already indexed as added again */
+	component = jana_store_get_component (store, "libjana-test-r");
+	components = g_list_prepend (NULL, component);
+	g_signal_emit_by_name (store_view, "added", components);
+	g_list_free (components);
+	g_object_unref (component);
+	if (!check_size (6)) return FALSE;
+	if (!check_query (2, 0, 0, 23, 59, 1)) return FALSE;
+	
+	return TRUE;
+}
+
+static void
+progress_cb (JanaStoreView *store_view, gint percent, gpointer user_data)
+{
+	if ((percent != 100) || (stage != 0)) return;
+	
+	if (run_checks ()) error_code = 0;
+	
+	g_main_loop_quit (main_loop);
+}
+
+static gboolean
+timeout_cb (gpointer user_data)
+{
+	g_main_loop_quit (main_loop);
+	
+	return FALSE;
+}
+
+int
+main (int argc, char **argv)
+{
+	icaltimetype ical_time;
+	const icaltimezone *zone;
+	JanaRecurrence *recur;
+	JanaTime *start, *end;
+	JanaEvent *event;
+	
+	error_code = 1;
+	
+	g_type_init ();
+	
+	store = jana_memory_store_new ();
+	
+	zone = (const icaltimezone *)icaltimezone_get_builtin_timezone (
+		"Europe/London");
+	ical_time = icaltime_current_time_with_zone (zone);
+	ical_time.zone = zone;
+	
+	base = jana_ecal_time_new_from_icaltime (&ical_time);
+	jana_time_set_hours (base, 0);
+	jana_time_set_minutes (base, 0);
+	jana_time_set_seconds (base, 0);
+	
+	add_event (new_event ("libjana-test-a", 0, 10, 0, 11, 0));
+	add_event (new_event ("libjana-test-b", 0, 10, 30, 12, 0));
+	add_event (new_event ("libjana-test-c", 0, 14, 0, 15, 0));
+	
+	event = new_event ("libjana-test-r", 0, 8, 0, 9, 0);
+	recur = jana_recurrence_new ();
+	recur->end = time_at (2, 23, 0);
+	jana_event_set_recurrence (event, recur);
+	jana_recurrence_free (recur);
+	add_event (event);
+	
+	start = time_at (-1, 0, 0);
+	end = time_at (6, 0, 0);
+	store_view = jana_store_get_view (store);
+	jana_store_view_set_range (store_view, start, end);
+	g_object_unref (start);
+	g_object_unref (end);
+	
+	/* Created before the view starts, so that it sees everything */
+	occurrence_index = jana_occurrence_index_new (store_view);
+	
+	g_signal_connect (G_OBJECT (store_view), "progress",
+		G_CALLBACK (progress_cb), NULL);
+	
+	jana_store_view_start (store_view);
+	
+	g_timeout_add (10000, (GSourceFunc)timeout_cb, NULL);
+	
+	main_loop = g_main_loop_new (NULL, FALSE);
+	g_main_loop_run (main_loop);
+	
+	if (error_code != 0) g_warning ("Error");
+	else g_message ("Success");
+	
+	g_object_unref (occurrence_index);
+	g_object_unref (store_view);
+	g_object_unref (store);
+	g_object_unref (base);
+	
+	return error_code;
+}